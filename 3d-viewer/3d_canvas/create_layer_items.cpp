@@ -50,9 +50,9 @@
 #include <class_text_mod.h>
 #include <convert_basic_shapes_to_polygon.h>
 #include <trigo.h>
+#include <thread_pool.h>
 #include <utility>
 #include <vector>
-#include <thread>
 #include <algorithm>
 #include <atomic>
 
@@ -792,12 +792,12 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
         // Add zones objects
         // /////////////////////////////////////////////////////////////////////
         std::atomic<size_t> nextZone( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        TASK_GROUP tasks;
 
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+        size_t parallelThreadCount = tasks.GetThreadCount();
         for( size_t ii = 0; ii < parallelThreadCount; ++ii )
         {
-            std::thread t = std::thread( [&]()
+            tasks.Run( [&]()
             {
                 for( size_t areaId = nextZone.fetch_add( 1 );
                             areaId < static_cast<size_t>( m_board->GetAreaCount() );
@@ -814,15 +814,10 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
                         AddSolidAreasShapesToContainer( zone, layerContainer->second,
                                                         zone->GetLayer() );
                 }
-
-                threadsFinished++;
             } );
-
-            t.detach();
         }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        tasks.Wait();
 
     }
 
@@ -865,14 +860,12 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
         (m_render_engine == RENDER_ENGINE_OPENGL_LEGACY) )
     {
         std::atomic<size_t> nextItem( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        TASK_GROUP tasks;
 
-        size_t parallelThreadCount = std::min<size_t>(
-                std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-                layer_id.size() );
+        size_t parallelThreadCount = std::min<size_t>( tasks.GetThreadCount(), layer_id.size() );
         for( size_t ii = 0; ii < parallelThreadCount; ++ii )
         {
-            std::thread t = std::thread( [&nextItem, &threadsFinished, &layer_id, this]()
+            tasks.Run( [&nextItem, &layer_id, this]()
             {
                 for( size_t i = nextItem.fetch_add( 1 );
                             i < layer_id.size();
@@ -882,17 +875,12 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
 
                     if( layerPoly != m_layers_poly.end() )
                         // This will make a union of all added contours
-                        layerPoly->second->Simplify( SHAPE_POLY_SET::PM_FAST );
+                        layerPoly->second->SimplifyParallel( SHAPE_POLY_SET::PM_FAST );
                 }
-
-                threadsFinished++;
             } );
-
-            t.detach();
         }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        tasks.Wait();
     }
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
@@ -914,13 +902,13 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
         {
             // found
             SHAPE_POLY_SET *polyLayer = m_layers_outer_holes_poly[curr_layer_id];
-            polyLayer->Simplify( SHAPE_POLY_SET::PM_FAST );
+            polyLayer->SimplifyParallel( SHAPE_POLY_SET::PM_FAST );
 
             wxASSERT( m_layers_inner_holes_poly.find( curr_layer_id ) !=
                       m_layers_inner_holes_poly.end() );
 
             polyLayer = m_layers_inner_holes_poly[curr_layer_id];
-            polyLayer->Simplify( SHAPE_POLY_SET::PM_FAST );
+            polyLayer->SimplifyParallel( SHAPE_POLY_SET::PM_FAST );
         }
     }
 
@@ -931,10 +919,10 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
 
 
     // This will make a union of all added contourns
-    m_through_inner_holes_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_through_outer_holes_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_through_outer_holes_poly_NPTH.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_through_outer_holes_vias_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
+    m_through_inner_holes_poly.SimplifyParallel( SHAPE_POLY_SET::PM_FAST );
+    m_through_outer_holes_poly.SimplifyParallel( SHAPE_POLY_SET::PM_FAST );
+    m_through_outer_holes_poly_NPTH.SimplifyParallel( SHAPE_POLY_SET::PM_FAST );
+    m_through_outer_holes_vias_poly.SimplifyParallel( SHAPE_POLY_SET::PM_FAST );
     //m_through_inner_holes_vias_poly.Simplify( SHAPE_POLY_SET::PM_FAST ); // Not in use
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
@@ -1163,7 +1151,7 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
         }
 
         // This will make a union of all added contours
-        layerPoly->Simplify( SHAPE_POLY_SET::PM_FAST );
+        layerPoly->SimplifyParallel( SHAPE_POLY_SET::PM_FAST );
     }
     // End Build Tech layers
 
@@ -30,7 +30,6 @@
 #include <GL/glew.h>
 #include <climits>
 #include <atomic>
-#include <thread>
 #include <chrono>
 
 #include "c3d_render_raytracing.h"
@@ -39,6 +38,7 @@
 #include "3d_fastmath.h"
 #include "3d_math.h"
 #include "../common_ogl/ogl_utils.h"
+#include <thread_pool.h>
 #include <profile.h>        // To use GetRunningMicroSecs or another profiling utility
 
 // This should be used in future for the function
@@ -365,21 +365,19 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
     m_isPreview = false;
 
     auto startTime = std::chrono::steady_clock::now();
-    bool breakLoop = false;
 
     std::atomic<size_t> numBlocksRendered( 0 );
     std::atomic<size_t> currentBlock( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
+    TASK_GROUP tasks;
 
-    size_t parallelThreadCount = std::min<size_t>(
-            std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-            m_blockPositions.size() );
+    size_t parallelThreadCount = std::min<size_t>( tasks.GetThreadCount(),
+                                                   m_blockPositions.size() );
     for( size_t ii = 0; ii < parallelThreadCount; ++ii )
     {
-        std::thread t = std::thread( [&]()
+        tasks.Run( [&]()
         {
             for( size_t iBlock = currentBlock.fetch_add( 1 );
-                        iBlock < m_blockPositions.size() && !breakLoop;
+                        iBlock < m_blockPositions.size() && !tasks.IsCancelled();
                         iBlock = currentBlock.fetch_add( 1 ) )
             {
                 if( !m_blockPositionsWasProcessed[iBlock] )
@@ -392,18 +390,13 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
                     // to display the progress
                     if( std::chrono::duration_cast<std::chrono::milliseconds>(
                             std::chrono::steady_clock::now() - startTime ).count() > 150 )
-                        breakLoop = true;
+                        tasks.Cancel();
                 }
             }
-
-            threadsFinished++;
         } );
-
-        t.detach();
     }
 
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    tasks.Wait();
 
     m_nrBlocksRenderProgress += numBlocksRendered;
 
@@ -922,12 +915,12 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_shade( GLubyte *ptrPBO,
             aStatusTextReporter->Report( _("Rendering: Post processing shader") );
 
         std::atomic<size_t> nextBlock( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        TASK_GROUP tasks;
 
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+        size_t parallelThreadCount = tasks.GetThreadCount();
         for( size_t ii = 0; ii < parallelThreadCount; ++ii )
         {
-            std::thread t = std::thread( [&]()
+            tasks.Run( [&]()
             {
                 for( size_t y = nextBlock.fetch_add( 1 );
                             y < m_realBufferSize.y;
@@ -941,15 +934,10 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_shade( GLubyte *ptrPBO,
                         ptr++;
                     }
                 }
-
-                threadsFinished++;
             } );
-
-            t.detach();
         }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        tasks.Wait();
 
         // Set next state
         m_rt_render_state = RT_RENDER_STATE_POST_PROCESS_BLUR_AND_FINISH;
@@ -971,12 +959,12 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_blur_finish( GLubyte *ptrPBO,
     {
         // Now blurs the shader result and compute the final color
         std::atomic<size_t> nextBlock( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        TASK_GROUP tasks;
 
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+        size_t parallelThreadCount = tasks.GetThreadCount();
         for( size_t ii = 0; ii < parallelThreadCount; ++ii )
         {
-            std::thread t = std::thread( [&]()
+            tasks.Run( [&]()
             {
                 for( size_t y = nextBlock.fetch_add( 1 );
                             y < m_realBufferSize.y;
@@ -1061,15 +1049,10 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_blur_finish( GLubyte *ptrPBO,
                         ptr += 4;
                     }
                 }
-
-                threadsFinished++;
             } );
-
-            t.detach();
         }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        tasks.Wait();
 
 
         // Debug code
@@ -1086,14 +1069,13 @@ void C3D_RENDER_RAYTRACING::render_preview( GLubyte *ptrPBO )
     m_isPreview = true;
 
     std::atomic<size_t> nextBlock( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
+    TASK_GROUP tasks;
 
-    size_t parallelThreadCount = std::min<size_t>(
-            std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-            m_blockPositions.size() );
+    size_t parallelThreadCount = std::min<size_t>( tasks.GetThreadCount(),
+                                                   m_blockPositions.size() );
     for( size_t ii = 0; ii < parallelThreadCount; ++ii )
     {
-        std::thread t = std::thread( [&]()
+        tasks.Run( [&]()
         {
             for( size_t iBlock = nextBlock.fetch_add( 1 );
                         iBlock < m_blockPositionsFast.size();
@@ -1699,15 +1681,10 @@ void C3D_RENDER_RAYTRACING::render_preview( GLubyte *ptrPBO )
                     }
                 }
             }
-
-            threadsFinished++;
         } );
-
-        t.detach();
     }
 
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    tasks.Wait();
 }
 
 
@@ -32,7 +32,7 @@
 #include <string.h> // For memcpy
 
 #include <atomic>
-#include <thread>
+#include <thread_pool.h>
 #include <chrono>
 
 #ifndef CLAMP
@@ -474,13 +474,13 @@ void CIMAGE::EfxFilter( CIMAGE *aInImg, E_FILTER aFilterType )
     m_wraping = WRAP_CLAMP;
 
     std::atomic<size_t> nextRow( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
+    TASK_GROUP tasks;
 
-    size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+    size_t parallelThreadCount = tasks.GetThreadCount();
 
     for( size_t ii = 0; ii < parallelThreadCount; ++ii )
     {
-        std::thread t = std::thread( [&]()
+        tasks.Run( [&]()
         {
             for( size_t iy = nextRow.fetch_add( 1 );
                         iy < m_height;
@@ -509,15 +509,10 @@ void CIMAGE::EfxFilter( CIMAGE *aInImg, E_FILTER aFilterType )
                     m_pixels[ix + iy * m_width] = v;
                 }
             }
-
-            threadsFinished++;
         } );
-
-        t.detach();
     }
 
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    tasks.Wait();
 }
 
 
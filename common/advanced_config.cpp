@@ -68,6 +68,12 @@ static const wxChar EnableSvgImport[] = wxT( "EnableSvgImport" );
  */
 static const wxChar AllowLegacyCanvasInGtk3[] = wxT( "AllowLegacyCanvasInGtk3" );
 
+/**
+ * Record the operations of the interactive router, so a session can be saved with the
+ * dump key and replayed by the qa/pns_replay benchmark.
+ */
+static const wxChar RecordRouterEvents[] = wxT( "RecordRouterEvents" );
+
 } // namespace KEYS
 
 
@@ -147,6 +153,7 @@ ADVANCED_CFG::ADVANCED_CFG()
     // then the values will remain as set here.
     m_enableSvgImport = false;
     m_allowLegacyCanvasInGtk3 = false;
+    m_recordRouterEvents = false;
 
     loadFromConfigFile();
 }
@@ -186,6 +193,9 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
     configParams.push_back( new PARAM_CFG_BOOL(
             true, AC_KEYS::AllowLegacyCanvasInGtk3, &m_allowLegacyCanvasInGtk3, false ) );
 
+    configParams.push_back( new PARAM_CFG_BOOL(
+            true, AC_KEYS::RecordRouterEvents, &m_recordRouterEvents, false ) );
+
     wxConfigLoadSetups( &aCfg, configParams );
 
     dumpCfg( configParams );
@@ -53,15 +53,23 @@ const VECTOR2D BASIC_GAL::transform( const VECTOR2D& aPoint ) const
 
 void BASIC_GAL::DrawPolyline( const std::deque<VECTOR2D>& aPointList )
 {
-    if( aPointList.empty() )
+    std::vector<VECTOR2D> points( aPointList.begin(), aPointList.end() );
+
+    DrawPolyline( points.data(), points.size() );
+}
+
+void BASIC_GAL::DrawPolyline( const VECTOR2D aPointList[], int aListSize )
+{
+    if( aListSize <= 0 )
         return;
 
-    std::deque<VECTOR2D>::const_iterator it = aPointList.begin();
     std::vector <wxPoint> polyline_corners;
 
-    for( ; it != aPointList.end(); ++it )
+    polyline_corners.reserve( aListSize );
+
+    for( int ii = 0; ii < aListSize; ++ii )
     {
-        VECTOR2D corner = transform(*it);
+        VECTOR2D corner = transform( aPointList[ii] );
         polyline_corners.push_back( wxPoint( corner.x, corner.y ) );
     }
 
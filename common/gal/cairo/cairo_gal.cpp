@@ -34,7 +34,10 @@
 #include <gal/definitions.h>
 #include <geometry/shape_poly_set.h>
 #include <bitmap_base.h>
+#include <thread_pool.h>
 
+#include <algorithm>
+#include <atomic>
 #include <limits>
 
 #include <pixman.h>
@@ -58,6 +61,11 @@ CAIRO_GAL_BASE::CAIRO_GAL_BASE( GAL_DISPLAY_OPTIONS& aDisplayOptions ) :
     context             = nullptr;
     surface             = nullptr;
 
+    // Parallel rasterization is off unless asked for
+    m_parallelRendering = false;
+    m_deferredSurface   = nullptr;
+    m_deferredAntialias = CAIRO_ANTIALIAS_NONE;
+
     // Grid color settings are different in Cairo and OpenGL
     SetGridColor( COLOR4D( 0.1, 0.1, 0.1, 0.8 ) );
     SetAxesColor( COLOR4D( BLUE ) );
@@ -66,6 +74,7 @@ CAIRO_GAL_BASE::CAIRO_GAL_BASE( GAL_DISPLAY_OPTIONS& aDisplayOptions ) :
 
 CAIRO_GAL_BASE::~CAIRO_GAL_BASE()
 {
+    releaseCommands( m_deferred );
     ClearCache();
 
     if( surface )
@@ -79,6 +88,7 @@ CAIRO_GAL_BASE::~CAIRO_GAL_BASE()
 void CAIRO_GAL_BASE::beginDrawing()
 {
     resetContext();
+    startDeferring();
 }
 
 
@@ -86,6 +96,8 @@ void CAIRO_GAL_BASE::endDrawing()
 {
     // Force remaining objects to be drawn
     Flush();
+    flushDeferred();
+    m_deferredSurface = nullptr;
 }
 
 
@@ -108,8 +120,7 @@ void CAIRO_GAL_BASE::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& a
 
         cairo_move_to( currentContext, (double) aStartPoint.x, (double) aStartPoint.y );
         cairo_line_to( currentContext, (double) aEndPoint.x, (double) aEndPoint.y );
-        cairo_set_source_rgba( currentContext, fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-        cairo_stroke( currentContext );
+        strokePath( fillColor );
     }
     else
     {
@@ -197,8 +208,7 @@ void CAIRO_GAL_BASE::DrawArcSegment( const VECTOR2D& aCenterPoint, double aRadiu
         // Filled segments mode
         SetLineWidth( aWidth );
         cairo_arc( currentContext, aCenterPoint.x, aCenterPoint.y, aRadius, aStartAngle, aEndAngle );
-        cairo_set_source_rgba( currentContext, fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-        cairo_stroke( currentContext );
+        strokePath( fillColor );
     }
     else
     {
@@ -326,8 +336,7 @@ void CAIRO_GAL_BASE::DrawBitmap( const BITMAP_BASE& aBitmap )
     }
 
     cairo_surface_mark_dirty( image );
-    cairo_set_source_surface( currentContext, image, 0, 0 );
-    cairo_paint( currentContext );
+    paintSurface( image );
     cairo_surface_destroy( image );
 
     isElementAdded = true;
@@ -350,9 +359,8 @@ void CAIRO_GAL_BASE::Flush()
 
 void CAIRO_GAL_BASE::ClearScreen()
 {
-    cairo_set_source_rgb( currentContext, m_clearColor.r, m_clearColor.g, m_clearColor.b );
     cairo_rectangle( currentContext, 0.0, 0.0, screenSize.x, screenSize.y );
-    cairo_fill( currentContext );
+    fillPath( COLOR4D( m_clearColor.r, m_clearColor.g, m_clearColor.b, 1.0 ) );
 }
 
 
@@ -623,15 +631,13 @@ void CAIRO_GAL_BASE::DrawGroup( int aGroupNumber )
 
 
         case CMD_STROKE_PATH:
-            cairo_set_source_rgba( currentContext, strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
             cairo_append_path( currentContext, it->cairoPath );
-            cairo_stroke( currentContext );
+            strokePath( strokeColor );
             break;
 
         case CMD_FILL_PATH:
-            cairo_set_source_rgba( currentContext, fillColor.r, fillColor.g, fillColor.b, strokeColor.a );
             cairo_append_path( currentContext, it->cairoPath );
-            cairo_fill( currentContext );
+            fillPath( COLOR4D( fillColor.r, fillColor.g, fillColor.b, strokeColor.a ) );
             break;
 
             /*
@@ -774,30 +780,17 @@ void CAIRO_GAL_BASE::drawGridLine( const VECTOR2D& aStartPoint, const VECTOR2D&
 {
     cairo_move_to( currentContext, aStartPoint.x, aStartPoint.y );
     cairo_line_to( currentContext, aEndPoint.x, aEndPoint.y );
-    cairo_set_source_rgba( currentContext, strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-    cairo_stroke( currentContext );
+    strokePath( strokeColor );
 }
 
 
 void CAIRO_GAL_BASE::flushPath()
 {
    if( isFillEnabled )
-   {
-       cairo_set_source_rgba( currentContext,
-               fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-
-       if( isStrokeEnabled )
-           cairo_fill_preserve( currentContext );
-       else
-           cairo_fill( currentContext );
-   }
+       fillPath( fillColor, isStrokeEnabled );
 
    if( isStrokeEnabled )
-   {
-       cairo_set_source_rgba( currentContext,
-               strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-       cairo_stroke( currentContext );
-   }
+       strokePath( strokeColor );
 }
 
 
@@ -810,17 +803,10 @@ void CAIRO_GAL_BASE::storePath()
         if( !isGrouping )
         {
             if( isFillEnabled )
-            {
-                cairo_set_source_rgba( currentContext, fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-                cairo_fill_preserve( currentContext );
-            }
+                fillPath( fillColor, true );
 
             if( isStrokeEnabled )
-            {
-                cairo_set_source_rgba( currentContext, strokeColor.r, strokeColor.g,
-                                      strokeColor.b, strokeColor.a );
-                cairo_stroke_preserve( currentContext );
-            }
+                strokePath( strokeColor, true );
         }
         else
         {
@@ -926,6 +912,282 @@ void CAIRO_GAL_BASE::drawPoly( const SHAPE_LINE_CHAIN& aLineChain )
 }
 
 
+void CAIRO_GAL_BASE::startDeferring()
+{
+    m_deferredSurface = nullptr;
+
+    if( !m_parallelRendering || !currentContext )
+        return;
+
+    // The bands are drawn directly in the pixels, so only image surfaces can be split
+    cairo_surface_t* target = cairo_get_target( currentContext );
+
+    if( cairo_surface_get_type( target ) == CAIRO_SURFACE_TYPE_IMAGE )
+    {
+        m_deferredSurface = target;
+        m_deferredAntialias = cairo_get_antialias( currentContext );
+    }
+}
+
+
+void CAIRO_GAL_BASE::flushDeferred()
+{
+    if( m_deferred.empty() )
+        return;
+
+    rasterizeCommands( m_deferred, m_deferredSurface, m_deferredAntialias );
+    releaseCommands( m_deferred );
+}
+
+
+void CAIRO_GAL_BASE::fillPath( const COLOR4D& aColor, bool aPreserve )
+{
+    if( m_deferredSurface && cairo_get_target( currentContext ) == m_deferredSurface )
+    {
+        recordCommand( DEFERRED_COMMAND::CMD_FILL, aColor, aPreserve );
+        return;
+    }
+
+    cairo_set_source_rgba( currentContext, aColor.r, aColor.g, aColor.b, aColor.a );
+
+    if( aPreserve )
+        cairo_fill_preserve( currentContext );
+    else
+        cairo_fill( currentContext );
+}
+
+
+void CAIRO_GAL_BASE::strokePath( const COLOR4D& aColor, bool aPreserve )
+{
+    if( m_deferredSurface && cairo_get_target( currentContext ) == m_deferredSurface )
+    {
+        recordCommand( DEFERRED_COMMAND::CMD_STROKE, aColor, aPreserve );
+        return;
+    }
+
+    cairo_set_source_rgba( currentContext, aColor.r, aColor.g, aColor.b, aColor.a );
+
+    if( aPreserve )
+        cairo_stroke_preserve( currentContext );
+    else
+        cairo_stroke( currentContext );
+}
+
+
+void CAIRO_GAL_BASE::paintSurface( cairo_surface_t* aSource )
+{
+    if( m_deferredSurface && cairo_get_target( currentContext ) == m_deferredSurface )
+    {
+        DEFERRED_COMMAND command;
+
+        command.m_type = DEFERRED_COMMAND::CMD_PAINT;
+        command.m_path = nullptr;
+        command.m_source = cairo_surface_reference( aSource );
+        command.m_operator = cairo_get_operator( currentContext );
+        command.m_lineWidth = 0.0;
+        command.m_top = -std::numeric_limits<double>::max();
+        command.m_bottom = std::numeric_limits<double>::max();
+        cairo_get_matrix( currentContext, &command.m_matrix );
+
+        m_deferred.push_back( command );
+        return;
+    }
+
+    cairo_set_source_surface( currentContext, aSource, 0, 0 );
+    cairo_paint( currentContext );
+}
+
+
+void CAIRO_GAL_BASE::recordCommand( DEFERRED_COMMAND::TYPE aType, const COLOR4D& aColor,
+                                    bool aPreserve )
+{
+    if( !cairo_has_current_point( currentContext ) )
+    {
+        // Nothing to draw
+        if( !aPreserve )
+            cairo_new_path( currentContext );
+
+        return;
+    }
+
+    DEFERRED_COMMAND command;
+
+    command.m_type = aType;
+    command.m_path = cairo_copy_path( currentContext );
+    command.m_source = nullptr;
+    command.m_operator = cairo_get_operator( currentContext );
+    command.m_color = aColor;
+    command.m_lineWidth = cairo_get_line_width( currentContext );
+    cairo_get_matrix( currentContext, &command.m_matrix );
+
+    // The bands not crossed by the shape skip it
+    double x1, y1, x2, y2;
+    cairo_path_extents( currentContext, &x1, &y1, &x2, &y2 );
+
+    double xs[] = { x1, x2, x1, x2 };
+    double ys[] = { y1, y1, y2, y2 };
+
+    command.m_top = std::numeric_limits<double>::max();
+    command.m_bottom = -std::numeric_limits<double>::max();
+
+    for( int i = 0; i < 4; ++i )
+    {
+        cairo_matrix_transform_point( &command.m_matrix, &xs[i], &ys[i] );
+        command.m_top = std::min( command.m_top, ys[i] );
+        command.m_bottom = std::max( command.m_bottom, ys[i] );
+    }
+
+    // One more pixel for the antialiasing
+    double margin = 1.0;
+
+    if( aType == DEFERRED_COMMAND::CMD_STROKE )
+    {
+        double dx1 = command.m_lineWidth, dy1 = 0.0;
+        double dx2 = 0.0, dy2 = command.m_lineWidth;
+
+        cairo_matrix_transform_distance( &command.m_matrix, &dx1, &dy1 );
+        cairo_matrix_transform_distance( &command.m_matrix, &dx2, &dy2 );
+        margin += std::max( hypot( dx1, dy1 ), hypot( dx2, dy2 ) ) / 2.0;
+    }
+
+    command.m_top -= margin;
+    command.m_bottom += margin;
+
+    m_deferred.push_back( command );
+
+    if( !aPreserve )
+        cairo_new_path( currentContext );
+}
+
+
+void CAIRO_GAL_BASE::rasterizeCommands( const DEFERRED_COMMANDS& aCommands,
+                                        cairo_surface_t* aTarget, cairo_antialias_t aAntialias )
+{
+    if( aCommands.empty() )
+        return;
+
+    cairo_surface_flush( aTarget );
+
+    unsigned char* data = cairo_image_surface_get_data( aTarget );
+    cairo_format_t format = cairo_image_surface_get_format( aTarget );
+    int            width = cairo_image_surface_get_width( aTarget );
+    int            height = cairo_image_surface_get_height( aTarget );
+    int            stride = cairo_image_surface_get_stride( aTarget );
+
+    // A few bands per thread balance the load, as the shapes are rarely spread evenly;
+    // we don't want bands thinner than 16 rows (overhead costs)
+    TASK_GROUP tasks;
+    size_t     bandCount = std::min<size_t>( tasks.GetThreadCount() * 4, ( height + 15 ) / 16 );
+    size_t     parallelThreadCount = std::min<size_t>( tasks.GetThreadCount(), bandCount );
+
+    if( parallelThreadCount <= 1 )
+    {
+        rasterizeBand( aCommands, data, format, width, 0, height, stride, aAntialias );
+    }
+    else
+    {
+        int                 bandHeight = ( height + bandCount - 1 ) / bandCount;
+        std::atomic<size_t> nextBand( 0 );
+
+        auto rasterize_lambda = [&nextBand, &aCommands, bandCount, bandHeight, data, format,
+                                 width, height, stride, aAntialias]()
+        {
+            for( size_t i = nextBand++; i < bandCount; i = nextBand++ )
+            {
+                int top = i * bandHeight;
+
+                if( top < height )
+                {
+                    rasterizeBand( aCommands, data + top * stride, format, width, top,
+                                   std::min( bandHeight, height - top ), stride, aAntialias );
+                }
+            }
+        };
+
+        for( size_t ii = 1; ii < parallelThreadCount; ++ii )
+            tasks.Run( rasterize_lambda );
+
+        // The calling thread takes bands too, so the frame does not wait for workers
+        // busy with other jobs.  Wait() then only helps with the band tasks.
+        rasterize_lambda();
+        tasks.Wait();
+    }
+
+    cairo_surface_mark_dirty( aTarget );
+}
+
+
+void CAIRO_GAL_BASE::rasterizeBand( const DEFERRED_COMMANDS& aCommands, unsigned char* aData,
+                                    cairo_format_t aFormat, int aWidth, int aTop, int aHeight,
+                                    int aStride, cairo_antialias_t aAntialias )
+{
+    typedef DEFERRED_COMMAND COMMAND;
+
+    cairo_surface_t* band = cairo_image_surface_create_for_data( aData, aFormat, aWidth,
+                                                                 aHeight, aStride );
+    cairo_t*         ctx = cairo_create( band );
+
+    cairo_set_antialias( ctx, aAntialias );
+    cairo_set_line_join( ctx, CAIRO_LINE_JOIN_ROUND );
+    cairo_set_line_cap( ctx, CAIRO_LINE_CAP_ROUND );
+
+    for( const COMMAND& command : aCommands )
+    {
+        if( command.m_bottom < aTop || command.m_top >= aTop + aHeight )
+            continue;
+
+        // The band origin is the top of its first row
+        cairo_matrix_t matrix = command.m_matrix;
+        matrix.y0 -= aTop;
+
+        cairo_set_matrix( ctx, &matrix );
+        cairo_set_operator( ctx, command.m_operator );
+
+        switch( command.m_type )
+        {
+        case COMMAND::CMD_FILL:
+            cairo_append_path( ctx, command.m_path );
+            cairo_set_source_rgba( ctx, command.m_color.r, command.m_color.g, command.m_color.b,
+                                   command.m_color.a );
+            cairo_fill( ctx );
+            break;
+
+        case COMMAND::CMD_STROKE:
+            cairo_append_path( ctx, command.m_path );
+            cairo_set_line_width( ctx, command.m_lineWidth );
+            cairo_set_source_rgba( ctx, command.m_color.r, command.m_color.g, command.m_color.b,
+                                   command.m_color.a );
+            cairo_stroke( ctx );
+            break;
+
+        case COMMAND::CMD_PAINT:
+            cairo_set_source_surface( ctx, command.m_source, 0, 0 );
+            cairo_paint( ctx );
+            break;
+        }
+    }
+
+    cairo_destroy( ctx );
+    cairo_surface_finish( band );
+    cairo_surface_destroy( band );
+}
+
+
+void CAIRO_GAL_BASE::releaseCommands( DEFERRED_COMMANDS& aCommands )
+{
+    for( DEFERRED_COMMAND& command : aCommands )
+    {
+        if( command.m_path )
+            cairo_path_destroy( command.m_path );
+
+        if( command.m_source )
+            cairo_surface_destroy( command.m_source );
+    }
+
+    aCommands.clear();
+}
+
+
 unsigned int CAIRO_GAL_BASE::getNewGroupNumber()
 {
     wxASSERT_MSG( groups.size() < std::numeric_limits<unsigned int>::max(),
@@ -950,6 +1212,13 @@ CAIRO_GAL::CAIRO_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions,
     validCompositor     = false;
     SetTarget( TARGET_NONCACHED );
 
+    // The frames are rasterized by the worker threads, and refined once the view stops moving
+    m_parallelRendering = true;
+    m_frameSurface      = nullptr;
+    m_frameAntialias    = CAIRO_ANTIALIAS_NONE;
+    m_coarseFrame       = false;
+    m_lastFrameTime     = 0;
+
     parentWindow  = aParent;
     mouseListener = aMouseListener;
     paintListener = aPaintListener;
@@ -973,6 +1242,10 @@ CAIRO_GAL::CAIRO_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions,
     Connect( wxEVT_ENTER_WINDOW,    wxMouseEventHandler( CAIRO_GAL::skipMouseEvent ) );
 #endif
 
+    m_refineTimer.SetOwner( this );
+    Connect( m_refineTimer.GetId(), wxEVT_TIMER,
+             wxTimerEventHandler( CAIRO_GAL::onRefineTimer ), NULL, this );
+
     SetSize( aParent->GetClientSize() );
     screenSize = VECTOR2I( aParent->GetClientSize() );
 
@@ -985,6 +1258,8 @@ CAIRO_GAL::CAIRO_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions,
 
 CAIRO_GAL::~CAIRO_GAL()
 {
+    m_refineTimer.Stop();
+    clearFrameCommands();
     deleteBitmaps();
 }
 
@@ -1000,6 +1275,9 @@ void CAIRO_GAL::beginDrawing()
 
     compositor->SetMainContext( context );
     compositor->SetBuffer( mainBuffer );
+
+    // Only the main buffer is worth drawing in parallel
+    startDeferring();
 }
 
 
@@ -1042,6 +1320,9 @@ void CAIRO_GAL::ResizeScreen( int aWidth, int aHeight )
 {
     CAIRO_GAL_BASE::ResizeScreen( aWidth, aHeight );
 
+    // The buffers are going to be recreated
+    clearFrameCommands();
+
     // Recreate the bitmaps
     deleteBitmaps();
     allocateBitmaps();
@@ -1157,6 +1438,10 @@ void CAIRO_GAL::ClearTarget( RENDER_TARGET aTarget )
     case TARGET_CACHED:
     case TARGET_NONCACHED:
         compositor->SetBuffer( mainBuffer );
+
+        // The shapes not rasterized yet would be erased anyway
+        releaseCommands( m_deferred );
+        clearFrameCommands();
         break;
 
     case TARGET_OVERLAY:
@@ -1230,6 +1515,8 @@ void CAIRO_GAL::deleteBitmaps()
 
 void CAIRO_GAL::setCompositor()
 {
+    clearFrameCommands();
+
     // Recreate the compositor with the new Cairo context
     compositor.reset( new CAIRO_COMPOSITOR( &currentContext ) );
     compositor->Resize( screenSize.x, screenSize.y );
@@ -1243,6 +1530,72 @@ void CAIRO_GAL::setCompositor()
 }
 
 
+void CAIRO_GAL::flushDeferred()
+{
+    if( m_deferred.empty() )
+        return;
+
+    // Frames following each other closely mean the view is moving
+    wxLongLong now = wxGetLocalTimeMillis();
+    bool       moving = ( now - m_lastFrameTime ) < REFINE_DELAY;
+
+    m_lastFrameTime = now;
+
+    // Without antialiasing, there is nothing to refine
+    if( m_deferredAntialias == CAIRO_ANTIALIAS_NONE )
+    {
+        CAIRO_GAL_BASE::flushDeferred();
+        return;
+    }
+
+    if( m_frameSurface != m_deferredSurface )
+        clearFrameCommands();
+
+    rasterizeCommands( m_deferred, m_deferredSurface,
+                       moving ? CAIRO_ANTIALIAS_NONE : m_deferredAntialias );
+
+    // The shapes are kept until the main buffer is cleared, to be rasterized again
+    m_frameCommands.insert( m_frameCommands.end(), m_deferred.begin(), m_deferred.end() );
+    m_deferred.clear();
+    m_frameSurface = m_deferredSurface;
+    m_frameAntialias = m_deferredAntialias;
+
+    if( moving )
+    {
+        m_coarseFrame = true;
+        m_refineTimer.StartOnce( REFINE_DELAY );
+    }
+}
+
+
+void CAIRO_GAL::clearFrameCommands()
+{
+    releaseCommands( m_frameCommands );
+    m_frameSurface = nullptr;
+    m_coarseFrame = false;
+}
+
+
+void CAIRO_GAL::onRefineTimer( wxTimerEvent& WXUNUSED( aEvent ) )
+{
+    if( !m_coarseFrame || !validCompositor || m_frameCommands.empty() )
+        return;
+
+    // Clear the main buffer and draw the same shapes again, with antialiasing
+    cairo_surface_flush( m_frameSurface );
+    memset( cairo_image_surface_get_data( m_frameSurface ), 0x00,
+            cairo_image_surface_get_stride( m_frameSurface )
+                    * cairo_image_surface_get_height( m_frameSurface ) );
+    cairo_surface_mark_dirty( m_frameSurface );
+
+    rasterizeCommands( m_frameCommands, m_frameSurface, m_frameAntialias );
+    m_coarseFrame = false;
+
+    // The buffers are composited and shown again by the next paint
+    PostPaint();
+}
+
+
 void CAIRO_GAL::onPaint( wxPaintEvent& WXUNUSED( aEvent ) )
 {
     PostPaint();
@@ -1266,6 +1619,7 @@ bool CAIRO_GAL::updatedGalDisplayOptions( const GAL_DISPLAY_OPTIONS& aOptions )
 
         compositor->SetAntialiasingMode( options.cairo_antialiasing_mode );
         validCompositor = false;
+        clearFrameCommands();
         deinitSurface();
 
         refresh = true;
@@ -167,6 +167,21 @@ void GAL::ResetTextAttributes()
 }
 
 
+void GAL::DrawStrokes( const STROKE_POLYLINES& aStrokes )
+{
+    SetIsStroke( true );
+    SetLineWidth( aStrokes.m_lineWidth );
+
+    int start = 0;
+
+    for( int end : aStrokes.m_polylineEnds )
+    {
+        DrawPolyline( aStrokes.m_points.data() + start, end - start );
+        start = end;
+    }
+}
+
+
 VECTOR2D GAL::GetTextLineSize( const UTF8& aText ) const
 {
     // Compute the X and Y size of a given text.
@@ -34,8 +34,11 @@
 #include <gal/opengl/vertex_item.h>
 #include <gal/opengl/utils.h>
 
-#include <list>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <iterator>
 
 #ifdef __WXDEBUG__
 #include <wx/log.h>
@@ -45,10 +48,12 @@
 using namespace KIGFX;
 
 CACHED_CONTAINER::CACHED_CONTAINER( unsigned int aSize ) :
-    VERTEX_CONTAINER( aSize ), m_item( NULL ), m_chunkSize( 0 ), m_chunkOffset( 0 ), m_maxIndex( 0 )
+    VERTEX_CONTAINER( aSize ), m_item( NULL ), m_chunkSize( 0 ), m_chunkOffset( 0 ), m_maxIndex( 0 ),
+    m_bytesMoved( 0 )
 {
     // In the beginning there is only free space
-    m_freeChunks.insert( std::make_pair( aSize, 0 ) );
+    m_freeSpace = 0;
+    addFreeChunk( 0, aSize );
 }
 
 
@@ -63,6 +68,10 @@ void CACHED_CONTAINER::SetItem( VERTEX_ITEM* aItem )
     // Get the previously set offset if the item was stored previously
     m_chunkOffset = itemSize > 0 ? aItem->GetOffset() : -1;
 
+    // The chunk of the modified item may move, it is stored again when finished
+    if( itemSize > 0 )
+        m_items.erase( m_chunkOffset );
+
 #if CACHED_CONTAINER_TEST > 1
     wxLogDebug( wxT( "Adding/editing item 0x%08lx (size %d)" ), (long) m_item, itemSize );
 #endif
@@ -74,22 +83,20 @@ void CACHED_CONTAINER::FinishItem()
     assert( m_item != NULL );
 
     unsigned int itemSize = m_item->GetSize();
+    unsigned int itemOffset = m_item->GetOffset();
 
     // Finishing the previously edited item
     if( itemSize < m_chunkSize )
     {
         // There is some not used but reserved memory left, so we should return it to the pool
-        int itemOffset = m_item->GetOffset();
-
-        // Add the not used memory back to the pool
         addFreeChunk( itemOffset + itemSize, m_chunkSize - itemSize );
-        // mergeFreeChunks();   // veery slow and buggy
-
-        m_maxIndex = std::max( itemOffset + itemSize, m_maxIndex );
     }
 
     if( itemSize > 0 )
-        m_items.insert( m_item );
+    {
+        m_items[itemOffset] = m_item;
+        m_maxIndex = std::max( itemOffset + itemSize, m_maxIndex );
+    }
 
     m_item = NULL;
     m_chunkSize = 0;
@@ -146,14 +153,15 @@ VERTEX* CACHED_CONTAINER::Allocate( unsigned int aSize )
 void CACHED_CONTAINER::Delete( VERTEX_ITEM* aItem )
 {
     assert( aItem != NULL );
-    assert( m_items.find( aItem ) != m_items.end() || aItem->GetSize() == 0 );
 
-    int size = aItem->GetSize();
+    unsigned int size = aItem->GetSize();
 
     if( size == 0 )
         return;     // Item is not stored here
 
-    int offset = aItem->GetOffset();
+    unsigned int offset = aItem->GetOffset();
+
+    assert( m_items.count( offset ) && m_items.at( offset ) == aItem );
 
 #if CACHED_CONTAINER_TEST > 1
     wxLogDebug( wxT( "Removing 0x%08lx (size %d offset %d)" ), (long) aItem, size, offset );
@@ -165,45 +173,43 @@ void CACHED_CONTAINER::Delete( VERTEX_ITEM* aItem )
     // Indicate that the item is not stored in the container anymore
     aItem->setSize( 0 );
 
-    m_items.erase( aItem );
+    m_items.erase( offset );
+
+    if( offset + size >= m_maxIndex )
+        m_maxIndex = usedEnd();
 
 #if CACHED_CONTAINER_TEST > 0
     test();
 #endif
-
-    // This dynamic memory freeing optimize memory usage, but in fact can create
-    // out of memory issues because freeing and reallocation large chuncks of memory
-    // can create memory fragmentation and no room to reallocate large chuncks
-    // after many free/reallocate cycles during a session using the same complex board
-    // So it can be disable.
-    // Currently: it is disable to avoid "out of memory" issues
-#if 0
-    // Dynamic memory freeing, there is no point in holding
-    // a large amount of memory when there is no use for it
-    if( m_freeSpace > ( 0.75 * m_currentSize ) && m_currentSize > m_initialSize )
-    {
-        defragmentResize( 0.5 * m_currentSize );
-    }
-#endif
 }
 
 
 void CACHED_CONTAINER::Clear()
 {
-    m_freeSpace = m_currentSize;
     m_maxIndex = 0;
     m_failed = false;
 
     // Set the size of all the stored VERTEX_ITEMs to 0, so it is clear that they are not held
     // in the container anymore
     for( ITEMS::iterator it = m_items.begin(); it != m_items.end(); ++it )
-        ( *it )->setSize( 0 );
+        it->second->setSize( 0 );
 
     m_items.clear();
 
     // Now there is only free space left
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, 0 ) );
+    clearFreeChunks();
+    addFreeChunk( 0, m_currentSize );
+}
+
+
+double CACHED_CONTAINER::GetFragmentation() const
+{
+    if( m_freeSpace == 0 )
+        return 0.0;
+
+    unsigned int largest = m_freeChunks.empty() ? 0 : getChunkSize( *m_freeChunks.rbegin() );
+
+    return 1.0 - (double) largest / m_freeSpace;
 }
 
 
@@ -218,30 +224,54 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
     wxLogDebug( wxT( "Resize %p from %d to %d" ), m_item, itemSize, aSize );
 #endif
 
-    // Find a free space chunk >= aSize
-    FREE_CHUNK_MAP::iterator newChunk = m_freeChunks.lower_bound( aSize );
+    // The chunk may simply grow, if it is followed by enough free space
+    auto growChunk = [&]() -> bool
+    {
+        if( m_chunkSize == 0 )
+            return false;
+
+        auto next = m_freeOffsets.find( m_chunkOffset + m_chunkSize );
+
+        if( next == m_freeOffsets.end() || m_chunkSize + next->second < aSize )
+            return false;
+
+        // The whole free chunk is taken, FinishItem() returns what is not used
+        m_chunkSize += next->second;
+        takeFreeChunk( CHUNK( next->second, next->first ) );
+
+        return true;
+    };
+
+    if( growChunk() )
+        return true;
+
+    // Find the smallest free space chunk >= aSize
+    FREE_CHUNK_MAP::iterator newChunk = m_freeChunks.lower_bound( CHUNK( aSize, 0 ) );
 
     // Is there enough space to store vertices?
     if( newChunk == m_freeChunks.end() )
     {
-        bool result;
+        unsigned int newSize;
 
         // Would it be enough to double the current space?
         if( aSize < m_freeSpace + m_currentSize )
         {
             // Yes: exponential growing
-            result = defragmentResize( m_currentSize * 2 );
+            newSize = m_currentSize * 2;
         }
         else
         {
             // No: grow to the nearest greater power of 2
-            result = defragmentResize( pow( 2, ceil( log2( m_currentSize * 2 + aSize ) ) ) );
+            newSize = pow( 2, ceil( log2( m_currentSize * 2 + aSize ) ) );
         }
 
-        if( !result )
+        if( !resize( newSize ) )
             return false;
 
-        newChunk = m_freeChunks.lower_bound( aSize );
+        if( growChunk() )
+            return true;
+
+        newChunk = m_freeChunks.lower_bound( CHUNK( aSize, 0 ) );
         assert( newChunk != m_freeChunks.end() );
     }
 
@@ -252,23 +282,24 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
     assert( newChunkSize >= aSize );
     assert( newChunkOffset < m_currentSize );
 
+    // Remove the new allocated chunk from the free space pool
+    takeFreeChunk( *newChunk );
+
     // Check if the item was previously stored in the container
     if( itemSize > 0 )
     {
 #if CACHED_CONTAINER_TEST > 3
         wxLogDebug( wxT( "Moving 0x%08x from 0x%08x to 0x%08x" ),
-                    (int) m_item, oldChunkOffset, newChunkOffset );
+                    (int) m_item, m_chunkOffset, newChunkOffset );
 #endif
         // The item was reallocated, so we have to copy all the old data to the new place
         memcpy( &m_vertices[newChunkOffset], &m_vertices[m_chunkOffset], itemSize * VERTEX_SIZE );
-
-        // Free the space used by the previous chunk
-        addFreeChunk( m_chunkOffset, m_chunkSize );
+        m_bytesMoved += itemSize * VERTEX_SIZE;
     }
 
-    // Remove the new allocated chunk from the free space pool
-    m_freeChunks.erase( newChunk );
-    m_freeSpace -= newChunkSize;
+    // Free the space used by the previous chunk
+    if( m_chunkSize > 0 )
+        addFreeChunk( m_chunkOffset, m_chunkSize );
 
     m_chunkSize = newChunkSize;
     m_chunkOffset = newChunkOffset;
@@ -279,106 +310,168 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
 }
 
 
-void CACHED_CONTAINER::defragment( VERTEX* aTarget )
+void CACHED_CONTAINER::defragmentStep()
 {
-    // Defragmentation
-    ITEMS::iterator it, it_end;
-    int newOffset = 0;
-
-    for( VERTEX_ITEM* item : m_items )
-    {
-        int itemOffset    = item->GetOffset();
-        int itemSize      = item->GetSize();
-
-        // Move an item to the new container
-        memcpy( &aTarget[newOffset], &m_vertices[itemOffset], itemSize * VERTEX_SIZE );
-
-        // Update new offset
-        item->setOffset( newOffset );
-
-        // Move to the next free space
-        newOffset += itemSize;
-    }
-
-    // Move the current item and place it at the end
-    if( m_item->GetSize() > 0 )
-    {
-        memcpy( &aTarget[newOffset], &m_vertices[m_item->GetOffset()],
-                m_item->GetSize() * VERTEX_SIZE );
-        m_item->setOffset( newOffset );
-        m_chunkOffset = newOffset;
-    }
+    assert( IsMapped() );
 
-    m_maxIndex = usedSpace();
-}
+    // Nothing to do while an item is modified, or if there are only a few small holes
+    if( m_item || m_freeChunks.size() < 2 )
+        return;
 
+    unsigned int largest = getChunkSize( *m_freeChunks.rbegin() );
 
-void CACHED_CONTAINER::mergeFreeChunks()
-{
-    if( m_freeChunks.size() <= 1 ) // There are no chunks that can be merged
+    if( m_freeSpace - largest < m_currentSize / 8 )
         return;
 
 #ifdef __WXDEBUG__
     PROF_COUNTER totalTime;
 #endif /* __WXDEBUG__ */
 
-    // Reversed free chunks map - this one stores chunk size with its offset as the key
-    std::list<CHUNK> freeChunks;
-
-    FREE_CHUNK_MAP::const_iterator it, it_end;
+    unsigned int moved = 0;
+    unsigned int limit = usedEnd();
+    int          misses = 0;
 
-    for( it = m_freeChunks.begin(), it_end = m_freeChunks.end(); it != it_end; ++it )
+    // Move the last items to the best fitting holes before them
+    while( moved < DEFRAGMENT_STEP_SIZE && misses < 64 )
     {
-        freeChunks.push_back( std::make_pair( it->second, it->first ) );
-    }
+        ITEMS::iterator it = m_items.lower_bound( limit );
 
-    m_freeChunks.clear();
-    freeChunks.sort();
+        if( it == m_items.begin() )
+            break;
 
-    std::list<CHUNK>::const_iterator itf, itf_end;
-    unsigned int offset = freeChunks.front().first;
-    unsigned int size   = freeChunks.front().second;
-    freeChunks.pop_front();
+        --it;
 
-    for( itf = freeChunks.begin(), itf_end = freeChunks.end(); itf != itf_end; ++itf )
-    {
-        if( itf->first == offset + size )
+        VERTEX_ITEM* item   = it->second;
+        unsigned int offset = it->first;
+        unsigned int size   = item->GetSize();
+
+        limit = offset;
+
+        FREE_CHUNK_MAP::iterator hole = m_freeChunks.lower_bound( CHUNK( size, 0 ) );
+
+        // Among the chunks of the same size, the ones at lower offsets come first
+        for( int ii = 0; ii < 4 && hole != m_freeChunks.end(); ++ii, ++hole )
         {
-            // These chunks can be merged, so just increase the current chunk size and go on
-            size += itf->second;
+            if( getChunkOffset( *hole ) < offset )
+                break;
         }
-        else
-        {
-            // These chunks cannot be merged
-            // So store the previous one
-            m_freeChunks.insert( std::make_pair( size, offset ) );
-            // and let's check the next chunk
-            offset = itf->first;
-            size   = itf->second;
 
+        if( hole == m_freeChunks.end() || getChunkOffset( *hole ) > offset )
+        {
+            misses++;
+            continue;
         }
+
+        CHUNK target = *hole;
+
+        takeFreeChunk( target );
+        memcpy( &m_vertices[getChunkOffset( target )], &m_vertices[offset], size * VERTEX_SIZE );
+
+        if( getChunkSize( target ) > size )
+            addFreeChunk( getChunkOffset( target ) + size, getChunkSize( target ) - size );
+
+        addFreeChunk( offset, size );
+
+        m_items.erase( it );
+        m_items[getChunkOffset( target )] = item;
+        item->setOffset( getChunkOffset( target ) );
+
+        moved += size;
     }
 
-    // Add the last one
-    m_freeChunks.insert( std::make_pair( size, offset ) );
+    if( moved == 0 )
+        return;
+
+    m_bytesMoved += moved * VERTEX_SIZE;
+    m_maxIndex = usedEnd();
+    m_dirty = true;
 
 #ifdef __WXDEBUG__
     totalTime.Stop();
-    wxLogDebug( "Merged free chunks / %.1f ms", totalTime.msecs() );
+
+    wxLogTrace( "GAL_CACHED_CONTAINER",
+                "Defragmentation step: moved %u vertices, %u free chunks, "
+                "fragmentation %.2f / %.1f ms",
+                moved, GetFreeChunkCount(), GetFragmentation(), totalTime.msecs() );
 #endif /* __WXDEBUG__ */
+
 #if CACHED_CONTAINER_TEST > 0
     test();
 #endif
 }
 
 
+unsigned int CACHED_CONTAINER::usedEnd() const
+{
+    unsigned int end = 0;
+
+    if( !m_items.empty() )
+        end = m_items.rbegin()->first + m_items.rbegin()->second->GetSize();
+
+    if( m_item && m_chunkSize > 0 )
+        end = std::max( end, m_chunkOffset + m_chunkSize );
+
+    return end;
+}
+
+
 void CACHED_CONTAINER::addFreeChunk( unsigned int aOffset, unsigned int aSize )
 {
     assert( aOffset + aSize <= m_currentSize );
     assert( aSize > 0 );
 
-    m_freeChunks.insert( std::make_pair( aSize, aOffset ) );
     m_freeSpace += aSize;
+
+    // Merge the chunk with the free chunks right before and after it
+    FREE_CHUNK_OFFSETS::iterator next = m_freeOffsets.lower_bound( aOffset );
+
+    assert( next == m_freeOffsets.end() || next->first >= aOffset + aSize );
+
+    if( next != m_freeOffsets.end() && next->first == aOffset + aSize )
+    {
+        aSize += next->second;
+        m_freeChunks.erase( CHUNK( next->second, next->first ) );
+        next = m_freeOffsets.erase( next );
+    }
+
+    if( next != m_freeOffsets.begin() )
+    {
+        FREE_CHUNK_OFFSETS::iterator prev = std::prev( next );
+
+        assert( prev->first + prev->second <= aOffset );
+
+        if( prev->first + prev->second == aOffset )
+        {
+            aOffset = prev->first;
+            aSize += prev->second;
+            m_freeChunks.erase( CHUNK( prev->second, prev->first ) );
+            m_freeOffsets.erase( prev );
+        }
+    }
+
+    m_freeChunks.insert( CHUNK( aSize, aOffset ) );
+    m_freeOffsets[aOffset] = aSize;
+}
+
+
+void CACHED_CONTAINER::takeFreeChunk( const CHUNK& aChunk )
+{
+    // Copied, as the reference may point to the erased entry
+    CHUNK chunk = aChunk;
+
+    assert( m_freeChunks.count( chunk ) );
+
+    m_freeChunks.erase( chunk );
+    m_freeOffsets.erase( getChunkOffset( chunk ) );
+    m_freeSpace -= getChunkSize( chunk );
+}
+
+
+void CACHED_CONTAINER::clearFreeChunks()
+{
+    m_freeChunks.clear();
+    m_freeOffsets.clear();
+    m_freeSpace = 0;
 }
 
 
@@ -411,7 +504,7 @@ void CACHED_CONTAINER::showUsedChunks()
 
     for( it = m_items.begin(); it != m_items.end(); ++it )
     {
-        VERTEX_ITEM* item   = *it;
+        VERTEX_ITEM* item   = it->second;
         unsigned int offset = item->GetOffset();
         unsigned int size   = item->GetSize();
         assert( size > 0 );
@@ -439,7 +532,7 @@ void CACHED_CONTAINER::test()
     unsigned int used_space = 0;
     ITEMS::iterator itr;
     for( itr = m_items.begin(); itr != m_items.end(); ++itr )
-        used_space += ( *itr )->GetSize();
+        used_space += itr->second->GetSize();
 
     // If we have a chunk assigned, then there must be an item edited
     assert( m_chunkSize == 0 || m_item );
@@ -85,6 +85,9 @@ void CACHED_CONTAINER_GPU::Unmap()
 {
     wxCHECK( IsMapped(), /*void*/ );
 
+    // Some of the defragmentation is done at every update
+    defragmentStep();
+
     glUnmapBuffer( GL_ARRAY_BUFFER );
     checkGlError( "unmapping vertices buffer" );
     glBindBuffer( GL_ARRAY_BUFFER, 0 );
@@ -95,25 +98,23 @@ void CACHED_CONTAINER_GPU::Unmap()
 }
 
 
-bool CACHED_CONTAINER_GPU::defragmentResize( unsigned int aNewSize )
+bool CACHED_CONTAINER_GPU::resize( unsigned int aNewSize )
 {
     if( !m_useCopyBuffer )
-        return defragmentResizeMemcpy( aNewSize );
+        return resizeMemcpy( aNewSize );
 
     wxCHECK( IsMapped(), false );
+    wxCHECK( aNewSize > m_currentSize, false );
 
     wxLogTrace( "GAL_CACHED_CONTAINER_GPU",
-            wxT( "Resizing & defragmenting container from %d to %d" ), m_currentSize, aNewSize );
-
-    // No shrinking if we cannot fit all the data
-    if( usedSpace() > aNewSize )
-        return false;
+            wxT( "Resizing container from %d to %d" ), m_currentSize, aNewSize );
 
 #ifdef __WXDEBUG__
     PROF_COUNTER totalTime;
 #endif /* __WXDEBUG__ */
 
     GLuint newBuffer;
+    unsigned int copySize = usedEnd();
 
     // glCopyBufferSubData requires a buffer to be unmapped
     glUnmapBuffer( GL_ARRAY_BUFFER );
@@ -130,38 +131,14 @@ bool CACHED_CONTAINER_GPU::defragmentResize( unsigned int aNewSize )
 #endif /* __WXDEBUG__ */
     glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, newBuffer );
     glBufferData( GL_ELEMENT_ARRAY_BUFFER, aNewSize * VERTEX_SIZE, NULL, GL_DYNAMIC_DRAW );
-    checkGlError( "creating buffer during defragmentation" );
+    checkGlError( "creating buffer during resizing" );
 
-    ITEMS::iterator it, it_end;
-    int newOffset = 0;
-
-    // Defragmentation
-    for( it = m_items.begin(), it_end = m_items.end(); it != it_end; ++it )
+    // The items keep their offsets, so the used part of the buffer is copied at once
+    if( copySize > 0 )
     {
-        VERTEX_ITEM* item = *it;
-        int itemOffset    = item->GetOffset();
-        int itemSize      = item->GetSize();
-
-        // Move an item to the new container
-        glCopyBufferSubData( GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER,
-                itemOffset * VERTEX_SIZE, newOffset * VERTEX_SIZE, itemSize * VERTEX_SIZE );
-
-        // Update new offset
-        item->setOffset( newOffset );
-
-        // Move to the next free space
-        newOffset += itemSize;
-    }
-
-    // Move the current item and place it at the end
-    if( m_item->GetSize() > 0 )
-    {
-        glCopyBufferSubData( GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER,
-                m_item->GetOffset() * VERTEX_SIZE, newOffset * VERTEX_SIZE,
-                m_item->GetSize() * VERTEX_SIZE );
-
-        m_item->setOffset( newOffset );
-        m_chunkOffset = newOffset;
+        glCopyBufferSubData( GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, 0, 0,
+                             copySize * VERTEX_SIZE );
+        m_bytesMoved += copySize * VERTEX_SIZE;
     }
 
     // Cleanup
@@ -176,38 +153,31 @@ bool CACHED_CONTAINER_GPU::defragmentResize( unsigned int aNewSize )
     // Switch to the new vertex buffer
     m_glBufferHandle = newBuffer;
     Map();
-    checkGlError( "switching buffers during defragmentation" );
+    checkGlError( "switching buffers during resizing" );
 
 #ifdef __WXDEBUG__
     totalTime.Stop();
 
     wxLogTrace( "GAL_CACHED_CONTAINER_GPU",
-                "Defragmented container storing %d vertices / %.1f ms",
+                "Resized container storing %d vertices / %.1f ms",
                 m_currentSize - m_freeSpace, totalTime.msecs() );
 #endif /* __WXDEBUG__ */
 
-    m_freeSpace += ( aNewSize - m_currentSize );
+    unsigned int oldSize = m_currentSize;
     m_currentSize = aNewSize;
-
-    // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
+    addFreeChunk( oldSize, aNewSize - oldSize );
 
     return true;
 }
 
 
-bool CACHED_CONTAINER_GPU::defragmentResizeMemcpy( unsigned int aNewSize )
+bool CACHED_CONTAINER_GPU::resizeMemcpy( unsigned int aNewSize )
 {
     wxCHECK( IsMapped(), false );
+    wxCHECK( aNewSize > m_currentSize, false );
 
     wxLogTrace( "GAL_CACHED_CONTAINER_GPU",
-            wxT( "Resizing & defragmenting container (memcpy) from %d to %d" ),
-            m_currentSize, aNewSize );
-
-    // No shrinking if we cannot fit all the data
-    if( usedSpace() > aNewSize )
-        return false;
+            wxT( "Resizing container (memcpy) from %d to %d" ), m_currentSize, aNewSize );
 
 #ifdef __WXDEBUG__
     PROF_COUNTER totalTime;
@@ -215,6 +185,7 @@ bool CACHED_CONTAINER_GPU::defragmentResizeMemcpy( unsigned int aNewSize )
 
     GLuint newBuffer;
     VERTEX* newBufferMem;
+    unsigned int copySize = usedEnd();
 
     // Create the destination buffer
     glGenBuffers( 1, &newBuffer );
@@ -229,9 +200,11 @@ bool CACHED_CONTAINER_GPU::defragmentResizeMemcpy( unsigned int aNewSize )
     glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, newBuffer );
     glBufferData( GL_ELEMENT_ARRAY_BUFFER, aNewSize * VERTEX_SIZE, NULL, GL_DYNAMIC_DRAW );
     newBufferMem = static_cast<VERTEX*>( glMapBuffer( GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY ) );
-    checkGlError( "creating buffer during defragmentation" );
+    checkGlError( "creating buffer during resizing" );
 
-    defragment( newBufferMem );
+    // The items keep their offsets, so the used part of the buffer is copied at once
+    memcpy( newBufferMem, m_vertices, copySize * VERTEX_SIZE );
+    m_bytesMoved += copySize * VERTEX_SIZE;
 
     // Cleanup
     glUnmapBuffer( GL_ELEMENT_ARRAY_BUFFER );
@@ -242,22 +215,19 @@ bool CACHED_CONTAINER_GPU::defragmentResizeMemcpy( unsigned int aNewSize )
     // Switch to the new vertex buffer
     m_glBufferHandle = newBuffer;
     Map();
-    checkGlError( "switching buffers during defragmentation" );
+    checkGlError( "switching buffers during resizing" );
 
 #ifdef __WXDEBUG__
     totalTime.Stop();
 
     wxLogTrace( "GAL_CACHED_CONTAINER_GPU",
-                "Defragmented container storing %d vertices / %.1f ms",
+                "Resized container storing %d vertices / %.1f ms",
                 m_currentSize - m_freeSpace, totalTime.msecs() );
 #endif /* __WXDEBUG__ */
 
-    m_freeSpace += ( aNewSize - m_currentSize );
+    unsigned int oldSize = m_currentSize;
     m_currentSize = aNewSize;
-
-    // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
+    addFreeChunk( oldSize, aNewSize - oldSize );
 
     return true;
 }
@@ -58,6 +58,9 @@ CACHED_CONTAINER_RAM::~CACHED_CONTAINER_RAM()
 
 void CACHED_CONTAINER_RAM::Unmap()
 {
+    // Some of the defragmentation is done at every frame
+    defragmentStep();
+
     if( !m_dirty )
         return;
 
@@ -71,45 +74,37 @@ void CACHED_CONTAINER_RAM::Unmap()
 }
 
 
-bool CACHED_CONTAINER_RAM::defragmentResize( unsigned int aNewSize )
+bool CACHED_CONTAINER_RAM::resize( unsigned int aNewSize )
 {
     wxLogTrace( "GAL_CACHED_CONTAINER",
-            wxT( "Resizing & defragmenting container (memcpy) from %d to %d" ),
-            m_currentSize, aNewSize );
+            wxT( "Resizing container from %d to %d" ), m_currentSize, aNewSize );
 
-    // No shrinking if we cannot fit all the data
-    if( usedSpace() > aNewSize )
-        return false;
+    wxCHECK( aNewSize > m_currentSize, false );
 
 #ifdef __WXDEBUG__
     PROF_COUNTER totalTime;
 #endif /* __WXDEBUG__ */
 
-    VERTEX* newBufferMem = static_cast<VERTEX*>( malloc( aNewSize * VERTEX_SIZE ) );
+    // The items keep their offsets, so the buffer is simply enlarged
+    VERTEX* newBufferMem = static_cast<VERTEX*>( realloc( m_vertices, aNewSize * VERTEX_SIZE ) );
 
     if( !newBufferMem )
         return false;
 
-    defragment( newBufferMem );
-
-    // Switch to the new vertex buffer
-    free( m_vertices );
     m_vertices = newBufferMem;
+    m_bytesMoved += usedEnd() * VERTEX_SIZE;
 
 #ifdef __WXDEBUG__
     totalTime.Stop();
 
     wxLogTrace( "GAL_CACHED_CONTAINER",
-                "Defragmented container storing %d vertices / %.1f ms",
+                "Resized container storing %d vertices / %.1f ms",
                 m_currentSize - m_freeSpace, totalTime.msecs() );
 #endif /* __WXDEBUG__ */
 
-    m_freeSpace += ( aNewSize - m_currentSize );
+    unsigned int oldSize = m_currentSize;
     m_currentSize = aNewSize;
-
-    // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
+    addFreeChunk( oldSize, aNewSize - oldSize );
     m_dirty = true;
 
     return true;
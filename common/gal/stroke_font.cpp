@@ -48,14 +48,14 @@ STROKE_FONT::STROKE_FONT( GAL* aGal ) :
 
 bool STROKE_FONT::LoadNewStrokeFont( const char* const aNewStrokeFont[], int aNewStrokeFontSize )
 {
-    m_glyphs.clear();
+    m_glyphStrokes.clear();
     m_glyphBoundingBoxes.clear();
-    m_glyphs.resize( aNewStrokeFontSize );
+    m_glyphStrokes.resize( aNewStrokeFontSize );
     m_glyphBoundingBoxes.resize( aNewStrokeFontSize );
 
     for( int j = 0; j < aNewStrokeFontSize; j++ )
     {
-        GLYPH&   glyph = m_glyphs[j];
+        GLYPH    glyph;
         double   glyphStartX = 0.0;
         double   glyphEndX = 0.0;
         VECTOR2D glyphBoundingX;
@@ -117,6 +117,15 @@ bool STROKE_FONT::LoadNewStrokeFont( const char* const aNewStrokeFont[], int aNe
 
         // Compute the bounding box of the glyph
         m_glyphBoundingBoxes[j] = computeBoundingBox( glyph, glyphBoundingX );
+
+        // Store the strokes in a single buffer
+        GLYPH_STROKES& strokes = m_glyphStrokes[j];
+
+        for( const std::deque<VECTOR2D>& pointList : glyph )
+        {
+            strokes.m_points.insert( strokes.m_points.end(), pointList.begin(), pointList.end() );
+            strokes.m_strokeEnds.push_back( strokes.m_points.size() );
+        }
     }
 
     return true;
@@ -165,26 +174,52 @@ void STROKE_FONT::Draw( const UTF8& aText, const VECTOR2D& aPosition, double aRo
     if( aText.empty() )
         return;
 
-    // Context needs to be saved before any transformations
-    m_gal->Save();
+    STROKE_TEXT_ATTRIBUTES attributes;
+
+    attributes.m_glyphSize = m_gal->GetGlyphSize();
+    attributes.m_horizontalJustify = m_gal->GetHorizontalJustify();
+    attributes.m_verticalJustify = m_gal->GetVerticalJustify();
+    attributes.m_bold = m_gal->IsFontBold();
+    attributes.m_italic = m_gal->IsFontItalic();
+    attributes.m_mirrored = m_gal->IsTextMirrored();
+    attributes.m_lineWidth = m_gal->GetLineWidth();
+
+    GetStrokes( aText, aPosition, aRotationAngle, attributes, m_drawnStrokes );
+    m_gal->DrawStrokes( m_drawnStrokes );
+}
+
+
+void STROKE_FONT::GetStrokes( const UTF8& aText, const VECTOR2D& aPosition, double aRotationAngle,
+                              const STROKE_TEXT_ATTRIBUTES& aAttributes,
+                              STROKE_POLYLINES& aStrokes ) const
+{
+    aStrokes.m_points.clear();
+    aStrokes.m_polylineEnds.clear();
+    aStrokes.m_lineWidth = aAttributes.m_lineWidth;
 
-    m_gal->Translate( aPosition );
-    m_gal->Rotate( -aRotationAngle );
+    if( aAttributes.m_bold )
+        aStrokes.m_lineWidth *= BOLD_FACTOR;
+
+    if( aText.empty() )
+        return;
 
     // Single line height
-    int lineHeight = getInterline( );
+    int lineHeight = KiROUND( GetInterline( aAttributes.m_glyphSize.y, aAttributes.m_lineWidth ) );
     int lineCount = linesCount( aText );
-    const VECTOR2D& glyphSize = m_gal->GetGlyphSize();
+    const VECTOR2D& glyphSize = aAttributes.m_glyphSize;
+
+    // Position of the first line, relative to the text position
+    VECTOR2D offset( 0.0, 0.0 );
 
     // align the 1st line of text
-    switch( m_gal->GetVerticalJustify() )
+    switch( aAttributes.m_verticalJustify )
     {
     case GR_TEXT_VJUSTIFY_TOP:
-        m_gal->Translate( VECTOR2D( 0, glyphSize.y ) );
+        offset.y += glyphSize.y;
         break;
 
     case GR_TEXT_VJUSTIFY_CENTER:
-        m_gal->Translate( VECTOR2D( 0, glyphSize.y / 2.0 ) );
+        offset.y += glyphSize.y / 2.0;
         break;
 
     case GR_TEXT_VJUSTIFY_BOTTOM:
@@ -196,28 +231,22 @@ void STROKE_FONT::Draw( const UTF8& aText, const VECTOR2D& aPosition, double aRo
 
     if( lineCount > 1 )
     {
-        switch( m_gal->GetVerticalJustify() )
+        switch( aAttributes.m_verticalJustify )
         {
         case GR_TEXT_VJUSTIFY_TOP:
             break;
 
         case GR_TEXT_VJUSTIFY_CENTER:
-            m_gal->Translate( VECTOR2D(0, -( lineCount - 1 ) * lineHeight / 2) );
+            offset.y += -( lineCount - 1 ) * lineHeight / 2;
             break;
 
         case GR_TEXT_VJUSTIFY_BOTTOM:
-            m_gal->Translate( VECTOR2D(0, -( lineCount - 1 ) * lineHeight ) );
+            offset.y += -( lineCount - 1 ) * lineHeight;
             break;
         }
     }
 
-    m_gal->SetIsStroke( true );
-    //m_gal->SetIsFill( false );
-
-    if( m_gal->IsFontBold() )
-        m_gal->SetLineWidth( m_gal->GetLineWidth() * BOLD_FACTOR );
-
-    // Split multiline strings into separate ones and draw them line by line
+    // Split multiline strings into separate ones and lay them out line by line
     size_t  begin = 0;
     size_t  newlinePos = aText.find( '\n' );
 
@@ -225,71 +254,82 @@ void STROKE_FONT::Draw( const UTF8& aText, const VECTOR2D& aPosition, double aRo
     {
         size_t length = newlinePos - begin;
 
-        drawSingleLineText( aText.substr( begin, length ) );
-        m_gal->Translate( VECTOR2D( 0.0, lineHeight ) );
+        layoutSingleLineText( aText.substr( begin, length ), offset, aAttributes,
+                              aStrokes.m_lineWidth, aStrokes );
+        offset.y += lineHeight;
 
         begin = newlinePos + 1;
         newlinePos = aText.find( '\n', begin );
     }
 
-    // Draw the last (or the only one) line
-    if( !aText.empty() )
-        drawSingleLineText( aText.substr( begin ) );
+    // The last (or the only one) line
+    layoutSingleLineText( aText.substr( begin ), offset, aAttributes, aStrokes.m_lineWidth,
+                          aStrokes );
 
-    m_gal->Restore();
+    // Place the strokes, as the GAL did with a translation and a rotation
+    double cosAngle = cos( -aRotationAngle );
+    double sinAngle = sin( -aRotationAngle );
+
+    for( VECTOR2D& point : aStrokes.m_points )
+    {
+        point = VECTOR2D( aPosition.x + point.x * cosAngle - point.y * sinAngle,
+                          aPosition.y + point.x * sinAngle + point.y * cosAngle );
+    }
 }
 
 
-void STROKE_FONT::drawSingleLineText( const UTF8& aText )
+void STROKE_FONT::layoutSingleLineText( const UTF8& aText, const VECTOR2D& aOffset,
+                                        const STROKE_TEXT_ATTRIBUTES& aAttributes,
+                                        double aLineWidth, STROKE_POLYLINES& aStrokes ) const
 {
     double      xOffset;
-    VECTOR2D    glyphSize( m_gal->GetGlyphSize() );
-    double      overbar_italic_comp = computeOverbarVerticalPosition() * ITALIC_TILT;
+    double      italicTilt = 0.0;
+    VECTOR2D    glyphSize( aAttributes.m_glyphSize );
+    double      overbarPosition = ComputeOverbarVerticalPosition( glyphSize.y, aLineWidth );
+    double      overbar_italic_comp = overbarPosition * ITALIC_TILT;
 
-    if( m_gal->IsTextMirrored() )
+    if( aAttributes.m_mirrored )
         overbar_italic_comp = -overbar_italic_comp;
 
     // Compute the text size
-    VECTOR2D textSize = computeTextLineSize( aText );
-    double half_thickness = m_gal->GetLineWidth()/2;
-
-    // Context needs to be saved before any transformations
-    m_gal->Save();
+    VECTOR2D textSize = computeStringBoundaryLimits( aText, glyphSize, aLineWidth,
+                                                     aAttributes.m_italic );
+    double half_thickness = aLineWidth / 2;
 
     // First adjust: the text X position is corrected by half_thickness
     // because when the text with thickness is draw, its full size is textSize,
     // but the position of lines is half_thickness to textSize - half_thickness
     // so we must translate the coordinates by half_thickness on the X axis
     // to place the text inside the 0 to textSize X area.
-    m_gal->Translate( VECTOR2D( half_thickness, 0 ) );
+    VECTOR2D lineOffset( aOffset.x + half_thickness, aOffset.y );
 
     // Adjust the text position to the given horizontal justification
-    switch( m_gal->GetHorizontalJustify() )
+    switch( aAttributes.m_horizontalJustify )
     {
     case GR_TEXT_HJUSTIFY_CENTER:
-        m_gal->Translate( VECTOR2D( -textSize.x / 2.0, 0 ) );
+        lineOffset.x -= textSize.x / 2.0;
         break;
 
     case GR_TEXT_HJUSTIFY_RIGHT:
-        if( !m_gal->IsTextMirrored() )
-            m_gal->Translate( VECTOR2D( -textSize.x, 0 ) );
+        if( !aAttributes.m_mirrored )
+            lineOffset.x -= textSize.x;
         break;
 
     case GR_TEXT_HJUSTIFY_LEFT:
-        if( m_gal->IsTextMirrored() )
-            m_gal->Translate( VECTOR2D( -textSize.x, 0 ) );
+        if( aAttributes.m_mirrored )
+            lineOffset.x -= textSize.x;
         break;
 
     default:
         break;
     }
 
-    if( m_gal->IsTextMirrored() )
+    if( aAttributes.m_mirrored )
     {
         // In case of mirrored text invert the X scale of points and their X direction
         // (m_glyphSize.x) and start drawing from the position where text normally should end
         // (textSize.x)
-        xOffset = textSize.x - m_gal->GetLineWidth();
+        xOffset = textSize.x - aLineWidth;
         glyphSize.x = -glyphSize.x;
     }
     else
@@ -297,6 +337,17 @@ void STROKE_FONT::drawSingleLineText( const UTF8& aText )
         xOffset = 0.0;
     }
 
+    // The italic tilt shifts the points in X by an amount proportional to their Y
+    // FIXME should be done other way - referring to the lowest Y value of point
+    // because now italic fonts are translated a bit
+    if( aAttributes.m_italic )
+    {
+        italicTilt = glyphSize.y * STROKE_FONT::ITALIC_TILT;
+
+        if( !aAttributes.m_mirrored )
+            italicTilt = -italicTilt;
+    }
+
     // The overbar is indented inward at the beginning of an italicized section, but
     // must not be indented on subsequent letters to ensure that the bar segments
     // overlap.
@@ -313,65 +364,54 @@ void STROKE_FONT::drawSingleLineText( const UTF8& aText )
         if( dd >= (int) m_glyphBoundingBoxes.size() || dd < 0 )
             dd = '?' - ' ';
 
-        GLYPH& glyph = m_glyphs[dd];
-        BOX2D& bbox  = m_glyphBoundingBoxes[dd];
+        const GLYPH_STROKES& strokes = m_glyphStrokes[dd];
+        const BOX2D& bbox = m_glyphBoundingBoxes[dd];
 
         if( overbars[i] )
         {
             double overbar_start_x = xOffset;
-            double overbar_start_y = - computeOverbarVerticalPosition();
+            double overbar_start_y = -overbarPosition;
             double overbar_end_x = xOffset + glyphSize.x * bbox.GetEnd().x;
             double overbar_end_y = overbar_start_y;
 
             if( !last_had_overbar )
             {
-                if( m_gal->IsFontItalic() )
+                if( aAttributes.m_italic )
                     overbar_start_x += overbar_italic_comp;
 
                 last_had_overbar = true;
             }
 
-            VECTOR2D startOverbar( overbar_start_x, overbar_start_y );
-            VECTOR2D endOverbar( overbar_end_x, overbar_end_y );
-
-            m_gal->DrawLine( startOverbar, endOverbar );
+            aStrokes.m_points.push_back( lineOffset + VECTOR2D( overbar_start_x, overbar_start_y ) );
+            aStrokes.m_points.push_back( lineOffset + VECTOR2D( overbar_end_x, overbar_end_y ) );
+            aStrokes.m_polylineEnds.push_back( aStrokes.m_points.size() );
         }
         else
         {
             last_had_overbar = false;
         }
 
-        for( GLYPH::iterator pointListIt = glyph.begin(); pointListIt != glyph.end();
-             ++pointListIt )
-        {
-            std::deque<VECTOR2D> pointListScaled;
+        // The same transform applies to all the glyphs of the line, only the offset changes
+        int strokeStart = 0;
 
-            for( std::deque<VECTOR2D>::iterator pointIt = pointListIt->begin();
-                 pointIt != pointListIt->end(); ++pointIt )
+        for( int strokeEnd : strokes.m_strokeEnds )
+        {
+            for( int ii = strokeStart; ii < strokeEnd; ++ii )
             {
-                VECTOR2D pointPos( pointIt->x * glyphSize.x + xOffset, pointIt->y * glyphSize.y );
+                const VECTOR2D& point = strokes.m_points[ii];
 
-                if( m_gal->IsFontItalic() )
-                {
-                    // FIXME should be done other way - referring to the lowest Y value of point
-                    // because now italic fonts are translated a bit
-                    if( m_gal->IsTextMirrored() )
-                        pointPos.x += pointPos.y * STROKE_FONT::ITALIC_TILT;
-                    else
-                        pointPos.x -= pointPos.y * STROKE_FONT::ITALIC_TILT;
-                }
-
-                pointListScaled.push_back( pointPos );
+                aStrokes.m_points.push_back( lineOffset + VECTOR2D(
+                        point.x * glyphSize.x + point.y * italicTilt + xOffset,
+                        point.y * glyphSize.y ) );
             }
 
-            m_gal->DrawPolyline( pointListScaled );
+            aStrokes.m_polylineEnds.push_back( aStrokes.m_points.size() );
+            strokeStart = strokeEnd;
         }
 
         xOffset += glyphSize.x * bbox.GetEnd().x;
         ++i;
     }
-
-    m_gal->Restore();
 }
 
 
@@ -400,6 +440,14 @@ VECTOR2D STROKE_FONT::computeTextLineSize( const UTF8& aText ) const
 
 VECTOR2D STROKE_FONT::ComputeStringBoundaryLimits( const UTF8& aText, const VECTOR2D& aGlyphSize,
                                         double aGlyphThickness ) const
+{
+    return computeStringBoundaryLimits( aText, aGlyphSize, aGlyphThickness,
+                                        m_gal->IsFontItalic() );
+}
+
+
+VECTOR2D STROKE_FONT::computeStringBoundaryLimits( const UTF8& aText, const VECTOR2D& aGlyphSize,
+                                                   double aGlyphThickness, bool aItalic ) const
 {
     VECTOR2D string_bbox;
     int line_count = 1;
@@ -439,7 +487,7 @@ VECTOR2D STROKE_FONT::ComputeStringBoundaryLimits( const UTF8& aText, const VECT
     string_bbox.y = line_count * GetInterline( aGlyphSize.y, aGlyphThickness );
 
     // For italic correction, take in account italic tilt
-    if( m_gal->IsFontItalic() )
+    if( aItalic )
         string_bbox.x += string_bbox.y * STROKE_FONT::ITALIC_TILT;
 
     return string_bbox;
@@ -22,6 +22,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <algorithm>
+
 #include <geometry/seg.h>
 
 template <typename T>
@@ -73,6 +75,18 @@ bool SEG::PointCloserThan( const VECTOR2I& aP, int aDist ) const
 }
 
 
+bool SEG::ApproximatesDistance() const
+{
+    int dx = std::abs( B.x - A.x );
+    int dy = std::abs( B.y - A.y );
+    int dxdy = dx - dy;
+
+    bool shortcut = ( dxdy >= -1 && dxdy <= 1 ) || dx <= 1 || dy <= 1;
+
+    return shortcut && dx != 0 && dy != 0 && dx != dy;
+}
+
+
 SEG::ecoord SEG::SquaredDistance( const SEG& aSeg ) const
 {
     // fixme: rather inefficient....
@@ -166,6 +180,18 @@ bool SEG::ccw( const VECTOR2I& aA, const VECTOR2I& aB, const VECTOR2I& aC ) cons
 
 bool SEG::Collide( const SEG& aSeg, int aClearance ) const
 {
+    // Quick rejection on the bounding boxes: the tests below find the crossing segments,
+    // and the ones closer than the clearance up to the rounding of the nearest points, by
+    // less than one unit on each axis, unless PointCloserThan() approximates the distance
+    ecoord limit = std::abs( (ecoord) aClearance ) + 2;
+
+    if( ( (ecoord) std::min( A.x, B.x ) - std::max( aSeg.A.x, aSeg.B.x ) >= limit
+            || (ecoord) std::min( aSeg.A.x, aSeg.B.x ) - std::max( A.x, B.x ) >= limit
+            || (ecoord) std::min( A.y, B.y ) - std::max( aSeg.A.y, aSeg.B.y ) >= limit
+            || (ecoord) std::min( aSeg.A.y, aSeg.B.y ) - std::max( A.y, B.y ) >= limit )
+            && !ApproximatesDistance() && !aSeg.ApproximatesDistance() )
+        return false;
+
     // check for intersection
     // fixme: move to a method
     if( ccw( A, aSeg.A, aSeg.B ) != ccw( B, aSeg.A, aSeg.B ) &&
@@ -0,0 +1,226 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+
+#include <geometry/seg_batch.h>
+
+///> Number of segments of which the boxes are compared at once
+static const int BLOCK_SIZE = 64;
+
+
+void SEG_BATCH::Clear()
+{
+    m_ax.clear();
+    m_ay.clear();
+    m_bx.clear();
+    m_by.clear();
+}
+
+
+void SEG_BATCH::Reserve( int aCount )
+{
+    m_ax.reserve( aCount );
+    m_ay.reserve( aCount );
+    m_bx.reserve( aCount );
+    m_by.reserve( aCount );
+}
+
+
+void SEG_BATCH::Add( const VECTOR2I& aA, const VECTOR2I& aB )
+{
+    m_ax.push_back( aA.x );
+    m_ay.push_back( aA.y );
+    m_bx.push_back( aB.x );
+    m_by.push_back( aB.y );
+}
+
+
+void SEG_BATCH::SetPolyline( const std::vector<VECTOR2I>& aPoints, bool aClosed )
+{
+    int pointCount = aPoints.size();
+    int segmentCount = std::max( 0, aClosed ? pointCount : pointCount - 1 );
+
+    m_ax.resize( segmentCount );
+    m_ay.resize( segmentCount );
+    m_bx.resize( segmentCount );
+    m_by.resize( segmentCount );
+
+    for( int i = 0; i < segmentCount; i++ )
+    {
+        const VECTOR2I& a = aPoints[i];
+        const VECTOR2I& b = aPoints[i + 1 < pointCount ? i + 1 : 0];
+
+        m_ax[i] = a.x;
+        m_ay[i] = a.y;
+        m_bx[i] = b.x;
+        m_by[i] = b.y;
+    }
+}
+
+
+/**
+ * Clamp a coordinate of an expanded box to the int range, which keeps the comparisons
+ * with the int coordinates of the segments unchanged.
+ */
+static int clampCoord( SEG::ecoord aValue )
+{
+    return (int) std::max<SEG::ecoord>( INT_MIN, std::min<SEG::ecoord>( INT_MAX, aValue ) );
+}
+
+
+void SEG_BATCH::closeBoxes( int aFirst, int aCount, const SEG& aSeg, SEG::ecoord aLimit,
+                            bool aApproximated, int* aClose ) const
+{
+    const int* ax = m_ax.data() + aFirst;
+    const int* ay = m_ay.data() + aFirst;
+    const int* bx = m_bx.data() + aFirst;
+    const int* by = m_by.data() + aFirst;
+
+    // The box of aSeg expanded by aLimit - 1: the boxes overlapping it are the ones closer
+    // than aLimit on both axes
+    const int left = clampCoord( (SEG::ecoord) std::min( aSeg.A.x, aSeg.B.x ) - aLimit + 1 );
+    const int top = clampCoord( (SEG::ecoord) std::min( aSeg.A.y, aSeg.B.y ) - aLimit + 1 );
+    const int right = clampCoord( (SEG::ecoord) std::max( aSeg.A.x, aSeg.B.x ) + aLimit - 1 );
+    const int bottom = clampCoord( (SEG::ecoord) std::max( aSeg.A.y, aSeg.B.y ) + aLimit - 1 );
+
+    const unsigned approximated = aApproximated ? 1 : 0;
+
+    // Only int comparisons and selections, no branches: the compiler vectorizes this loop
+    for( int i = 0; i < aCount; i++ )
+    {
+        int minX = ax[i] < bx[i] ? ax[i] : bx[i];
+        int maxX = ax[i] < bx[i] ? bx[i] : ax[i];
+        int minY = ay[i] < by[i] ? ay[i] : by[i];
+        int maxY = ay[i] < by[i] ? by[i] : ay[i];
+
+        unsigned close = ( maxX >= left ) & ( minX <= right ) & ( maxY >= top )
+                         & ( minY <= bottom );
+
+        // SEG::ApproximatesDistance(), with unsigned differences to avoid branches
+        unsigned dx = (unsigned) maxX - (unsigned) minX;
+        unsigned dy = (unsigned) maxY - (unsigned) minY;
+        unsigned shortcut = ( dx - dy + 1 <= 2 ) | ( dx <= 1 ) | ( dy <= 1 );
+
+        close |= approximated & shortcut & ( dx != 0 ) & ( dy != 0 ) & ( dx != dy );
+
+        aClose[i] = close;
+    }
+}
+
+
+int SEG_BATCH::Collide( const SEG& aSeg, int aClearance ) const
+{
+    // Same rejection as in SEG::Collide(), done here for a whole block at once
+    bool        testAll = aSeg.ApproximatesDistance();
+    SEG::ecoord limit = std::abs( (SEG::ecoord) aClearance ) + 2;
+    int         close[BLOCK_SIZE];
+
+    for( int first = 0; first < Size(); first += BLOCK_SIZE )
+    {
+        int count = std::min( BLOCK_SIZE, Size() - first );
+
+        if( !testAll )
+            closeBoxes( first, count, aSeg, limit, true, close );
+
+        for( int i = 0; i < count; i++ )
+        {
+            if( !testAll && !close[i] )
+                continue;
+
+            if( Segment( first + i ).Collide( aSeg, aClearance ) )
+                return first + i;
+        }
+    }
+
+    return -1;
+}
+
+
+template <typename DIST_FUNC>
+SEG::ecoord SEG_BATCH::minSquaredDistance( const SEG& aSeg, int* aIndex,
+                                           DIST_FUNC aDistFunc ) const
+{
+    if( aIndex )
+        *aIndex = Size() ? 0 : -1;
+
+    if( !Size() )
+        return VECTOR2I::ECOORD_MAX;
+
+    // Start from the first segment, to skip segments from the first block on
+    SEG::ecoord best = aDistFunc( Segment( 0 ) );
+    int         close[BLOCK_SIZE];
+
+    for( int first = 0; first < Size() && best > 0; first += BLOCK_SIZE )
+    {
+        int count = std::min( BLOCK_SIZE, Size() - first );
+
+        // The SEG distances are exact up to the rounding of the nearest points, which is
+        // less than one unit on each axis: the segments with a box farther than this on
+        // one axis are farther than the best one.
+        SEG::ecoord limit = (SEG::ecoord) std::sqrt( (double) best ) + 3;
+
+        closeBoxes( first, count, aSeg, limit, false, close );
+
+        for( int i = 0; i < count; i++ )
+        {
+            if( !close[i] || first + i == 0 )
+                continue;
+
+            SEG::ecoord d = aDistFunc( Segment( first + i ) );
+
+            if( d < best )
+            {
+                best = d;
+
+                if( aIndex )
+                    *aIndex = first + i;
+            }
+        }
+    }
+
+    return best;
+}
+
+
+SEG::ecoord SEG_BATCH::SquaredDistance( const SEG& aSeg, int* aIndex ) const
+{
+    return minSquaredDistance( aSeg, aIndex,
+                               [&aSeg]( const SEG& aOther )
+                               {
+                                   return aOther.SquaredDistance( aSeg );
+                               } );
+}
+
+
+SEG::ecoord SEG_BATCH::SquaredDistance( const VECTOR2I& aP, int* aIndex ) const
+{
+    return minSquaredDistance( SEG( aP, aP ), aIndex,
+                               [&aP]( const SEG& aOther )
+                               {
+                                   return aOther.SquaredDistance( aP );
+                               } );
+}
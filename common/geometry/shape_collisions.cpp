@@ -31,10 +31,14 @@
 #include <geometry/shape_circle.h>
 #include <geometry/shape_rect.h>
 #include <geometry/shape_segment.h>
+#include <geometry/seg_batch.h>
 #include "../../include/geometry/shape_simple.h"
 
 typedef VECTOR2I::extended_type ecoord;
 
+///> Segments of a line chain tested against many segments or points
+static thread_local SEG_BATCH s_segBatch;
+
 static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_CIRCLE& aB, int aClearance,
                             bool aNeedMTV, VECTOR2I& aMTV )
 {
@@ -150,16 +154,12 @@ static VECTOR2I pushoutForce( const SHAPE_CIRCLE& aA, const SEG& aB, int aCleara
 static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_LINE_CHAIN& aB, int aClearance,
                             bool aNeedMTV, VECTOR2I& aMTV )
 {
-    bool found = false;
+    // Same as SHAPE_CIRCLE::Collide() on each segment
+    s_segBatch.SetPolyline( aB.CPoints(), aB.IsClosed() );
 
-    for( int s = 0; s < aB.SegmentCount(); s++ )
-    {
-        if( aA.Collide( aB.CSegment( s ), aClearance ) )
-        {
-            found = true;
-            break;
-        }
-    }
+    bool found = s_segBatch.Size() > 0 &&
+                 (int) sqrt( s_segBatch.SquaredDistance( aA.GetCenter() ) )
+                        < aClearance + aA.GetRadius();
 
     if( !aNeedMTV || !found )
         return found;
@@ -221,9 +221,13 @@ static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_SEGMENT& aSeg, i
 static inline bool Collide( const SHAPE_LINE_CHAIN& aA, const SHAPE_LINE_CHAIN& aB, int aClearance,
                             bool aNeedMTV, VECTOR2I& aMTV )
 {
+    s_segBatch.SetPolyline( aA.CPoints(), aA.IsClosed() );
+
     for( int i = 0; i < aB.SegmentCount(); i++ )
-        if( aA.Collide( aB.CSegment( i ), aClearance ) )
+    {
+        if( s_segBatch.Collide( aB.CSegment( i ), aClearance ) >= 0 )
             return true;
+    }
 
     return false;
 }
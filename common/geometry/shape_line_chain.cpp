@@ -26,26 +26,38 @@
 
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_circle.h>
+#include <geometry/seg_batch.h>
 #include "clipper.hpp"
 
 
+///> Segments of the line chain tested by Collide() and Distance(), reused between the calls
+static thread_local SEG_BATCH s_segBatch;
+
+
 ClipperLib::Path SHAPE_LINE_CHAIN::convertToClipper( bool aRequiredOrientation ) const
 {
     ClipperLib::Path c_path;
 
-    for( int i = 0; i < PointCount(); i++ )
-    {
-        const VECTOR2I& vertex = CPoint( i );
-        c_path.push_back( ClipperLib::IntPoint( vertex.x, vertex.y ) );
-    }
-
-    if( Orientation( c_path ) != aRequiredOrientation )
-        ReversePath( c_path );
+    convertToClipper( c_path, aRequiredOrientation );
 
     return c_path;
 }
 
 
+void SHAPE_LINE_CHAIN::convertToClipper( ClipperLib::Path& aPath,
+                                         bool aRequiredOrientation ) const
+{
+    aPath.clear();
+    aPath.reserve( m_points.size() );
+
+    for( const VECTOR2I& vertex : m_points )
+        aPath.push_back( ClipperLib::IntPoint( vertex.x, vertex.y ) );
+
+    if( Orientation( aPath ) != aRequiredOrientation )
+        ReversePath( aPath );
+}
+
+
 bool SHAPE_LINE_CHAIN::Collide( const VECTOR2I& aP, int aClearance ) const
 {
     // fixme: ugly!
@@ -67,24 +79,9 @@ void SHAPE_LINE_CHAIN::Rotate( double aAngle, const VECTOR2I& aCenter )
 
 bool SHAPE_LINE_CHAIN::Collide( const SEG& aSeg, int aClearance ) const
 {
-    BOX2I box_a( aSeg.A, aSeg.B - aSeg.A );
-    BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
+    s_segBatch.SetPolyline( m_points, m_closed );
 
-    for( int i = 0; i < SegmentCount(); i++ )
-    {
-        const SEG& s = CSegment( i );
-        BOX2I box_b( s.A, s.B - s.A );
-
-        BOX2I::ecoord_type d = box_a.SquaredDistance( box_b );
-
-        if( d < dist_sq )
-        {
-            if( s.Collide( aSeg, aClearance ) )
-                return true;
-        }
-    }
-
-    return false;
+    return s_segBatch.Collide( aSeg, aClearance ) >= 0;
 }
 
 
@@ -160,8 +157,10 @@ int SHAPE_LINE_CHAIN::Distance( const VECTOR2I& aP, bool aOutlineOnly ) const
     if( IsClosed() && PointInside( aP ) && !aOutlineOnly )
         return 0;
 
-    for( int s = 0; s < SegmentCount(); s++ )
-        d = std::min( d, CSegment( s ).Distance( aP ) );
+    s_segBatch.SetPolyline( m_points, m_closed );
+
+    if( s_segBatch.Size() )
+        d = std::min( d, (int) sqrt( s_segBatch.SquaredDistance( aP ) ) );
 
     return d;
 }
@@ -32,6 +32,7 @@
 #include <set>
 #include <list>
 #include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
 #include <memory>
 
@@ -39,6 +40,7 @@
 #include <map>
 
 #include <make_unique.h>
+#include <thread_pool.h>
 
 #include <geometry/geometry_utils.h>
 #include <geometry/shape.h>
@@ -48,6 +50,28 @@
 
 using namespace ClipperLib;
 
+
+/**
+ * Clipper objects kept between the boolean operations done by a thread, so that the memory
+ * of their internal lists and of the converted paths is reused from one operation to the next.
+ */
+struct CLIPPER_BUFFERS
+{
+    Clipper m_clipper;
+    Path    m_path;         ///< Path being converted before being added to m_clipper
+    Paths   m_result;       ///< Intermediate result of BooleanBatch()
+};
+
+static thread_local CLIPPER_BUFFERS s_clipperBuffers;
+
+///> Triangulation object of the thread, so that its vertex pool is reused by all the
+///> polygons triangulated by CacheTriangulation()
+static thread_local PolygonTriangulation s_triangulation;
+
+///> Number of vertices kept in the pool of s_triangulation after a bigger polygon
+static const size_t TRIANGULATION_POOL_SIZE = 16384;
+
+
 SHAPE_POLY_SET::SHAPE_POLY_SET() :
     SHAPE( SH_POLY_SET )
 {
@@ -55,7 +79,9 @@ SHAPE_POLY_SET::SHAPE_POLY_SET() :
 
 
 SHAPE_POLY_SET::SHAPE_POLY_SET( const SHAPE_POLY_SET& aOther, bool aDeepCopy ) :
-    SHAPE( SH_POLY_SET ), m_polys( aOther.m_polys )
+    SHAPE( SH_POLY_SET ), m_polys( aOther.m_polys ),
+    m_containmentIndexEnabled( aOther.m_containmentIndexEnabled ),
+    m_containmentIndex( std::atomic_load( &aOther.m_containmentIndex ) )
 {
     if( aOther.IsTriangulationUpToDate() )
     {
@@ -165,6 +191,8 @@ bool SHAPE_POLY_SET::GetGlobalIndex( SHAPE_POLY_SET::VERTEX_INDEX aRelativeIndic
 
 int SHAPE_POLY_SET::NewOutline()
 {
+    contentsChanged();
+
     SHAPE_LINE_CHAIN empty_path;
     POLYGON poly;
 
@@ -177,6 +205,8 @@ int SHAPE_POLY_SET::NewOutline()
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    contentsChanged();
+
     SHAPE_LINE_CHAIN empty_path;
 
     empty_path.SetClosed( true );
@@ -194,6 +224,8 @@ int SHAPE_POLY_SET::NewHole( int aOutline )
 
 int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDuplication )
 {
+    contentsChanged();
+
     if( aOutline < 0 )
         aOutline += m_polys.size();
 
@@ -215,6 +247,8 @@ int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDu
 
 void SHAPE_POLY_SET::InsertVertex( int aGlobalIndex, VECTOR2I aNewVertex )
 {
+    contentsChanged();
+
     VERTEX_INDEX index;
 
     if( aGlobalIndex < 0 )
@@ -277,6 +311,8 @@ SHAPE_POLY_SET SHAPE_POLY_SET::Subset( int aFirstPolygon, int aLastPolygon )
 
 VECTOR2I& SHAPE_POLY_SET::Vertex( int aIndex, int aOutline, int aHole )
 {
+    contentsChanged();
+
     if( aOutline < 0 )
         aOutline += m_polys.size();
 
@@ -315,6 +351,8 @@ const VECTOR2I& SHAPE_POLY_SET::CVertex( int aIndex, int aOutline, int aHole ) c
 
 VECTOR2I& SHAPE_POLY_SET::Vertex( int aGlobalIndex )
 {
+    contentsChanged();
+
     SHAPE_POLY_SET::VERTEX_INDEX index;
 
     // Assure the passed index references a legal position; abort otherwise
@@ -339,6 +377,7 @@ const VECTOR2I& SHAPE_POLY_SET::CVertex( int aGlobalIndex ) const
 
 VECTOR2I& SHAPE_POLY_SET::Vertex( SHAPE_POLY_SET::VERTEX_INDEX index )
 {
+    contentsChanged();
     return Vertex( index.m_vertex, index.m_polygon, index.m_contour - 1 );
 }
 
@@ -437,6 +476,8 @@ bool SHAPE_POLY_SET::IsSelfIntersecting()
 
 int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 {
+    contentsChanged();
+
     assert( aOutline.IsClosed() );
 
     POLYGON poly;
@@ -451,6 +492,8 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 
 int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 {
+    contentsChanged();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -478,27 +521,102 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType,
         const SHAPE_POLY_SET& aOtherShape,
         POLYGON_MODE aFastMode )
 {
-    Clipper c;
+    CLIPPER_BUFFERS& buffers = s_clipperBuffers;
+    Clipper&         c = buffers.m_clipper;
 
+    // Left filled if a previous operation was interrupted by an exception
+    c.Clear();
     c.StrictlySimple( aFastMode == PM_STRICTLY_SIMPLE );
 
-    for( auto poly : aShape.m_polys )
-    {
-        for( size_t i = 0 ; i < poly.size(); i++ )
-            c.AddPath( poly[i].convertToClipper( i == 0 ), ptSubject, true );
-    }
+    addPaths( c, buffers.m_path, aShape, ptSubject );
+    addPaths( c, buffers.m_path, aOtherShape, ptClip );
+
+    PolyTree solution;
 
-    for( auto poly : aOtherShape.m_polys )
+    c.Execute( aType, solution, pftNonZero, pftNonZero );
+    c.Clear();
+
+    importTree( &solution );
+}
+
+
+void SHAPE_POLY_SET::addPaths( Clipper& aClipper, Path& aBuffer, const SHAPE_POLY_SET& aShape,
+                               PolyType aType )
+{
+    for( const POLYGON& poly : aShape.m_polys )
     {
         for( size_t i = 0; i < poly.size(); i++ )
-            c.AddPath( poly[i].convertToClipper( i == 0 ), ptClip, true );
+        {
+            poly[i].convertToClipper( aBuffer, i == 0 );
+            aClipper.AddPath( aBuffer, aType, true );
+        }
     }
+}
 
-    PolyTree solution;
 
-    c.Execute( aType, solution, pftNonZero, pftNonZero );
+void SHAPE_POLY_SET::BooleanBatch( const std::vector<BOOLEAN_STEP>& aSteps,
+                                   POLYGON_MODE aFastMode )
+{
+    CLIPPER_BUFFERS& buffers = s_clipperBuffers;
+    Clipper&         c = buffers.m_clipper;
+    Paths&           result = buffers.m_result;
+    size_t           step = 0;
 
-    importTree( &solution );
+    c.Clear();
+
+    while( step < aSteps.size() )
+    {
+        // The first pass starts from the polyset, the next ones from the previous pass
+        if( step == 0 )
+            addPaths( c, buffers.m_path, *this, ptSubject );
+        else
+            c.AddPaths( result, ptSubject, true );
+
+        ClipType type = ctUnion;
+
+        if( aSteps[step].first == BO_INTERSECT )
+        {
+            // Intersections cannot be grouped: Clipper would intersect with the union
+            // of the clip polygons
+            type = ctIntersection;
+            addPaths( c, buffers.m_path, *aSteps[step].second, ptClip );
+            step++;
+        }
+        else
+        {
+            // The subject polygons and the clip polygons are merged by the non-zero fill rule
+            while( step < aSteps.size() && aSteps[step].first == BO_ADD )
+            {
+                addPaths( c, buffers.m_path, *aSteps[step].second, ptSubject );
+                step++;
+            }
+
+            while( step < aSteps.size() && aSteps[step].first == BO_SUBTRACT )
+            {
+                type = ctDifference;
+                addPaths( c, buffers.m_path, *aSteps[step].second, ptClip );
+                step++;
+            }
+        }
+
+        if( step < aSteps.size() )
+        {
+            c.StrictlySimple( false );
+            c.Execute( type, result, pftNonZero, pftNonZero );
+        }
+        else
+        {
+            PolyTree solution;
+
+            c.StrictlySimple( aFastMode == PM_STRICTLY_SIMPLE );
+            c.Execute( type, solution, pftNonZero, pftNonZero );
+            importTree( &solution );
+        }
+
+        c.Clear();
+    }
+
+    result.clear();
 }
 
 
@@ -592,20 +710,23 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
 
 void SHAPE_POLY_SET::importTree( PolyTree* tree )
 {
+    contentsChanged();
+
     m_polys.clear();
 
     for( PolyNode* n = tree->GetFirst(); n; n = n->GetNext() )
     {
         if( !n->IsHole() )
         {
-            POLYGON paths;
+            // Built in place, a copy of all the paths would be expensive
+            m_polys.emplace_back();
+
+            POLYGON& paths = m_polys.back();
             paths.reserve( n->Childs.size() + 1 );
-            paths.push_back( n->Contour );
+            paths.emplace_back( n->Contour );
 
             for( unsigned int i = 0; i < n->Childs.size(); i++ )
-                paths.push_back( n->Childs[i]->Contour );
-
-            m_polys.push_back( paths );
+                paths.emplace_back( n->Childs[i]->Contour );
         }
     }
 }
@@ -830,6 +951,8 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
 void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 {
+    contentsChanged();
+
     Simplify( aFastMode );    // remove overlapping holes/degeneracy
 
     for( POLYGON& paths : m_polys )
@@ -1017,6 +1140,8 @@ bool SHAPE_POLY_SET::HasHoles() const
 
 void SHAPE_POLY_SET::Unfracture( POLYGON_MODE aFastMode )
 {
+    contentsChanged();
+
     for( POLYGON& path : m_polys )
     {
         unfractureSingle( path );
@@ -1034,8 +1159,89 @@ void SHAPE_POLY_SET::Simplify( POLYGON_MODE aFastMode )
 }
 
 
+void SHAPE_POLY_SET::SimplifyParallel( POLYGON_MODE aFastMode, size_t aMaxStrips )
+{
+    contentsChanged();
+
+    // Below this count of polygons per strip, the split and the merges cost more than
+    // they save
+    const size_t minPolysPerStrip = 250;
+
+    TASK_GROUP tasks;
+    size_t     maxStrips = aMaxStrips ? aMaxStrips : tasks.GetThreadCount();
+    size_t     stripCount = std::min( maxStrips, m_polys.size() / minPolysPerStrip );
+
+    if( stripCount <= 1 )
+    {
+        Simplify( aFastMode );
+        return;
+    }
+
+    // Sort the polygons from left to right, so that each strip gets neighbour polygons
+    // and its union is small compared to its input
+    std::vector<std::pair<int, size_t>> order;
+
+    order.reserve( m_polys.size() );
+
+    for( size_t ii = 0; ii < m_polys.size(); ++ii )
+    {
+        const SHAPE_LINE_CHAIN& outline = m_polys[ii][0];
+
+        if( outline.PointCount() )
+            order.emplace_back( outline.BBox().Centre().x, ii );
+    }
+
+    std::sort( order.begin(), order.end() );
+
+    std::vector<SHAPE_POLY_SET> strips( stripCount );
+
+    for( size_t ii = 0; ii < order.size(); ++ii )
+    {
+        POLYGON& poly = m_polys[ order[ii].second ];
+
+        strips[ ii * stripCount / order.size() ].m_polys.push_back( std::move( poly ) );
+    }
+
+    m_polys.clear();
+
+    // Each round merges the strips two by two, the first one unioning them at the same time
+    while( strips.size() > 1 )
+    {
+        POLYGON_MODE mode = strips.size() == 2 ? aFastMode : PM_FAST;
+
+        auto merge_lambda = [&strips, mode]( size_t aStrip )
+        {
+            strips[aStrip].BooleanAdd( strips[aStrip + 1], mode );
+            strips[aStrip + 1].RemoveAllContours();
+        };
+
+        for( size_t ii = 0; ii + 1 < strips.size(); ii += 2 )
+            tasks.Run( std::bind( merge_lambda, ii ) );
+
+        tasks.Wait();
+
+        std::vector<SHAPE_POLY_SET> merged;
+
+        merged.reserve( ( strips.size() + 1 ) / 2 );
+
+        // SHAPE_POLY_SET has no move constructor, the polygons are swapped instead
+        for( size_t ii = 0; ii < strips.size(); ii += 2 )
+        {
+            merged.emplace_back();
+            merged.back().m_polys.swap( strips[ii].m_polys );
+        }
+
+        strips.swap( merged );
+    }
+
+    m_polys.swap( strips[0].m_polys );
+}
+
+
 int SHAPE_POLY_SET::NormalizeAreaOutlines()
 {
+    contentsChanged();
+
     // We are expecting only one main outline, but this main outline can have holes
     // if holes: combine holes and remove them from the main outline.
     // Note also we are using SHAPE_POLY_SET::PM_STRICTLY_SIMPLE in polygon
@@ -1094,6 +1300,8 @@ const std::string SHAPE_POLY_SET::Format() const
 
 bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
 {
+    contentsChanged();
+
     std::string tmp;
 
     aStream >> tmp;
@@ -1234,12 +1442,15 @@ bool SHAPE_POLY_SET::Collide( const VECTOR2I& aP, int aClearance ) const
 
 void SHAPE_POLY_SET::RemoveAllContours()
 {
+    contentsChanged();
     m_polys.clear();
 }
 
 
 void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 {
+    contentsChanged();
+
     // Default polygon is the last one
     if( aPolygonIdx < 0 )
         aPolygonIdx += m_polys.size();
@@ -1250,6 +1461,8 @@ void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 
 int SHAPE_POLY_SET::RemoveNullSegments()
 {
+    contentsChanged();
+
     int removed = 0;
 
     ITERATOR iterator = IterateWithHoles();
@@ -1303,12 +1516,14 @@ int SHAPE_POLY_SET::RemoveNullSegments()
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
+    contentsChanged();
     m_polys.erase( m_polys.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    contentsChanged();
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
 }
 
@@ -1392,14 +1607,19 @@ bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex, bool aIgno
     if( m_polys.size() == 0 ) // empty set?
         return false;
 
+    std::shared_ptr<const CONTAINMENT_INDEX> index;
+
+    if( m_containmentIndexEnabled )
+        index = containmentIndex();
+
     // If there is a polygon specified, check the condition against that polygon
     if( aSubpolyIndex >= 0 )
-        return containsSingle( aP, aSubpolyIndex, aIgnoreHoles );
+        return containsSingle( aP, aSubpolyIndex, aIgnoreHoles, index.get() );
 
     // In any other case, check it against all polygons in the set
     for( int polygonIdx = 0; polygonIdx < OutlineCount(); polygonIdx++ )
     {
-        if( containsSingle( aP, polygonIdx, aIgnoreHoles ) )
+        if( containsSingle( aP, polygonIdx, aIgnoreHoles, index.get() ) )
             return true;
     }
 
@@ -1407,6 +1627,127 @@ bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex, bool aIgno
 }
 
 
+void SHAPE_POLY_SET::EnableContainmentIndex( bool aEnable )
+{
+    // Dropped while still enabled, invalidateContainmentIndex() does nothing otherwise
+    if( !aEnable )
+        invalidateContainmentIndex();
+
+    m_containmentIndexEnabled = aEnable;
+}
+
+
+std::shared_ptr<const SHAPE_POLY_SET::CONTAINMENT_INDEX> SHAPE_POLY_SET::containmentIndex() const
+{
+    std::shared_ptr<const CONTAINMENT_INDEX> index = std::atomic_load( &m_containmentIndex );
+
+    if( index )
+        return index;
+
+    // Several threads may build it at the same time, they all build the same index
+    auto newIndex = std::make_shared<CONTAINMENT_INDEX>( m_polys.size() );
+
+    for( size_t polyIdx = 0; polyIdx < m_polys.size(); polyIdx++ )
+    {
+        for( const SHAPE_LINE_CHAIN& path : m_polys[polyIdx] )
+            ( *newIndex )[polyIdx].push_back( buildContourIndex( path ) );
+    }
+
+    index = newIndex;
+    std::atomic_store( &m_containmentIndex, index );
+
+    return index;
+}
+
+
+SHAPE_POLY_SET::CONTOUR_INDEX SHAPE_POLY_SET::buildContourIndex( const SHAPE_LINE_CHAIN& aPath )
+{
+    CONTOUR_INDEX index;
+    int           pointCount = aPath.PointCount();
+
+    index.m_bbox = aPath.BBox();
+
+    // About 8 edges per band, but no band thinner than one unit
+    int64_t height = (int64_t) index.m_bbox.GetHeight() + 1;
+    int     top = index.m_bbox.GetY();
+
+    index.m_bandCount = (int) std::max<int64_t>( 1, std::min<int64_t>( pointCount / 8, height ) );
+
+    auto bandOf = [&]( int y ) -> int
+    {
+        return (int) ( ( (int64_t) y - top ) * index.m_bandCount / height );
+    };
+
+    // An edge crosses the horizontal line at y when y is in [ymin, ymax), like in
+    // SHAPE_LINE_CHAIN::PointInside(); horizontal edges never cross it.
+    index.m_bandStarts.assign( index.m_bandCount + 1, 0 );
+
+    for( int pass = 0; pass < 2; pass++ )
+    {
+        std::vector<int> fill;
+
+        if( pass == 1 )
+        {
+            for( int band = 0; band < index.m_bandCount; band++ )
+                index.m_bandStarts[band + 1] += index.m_bandStarts[band];
+
+            index.m_edges.resize( index.m_bandStarts.back() );
+            fill.assign( index.m_bandStarts.begin(), index.m_bandStarts.end() - 1 );
+        }
+
+        for( int i = 0; i < pointCount; i++ )
+        {
+            int y1 = aPath.CPoint( i ).y;
+            int y2 = aPath.CPoint( i + 1 ).y;
+
+            if( y1 == y2 )
+                continue;
+
+            int firstBand = bandOf( std::min( y1, y2 ) );
+            int lastBand = bandOf( std::max( y1, y2 ) - 1 );
+
+            for( int band = firstBand; band <= lastBand; band++ )
+            {
+                if( pass == 0 )
+                    index.m_bandStarts[band + 1]++;
+                else
+                    index.m_edges[fill[band]++] = i;
+            }
+        }
+    }
+
+    return index;
+}
+
+
+bool SHAPE_POLY_SET::pointInContour( const VECTOR2I& aP, const SHAPE_LINE_CHAIN& aPath,
+                                     const CONTOUR_INDEX& aIndex )
+{
+    if( !aPath.IsClosed() || aPath.PointCount() < 3 || !aIndex.m_bbox.Contains( aP ) )
+        return false;
+
+    int64_t height = (int64_t) aIndex.m_bbox.GetHeight() + 1;
+    int     band = (int) ( ( (int64_t) aP.y - aIndex.m_bbox.GetY() ) * aIndex.m_bandCount
+                           / height );
+    bool    inside = false;
+
+    // Same crossing test as SHAPE_LINE_CHAIN::PointInside(), on the edges of the band only
+    for( int ii = aIndex.m_bandStarts[band]; ii < aIndex.m_bandStarts[band + 1]; ii++ )
+    {
+        int edge = aIndex.m_edges[ii];
+        const VECTOR2D p1 = aPath.CPoint( edge );
+        const VECTOR2D p2 = aPath.CPoint( edge + 1 );
+        const VECTOR2D diff = p2 - p1;
+
+        if( ( ( p1.y > aP.y ) != ( p2.y > aP.y ) ) &&
+                ( aP.x - p1.x < ( diff.x / diff.y ) * ( aP.y - p1.y ) ) )
+            inside = !inside;
+    }
+
+    return inside;
+}
+
+
 void SHAPE_POLY_SET::RemoveVertex( int aGlobalIndex )
 {
     VERTEX_INDEX index;
@@ -1421,25 +1762,37 @@ void SHAPE_POLY_SET::RemoveVertex( int aGlobalIndex )
 
 void SHAPE_POLY_SET::RemoveVertex( VERTEX_INDEX aIndex )
 {
+    contentsChanged();
     m_polys[aIndex.m_polygon][aIndex.m_contour].Remove( aIndex.m_vertex );
 }
 
 
-bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool aIgnoreHoles ) const
+bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool aIgnoreHoles,
+                                     const CONTAINMENT_INDEX* aIndex ) const
 {
+    const POLYGON& poly = m_polys[aSubpolyIndex];
+
+    auto inside = [&]( int aContour ) -> bool
+    {
+        if( aIndex )
+            return pointInContour( aP, poly[aContour], ( *aIndex )[aSubpolyIndex][aContour] );
+
+        return pointInPolygon( aP, poly[aContour] );
+    };
+
     // Check that the point is inside the outline
-    if( pointInPolygon( aP, m_polys[aSubpolyIndex][0] ) )
+    if( inside( 0 ) )
     {
         if( !aIgnoreHoles )
         {
             // Check that the point is not in any of the holes
             for( int holeIdx = 0; holeIdx < HoleCount( aSubpolyIndex ); holeIdx++ )
             {
-                const SHAPE_LINE_CHAIN hole = CHole( aSubpolyIndex, holeIdx );
+                const SHAPE_LINE_CHAIN& hole = CHole( aSubpolyIndex, holeIdx );
 
                 // If the point is inside a hole (and not on its edge),
                 // it is outside of the polygon
-                if( pointInPolygon( aP, hole ) && !hole.PointOnEdge( aP ) )
+                if( inside( holeIdx + 1 ) && !hole.PointOnEdge( aP ) )
                     return false;
             }
         }
@@ -1459,6 +1812,8 @@ bool SHAPE_POLY_SET::pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN&
 
 void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 {
+    contentsChanged();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1471,6 +1826,8 @@ void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 
 void SHAPE_POLY_SET::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
+    contentsChanged();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1811,7 +2168,17 @@ SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
     static_cast<SHAPE&>(*this) = aOther;
     m_polys = aOther.m_polys;
 
-    // reset poly cache:
+    // The index is enabled by the owner of the set, not by its contents; when both use
+    // one, the contours are the same, so is their index
+    if( m_containmentIndexEnabled )
+        std::atomic_store( &m_containmentIndex, std::atomic_load( &aOther.m_containmentIndex ) );
+
+    // reset poly cache, keeping the triangles for the outlines which are the same in aOther
+    // (e.g. when a zone is refilled, then assigned again without its islands).  They are
+    // dropped by the next triangulation, or by any other change of the contents.
+    if( !m_triangulatedPolys.empty() )
+        m_previousTriangulatedPolys = std::move( m_triangulatedPolys );
+
     m_hash = MD5_HASH{};
     m_triangulationValid = false;
     m_triangulatedPolys.clear();
@@ -1841,6 +2208,57 @@ bool SHAPE_POLY_SET::IsTriangulationUpToDate() const
 }
 
 
+/**
+ * Copies the aCount points given by aPoint( i ) in their canonical order: from the first
+ * smallest one, towards the smallest of its neighbours.  The points of a closed outline get
+ * the same order whatever point and direction the outline starts from.
+ */
+template <typename GET_POINT>
+static void canonicalPoints( int aCount, GET_POINT aPoint, std::vector<VECTOR2I>& aResult )
+{
+    auto less = []( const VECTOR2I& aA, const VECTOR2I& aB )
+    {
+        return aA.x < aB.x || ( aA.x == aB.x && aA.y < aB.y );
+    };
+
+    int start = 0;
+
+    for( int ii = 1; ii < aCount; ii++ )
+    {
+        if( less( aPoint( ii ), aPoint( start ) ) )
+            start = ii;
+    }
+
+    bool backwards = aCount > 2 && less( aPoint( ( start + aCount - 1 ) % aCount ),
+                                         aPoint( ( start + 1 ) % aCount ) );
+
+    aResult.clear();
+
+    for( int ii = 0; ii < aCount; ii++ )
+    {
+        if( backwards )
+            aResult.push_back( aPoint( ( start + aCount - ii ) % aCount ) );
+        else
+            aResult.push_back( aPoint( ( start + ii ) % aCount ) );
+    }
+}
+
+
+static size_t hashPoints( const std::vector<VECTOR2I>& aPoints )
+{
+    // FNV-1a on the coordinates: the points are compared anyway when the hashes match
+    uint64_t hash = 14695981039346656037ULL;
+
+    for( const VECTOR2I& p : aPoints )
+    {
+        hash = ( hash ^ (uint32_t) p.x ) * 1099511628211ULL;
+        hash = ( hash ^ (uint32_t) p.y ) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+
 void SHAPE_POLY_SET::CacheTriangulation()
 {
     bool recalculate = !m_hash.IsValid();
@@ -1868,28 +2286,80 @@ void SHAPE_POLY_SET::CacheTriangulation()
     if( tmpSet.HasHoles() )
         tmpSet.Fracture( PM_FAST );
 
-    m_triangulatedPolys.clear();
+    // The triangulated polygons of the previous contents, by the hash of their vertices
+    // (the points of their outline): an outline which did not change, like most of them
+    // when a zone is refilled, is not triangulated again
+    std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> previousPolys;
+    std::vector<std::vector<VECTOR2I>> previousPoints;
+    std::unordered_multimap<size_t, size_t> previousByHash;
+    std::vector<VECTOR2I> points;
+
+    for( auto polys : { &m_triangulatedPolys, &m_previousTriangulatedPolys } )
+    {
+        for( std::unique_ptr<TRIANGULATED_POLYGON>& poly : *polys )
+        {
+            const TRIANGULATED_POLYGON* tri = poly.get();
+
+            previousPoints.emplace_back();
+            canonicalPoints( tri->GetVertexCount(),
+                             [tri]( int aIndex ) { return tri->GetVertex( aIndex ); },
+                             previousPoints.back() );
+            previousByHash.emplace( hashPoints( previousPoints.back() ), previousPolys.size() );
+            previousPolys.push_back( std::move( poly ) );
+        }
+
+        polys->clear();
+    }
+
     m_triangulationValid = true;
 
     while( tmpSet.OutlineCount() > 0 )
     {
-        m_triangulatedPolys.push_back( std::make_unique<TRIANGULATED_POLYGON>() );
-        PolygonTriangulation tess( *m_triangulatedPolys.back() );
+        const SHAPE_LINE_CHAIN& outline = tmpSet.CPolygon( 0 ).front();
+        std::unique_ptr<TRIANGULATED_POLYGON> reused;
 
-        // If the tesselation fails, we re-fracture the polygon, which will
-        // first simplify the system before fracturing and removing the holes
-        // This may result in multiple, disjoint polygons.
-        if( !tess.TesselatePolygon( tmpSet.Polygon( 0 ).front() ) )
+        if( !previousPolys.empty() )
         {
-            tmpSet.Fracture( PM_FAST );
-            m_triangulationValid = false;
-            continue;
+            canonicalPoints( outline.PointCount(),
+                             [&outline]( int aIndex ) { return outline.CPoint( aIndex ); },
+                             points );
+
+            auto range = previousByHash.equal_range( hashPoints( points ) );
+
+            for( auto it = range.first; it != range.second && !reused; ++it )
+            {
+                if( previousPolys[it->second] && previousPoints[it->second] == points )
+                    reused = std::move( previousPolys[it->second] );
+            }
+        }
+
+        if( reused )
+        {
+            m_triangulatedPolys.push_back( std::move( reused ) );
+        }
+        else
+        {
+            m_triangulatedPolys.push_back( std::make_unique<TRIANGULATED_POLYGON>() );
+
+            // If the tesselation fails, we re-fracture the polygon, which will
+            // first simplify the system before fracturing and removing the holes
+            // This may result in multiple, disjoint polygons.
+            if( !s_triangulation.TesselatePolygon( outline, *m_triangulatedPolys.back() ) )
+            {
+                // Partial triangles are not kept, so that they are never reused
+                m_triangulatedPolys.pop_back();
+                tmpSet.Fracture( PM_FAST );
+                m_triangulationValid = false;
+                continue;
+            }
         }
 
         tmpSet.DeletePolygon( 0 );
         m_triangulationValid = true;
     }
 
+    s_triangulation.ShrinkPool( TRIANGULATION_POOL_SIZE );
+
     if( m_triangulationValid )
         m_hash = checksum();
 }
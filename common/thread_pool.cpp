@@ -0,0 +1,280 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <thread_pool.h>
+
+#include <algorithm>
+#include <iterator>
+
+
+// The pool and the queue index of the calling thread, when it is a worker
+static thread_local const THREAD_POOL* s_workerPool = nullptr;
+static thread_local size_t             s_workerIndex = 0;
+
+
+THREAD_POOL& THREAD_POOL::Get()
+{
+    static THREAD_POOL pool( std::max<size_t>( std::thread::hardware_concurrency(), 2 ) );
+
+    return pool;
+}
+
+
+THREAD_POOL::THREAD_POOL( size_t aThreadCount ) :
+    m_queuedCount( 0 ),
+    m_quit( false )
+{
+    aThreadCount = std::max<size_t>( aThreadCount, 1 );
+
+    // One queue per worker, and the last one for the threads outside of the pool
+    for( size_t ii = 0; ii <= aThreadCount; ++ii )
+        m_queues.emplace_back( new TASK_QUEUE );
+
+    for( size_t ii = 0; ii < aThreadCount; ++ii )
+        m_threads.emplace_back( &THREAD_POOL::workerLoop, this, ii );
+}
+
+
+THREAD_POOL::~THREAD_POOL()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_sleepLock );
+        m_quit = true;
+    }
+
+    m_wakeUp.notify_all();
+
+    for( auto& thread : m_threads )
+        thread.join();
+}
+
+
+bool THREAD_POOL::IsWorkerThread() const
+{
+    return s_workerPool == this;
+}
+
+
+size_t THREAD_POOL::queueIndex() const
+{
+    return IsWorkerThread() ? s_workerIndex : m_threads.size();
+}
+
+
+void THREAD_POOL::submit( TASK&& aTask )
+{
+    // Counted before being queued, so a worker never sleeps while a task is waiting
+    m_queuedCount++;
+
+    {
+        TASK_QUEUE& queue = *m_queues[ queueIndex() ];
+        std::lock_guard<std::mutex> lock( queue.m_lock );
+        queue.m_tasks.push_back( std::move( aTask ) );
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( m_sleepLock );
+    }
+
+    m_wakeUp.notify_one();
+}
+
+
+bool THREAD_POOL::runOne( const TASK_GROUP* aGroup )
+{
+    if( m_queuedCount == 0 )
+        return false;
+
+    const size_t own = queueIndex();
+    const size_t count = m_queues.size();
+    TASK         task;
+    bool         found = false;
+
+    auto isWanted = [aGroup]( const TASK& aTask )
+    {
+        return !aGroup || aTask.m_group == aGroup;
+    };
+
+    for( size_t ii = 0; ii < count && !found; ++ii )
+    {
+        TASK_QUEUE& queue = *m_queues[ ( own + ii ) % count ];
+        std::lock_guard<std::mutex> lock( queue.m_lock );
+
+        if( ii == 0 )
+        {
+            auto it = std::find_if( queue.m_tasks.rbegin(), queue.m_tasks.rend(), isWanted );
+
+            if( it == queue.m_tasks.rend() )
+                continue;
+
+            task = std::move( *it );
+            queue.m_tasks.erase( std::next( it ).base() );
+        }
+        else
+        {
+            auto it = std::find_if( queue.m_tasks.begin(), queue.m_tasks.end(), isWanted );
+
+            if( it == queue.m_tasks.end() )
+                continue;
+
+            task = std::move( *it );
+            queue.m_tasks.erase( it );
+        }
+
+        found = true;
+    }
+
+    if( !found )
+        return false;
+
+    m_queuedCount--;
+    task.m_group->execute( task.m_func );
+
+    return true;
+}
+
+
+void THREAD_POOL::workerLoop( size_t aIndex )
+{
+    s_workerPool = this;
+    s_workerIndex = aIndex;
+
+    while( true )
+    {
+        if( runOne() )
+            continue;
+
+        std::unique_lock<std::mutex> lock( m_sleepLock );
+
+        m_wakeUp.wait( lock, [this]() { return m_quit || m_queuedCount > 0; } );
+
+        if( m_quit )
+            break;
+    }
+}
+
+
+TASK_GROUP::TASK_GROUP( THREAD_POOL& aPool ) :
+    m_pool( aPool ),
+    m_cancelled( false ),
+    m_pending( 0 )
+{
+}
+
+
+TASK_GROUP::~TASK_GROUP()
+{
+    Cancel();
+
+    try
+    {
+        Wait();
+    }
+    catch( ... )
+    {
+        // Nobody is interested in the result any more
+    }
+}
+
+
+void TASK_GROUP::Run( std::function<void()> aTask )
+{
+    {
+        std::lock_guard<std::mutex> lock( m_lock );
+        m_pending++;
+    }
+
+    m_pool.submit( THREAD_POOL::TASK{ std::move( aTask ), this } );
+}
+
+
+void TASK_GROUP::execute( std::function<void()>& aTask )
+{
+    std::exception_ptr exception;
+
+    if( !m_cancelled )
+    {
+        try
+        {
+            aTask();
+        }
+        catch( ... )
+        {
+            exception = std::current_exception();
+        }
+    }
+
+    // Release the captures before the waiting thread can destroy what they refer to
+    aTask = nullptr;
+
+    // The group may be destroyed as soon as the lock is released
+    std::lock_guard<std::mutex> lock( m_lock );
+
+    if( exception && !m_exception )
+        m_exception = exception;
+
+    if( --m_pending == 0 )
+        m_done.notify_all();
+}
+
+
+void TASK_GROUP::Wait( const std::function<void()>& aKeepAlive,
+                       std::chrono::milliseconds aInterval )
+{
+    std::unique_lock<std::mutex> lock( m_lock );
+    auto isDone = [this]() { return m_pending == 0; };
+
+    if( aKeepAlive && !m_pool.IsWorkerThread() )
+    {
+        while( !m_done.wait_for( lock, aInterval, isDone ) )
+        {
+            lock.unlock();
+            aKeepAlive();
+            lock.lock();
+        }
+    }
+    else
+    {
+        while( !isDone() )
+        {
+            lock.unlock();
+
+            if( m_pool.runOne( this ) )
+            {
+                lock.lock();
+                continue;
+            }
+
+            // The remaining tasks are running on other threads, or are queued behind
+            // the ones of other groups
+            lock.lock();
+            m_done.wait_for( lock, std::chrono::milliseconds( 1 ), isDone );
+        }
+    }
+
+    if( m_exception )
+    {
+        std::exception_ptr exception = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception( exception );
+    }
+}
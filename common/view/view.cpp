@@ -26,6 +26,7 @@
 
 #include <base_struct.h>
 #include <layers_id_colors_and_visibility.h>
+#include <macros.h>
 
 #include <view/view.h>
 #include <view/view_group.h>
@@ -36,6 +37,9 @@
 #include <gal/definitions.h>
 #include <gal/graphics_abstraction_layer.h>
 #include <painter.h>
+#include <thread_pool.h>
+
+#include <cmath>
 
 #ifdef __WXDEBUG__
 #include <profile.h>
@@ -90,6 +94,7 @@ private:
     int     m_flags;            ///< Visibility flags
     int     m_requiredUpdate;   ///< Flag required for updating
     int     m_drawPriority;     ///< Order to draw this item in a layer, lowest first
+    BOX2I   m_bbox;             ///< Bounding box the item is indexed with in its layers
 
     ///> Helper for storing cached items group ids
     typedef std::pair<int, int> GroupPair;
@@ -308,6 +313,7 @@ VIEW::VIEW( bool aIsDynamic ) :
 
     m_allItems.reset( new std::vector<VIEW_ITEM*> );
     m_allItems->reserve( 32768 );
+    m_updatedItems.reset( new std::vector<VIEW_ITEM*> );
 
     // Redraw everything at the beginning
     MarkDirty();
@@ -339,6 +345,11 @@ void VIEW::AddLayer( int aLayer, bool aDisplayOnly )
         m_layers[aLayer].visible        = true;
         m_layers[aLayer].displayOnly    = aDisplayOnly;
         m_layers[aLayer].target         = TARGET_CACHED;
+        m_layers[aLayer].lodMinSize     = 0.0;
+        m_layers[aLayer].lodAggregate   = true;
+        m_layers[aLayer].lodSizeClass   = 0;
+        m_layers[aLayer].lodGroup       = -1;
+        m_layers[aLayer].lodDirty       = true;
     }
 }
 
@@ -358,6 +369,7 @@ void VIEW::Add( VIEW_ITEM* aItem, int aDrawPriority )
 
     aItem->ViewGetLayers( layers, layers_count );
     aItem->viewPrivData()->saveLayers( layers, layers_count );
+    aItem->viewPrivData()->m_bbox = aItem->ViewBBox();
 
     m_allItems->push_back( aItem );
 
@@ -366,6 +378,7 @@ void VIEW::Add( VIEW_ITEM* aItem, int aDrawPriority )
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Insert( aItem );
         MarkTargetDirty( l.target );
+        invalidateLodCell( l, aItem->viewPrivData()->m_bbox );
     }
 
     SetVisible( aItem, true );
@@ -384,6 +397,15 @@ void VIEW::Remove( VIEW_ITEM* aItem )
         return;
 
     wxCHECK( viewData->m_view == this, /*void*/ );
+
+    if( viewData->m_requiredUpdate != NONE )
+    {
+        auto updated = std::find( m_updatedItems->begin(), m_updatedItems->end(), aItem );
+
+        if( updated != m_updatedItems->end() )
+            m_updatedItems->erase( updated );
+    }
+
     auto item = std::find( m_allItems->begin(), m_allItems->end(), aItem );
 
     if( item != m_allItems->end() )
@@ -400,6 +422,7 @@ void VIEW::Remove( VIEW_ITEM* aItem )
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Remove( aItem );
         MarkTargetDirty( l.target );
+        invalidateLodCell( l, viewData->m_bbox );
 
         // Clear the GAL cache
         int prevGroup = viewData->getGroup( layers[i] );
@@ -660,9 +683,21 @@ void VIEW::SetCenter( VECTOR2D aCenter, const BOX2D& occultingScreenRect )
 }
 
 
+void VIEW::SetLayerLODThreshold( int aLayer, double aPixels, bool aAggregate )
+{
+    wxCHECK( aLayer < (int) m_layers.size(), /*void*/ );
+
+    m_layers[aLayer].lodMinSize = std::max( aPixels, 0.0 );
+    m_layers[aLayer].lodAggregate = aAggregate;
+    m_layers[aLayer].lodDirty = true;
+    MarkTargetDirty( m_layers[aLayer].target );
+}
+
+
 void VIEW::SetLayerOrder( int aLayer, int aRenderingOrder )
 {
     m_layers[aLayer].renderingOrder = aRenderingOrder;
+    m_layers[aLayer].lodDirty = true;
 
     sortLayers();
 }
@@ -722,6 +757,7 @@ void VIEW::ReorderLayerData( std::unordered_map<int, int> aReorderMap )
         }
 
         layer.id = new_idx;
+        layer.lodDirty = true;
         new_map[new_idx] = layer;
     }
 
@@ -741,7 +777,7 @@ void VIEW::ReorderLayerData( std::unordered_map<int, int> aReorderMap )
 
         viewData->reorderGroups( aReorderMap );
 
-        viewData->m_requiredUpdate |= COLOR;
+        addUpdateFlags( item, COLOR );
     }
 
     UpdateItems();
@@ -789,6 +825,7 @@ void VIEW::UpdateLayerColor( int aLayer )
 
         updateItemsColor visitor( aLayer, m_painter, m_gal );
         m_layers[aLayer].items->Query( r, visitor );
+        m_layers[aLayer].lodDirty = true;
         MarkTargetDirty( m_layers[aLayer].target );
     }
 }
@@ -821,6 +858,7 @@ void VIEW::UpdateAllLayersColor()
         }
     }
 
+    invalidateLodGroups();
     MarkDirty();
 }
 
@@ -1013,10 +1051,21 @@ void VIEW::redrawRect( const BOX2I& aRect )
         if( l->visible && IsTargetDirty( l->target ) && areRequiredLayersEnabled( l->id ) )
         {
             drawItem drawFunc( this, l->id, m_useDrawPriority, m_reverseDrawOrder );
+            int minSizeClass = 0;
 
             m_gal->SetTarget( l->target );
             m_gal->SetLayerDepth( l->renderingOrder );
-            l->items->Query( aRect, drawFunc );
+
+            // The items too small to be seen are drawn all at once, as blocks
+            if( isLodValid( *l ) )
+            {
+                if( l->lodGroup >= 0 )
+                    m_gal->DrawGroup( l->lodGroup );
+
+                minSizeClass = l->lodSizeClass;
+            }
+
+            l->items->Query( aRect, drawFunc, minSizeClass );
 
             if( m_useDrawPriority )
                 drawFunc.deferredDraw();
@@ -1113,12 +1162,26 @@ void VIEW::Clear()
     r.SetMaximum();
     m_allItems->clear();
 
+    for( VIEW_ITEM* item : *m_updatedItems )
+    {
+        if( auto viewData = item->viewPrivData() )
+            viewData->clearUpdateFlags();
+    }
+
+    m_updatedItems->clear();
+
     for( LAYER_MAP_ITER i = m_layers.begin(); i != m_layers.end(); ++i )
         i->second.items->RemoveAll();
 
     m_nextDrawPriority = 0;
 
     m_gal->ClearCache();
+
+    for( LAYER_MAP_ITER i = m_layers.begin(); i != m_layers.end(); ++i )
+    {
+        i->second.lodGroup = -1;
+        i->second.lodDirty = true;
+    }
 }
 
 
@@ -1208,6 +1271,8 @@ void VIEW::clearGroupCache()
     {
         VIEW_LAYER* l = &( ( *i ).second );
         l->items->Query( r, visitor );
+        l->lodGroup = -1;
+        l->lodDirty = true;
     }
 }
 
@@ -1251,6 +1316,9 @@ void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
 
         // Mark those layers as dirty, so the VIEW will be refreshed
         MarkTargetDirty( m_layers[layerId].target );
+
+        // The item may be one of the aggregated ones
+        invalidateLodCell( m_layers[layerId], aItem->viewPrivData()->m_bbox );
     }
 
     aItem->viewPrivData()->clearUpdateFlags();
@@ -1323,9 +1391,12 @@ void VIEW::updateItemGeometry( VIEW_ITEM* aItem, int aLayer )
 
 void VIEW::updateBbox( VIEW_ITEM* aItem )
 {
+    auto viewData = aItem->viewPrivData();
     int layers[VIEW_MAX_LAYERS], layers_count;
+    BOX2I prevBBox = viewData->m_bbox;
 
     aItem->ViewGetLayers( layers, layers_count );
+    viewData->m_bbox = aItem->ViewBBox();
 
     for( int i = 0; i < layers_count; ++i )
     {
@@ -1333,6 +1404,8 @@ void VIEW::updateBbox( VIEW_ITEM* aItem )
         l.items->Remove( aItem );
         l.items->Insert( aItem );
         MarkTargetDirty( l.target );
+        invalidateLodCell( l, prevBBox );
+        invalidateLodCell( l, viewData->m_bbox );
     }
 }
 
@@ -1353,6 +1426,7 @@ void VIEW::updateLayers( VIEW_ITEM* aItem )
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Remove( aItem );
         MarkTargetDirty( l.target );
+        invalidateLodCell( l, viewData->m_bbox );
 
         if( IsCached( l.id ) )
         {
@@ -1370,12 +1444,14 @@ void VIEW::updateLayers( VIEW_ITEM* aItem )
     // Add the item to new layer set
     aItem->ViewGetLayers( layers, layers_count );
     viewData->saveLayers( layers, layers_count );
+    viewData->m_bbox = aItem->ViewBBox();
 
     for( int i = 0; i < layers_count; i++ )
     {
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Insert( aItem );
         MarkTargetDirty( l.target );
+        invalidateLodCell( l, viewData->m_bbox );
     }
 }
 
@@ -1414,6 +1490,47 @@ void VIEW::RecacheAllItems()
             l->items->Query( r, visitor );
         }
     }
+
+    invalidateLodGroups();
+}
+
+
+void VIEW::prepareItems( const std::vector<VIEW_ITEM*>& aItems )
+{
+    const int redrawFlags = INITIAL_ADD | GEOMETRY | LAYERS | REPAINT;
+    std::vector<VIEW_ITEM*> items;
+
+    for( VIEW_ITEM* item : aItems )
+    {
+        if( item->viewPrivData()->m_requiredUpdate & redrawFlags )
+            items.push_back( item );
+    }
+
+    // We don't want to dispatch a task for fewer than 16 items (overhead costs)
+    size_t parallelThreadCount = std::min<size_t>( THREAD_POOL::Get().GetThreadCount(),
+            ( items.size() + 15 ) / 16 );
+
+    if( parallelThreadCount <= 1 )
+    {
+        for( VIEW_ITEM* item : items )
+            m_painter->PrepareItem( item );
+
+        return;
+    }
+
+    TASK_GROUP tasks;
+    std::atomic<size_t> nextItem( 0 );
+
+    auto prepare_lambda = [&nextItem, &items, this]()
+    {
+        for( size_t i = nextItem++; i < items.size(); i = nextItem++ )
+            m_painter->PrepareItem( items[i] );
+    };
+
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        tasks.Run( prepare_lambda );
+
+    tasks.Wait();
 }
 
 
@@ -1423,19 +1540,224 @@ void VIEW::UpdateItems()
     {
         GAL_UPDATE_CONTEXT ctx( m_gal );
 
-        for( VIEW_ITEM* item : *m_allItems )
+        if( !m_updatedItems->empty() )
         {
-            auto viewData = item->viewPrivData();
+            // Items updated while these ones are redrawn wait for the next call
+            std::vector<VIEW_ITEM*> items;
+            items.swap( *m_updatedItems );
 
-            if( !viewData )
-                continue;
+            // The drawing itself goes to the GAL caches, one item after the other
+            if( m_painter )
+                prepareItems( items );
 
-            if( viewData->m_requiredUpdate != NONE )
+            for( VIEW_ITEM* item : items )
             {
-                invalidateItem( item, viewData->m_requiredUpdate );
-                viewData->m_requiredUpdate = NONE;
+                auto viewData = item->viewPrivData();
+
+                if( viewData->m_requiredUpdate != NONE )
+                {
+                    invalidateItem( item, viewData->m_requiredUpdate );
+                    viewData->m_requiredUpdate = NONE;
+                }
             }
+
+            if( m_painter )
+                m_painter->ReleasePreparedItems();
         }
+
+        updateLodGroups();
+    }
+}
+
+
+int VIEW::lodSizeClass( const VIEW_LAYER& aLayer ) const
+{
+    // Printouts are drawn with all the details
+    if( aLayer.lodMinSize <= 0.0 || m_printMode > 0 || aLayer.target != TARGET_CACHED )
+        return 0;
+
+    // Limited to the cell sizes which fit in an int
+    return std::min( VIEW_RTREE::SizeClass( (int64_t) ToWorld( aLayer.lodMinSize ) ),
+                     VIEW_RTREE::SIZE_CLASSES - 2 );
+}
+
+
+bool VIEW::isLodValid( const VIEW_LAYER& aLayer ) const
+{
+    return aLayer.lodSizeClass > 0 && !aLayer.lodDirty && aLayer.lodDirtyCells.empty()
+            && aLayer.lodSizeClass == lodSizeClass( aLayer );
+}
+
+
+void VIEW::invalidateLodGroups()
+{
+    for( LAYER_MAP_ITER i = m_layers.begin(); i != m_layers.end(); ++i )
+        i->second.lodDirty = true;
+}
+
+
+/**
+ * Returns the key of the cell of the LOD grid holding a point.
+ */
+static uint64_t lodCellKey( const VECTOR2I& aPoint, int aCellSize )
+{
+    auto cellIndex = [aCellSize]( int aCoord )
+    {
+        return (uint32_t) (int) std::floor( (double) aCoord / aCellSize );
+    };
+
+    return ( (uint64_t) cellIndex( aPoint.x ) << 32 ) | cellIndex( aPoint.y );
+}
+
+
+void VIEW::invalidateLodCell( VIEW_LAYER& aLayer, const BOX2I& aBBox )
+{
+    // Nothing is aggregated, or everything is going to be aggregated again
+    if( aLayer.lodGroup < 0 || aLayer.lodDirty )
+        return;
+
+    // The items of this size are drawn one by one
+    if( VIEW_RTREE::SizeClass( aBBox ) >= aLayer.lodSizeClass )
+        return;
+
+    aLayer.lodDirtyCells.insert( lodCellKey( aBBox.Centre(), 1 << aLayer.lodSizeClass ) );
+}
+
+
+struct VIEW::aggregateItems
+{
+    aggregateItems( VIEW* aView, int aLayer, int aCellSize,
+                    std::unordered_map<uint64_t, LOD_CELL>& aCells,
+                    const std::unordered_set<uint64_t>* aOnlyCells = nullptr ) :
+        view( aView ), layer( aLayer ), cellSize( aCellSize ), cells( aCells ),
+        onlyCells( aOnlyCells )
+    {
+    }
+
+    bool operator()( VIEW_ITEM* aItem )
+    {
+        // Same conditions as for drawing the item
+        if( !aItem->viewPrivData()->isRenderable()
+                || aItem->ViewGetLOD( layer, view ) >= view->m_scale )
+            return true;
+
+        const BOX2I& bbox = aItem->ViewBBox();
+        uint64_t     key = lodCellKey( bbox.Centre(), cellSize );
+
+        if( onlyCells && !onlyCells->count( key ) )
+            return true;
+
+        auto it = cells.find( key );
+
+        if( it == cells.end() )
+            cells[key] = LOD_CELL{ bbox, view->m_painter->GetSettings()->GetColor( aItem, layer ) };
+        else
+            it->second.bbox.Merge( bbox );
+
+        return true;
+    }
+
+    VIEW* view;
+    int layer, cellSize;
+    std::unordered_map<uint64_t, LOD_CELL>& cells;
+    const std::unordered_set<uint64_t>* onlyCells;
+};
+
+
+void VIEW::updateLodGroups()
+{
+    BOX2I r;
+
+    r.SetMaximum();
+
+    for( LAYER_MAP_ITER i = m_layers.begin(); i != m_layers.end(); ++i )
+    {
+        VIEW_LAYER& l = i->second;
+
+        if( !l.visible || isLodValid( l ) )
+            continue;
+
+        int sizeClass = lodSizeClass( l );
+
+        // Nothing to do for the layers drawing all their items, unless they have to drop
+        // the blocks of a previous zoom level
+        if( sizeClass == 0 && l.lodSizeClass == 0 && l.lodGroup < 0 )
+            continue;
+
+        // Only the cells whose items have been modified are aggregated again, unless the
+        // zoom or the layer settings changed
+        bool rebuild = l.lodDirty || l.lodGroup < 0 || sizeClass != l.lodSizeClass;
+        std::unordered_set<uint64_t> dirtyCells;
+
+        dirtyCells.swap( l.lodDirtyCells );
+
+        if( l.lodGroup >= 0 )
+            m_gal->DeleteGroup( l.lodGroup );
+
+        l.lodGroup = -1;
+        l.lodSizeClass = sizeClass;
+        l.lodDirty = false;
+
+        if( rebuild )
+        {
+            l.lodCells.clear();
+        }
+        else
+        {
+            for( uint64_t key : dirtyCells )
+                l.lodCells.erase( key );
+        }
+
+        if( sizeClass == 0 || !l.lodAggregate )
+            continue;
+
+        // Each block covers the items of a cell not larger than the threshold, they are all
+        // smaller than one cell
+        int cellSize = 1 << sizeClass;
+
+        if( rebuild )
+        {
+            aggregateItems visitor( this, l.id, cellSize, l.lodCells );
+            l.items->Query( r, visitor, 0, sizeClass - 1 );
+        }
+        else
+        {
+            aggregateItems visitor( this, l.id, cellSize, l.lodCells, &dirtyCells );
+
+            for( uint64_t key : dirtyCells )
+            {
+                // The items whose center is in the cell overlap it by half a cell at most
+                int64_t x = (int64_t) (int32_t) ( key >> 32 ) * cellSize - cellSize / 2;
+                int64_t y = (int64_t) (int32_t) ( key & 0xffffffff ) * cellSize - cellSize / 2;
+                int64_t size = 2 * (int64_t) cellSize;
+                BOX2I   area;
+
+                area.SetOrigin( (int) Clamp<int64_t>( INT_MIN, x, INT_MAX ),
+                                (int) Clamp<int64_t>( INT_MIN, y, INT_MAX ) );
+                area.SetEnd( (int) Clamp<int64_t>( INT_MIN, x + size, INT_MAX ),
+                             (int) Clamp<int64_t>( INT_MIN, y + size, INT_MAX ) );
+
+                l.items->Query( area, visitor, 0, sizeClass - 1 );
+            }
+        }
+
+        m_gal->SetTarget( l.target );
+        m_gal->SetLayerDepth( l.renderingOrder );
+
+        l.lodGroup = m_gal->BeginGroup();
+        m_gal->SetIsStroke( false );
+        m_gal->SetIsFill( true );
+
+        for( const auto& cell : l.lodCells )
+        {
+            const BOX2I& bbox = cell.second.bbox;
+
+            m_gal->SetFillColor( cell.second.color );
+            m_gal->DrawRectangle( VECTOR2D( bbox.GetOrigin() ), VECTOR2D( bbox.GetEnd() ) );
+        }
+
+        m_gal->EndGroup();
+        MarkTargetDirty( l.target );
     }
 }
 
@@ -1449,7 +1771,7 @@ void VIEW::UpdateAllItems( int aUpdateFlags )
         if( !viewData )
             continue;
 
-        viewData->m_requiredUpdate |= aUpdateFlags;
+        addUpdateFlags( item, aUpdateFlags );
     }
 }
 
@@ -1466,7 +1788,7 @@ void VIEW::UpdateAllItemsConditionally( int aUpdateFlags,
             if( !viewData )
                 continue;
 
-            viewData->m_requiredUpdate |= aUpdateFlags;
+            addUpdateFlags( item, aUpdateFlags );
         }
     }
 }
@@ -1476,7 +1798,16 @@ std::unique_ptr<VIEW> VIEW::DataReference() const
 {
     auto ret = std::make_unique<VIEW>();
     ret->m_allItems = m_allItems;
+    ret->m_updatedItems = m_updatedItems;
     ret->m_layers = m_layers;
+
+    // The groups belong to the GAL of this view
+    for( LAYER_MAP_ITER i = ret->m_layers.begin(); i != ret->m_layers.end(); ++i )
+    {
+        i->second.lodGroup = -1;
+        i->second.lodDirty = true;
+    }
+
     ret->sortLayers();
     return ret;
 }
@@ -1545,8 +1876,22 @@ void VIEW::Update( VIEW_ITEM* aItem, int aUpdateFlags )
 
     assert( aUpdateFlags != NONE );
 
-    viewData->m_requiredUpdate |= aUpdateFlags;
+    addUpdateFlags( aItem, aUpdateFlags );
+}
+
+
+void VIEW::addUpdateFlags( VIEW_ITEM* aItem, int aUpdateFlags )
+{
+    auto viewData = aItem->viewPrivData();
+
+    // A removed item gets its INITIAL_ADD update when it is added again
+    if( !viewData->m_view )
+        return;
 
+    if( viewData->m_requiredUpdate == NONE )
+        m_updatedItems->push_back( aItem );
+
+    viewData->m_requiredUpdate |= aUpdateFlags;
 }
 
 
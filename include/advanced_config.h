@@ -73,6 +73,11 @@ public:
      */
     bool m_enableSvgImport;
 
+    /**
+     * Record the interactive router operations for replaying them.
+     */
+    bool m_recordRouterEvents;
+
     /**
      * Helper to determine if legacy canvas is allowed (according to platform
      * and config)
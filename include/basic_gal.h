@@ -118,6 +118,13 @@ public:
      */
     virtual void DrawPolyline( const std::deque<VECTOR2D>& aPointList ) override;
 
+    /**
+     * @brief Draw a polyline
+     * @param aPointList is an array of 2D-Vectors containing the polyline points.
+     * @param aListSize is the number of points in the array.
+     */
+    virtual void DrawPolyline( const VECTOR2D aPointList[], int aListSize ) override;
+
     /** Start and end points are defined as 2D-Vectors.
      * @param aStartPoint   is the start point of the line.
      * @param aEndPoint     is the end point of the line.
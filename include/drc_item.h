@@ -168,6 +168,13 @@ public:
     BOARD_ITEM* GetMainItem( BOARD* aBoard ) const;
     BOARD_ITEM* GetAuxiliaryItem( BOARD* aBoard ) const;
 
+    /**
+     * Access to the A and B weak references, to be compared with item pointers
+     * without searching the board.  They must never be dereferenced.
+     */
+    const void* GetMainItemWeakRef() const { return m_mainItemWeakRef; }
+    const void* GetAuxItemWeakRef() const { return m_auxItemWeakRef; }
+
     /**
      * Function ShowHtml
      * translates this object into a fragment of HTML suitable for the
@@ -31,11 +31,13 @@
 
 #include <map>
 #include <iterator>
+#include <vector>
 
 #include <cairo.h>
 
 #include <gal/graphics_abstraction_layer.h>
 #include <wx/dcbuffer.h>
+#include <wx/timer.h>
 
 #include <memory>
 
@@ -214,6 +216,16 @@ public:
 
     virtual void EnableDepthTest( bool aEnabled = false ) override;
 
+    /**
+     * @brief Enables the parallel rasterization of the frames.
+     *
+     * The shapes drawn on an image surface are then only recorded, and rasterized at the end
+     * of the frame by the worker threads, each one filling its own band of the image.
+     */
+    void SetParallelRendering( bool aEnabled ) { m_parallelRendering = aEnabled; }
+
+    bool IsParallelRendering() const { return m_parallelRendering; }
+
 protected:
     /// @copydoc GAL::BeginDrawing()
     virtual void beginDrawing() override;
@@ -223,6 +235,67 @@ protected:
 
     void resetContext();
 
+    /// Shape whose rasterization was deferred by the parallel rendering
+    struct DEFERRED_COMMAND
+    {
+        enum TYPE
+        {
+            CMD_FILL,                               ///< Fill the path
+            CMD_STROKE,                             ///< Stroke the path
+            CMD_PAINT                               ///< Paint the source image
+        };
+
+        TYPE                m_type;
+        cairo_path_t*       m_path;                 ///< Path in user space, if any
+        cairo_surface_t*    m_source;               ///< Painted image, if any
+        cairo_matrix_t      m_matrix;               ///< User to device space transformation
+        cairo_operator_t    m_operator;
+        COLOR4D             m_color;
+        double              m_lineWidth;
+        double              m_top;                  ///< Device space extents of the shape
+        double              m_bottom;
+    };
+
+    typedef std::vector<DEFERRED_COMMAND> DEFERRED_COMMANDS;
+
+    bool                m_parallelRendering;        ///< Is the parallel rasterization enabled
+    cairo_surface_t*    m_deferredSurface;          ///< Surface whose rasterization is deferred
+    cairo_antialias_t   m_deferredAntialias;        ///< Antialiasing mode of that surface
+    DEFERRED_COMMANDS   m_deferred;                 ///< Shapes waiting for flushDeferred()
+
+    /// Defers the rasterization of the shapes drawn with the current context, if possible
+    void startDeferring();
+
+    /// Rasterizes the deferred shapes on their surface
+    virtual void flushDeferred();
+
+    /// Fills or strokes the current path, right now or later depending on the current context
+    void fillPath( const COLOR4D& aColor, bool aPreserve = false );
+    void strokePath( const COLOR4D& aColor, bool aPreserve = false );
+
+    /// Paints an image with the current transformation
+    void paintSurface( cairo_surface_t* aSource );
+
+    /// Records a shape drawn on the deferred surface instead of rasterizing it
+    void recordCommand( DEFERRED_COMMAND::TYPE aType, const COLOR4D& aColor, bool aPreserve );
+
+    /**
+     * @brief Rasterizes shapes on an image surface, in bands drawn in parallel.
+     */
+    static void rasterizeCommands( const DEFERRED_COMMANDS& aCommands, cairo_surface_t* aTarget,
+                                   cairo_antialias_t aAntialias );
+
+    /**
+     * @brief Rasterizes the shapes crossing the rows [aTop, aTop + aHeight) of an image,
+     * on a surface covering only these rows.
+     */
+    static void rasterizeBand( const DEFERRED_COMMANDS& aCommands, unsigned char* aData,
+                               cairo_format_t aFormat, int aWidth, int aTop, int aHeight,
+                               int aStride, cairo_antialias_t aAntialias );
+
+    /// Frees the paths and images of the commands and clears the list
+    static void releaseCommands( DEFERRED_COMMANDS& aCommands );
+
     virtual void drawGridLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint ) override;
 
     /// Super class definition
@@ -416,6 +489,24 @@ protected:
     /// Prepare the compositor
     void setCompositor();
 
+    /// @copydoc CAIRO_GAL_BASE::flushDeferred()
+    virtual void flushDeferred() override;
+
+    /// Forgets the shapes of the last frame kept for the refinement
+    void clearFrameCommands();
+
+    // Progressive refinement: the frames drawn while the user is moving the view are rasterized
+    // without antialiasing, and rasterized again with it once the view stops moving.
+    DEFERRED_COMMANDS       m_frameCommands;        ///< Shapes drawn in the main buffer
+    cairo_surface_t*        m_frameSurface;         ///< Main buffer surface of m_frameCommands
+    cairo_antialias_t       m_frameAntialias;       ///< Antialiasing used for the refinement
+    bool                    m_coarseFrame;          ///< Was the last frame drawn without it
+    wxLongLong              m_lastFrameTime;        ///< When the main buffer was drawn last
+    wxTimer                 m_refineTimer;          ///< Starts the refinement
+
+    /// Time without any new frame after which the view is considered still (in ms)
+    static const int REFINE_DELAY = 150;
+
     // Event handlers
     /**
      * @brief Paint event handler.
@@ -431,6 +522,9 @@ protected:
      */
     void skipMouseEvent( wxMouseEvent& aEvent );
 
+    /// Rasterizes the last frame again, with antialiasing
+    void onRefineTimer( wxTimerEvent& aEvent );
+
     ///> Cairo-specific update handlers
     bool updatedGalDisplayOptions( const GAL_DISPLAY_OPTIONS& aOptions ) override;
 };
@@ -81,6 +81,12 @@ public:
     /// @brief Returns true if the GAL engine is a opengl based type.
     virtual bool IsOpenGlEngine() { return false; }
 
+    /**
+     * @brief Returns the angle step used to draw the arcs of a given radius as segments,
+     * or 0 if the engine draws them as true arcs.
+     */
+    virtual double GetArcAngleStep( double aRadius ) const { return 0.0; }
+
     // ---------------
     // Drawing methods
     // ---------------
@@ -340,6 +346,14 @@ public:
         strokeFont.Draw( aText, aPosition, aRotationAngle );
     }
 
+    /**
+     * @brief Draws polylines with their line width, e.g. a text laid out ahead by
+     * STROKE_FONT::GetStrokes().
+     *
+     * @param aStrokes are the polylines, in world coordinates.
+     */
+    void DrawStrokes( const STROKE_POLYLINES& aStrokes );
+
     /**
      * @brief Draws a text using a bitmap font. It should be faster than StrokeText(),
      * but can be used only for non-Gerber elements.
@@ -26,6 +26,7 @@
 #define CACHED_CONTAINER_H_
 
 #include <gal/opengl/vertex_container.h>
+#include <cstdint>
 #include <map>
 #include <set>
 
@@ -82,18 +83,49 @@ public:
     ///> @copydoc VERTEX_CONTAINER::Unmap()
     virtual void Unmap() override = 0;
 
+    /**
+     * Returns the fragmentation of the free space: 0 when it is all in one chunk, close to 1
+     * when it is scattered in small holes between the stored items.
+     */
+    double GetFragmentation() const;
+
+    /**
+     * Returns the number of free memory chunks.
+     */
+    unsigned int GetFreeChunkCount() const
+    {
+        return m_freeChunks.size();
+    }
+
+    /**
+     * Returns the number of bytes copied to move the stored items since the container
+     * was created.
+     */
+    uint64_t GetBytesMoved() const
+    {
+        return m_bytesMoved;
+    }
+
 protected:
-    ///> Maps size of free memory chunks to their offsets
+    ///> Size & offset of a free memory chunk
     typedef std::pair<unsigned int, unsigned int> CHUNK;
-    typedef std::multimap<unsigned int, unsigned int> FREE_CHUNK_MAP;
 
-    /// List of all the stored items
-    typedef std::set<VERTEX_ITEM*> ITEMS;
+    ///> Free chunks sorted by size, then by offset
+    typedef std::set<CHUNK> FREE_CHUNK_MAP;
+
+    ///> Maps offsets of free memory chunks to their sizes
+    typedef std::map<unsigned int, unsigned int> FREE_CHUNK_OFFSETS;
+
+    /// List of all the stored items, by offset
+    typedef std::map<unsigned int, VERTEX_ITEM*> ITEMS;
 
-    ///> Stores size & offset of free chunks.
+    ///> Stores size & offset of free chunks, for the best fit lookups.
     FREE_CHUNK_MAP  m_freeChunks;
 
-    ///> Stored VERTEX_ITEMs
+    ///> Stores offset & size of free chunks, for merging the neighbour chunks.
+    FREE_CHUNK_OFFSETS m_freeOffsets;
+
+    ///> Stored VERTEX_ITEMs, except the currently modified one
     ITEMS m_items;
 
     ///> Currently modified item
@@ -106,6 +138,12 @@ protected:
     ///> Maximal vertex index number stored in the container
     unsigned int m_maxIndex;
 
+    ///> Number of bytes copied to move items
+    uint64_t m_bytesMoved;
+
+    ///> Largest number of vertices moved by a defragmentation step
+    static constexpr unsigned int DEFRAGMENT_STEP_SIZE = 16384;
+
     /**
      * Resizes the chunk that stores the current item to the given size. The current item has
      * its offset adjusted after the call, and the new chunk parameters are stored
@@ -117,33 +155,32 @@ protected:
     bool reallocate( unsigned int aSize );
 
     /**
-     * Removes empty spaces between chunks and optionally resizes the container.
-     * After the operation there is continous space for storing vertices at the end of the container.
+     * Enlarges the container, keeping the stored data at the same offsets. The new space
+     * is added at the end of the container as free memory.
      *
      * @param aNewSize is the new size of container, expressed in number of vertices
      * @return false in case of failure (e.g. memory shortage)
      */
-    virtual bool defragmentResize( unsigned int aNewSize ) = 0;
+    virtual bool resize( unsigned int aNewSize ) = 0;
 
     /**
-     * Transfers all stored data to a new buffer, removing empty spaces between the data chunks
-     * in the container.
-     * @param aTarget is the destination for the defragmented data.
+     * Moves a few items from the end of the container to the holes before them, so the free
+     * space gathers in large chunks again.  It is meant to be called before each unmapping:
+     * the defragmentation is spread over the frames instead of stopping everything at once.
      */
-    void defragment( VERTEX* aTarget );
+    void defragmentStep();
 
     /**
-     * Looks for consecutive free memory chunks and merges them, decreasing fragmentation of
-     * memory.
+     * Returns the offset following the last vertex stored in the container.
      */
-    void mergeFreeChunks();
+    unsigned int usedEnd() const;
 
     /**
      * Returns the size of a chunk.
      *
      * @param aChunk is the chunk.
      */
-    inline int getChunkSize( const CHUNK& aChunk ) const
+    inline unsigned int getChunkSize( const CHUNK& aChunk ) const
     {
         return aChunk.first;
     }
@@ -159,10 +196,20 @@ protected:
     }
 
     /**
-     * Adds a chunk marked as a free space.
+     * Adds a chunk marked as a free space, merged with the free chunks next to it.
      */
     void addFreeChunk( unsigned int aOffset, unsigned int aSize );
 
+    /**
+     * Removes a chunk from the free space.
+     */
+    void takeFreeChunk( const CHUNK& aChunk );
+
+    /**
+     * Forgets all the free chunks.
+     */
+    void clearFreeChunks();
+
 private:
     /// Debug & test functions
     void showFreeChunks();
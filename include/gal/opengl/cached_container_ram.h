@@ -70,11 +70,11 @@ protected:
     GLuint  m_verticesBuffer;
 
     /**
-     * Defragments the currently stored data and resizes the buffer.
+     * Enlarges the buffer, keeping the stored data at the same offsets.
      * @param aNewSize is the new buffer vertex buffer size, expressed as the number of vertices.
      * @return true on success.
      */
-    bool defragmentResize( unsigned int aNewSize ) override;
+    bool resize( unsigned int aNewSize ) override;
 };
 } // namespace KIGFX
 
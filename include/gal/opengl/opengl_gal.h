@@ -88,6 +88,12 @@ public:
 
     virtual bool IsOpenGlEngine() override { return true; }
 
+    /// @copydoc GAL::GetArcAngleStep()
+    virtual double GetArcAngleStep( double aRadius ) const override
+    {
+        return calcAngleStep( aRadius );
+    }
+
     /// @copydoc GAL::IsInitialized()
     virtual bool IsInitialized() const override
     {
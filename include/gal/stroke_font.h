@@ -30,6 +30,7 @@
 #define STROKE_FONT_H_
 
 #include <deque>
+#include <vector>
 #include <algorithm>
 
 #include <utf8.h>
@@ -43,7 +44,41 @@ namespace KIGFX
 class GAL;
 
 typedef std::deque< std::deque<VECTOR2D> > GLYPH;
-typedef std::vector<GLYPH>                 GLYPH_LIST;
+
+/**
+ * The strokes of a glyph, stored one after the other in a single buffer, so they are
+ * transformed and drawn without any allocation.
+ */
+struct GLYPH_STROKES
+{
+    std::vector<VECTOR2D> m_points;         ///< Points of all the strokes, in glyph units
+    std::vector<int>      m_strokeEnds;     ///< Index following the last point of each stroke
+};
+
+/**
+ * Polylines drawn with the same line width, stored like GLYPH_STROKES: e.g. the strokes of
+ * a text laid out by STROKE_FONT::GetStrokes(), in world coordinates.
+ */
+struct STROKE_POLYLINES
+{
+    std::vector<VECTOR2D> m_points;         ///< Points of all the polylines
+    std::vector<int>      m_polylineEnds;   ///< Index following the last point of each polyline
+    double                m_lineWidth = 0.0;
+};
+
+/**
+ * The attributes of a text laid out by STROKE_FONT, the ones Draw() takes from the GAL.
+ */
+struct STROKE_TEXT_ATTRIBUTES
+{
+    VECTOR2D            m_glyphSize;
+    EDA_TEXT_HJUSTIFY_T m_horizontalJustify = GR_TEXT_HJUSTIFY_CENTER;
+    EDA_TEXT_VJUSTIFY_T m_verticalJustify = GR_TEXT_VJUSTIFY_CENTER;
+    bool                m_bold = false;
+    bool                m_italic = false;
+    bool                m_mirrored = false;
+    double              m_lineWidth = 0.0;  ///< Width of the strokes, without the bold factor
+};
 
 /**
  * @brief Class STROKE_FONT implements stroke font drawing.
@@ -76,6 +111,20 @@ public:
      */
     void Draw( const UTF8& aText, const VECTOR2D& aPosition, double aRotationAngle );
 
+    /**
+     * Function GetStrokes
+     * Lays out a string as Draw() does, but with the given attributes instead of the ones
+     * of the GAL, and without drawing it: it can be called from any thread.
+     *
+     * @param aText is the text to be laid out.
+     * @param aPosition is the text position in world coordinates.
+     * @param aRotationAngle is the text rotation angle in radians.
+     * @param aAttributes are the size, justification and style of the text.
+     * @param aStrokes receives the strokes of the text, in world coordinates.
+     */
+    void GetStrokes( const UTF8& aText, const VECTOR2D& aPosition, double aRotationAngle,
+                     const STROKE_TEXT_ATTRIBUTES& aAttributes, STROKE_POLYLINES& aStrokes ) const;
+
     /**
      * Function SetGAL
      * Changes Graphics Abstraction Layer used for drawing items for a new one.
@@ -117,8 +166,9 @@ public:
 
 private:
     GAL*                m_gal;                  ///< Pointer to the GAL
-    GLYPH_LIST          m_glyphs;               ///< Glyph list
+    std::vector<GLYPH_STROKES> m_glyphStrokes;  ///< Strokes of the glyphs
     std::vector<BOX2D>  m_glyphBoundingBoxes;   ///< Bounding boxes of the glyphs
+    STROKE_POLYLINES    m_drawnStrokes;         ///< Strokes of the text drawn by Draw()
 
     /**
      * @brief Compute the X and Y size of a given text. The text is expected to be
@@ -153,12 +203,25 @@ private:
     BOX2D computeBoundingBox( const GLYPH& aGlyph, const VECTOR2D& aGlyphBoundingX ) const;
 
     /**
-     * @brief Draws a single line of text. Multiline texts should be split before using the
-     * function.
+     * @brief Lays out a single line of text. Multiline texts should be split before using
+     * the function.
      *
-     * @param aText is the text to be drawn.
+     * @param aText is the text to be laid out.
+     * @param aOffset is the position of the line, before the justification.
+     * @param aAttributes are the size, justification and style of the text.
+     * @param aLineWidth is the width of the strokes, with the bold factor.
+     * @param aStrokes receives the strokes of the line, relative to the text position.
+     */
+    void layoutSingleLineText( const UTF8& aText, const VECTOR2D& aOffset,
+                               const STROKE_TEXT_ATTRIBUTES& aAttributes, double aLineWidth,
+                               STROKE_POLYLINES& aStrokes ) const;
+
+    /**
+     * Gives the same result as ComputeStringBoundaryLimits(), with the italic style given
+     * instead of taken from the GAL.
      */
-    void drawSingleLineText( const UTF8& aText );
+    VECTOR2D computeStringBoundaryLimits( const UTF8& aText, const VECTOR2D& aGlyphSize,
+                                          double aGlyphThickness, bool aItalic ) const;
 
     /**
      * @brief Returns number of lines for a given text.
@@ -48,6 +48,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <deque>
 #include <vector>
 #include <math/box2.h>
 
@@ -59,7 +60,16 @@ class PolygonTriangulation
 public:
 
     PolygonTriangulation( SHAPE_POLY_SET::TRIANGULATED_POLYGON& aResult ) :
-        m_result( aResult )
+        m_result( &aResult )
+    {};
+
+    /**
+     * Builds a triangulation object without result, to tesselate several polygons with
+     * TesselatePolygon( aPoly, aResult ): the vertices allocated for a polygon are then
+     * reused for the next ones.
+     */
+    PolygonTriangulation() :
+        m_result( nullptr )
     {};
 
 private:
@@ -72,6 +82,22 @@ private:
         Vertex& operator=( const Vertex& ) = delete;
         Vertex& operator=( Vertex&& ) = delete;
 
+        /**
+         * Function reset
+         * Reinitializes a vertex of the pool for a new polygon, as the constructor does.
+         */
+        void reset( size_t aIndex, double aX, double aY )
+        {
+            i = aIndex;
+            x = aX;
+            y = aY;
+            prev = nullptr;
+            next = nullptr;
+            z = 0;
+            prevZ = nullptr;
+            nextZ = nullptr;
+        }
+
         bool operator==( const Vertex& rhs ) const
         {
             return this->x == rhs.x && this->y == rhs.y;
@@ -92,10 +118,8 @@ private:
          */
         Vertex* split( Vertex* b )
         {
-            parent->m_vertices.emplace_back( i, x, y, parent );
-            Vertex* a2 = &parent->m_vertices.back();
-            parent->m_vertices.emplace_back( b->i, b->x, b->y, parent );
-            Vertex* b2 = &parent->m_vertices.back();
+            Vertex* a2 = parent->createVertex( i, x, y );
+            Vertex* b2 = parent->createVertex( b->i, b->x, b->y );
             Vertex* an = next;
             Vertex* bp = b->prev;
 
@@ -176,8 +200,9 @@ private:
          */
         void zSort()
         {
-            std::deque<Vertex*> queue;
+            std::vector<Vertex*>& queue = parent->m_zSortQueue;
 
+            queue.clear();
             queue.push_back( this );
 
             for( auto p = next; p && p != this; p = p->next )
@@ -212,9 +237,10 @@ private:
                     && ( b.x - x ) * ( c.y - y ) - ( c.x - x ) * ( b.y - y ) >= 0;
         }
 
-        const size_t i;
-        const double x;
-        const double y;
+        // not const, so that the vertex can be reused for another polygon
+        size_t i;
+        double x;
+        double y;
         PolygonTriangulation* parent;
 
         // previous and next vertices nodes in a polygon ring
@@ -230,8 +256,31 @@ private:
     };
 
     BOX2I m_bbox;
+
+    ///> Pool of vertices: only the first m_vertexCount ones are used by the current polygon,
+    ///> the other ones are kept for the next polygons.  A deque never moves its elements,
+    ///> so the links between the vertices stay valid when it grows.
     std::deque<Vertex> m_vertices;
-    SHAPE_POLY_SET::TRIANGULATED_POLYGON& m_result;
+    size_t m_vertexCount = 0;
+
+    ///> Buffer of Vertex::zSort(), kept to reuse its memory
+    std::vector<Vertex*> m_zSortQueue;
+
+    SHAPE_POLY_SET::TRIANGULATED_POLYGON* m_result;
+
+    /**
+     * Function createVertex
+     * Takes the next unused vertex of the pool, or adds one to the pool if they are all used.
+     */
+    Vertex* createVertex( size_t aIndex, double aX, double aY )
+    {
+        if( m_vertexCount < m_vertices.size() )
+            m_vertices[m_vertexCount].reset( aIndex, aX, aY );
+        else
+            m_vertices.emplace_back( aIndex, aX, aY, this );
+
+        return &m_vertices[m_vertexCount++];
+    }
 
     /**
      * Calculate the Morton code of the Vertex
@@ -397,7 +446,7 @@ private:
 
             if( isEar( aPoint ) )
             {
-                m_result.AddTriangle( prev->i, aPoint->i, next->i );
+                m_result->AddTriangle( prev->i, aPoint->i, next->i );
                 aPoint->remove();
 
                 // Skip one vertex as the triangle will account for the prev node
@@ -413,7 +462,7 @@ private:
                     locallyInside( prev, nextNext ) &&
                     locallyInside( nextNext, prev ) )
             {
-                m_result.AddTriangle( prev->i, aPoint->i, nextNext->i );
+                m_result->AddTriangle( prev->i, aPoint->i, nextNext->i );
 
                 // remove two nodes involved
                 next->remove();
@@ -630,10 +679,9 @@ private:
      */
     Vertex* insertVertex( const VECTOR2I& pt, Vertex* last )
     {
-        m_result.AddVertex( pt );
-        m_vertices.emplace_back( m_result.GetVertexCount() - 1, pt.x, pt.y, this );
+        m_result->AddVertex( pt );
 
-        Vertex* p = &m_vertices.back();
+        Vertex* p = createVertex( m_result->GetVertexCount() - 1, pt.x, pt.y );
         if( !last )
         {
             p->prev = p;
@@ -652,10 +700,35 @@ private:
 
 public:
 
+    /**
+     * Function ShrinkPool
+     * Frees the pooled vertices beyond the first aMaxVertices ones, and the sort buffer
+     * if it is larger, so that one big polygon does not keep its memory for good.
+     */
+    void ShrinkPool( size_t aMaxVertices )
+    {
+        // The vertices are not assignable: they are removed from the back, which frees the
+        // blocks of the deque as they get empty
+        while( m_vertices.size() > aMaxVertices )
+            m_vertices.pop_back();
+
+        if( m_zSortQueue.capacity() > aMaxVertices )
+            std::vector<Vertex*>().swap( m_zSortQueue );
+    }
+
+    bool TesselatePolygon( const SHAPE_LINE_CHAIN& aPoly,
+                           SHAPE_POLY_SET::TRIANGULATED_POLYGON& aResult )
+    {
+        m_result = &aResult;
+
+        return TesselatePolygon( aPoly );
+    }
+
     bool TesselatePolygon( const SHAPE_LINE_CHAIN& aPoly )
     {
         m_bbox = aPoly.BBox();
-        m_result.Clear();
+        m_result->Clear();
+        m_vertexCount = 0;
 
         if( !m_bbox.GetWidth() || !m_bbox.GetHeight() )
             return false;
@@ -670,7 +743,7 @@ public:
         firstVertex->updateList();
 
         auto retval = earcutList( firstVertex );
-        m_vertices.clear();
+        m_vertexCount = 0;
         return retval;
     }
 };
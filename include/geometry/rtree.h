@@ -99,6 +99,10 @@ public:
 public:
 
     RTree();
+
+    /// Copy the tree node by node, which is much faster than inserting all the entries again
+    RTree( const RTree& aOther );
+
     virtual ~RTree();
 
     /// Insert entry
@@ -508,6 +512,7 @@ protected:
     }
 
     void    RemoveAllRec( Node* a_node );
+    Node*   CopyRec( const Node* a_node );
     void    Reset();
     void    CountRec( Node* a_node, int& a_count );
 
@@ -628,6 +633,13 @@ RTREE_TEMPLATE RTREE_QUAL::RTree()
 }
 
 
+RTREE_TEMPLATE RTREE_QUAL::RTree( const RTree& aOther )
+{
+    m_root = CopyRec( aOther.m_root );
+    m_unitSphereVolume = aOther.m_unitSphereVolume;
+}
+
+
 RTREE_TEMPLATE
 RTREE_QUAL::~RTree() {
     Reset(); // Free, or reset node memory
@@ -1024,6 +1036,26 @@ void RTREE_QUAL::RemoveAllRec( Node* a_node )
 }
 
 
+RTREE_TEMPLATE
+typename RTREE_QUAL::Node* RTREE_QUAL::CopyRec( const Node* a_node )
+{
+    ASSERT( a_node );
+
+    Node* newNode = AllocNode();
+    *newNode = *a_node;
+
+    if( newNode->IsInternalNode() )
+    {
+        for( int index = 0; index < newNode->m_count; ++index )
+        {
+            newNode->m_branch[index].m_child = CopyRec( a_node->m_branch[index].m_child );
+        }
+    }
+
+    return newNode;
+}
+
+
 RTREE_TEMPLATE
 typename RTREE_QUAL::Node* RTREE_QUAL::AllocNode()
 {
@@ -320,6 +320,16 @@ public:
 
     bool PointCloserThan( const VECTOR2I& aP, int aDist ) const;
 
+    /**
+     * Function ApproximatesDistance()
+     *
+     * Tells if PointCloserThan() takes its shortcut for a segment almost, but not exactly,
+     * horizontal, vertical or diagonal: the distance it uses is then the one from a diagonal
+     * line, which can be much smaller than the real one, so Collide() can be true beyond
+     * the clearance.
+     */
+    bool ApproximatesDistance() const;
+
     void Reverse()
     {
         std::swap( A, B );
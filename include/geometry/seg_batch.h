@@ -0,0 +1,118 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_BATCH_H
+#define __SEG_BATCH_H
+
+#include <vector>
+
+#include <geometry/seg.h>
+
+/**
+ * Class SEG_BATCH
+ *
+ * Holds a list of segments as separate arrays of coordinates, to test a segment or a point
+ * against all of them at once.  The bounding boxes of a block of segments are first
+ * compared in a loop the compiler vectorizes, and only the segments close enough to give
+ * a result are then tested with the SEG methods, so the results are exactly the ones of
+ * the SEG methods called on each segment.
+ */
+class SEG_BATCH
+{
+public:
+    SEG_BATCH() {}
+
+    void Clear();
+
+    void Reserve( int aCount );
+
+    void Add( const VECTOR2I& aA, const VECTOR2I& aB );
+
+    void Add( const SEG& aSeg )
+    {
+        Add( aSeg.A, aSeg.B );
+    }
+
+    /**
+     * Function SetPolyline
+     * replaces the segments by the ones of a polyline, in the order and with the indices
+     * of SHAPE_LINE_CHAIN::CSegment().
+     */
+    void SetPolyline( const std::vector<VECTOR2I>& aPoints, bool aClosed );
+
+    int Size() const
+    {
+        return m_ax.size();
+    }
+
+    const SEG Segment( int aIndex ) const
+    {
+        return SEG( m_ax[aIndex], m_ay[aIndex], m_bx[aIndex], m_by[aIndex] );
+    }
+
+    /**
+     * Function Collide
+     * @return the index of the first segment for which SEG::Collide( aSeg, aClearance )
+     * is true, or -1 if there is none.
+     */
+    int Collide( const SEG& aSeg, int aClearance ) const;
+
+    /**
+     * Function SquaredDistance
+     * @return the smallest SEG::SquaredDistance( aSeg ) of the segments, or
+     * VECTOR2I::ECOORD_MAX if there are no segments.
+     * @param aIndex, if not null, receives the index of the first segment at this distance.
+     */
+    SEG::ecoord SquaredDistance( const SEG& aSeg, int* aIndex = nullptr ) const;
+
+    /**
+     * Function SquaredDistance
+     * @return the smallest SEG::SquaredDistance( aP ) of the segments, or
+     * VECTOR2I::ECOORD_MAX if there are no segments.
+     * @param aIndex, if not null, receives the index of the first segment at this distance.
+     */
+    SEG::ecoord SquaredDistance( const VECTOR2I& aP, int* aIndex = nullptr ) const;
+
+private:
+    /**
+     * Function closeBoxes
+     * sets aClose[i] to 1 for each of the aCount segments from aFirst with a bounding box
+     * closer than aLimit to the one of aSeg on both axes, and to 0 for the others.
+     * @param aApproximated tells to set it to 1 as well for the segments for which
+     * SEG::ApproximatesDistance() is true.
+     */
+    void closeBoxes( int aFirst, int aCount, const SEG& aSeg, SEG::ecoord aLimit,
+                     bool aApproximated, int* aClose ) const;
+
+    ///> Squared distance of aSeg from the segments or the point (aSeg.A == aSeg.B)
+    template <typename DIST_FUNC>
+    SEG::ecoord minSquaredDistance( const SEG& aSeg, int* aIndex, DIST_FUNC aDistFunc ) const;
+
+    ///> Coordinates of the ends of the segments
+    std::vector<int>    m_ax;
+    std::vector<int>    m_ay;
+    std::vector<int>    m_bx;
+    std::vector<int>    m_by;
+};
+
+#endif // __SEG_BATCH_H
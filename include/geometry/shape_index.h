@@ -206,6 +206,8 @@ class SHAPE_INDEX
 
         SHAPE_INDEX();
 
+        SHAPE_INDEX( const SHAPE_INDEX& aOther );
+
         ~SHAPE_INDEX();
 
         /**
@@ -300,6 +302,12 @@ SHAPE_INDEX<T>::SHAPE_INDEX()
     this->m_tree = new RTree<T, int, 2, double>();
 }
 
+template <class T>
+SHAPE_INDEX<T>::SHAPE_INDEX( const SHAPE_INDEX& aOther )
+{
+    this->m_tree = new RTree<T, int, 2, double>( *aOther.m_tree );
+}
+
 template <class T>
 SHAPE_INDEX<T>::~SHAPE_INDEX()
 {
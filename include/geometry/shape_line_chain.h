@@ -603,6 +603,12 @@ public:
      */
     ClipperLib::Path convertToClipper( bool aRequiredOrientation ) const;
 
+    /**
+     * Fills an existing Clipper path with the SHAPE_LINE_CHAIN in a given orientation,
+     * reusing its memory
+     */
+    void convertToClipper( ClipperLib::Path& aPath, bool aRequiredOrientation ) const;
+
     /**
      * Function NearestPoint()
      *
@@ -77,6 +77,11 @@ class SHAPE_POLY_SET : public SHAPE
                 m_triangles.clear();
             }
 
+            const VECTOR2I& GetVertex( int index ) const
+            {
+                return m_vertices[ index ];
+            }
+
             void GetTriangle( int index, VECTOR2I& a, VECTOR2I& b, VECTOR2I& c ) const
             {
                 auto tri = m_triangles[ index ];
@@ -570,6 +575,7 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aIndex-th outline in the set
         SHAPE_LINE_CHAIN& Outline( int aIndex )
         {
+            contentsChanged();
             return m_polys[aIndex][0];
         }
 
@@ -592,12 +598,14 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aHole-th hole in the aIndex-th outline
         SHAPE_LINE_CHAIN& Hole( int aOutline, int aHole )
         {
+            contentsChanged();
             return m_polys[aOutline][aHole + 1];
         }
 
         ///> Returns the aIndex-th subpolygon in the set
         POLYGON& Polygon( int aIndex )
         {
+            contentsChanged();
             return m_polys[aIndex];
         }
 
@@ -640,6 +648,8 @@ class SHAPE_POLY_SET : public SHAPE
         {
             ITERATOR iter;
 
+            contentsChanged();
+
             iter.m_poly = this;
             iter.m_currentPolygon = aFirst;
             iter.m_lastPolygon = aLast < 0 ? OutlineCount() - 1 : aLast;
@@ -752,6 +762,8 @@ class SHAPE_POLY_SET : public SHAPE
         {
             SEGMENT_ITERATOR iter;
 
+            contentsChanged();
+
             iter.m_poly = this;
             iter.m_currentPolygon = aFirst;
             iter.m_lastPolygon = aLast < 0 ? OutlineCount() - 1 : aLast;
@@ -826,6 +838,28 @@ class SHAPE_POLY_SET : public SHAPE
         void BooleanIntersection( const SHAPE_POLY_SET& a, const SHAPE_POLY_SET& b,
                                   POLYGON_MODE aFastMode );
 
+        ///> Operations of the BooleanBatch() steps
+        enum BOOLEAN_OP
+        {
+            BO_ADD,
+            BO_SUBTRACT,
+            BO_INTERSECT
+        };
+
+        ///> A step of BooleanBatch(): an operation and the polyset it is done with
+        typedef std::pair<BOOLEAN_OP, const SHAPE_POLY_SET*> BOOLEAN_STEP;
+
+        /**
+         * Function BooleanBatch
+         * performs a sequence of boolean operations, each step combining the result of the
+         * previous ones with its own polyset.  Unions followed by differences are done in a
+         * single Clipper pass, and the intermediate results are kept in the Clipper format,
+         * so it is much cheaper than the same sequence of BooleanAdd() and BooleanSubtract()
+         * calls, or than merging the operands beforehand.
+         * For aFastMode meaning, see function booleanOp; it only applies to the last pass.
+         */
+        void BooleanBatch( const std::vector<BOOLEAN_STEP>& aSteps, POLYGON_MODE aFastMode );
+
         ///> Performs outline inflation/deflation, using round corners.
         void Inflate( int aFactor, int aCircleSegmentsCount );
 
@@ -849,6 +883,16 @@ class SHAPE_POLY_SET : public SHAPE
         ///> For aFastMode meaning, see function booleanOp
         void Simplify( POLYGON_MODE aFastMode );
 
+        /**
+         * Function SimplifyParallel
+         * does the same as Simplify(), for the large sets of overlapping polygons built from
+         * many items: the polygons are split in vertical strips, whose unions are merged
+         * pairwise across the worker threads.  Small sets are simplified in one pass.
+         * For aFastMode meaning, see function booleanOp; it only applies to the last merge.
+         * @param aMaxStrips caps the count of strips, 0 for one strip by worker thread.
+         */
+        void SimplifyParallel( POLYGON_MODE aFastMode, size_t aMaxStrips = 0 );
+
         /**
          * Function NormalizeAreaOutlines
          * Convert a self-intersecting polygon to one (or more) non self-intersecting polygon(s)
@@ -955,6 +999,20 @@ class SHAPE_POLY_SET : public SHAPE
          */
         bool Contains( const VECTOR2I& aP, int aSubpolyIndex = -1, bool aIgnoreHoles = false ) const;
 
+        /**
+         * Function EnableContainmentIndex
+         * makes Contains() use an index of the contours, worth it for the sets tested against
+         * many points: the bounding box of each contour, and its edges sorted in horizontal
+         * bands so that only the edges at the height of the point are tested.
+         * The index is built by the first Contains() call and dropped by the changes made
+         * through the methods of the set.  A contour must not be changed through a reference
+         * obtained before the index was built (from Outline(), Vertex(), an iterator...).
+         * The setting is kept by an assignment to the set, and copied by the copy constructor.
+         */
+        void EnableContainmentIndex( bool aEnable = true );
+
+        bool IsContainmentIndexEnabled() const { return m_containmentIndexEnabled; }
+
         ///> Returns true if the set is empty (no polygons at all)
         bool IsEmpty() const
         {
@@ -1117,8 +1175,62 @@ class SHAPE_POLY_SET : public SHAPE
                         const SHAPE_POLY_SET& aShape,
                         const SHAPE_POLY_SET& aOtherShape, POLYGON_MODE aFastMode );
 
+        /** Function addPaths
+         * adds all the outlines and holes of aShape to aClipper, converted in aBuffer
+         * to avoid a memory allocation for each path.
+         */
+        static void addPaths( ClipperLib::Clipper& aClipper, ClipperLib::Path& aBuffer,
+                              const SHAPE_POLY_SET& aShape, ClipperLib::PolyType aType );
+
         bool pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN& aPath ) const;
 
+        /**
+         * Index of the edges of a contour, for the point in contour test: the edges are
+         * sorted in horizontal bands of equal height, an edge being in all the bands it
+         * crosses, so the ray cast from a point is only tested against the edges of its band.
+         */
+        struct CONTOUR_INDEX
+        {
+            BOX2I               m_bbox;
+            int                 m_bandCount;
+            std::vector<int>    m_bandStarts;       ///< First entry of each band in m_edges
+            std::vector<int>    m_edges;            ///< Edge indices, band after band
+        };
+
+        ///> Index of all the contours, laid out like m_polys
+        typedef std::vector<std::vector<CONTOUR_INDEX>> CONTAINMENT_INDEX;
+
+        static CONTOUR_INDEX buildContourIndex( const SHAPE_LINE_CHAIN& aPath );
+
+        /**
+         * Function pointInContour
+         * gives the same result as SHAPE_LINE_CHAIN::PointInside(), using the contour index.
+         */
+        static bool pointInContour( const VECTOR2I& aP, const SHAPE_LINE_CHAIN& aPath,
+                                    const CONTOUR_INDEX& aIndex );
+
+        ///> Returns the containment index, building it if needed
+        std::shared_ptr<const CONTAINMENT_INDEX> containmentIndex() const;
+
+        void invalidateContainmentIndex()
+        {
+            // The index is only built while enabled, and the flag only changes through non-const
+            // calls, so the sets without index skip the lock of the atomic store
+            if( !m_containmentIndexEnabled )
+                return;
+
+            // Other threads may be loading the index of this set at the same time
+            std::atomic_store( &m_containmentIndex, {} );
+        }
+
+        ///> Drops what depends on the contents: the containment index, and the triangles
+        ///> kept from the contents before the last assignment
+        void contentsChanged()
+        {
+            invalidateContainmentIndex();
+            m_previousTriangulatedPolys.clear();
+        }
+
         /**
          * containsSingle function
          * Checks whether the point aP is inside the aSubpolyIndex-th polygon of the polyset. If
@@ -1128,10 +1240,13 @@ class SHAPE_POLY_SET : public SHAPE
          * @param  aSubpolyIndex is an integer specifying which polygon in the set has to be
          *                       checked.
          * @param  aIgnoreHoles  can be set to true to ignore internal holes in the polygon
+         * @param  aIndex        is the containment index of the set, or nullptr to test all
+         *                       the edges of the contours.
          * @return bool - true if aP is inside aSubpolyIndex-th polygon; false in any other
          *         case.
          */
-        bool containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool aIgnoreHoles = false ) const;
+        bool containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool aIgnoreHoles = false,
+                             const CONTAINMENT_INDEX* aIndex = nullptr ) const;
 
         /**
          * Operations ChamferPolygon and FilletPolygon are computed under the private chamferFillet
@@ -1174,6 +1289,12 @@ class SHAPE_POLY_SET : public SHAPE
 
         SHAPE_POLY_SET& operator=( const SHAPE_POLY_SET& );
 
+        /**
+         * Function CacheTriangulation
+         * triangulates the outlines of the set, fractured first if it has holes.  The
+         * outlines which did not change since the previous triangulation, including the one
+         * of the contents replaced by operator=(), keep their triangles.
+         */
         void CacheTriangulation();
         bool IsTriangulationUpToDate() const;
 
@@ -1187,6 +1308,16 @@ class SHAPE_POLY_SET : public SHAPE
         bool m_triangulationValid = false;
         MD5_HASH m_hash;
 
+        ///> Triangulated polygons of the contents replaced by operator=(): CacheTriangulation()
+        ///> takes the ones of the outlines which did not change
+        std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> m_previousTriangulatedPolys;
+
+        bool m_containmentIndexEnabled = false;
+
+        // Built on demand by the const Contains(), possibly from several threads: only
+        // accessed with the atomic shared_ptr functions there
+        mutable std::shared_ptr<const CONTAINMENT_INDEX> m_containmentIndex;
+
 };
 
 #endif
@@ -354,6 +354,23 @@ public:
      */
     virtual bool Draw( const VIEW_ITEM* aItem, int aLayer ) = 0;
 
+    /**
+     * Function PrepareItem
+     * Computes ahead of Draw() the geometry an item caches for its drawing (e.g. polygon
+     * triangulations, text strokes or arc segments), so it is not done while the GAL is busy
+     * caching the item.
+     * The VIEW calls it from several threads at once for different items, so it must not
+     * use the GAL nor change anything shared between items without locking it.
+     * @param aItem is the item which is going to be redrawn.
+     */
+    virtual void PrepareItem( VIEW_ITEM* aItem ) {}
+
+    /**
+     * Function ReleasePreparedItems
+     * Frees what PrepareItem() computed for the items which were not drawn afterwards.
+     */
+    virtual void ReleasePreparedItems() {}
+
 protected:
     /// Instance of graphic abstraction layer that gives an interface to call
     /// commands used to draw (eg. DrawLine, DrawCircle, etc.)
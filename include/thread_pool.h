@@ -0,0 +1,186 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TASK_GROUP;
+
+/**
+ * Class THREAD_POOL
+ * is the set of worker threads shared by all the parallel computations of the
+ * application (zone filling, connectivity, ratsnest, 3D rendering...), so they do not
+ * oversubscribe the cores and do not pay a thread creation for each operation.
+ *
+ * Each worker owns a task queue: the tasks it submits itself are pushed on and popped
+ * from the back of its own queue, so nested work stays hot in its cache, while idle
+ * workers steal the oldest tasks from the front of the other queues.  Threads which are
+ * not part of the pool submit to one more shared queue.
+ *
+ * Tasks are always submitted through a TASK_GROUP, which is what the callers wait on.
+ */
+class THREAD_POOL
+{
+public:
+    /**
+     * Function Get
+     * @return the pool of the application, created with one worker per core the first
+     * time it is used.
+     */
+    static THREAD_POOL& Get();
+
+    THREAD_POOL( size_t aThreadCount );
+    ~THREAD_POOL();
+
+    /**
+     * Function GetThreadCount
+     * @return the number of workers, i.e. the number of tasks which can really run
+     * at the same time.
+     */
+    size_t GetThreadCount() const { return m_threads.size(); }
+
+    /**
+     * Function IsWorkerThread
+     * @return true if the calling thread is one of the workers of this pool.
+     */
+    bool IsWorkerThread() const;
+
+private:
+    friend class TASK_GROUP;
+
+    struct TASK
+    {
+        std::function<void()>   m_func;
+        TASK_GROUP*             m_group;
+    };
+
+    struct TASK_QUEUE
+    {
+        std::mutex              m_lock;
+        std::deque<TASK>        m_tasks;
+    };
+
+    THREAD_POOL( const THREAD_POOL& ) = delete;
+    THREAD_POOL& operator=( const THREAD_POOL& ) = delete;
+
+    void submit( TASK&& aTask );
+
+    /**
+     * Function runOne
+     * runs one queued task in the calling thread: the newest one of its own queue,
+     * otherwise the oldest one of the other queues.
+     * @param aGroup if not null, only the tasks of this group are run.
+     * @return false if there was nothing to run.
+     */
+    bool runOne( const TASK_GROUP* aGroup = nullptr );
+
+    void workerLoop( size_t aIndex );
+
+    size_t queueIndex() const;
+
+    std::vector<std::unique_ptr<TASK_QUEUE>>    m_queues;
+    std::vector<std::thread>                    m_threads;
+
+    std::atomic<size_t>                         m_queuedCount;
+    std::atomic<bool>                           m_quit;
+
+    std::mutex                                  m_sleepLock;
+    std::condition_variable                     m_wakeUp;
+};
+
+
+/**
+ * Class TASK_GROUP
+ * is a set of tasks run by a THREAD_POOL which can be waited for and cancelled
+ * together.
+ *
+ * The tasks of a cancelled group which did not start yet are skipped, the running ones
+ * are expected to poll IsCancelled().  If a task throws, the first exception is
+ * rethrown by Wait().  The destructor cancels the group and waits for it, so the tasks
+ * never outlive the objects they refer to.
+ */
+class TASK_GROUP
+{
+public:
+    TASK_GROUP( THREAD_POOL& aPool = THREAD_POOL::Get() );
+    ~TASK_GROUP();
+
+    /**
+     * Function Run
+     * queues a task.  It can start immediately on any worker.
+     */
+    void Run( std::function<void()> aTask );
+
+    /**
+     * Function Wait
+     * waits until all the tasks of the group are done.
+     *
+     * When called from a thread outside of the pool with a keep alive callback, the
+     * callback is invoked every aInterval while waiting: this is the hook for the progress
+     * reporters, which must be refreshed from the main thread.  Otherwise the calling
+     * thread helps running the queued tasks of this group, so a task waiting for a nested
+     * group never blocks a worker.  The tasks of the other groups are never run by a
+     * waiting thread, as they may be long or need locks the caller holds.
+     */
+    void Wait( const std::function<void()>& aKeepAlive = nullptr,
+               std::chrono::milliseconds aInterval = std::chrono::milliseconds( 100 ) );
+
+    void Cancel() { m_cancelled = true; }
+
+    bool IsCancelled() const { return m_cancelled; }
+
+    /**
+     * Function GetThreadCount
+     * @return the number of tasks of this group which can run at the same time: callers
+     * splitting a loop over the workers should not submit more tasks than this.
+     */
+    size_t GetThreadCount() const { return m_pool.GetThreadCount(); }
+
+private:
+    friend class THREAD_POOL;
+
+    TASK_GROUP( const TASK_GROUP& ) = delete;
+    TASK_GROUP& operator=( const TASK_GROUP& ) = delete;
+
+    void execute( std::function<void()>& aTask );
+
+    THREAD_POOL&            m_pool;
+
+    std::atomic<bool>       m_cancelled;
+    size_t                  m_pending;          // protected by m_lock
+    std::exception_ptr      m_exception;        // protected by m_lock
+    std::mutex              m_lock;
+    std::condition_variable m_done;
+};
+
+#endif  // THREAD_POOL_H
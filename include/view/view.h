@@ -25,12 +25,15 @@
 #ifndef __VIEW_H
 #define __VIEW_H
 
+#include <cstdint>
 #include <vector>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 
 #include <math/box2.h>
+#include <gal/color4d.h>
 #include <gal/definitions.h>
 
 #include <view/view_overlay.h>
@@ -448,6 +451,27 @@ public:
         m_layers[aLayer].target = aTarget;
     }
 
+    /**
+     * Function SetLayerLODThreshold()
+     * Sets the size on screen below which the items of a cached layer are not drawn one by one:
+     * they are replaced by blocks covering the areas they occupy, or simply skipped, so zooming
+     * out on thousands of tiny items does not cost a draw call for each of them.
+     * @param aLayer is the layer.
+     * @param aPixels is the threshold in pixels, 0 draws all the items of the layer.
+     * @param aAggregate tells if the small items are replaced by blocks or skipped.
+     */
+    void SetLayerLODThreshold( int aLayer, double aPixels, bool aAggregate = true );
+
+    /**
+     * Function GetLayerLODThreshold()
+     * Returns the size on screen, in pixels, below which the items of a layer are aggregated.
+     */
+    double GetLayerLODThreshold( int aLayer ) const
+    {
+        wxCHECK( aLayer < (int) m_layers.size(), 0.0 );
+        return m_layers.at( aLayer ).lodMinSize;
+    }
+
     /**
      * Function SetLayerOrder()
      * Sets rendering order of a particular layer. Lower values are rendered first.
@@ -712,6 +736,13 @@ public:
     static constexpr int VIEW_MAX_LAYERS = 512;      ///< maximum number of layers that may be shown
 
 protected:
+    ///> Block drawn in place of the small items whose center is in a cell of the LOD grid
+    struct LOD_CELL
+    {
+        BOX2I   bbox;       ///< bounding box of the items
+        COLOR4D color;      ///< color of the first item
+    };
+
     struct VIEW_LAYER
     {
         bool                    visible;         ///< is the layer to be rendered?
@@ -721,6 +752,13 @@ protected:
         int                     id;              ///< layer ID
         RENDER_TARGET           target;          ///< where the layer should be rendered
         std::set<int>           requiredLayers;  ///< layers that have to be enabled to show the layer
+        double                  lodMinSize;      ///< items smaller on screen (in pixels) are not drawn
+        bool                    lodAggregate;    ///< are the small items replaced by blocks?
+        int                     lodSizeClass;    ///< size class of the smallest item still drawn
+        int                     lodGroup;        ///< GAL group drawing the aggregated items, or -1
+        bool                    lodDirty;        ///< all the aggregated items have to be redone
+        std::unordered_map<uint64_t, LOD_CELL> lodCells; ///< blocks drawn in lodGroup, by cell
+        std::unordered_set<uint64_t> lodDirtyCells;      ///< cells whose items have been modified
     };
 
     // Convenience typedefs
@@ -737,6 +775,7 @@ protected:
     struct updateItemsColor;
     struct changeItemsDepth;
     struct extentsVisitor;
+    struct aggregateItems;
 
 
     ///* Redraws contents within rect aRect
@@ -795,6 +834,35 @@ protected:
      */
     void invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags );
 
+    /**
+     * Function addUpdateFlags()
+     * Sets update flags of an item, and queues it for UpdateItems() if it had none.
+     */
+    void addUpdateFlags( VIEW_ITEM* aItem, int aUpdateFlags );
+
+    /// Lets the painter prepare the items which are going to be redrawn, in parallel if
+    /// there are enough of them
+    void prepareItems( const std::vector<VIEW_ITEM*>& aItems );
+
+    /**
+     * Function lodSizeClass()
+     * Returns the size class of the smallest items of a layer drawn one by one at the current
+     * zoom, or 0 if all the items are drawn.
+     */
+    int lodSizeClass( const VIEW_LAYER& aLayer ) const;
+
+    /// Returns true if the small items of a layer can be left out, their blocks being up to date
+    bool isLodValid( const VIEW_LAYER& aLayer ) const;
+
+    /// Builds again the blocks replacing the items too small to be drawn, where needed
+    void updateLodGroups();
+
+    /// Marks the aggregated items of all the layers as outdated
+    void invalidateLodGroups();
+
+    /// Marks as outdated the block an item of a layer is aggregated into, if any
+    void invalidateLodCell( VIEW_LAYER& aLayer, const BOX2I& aBBox );
+
     /// Updates colors that are used for an item to be drawn
     void updateItemColor( VIEW_ITEM* aItem, int aLayer );
 
@@ -825,6 +893,9 @@ protected:
     /// Flat list of all items
     std::shared_ptr<std::vector<VIEW_ITEM*>> m_allItems;
 
+    /// Items with update flags waiting for UpdateItems(), shared like m_allItems
+    std::shared_ptr<std::vector<VIEW_ITEM*>> m_updatedItems;
+
     /// Sorted list of pointers to members of m_layers
     LAYER_ORDER m_orderedLayers;
 
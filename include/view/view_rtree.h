@@ -29,6 +29,12 @@
 
 #include <geometry/rtree.h>
 
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
 namespace KIGFX
 {
 typedef RTree<VIEW_ITEM*, int, 2, double> VIEW_RTREE_BASE;
@@ -37,10 +43,40 @@ typedef RTree<VIEW_ITEM*, int, 2, double> VIEW_RTREE_BASE;
  * Class VIEW_RTREE -
  * Implements an R-tree for fast spatial indexing of VIEW items.
  * Non-owning.
+ *
+ * The items are split by size into several trees, each one holding the items whose largest
+ * dimension is within a factor of two, so the queries can skip the items too small to be seen
+ * without visiting them.
  */
-class VIEW_RTREE : public VIEW_RTREE_BASE
+class VIEW_RTREE
 {
 public:
+    ///> Number of the item size classes, the size class N holds the sizes in [2^N, 2^(N+1))
+    static constexpr int SIZE_CLASSES = 32;
+
+    /**
+     * Function SizeClass()
+     * Returns the size class of an item of the given size, that is the rounded down base 2
+     * logarithm of the size.
+     */
+    static int SizeClass( int64_t aSize )
+    {
+        int sizeClass = 0;
+
+        while( aSize > 1 && sizeClass < SIZE_CLASSES - 1 )
+        {
+            aSize >>= 1;
+            sizeClass++;
+        }
+
+        return sizeClass;
+    }
+
+    static int SizeClass( const BOX2I& aBox )
+    {
+        return SizeClass( std::max( std::abs( (int64_t) aBox.GetWidth() ),
+                                    std::abs( (int64_t) aBox.GetHeight() ) ) );
+    }
 
     /**
      * Function Insert()
@@ -51,8 +87,12 @@ public:
         const BOX2I&    bbox    = aItem->ViewBBox();
         const int       mmin[2] = { bbox.GetX(), bbox.GetY() };
         const int       mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+        int             sizeClass = SizeClass( bbox );
+
+        if( !m_trees[sizeClass] )
+            m_trees[sizeClass].reset( new VIEW_RTREE_BASE );
 
-        VIEW_RTREE_BASE::Insert( mmin, mmax, aItem );
+        m_trees[sizeClass]->Insert( mmin, mmax, aItem );
     }
 
     /**
@@ -62,30 +102,60 @@ public:
      */
     void Remove( VIEW_ITEM* aItem )
     {
-        // const BOX2I&    bbox    = aItem->ViewBBox();
-
         // FIXME: use cached bbox or ptr_map to speed up pointer <-> node lookups.
         const int       mmin[2] = { INT_MIN, INT_MIN };
         const int       mmax[2] = { INT_MAX, INT_MAX };
 
-        VIEW_RTREE_BASE::Remove( mmin, mmax, aItem );
+        // The item may have been resized since it was inserted, so its current size class
+        // is only the first guess
+        int guess = SizeClass( aItem->ViewBBox() );
+
+        if( m_trees[guess] && !m_trees[guess]->Remove( mmin, mmax, aItem ) )
+            return;
+
+        for( int ii = 0; ii < SIZE_CLASSES; ++ii )
+        {
+            if( ii != guess && m_trees[ii] && !m_trees[ii]->Remove( mmin, mmax, aItem ) )
+                return;
+        }
+    }
+
+    /**
+     * Function RemoveAll()
+     * Removes all the items from the tree.
+     */
+    void RemoveAll()
+    {
+        for( auto& tree : m_trees )
+            tree.reset();
     }
 
     /**
      * Function Query()
      * Executes a function object aVisitor for each item whose bounding box intersects
      * with aBounds.
+     * @param aMinSizeClass and aMaxSizeClass: the range of size classes of the visited items,
+     * the items of the other size classes are not visited at all.
      */
     template <class Visitor>
-    void Query( const BOX2I& aBounds, Visitor& aVisitor )    // const
+    void Query( const BOX2I& aBounds, Visitor& aVisitor, int aMinSizeClass = 0,
+                int aMaxSizeClass = SIZE_CLASSES - 1 )    // const
     {
         const int   mmin[2] = { aBounds.GetX(), aBounds.GetY() };
         const int   mmax[2] = { aBounds.GetRight(), aBounds.GetBottom() };
 
-        VIEW_RTREE_BASE::Search( mmin, mmax, aVisitor );
+        aMinSizeClass = std::max( aMinSizeClass, 0 );
+        aMaxSizeClass = std::min( aMaxSizeClass, SIZE_CLASSES - 1 );
+
+        for( int ii = aMinSizeClass; ii <= aMaxSizeClass; ++ii )
+        {
+            if( m_trees[ii] )
+                m_trees[ii]->Search( mmin, mmax, aVisitor );
+        }
     }
 
 private:
+    std::unique_ptr<VIEW_RTREE_BASE> m_trees[SIZE_CLASSES];
 };
 } // namespace KIGFX
 
@@ -66,6 +66,8 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
     auto              connectivity = board->GetConnectivity();
     std::set<EDA_ITEM*>      savedModules;
     std::vector<BOARD_ITEM*> itemsToDeselect;
+    std::vector<BOARD_ITEM*> changedItems;      // added or modified, for the board listeners
+    std::vector<BOARD_ITEM*> removedItems;
 
     if( Empty() )
         return;
@@ -135,6 +137,7 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
                 }
 
                 view->Add( boardItem );
+                changedItems.push_back( boardItem );
                 break;
             }
 
@@ -143,6 +146,8 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
                 if( !m_editModules && aCreateUndoEntry )
                     undoList.PushItem( ITEM_PICKER( boardItem, UR_DELETED ) );
 
+                removedItems.push_back( boardItem );
+
                 switch( boardItem->Type() )
                 {
                 // Module items
@@ -236,6 +241,7 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
 
                 connectivity->Update( boardItem );
                 view->Update( boardItem );
+                changedItems.push_back( boardItem );
 
                 // if no undo entry is needed, the copy would create a memory leak
                 if( !aCreateUndoEntry )
@@ -276,6 +282,10 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
     frame->UpdateMsgPanel();
 
     clear();
+
+    // Listeners are notified last, as they may push commits of their own
+    if( !m_editModules )
+        board->OnItemsChanged( changedItems, removedItems );
 }
 
 
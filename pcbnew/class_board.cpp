@@ -149,6 +149,12 @@ BOARD::BOARD() :
 
 BOARD::~BOARD()
 {
+    // The listeners may unregister themselves
+    std::vector<BOARD_LISTENER*> listeners = m_listeners;
+
+    for( BOARD_LISTENER* listener : listeners )
+        listener->OnBoardDeleted( *this );
+
     while( m_ZoneDescriptorList.size() )
     {
         ZONE_CONTAINER* area_to_remove = m_ZoneDescriptorList[0];
@@ -2984,6 +2990,40 @@ const std::vector<D_PAD*> BOARD::GetPads()
 }
 
 
+void BOARD::AddListener( BOARD_LISTENER* aListener )
+{
+    if( std::find( m_listeners.begin(), m_listeners.end(), aListener ) == m_listeners.end() )
+        m_listeners.push_back( aListener );
+}
+
+
+void BOARD::RemoveListener( BOARD_LISTENER* aListener )
+{
+    auto it = std::find( m_listeners.begin(), m_listeners.end(), aListener );
+
+    if( it != m_listeners.end() )
+        m_listeners.erase( it );
+}
+
+
+bool BOARD::HasListener( BOARD_LISTENER* aListener ) const
+{
+    return std::find( m_listeners.begin(), m_listeners.end(), aListener ) != m_listeners.end();
+}
+
+
+void BOARD::OnItemsChanged( const std::vector<BOARD_ITEM*>& aChangedItems,
+                            const std::vector<BOARD_ITEM*>& aRemovedItems )
+{
+    // Listeners may commit changes of their own (e.g. DRC markers), which would
+    // modify the list while we iterate over it
+    std::vector<BOARD_LISTENER*> listeners = m_listeners;
+
+    for( BOARD_LISTENER* listener : listeners )
+        listener->OnBoardItemsChanged( *this, aChangedItems, aRemovedItems );
+}
+
+
 unsigned BOARD::GetPadCount()
 {
     unsigned retval = 0;
@@ -164,6 +164,37 @@ DECL_VEC_FOR_SWIG(ZONE_CONTAINERS, ZONE_CONTAINER*)
 DECL_VEC_FOR_SWIG(TRACKS, TRACK*)
 
 
+/**
+ * Class BOARD_LISTENER
+ * is the interface of the objects which want to be told about the changes
+ * committed to a BOARD (see BOARD_COMMIT::Push()).
+ */
+class BOARD_LISTENER
+{
+public:
+    virtual ~BOARD_LISTENER() { }
+
+    /**
+     * Function OnBoardItemsChanged
+     * is called once all the changes of a commit have been applied to the board.
+     * @param aBoard is the modified board.
+     * @param aChangedItems are the items added or modified by the commit.
+     * @param aRemovedItems are the items removed by the commit.  They are not owned by
+     *          the board anymore and may be deleted at any time after this call.
+     */
+    virtual void OnBoardItemsChanged( BOARD& aBoard,
+                                      const std::vector<BOARD_ITEM*>& aChangedItems,
+                                      const std::vector<BOARD_ITEM*>& aRemovedItems ) = 0;
+
+    /**
+     * Function OnBoardDeleted
+     * is called when the board is about to be deleted, so the listener does not try to
+     * unregister from it afterwards.
+     */
+    virtual void OnBoardDeleted( BOARD& aBoard ) { }
+};
+
+
 /**
  * Class BOARD
  * holds information pertinent to a Pcbnew printed circuit board.
@@ -200,6 +231,8 @@ private:
     PCB_PLOT_PARAMS         m_plotOptions;
     NETINFO_LIST            m_NetInfo;              ///< net info list (name, design constraints ..
 
+    std::vector<BOARD_LISTENER*> m_listeners;       ///< not owned
+
     /**
      * Function chainMarkedSegments
      * is used by MarkTrace() to set the BUSY flag of connected segments of the trace
@@ -240,6 +273,33 @@ public:
     /// Flags used in ratsnest calculation and update.
     int m_Status_Pcb;
 
+    /**
+     * Function AddListener
+     * registers a listener, which will be notified of the changes committed to this board
+     * until it is removed.  The listener is not owned by the board.
+     */
+    void AddListener( BOARD_LISTENER* aListener );
+
+    /**
+     * Function RemoveListener
+     * unregisters a listener previously added by AddListener().
+     */
+    void RemoveListener( BOARD_LISTENER* aListener );
+
+    /**
+     * Function HasListener
+     * @return true if aListener is notified of the changes committed to this board.
+     */
+    bool HasListener( BOARD_LISTENER* aListener ) const;
+
+    /**
+     * Function OnItemsChanged
+     * notifies all the listeners that a set of changes has been committed to the board.
+     * @see BOARD_LISTENER::OnBoardItemsChanged()
+     */
+    void OnItemsChanged( const std::vector<BOARD_ITEM*>& aChangedItems,
+                         const std::vector<BOARD_ITEM*>& aRemovedItems );
+
 
 private:
     DLIST<BOARD_ITEM>           m_Drawings;             // linked list of lines & texts
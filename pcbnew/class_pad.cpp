@@ -374,6 +374,18 @@ const EDA_RECT D_PAD::GetBoundingBox() const
 }
 
 
+const EDA_RECT D_PAD::GetBoundingBoxWithHole() const
+{
+    EDA_RECT bbox = GetBoundingBox();
+    EDA_RECT holeBox( GetPosition(), wxSize( 0, 0 ) );
+
+    holeBox.Inflate( std::max( m_Drill.x, m_Drill.y ) / 2 );
+    bbox.Merge( holeBox );
+
+    return bbox;
+}
+
+
 void D_PAD::SetDrawCoord()
 {
     MODULE* module = (MODULE*) m_Parent;
@@ -684,6 +684,14 @@ public:
     // Virtual function:
     const EDA_RECT GetBoundingBox() const override;
 
+    /**
+     * Function GetBoundingBoxWithHole
+     * @return the bounding box of the pad merged with the one of its hole.  The hole goes
+     * through every layer, so this is the area to search for the items which can collide
+     * with the pad, even on the layers it has no copper on.
+     */
+    const EDA_RECT GetBoundingBoxWithHole() const;
+
     ///> Set absolute coordinates.
     void SetDrawCoord();
 
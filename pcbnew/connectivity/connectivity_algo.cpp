@@ -25,11 +25,11 @@
 #include <connectivity/connectivity_algo.h>
 #include <widgets/progress_reporter.h>
 #include <geometry/geometry_utils.h>
+#include <thread_pool.h>
 
 #include <thread>
 #include <mutex>
 #include <algorithm>
-#include <future>
 
 #ifdef PROFILE
 #include <profile.h>
@@ -45,7 +45,7 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
     case PCB_MODULE_T:
         for( auto pad : static_cast<MODULE*>( aItem ) -> Pads() )
         {
-            m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( pad ) ].MarkItemsAsInvalid();
+            invalidateEntry( m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( pad ) ] );
             m_itemMap.erase( static_cast<BOARD_CONNECTED_ITEM*>( pad ) );
         }
 
@@ -53,26 +53,26 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
         break;
 
     case PCB_PAD_T:
-        m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ].MarkItemsAsInvalid();
+        invalidateEntry( m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ] );
         m_itemMap.erase( static_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
         m_itemList.SetDirty( true );
         break;
 
     case PCB_TRACE_T:
-        m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ].MarkItemsAsInvalid();
+        invalidateEntry( m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ] );
         m_itemMap.erase( static_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
         m_itemList.SetDirty( true );
         break;
 
     case PCB_VIA_T:
-        m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ].MarkItemsAsInvalid();
+        invalidateEntry( m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ] );
         m_itemMap.erase( static_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
         m_itemList.SetDirty( true );
         break;
 
     case PCB_ZONE_AREA_T:
     {
-        m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ].MarkItemsAsInvalid();
+        invalidateEntry( m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ] );
         m_itemMap.erase ( static_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
         m_itemList.SetDirty( true );
         break;
@@ -90,6 +90,27 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
 }
 
 
+void CN_CONNECTIVITY_ALGO::invalidateEntry( ITEM_MAP_ENTRY& aEntry )
+{
+    // The clusters need the connections of the items, so they are told before
+    // the items are invalidated
+    for( auto item : aEntry.m_items )
+    {
+        m_propagateClusters.ItemRemoved( item );
+        m_ratsnestClusters.ItemRemoved( item );
+    }
+
+    aEntry.MarkItemsAsInvalid();
+}
+
+
+void CN_CONNECTIVITY_ALGO::itemAdded( CN_ITEM* aItem )
+{
+    m_propagateClusters.ItemAdded( aItem );
+    m_ratsnestClusters.ItemAdded( aItem );
+}
+
+
 void CN_CONNECTIVITY_ALGO::markItemNetAsDirty( const BOARD_ITEM* aItem )
 {
     if( aItem->IsConnected() )
@@ -171,7 +192,10 @@ bool CN_CONNECTIVITY_ALGO::Add( BOARD_ITEM* aItem )
         m_itemMap[zone] = ITEM_MAP_ENTRY();
 
         for( auto zitem : m_itemList.Add( zone ) )
+        {
             m_itemMap[zone].Link(zitem);
+            itemAdded( zitem );
+        }
 
         break;
     }
@@ -220,14 +244,14 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
 
     if( m_itemList.IsDirty() )
     {
-        size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+        TASK_GROUP tasks;
+        size_t parallelThreadCount = std::min<size_t>( tasks.GetThreadCount(),
                 ( dirtyItems.size() + 7 ) / 8 );
 
         std::atomic<size_t> nextItem( 0 );
-        std::vector<std::future<size_t>> returns( parallelThreadCount );
 
         auto conn_lambda = [&nextItem, &dirtyItems]
-                            ( CN_LIST* aItemList, PROGRESS_REPORTER* aReporter) -> size_t
+                            ( CN_LIST* aItemList, PROGRESS_REPORTER* aReporter )
         {
             for( size_t i = nextItem++; i < dirtyItems.size(); i = nextItem++ )
             {
@@ -237,8 +261,6 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
                 if( aReporter )
                     aReporter->AdvanceProgress();
             }
-
-            return 1;
         };
 
         if( parallelThreadCount <= 1 )
@@ -246,21 +268,14 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
         else
         {
             for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-                returns[ii] = std::async( std::launch::async, conn_lambda,
-                        &m_itemList, m_progressReporter );
-
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            {
-                // Here we balance returns with a 100ms timeout to allow UI updating
-                std::future_status status;
-                do
-                {
-                    if( m_progressReporter )
-                        m_progressReporter->KeepRefreshing();
+                tasks.Run( std::bind( conn_lambda, &m_itemList, m_progressReporter ) );
 
-                    status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-                } while( status != std::future_status::ready );
-            }
+            // Wake up every 100ms to allow UI updating
+            tasks.Wait( [this]()
+                    {
+                        if( m_progressReporter )
+                            m_progressReporter->KeepRefreshing();
+                    } );
         }
 
         if( m_progressReporter )
@@ -449,9 +464,9 @@ void CN_CONNECTIVITY_ALGO::Build( const std::vector<BOARD_ITEM*>& aItems )
 }
 
 
-void CN_CONNECTIVITY_ALGO::propagateConnections()
+void CN_CONNECTIVITY_ALGO::propagateConnections( const CLUSTERS& aClusters )
 {
-    for( const auto& cluster : m_connClusters )
+    for( const auto& cluster : aClusters )
     {
         if( cluster->IsConflicting() )
         {
@@ -477,6 +492,7 @@ void CN_CONNECTIVITY_ALGO::propagateConnections()
                         MarkNetAsDirty( cluster->OriginNet() );
 
                         item->Parent()->SetNetCode( cluster->OriginNet() );
+                        m_ratsnestClusters.ItemNetChanged( item );
                         n_changed++;
                     }
                 }
@@ -498,8 +514,14 @@ void CN_CONNECTIVITY_ALGO::propagateConnections()
 
 void CN_CONNECTIVITY_ALGO::PropagateNets()
 {
-    m_connClusters = SearchClusters( CSM_PROPAGATE );
-    propagateConnections();
+    CLUSTERS changed;
+
+    if( m_itemList.IsDirty() )
+        searchConnections();
+
+    // Only the clusters touched by the changes can have something to propagate
+    m_propagateClusters.Update( m_itemList, &changed );
+    propagateConnections( changed );
 }
 
 
@@ -569,8 +591,18 @@ void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLAT
 
 const CN_CONNECTIVITY_ALGO::CLUSTERS& CN_CONNECTIVITY_ALGO::GetClusters()
 {
-    m_ratsnestClusters = SearchClusters( CSM_RATSNEST );
-    return m_ratsnestClusters;
+    if( m_itemList.IsDirty() )
+        searchConnections();
+
+    m_ratsnestClusters.Update( m_itemList );
+
+#ifdef CONNECTIVITY_DEBUG
+    printf( "Incremental clusters: %d, full search: %d\n",
+            (int) m_ratsnestClusters.Clusters().size(),
+            (int) SearchClusters( CSM_RATSNEST ).size() );
+#endif
+
+    return m_ratsnestClusters.Clusters();
 }
 
 
@@ -713,7 +745,8 @@ bool CN_VISITOR::operator()( CN_ITEM* aCandidate )
 
 void CN_CONNECTIVITY_ALGO::Clear()
 {
-    m_ratsnestClusters.clear();
+    m_ratsnestClusters.Invalidate();
+    m_propagateClusters.Invalidate();
     m_connClusters.clear();
     m_itemMap.clear();
     m_itemList.Clear();
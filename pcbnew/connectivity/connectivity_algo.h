@@ -46,6 +46,7 @@
 #include <connectivity/connectivity_rtree.h>
 #include <connectivity/connectivity_data.h>
 #include <connectivity/connectivity_items.h>
+#include <connectivity/connectivity_clusters.h>
 
 class CN_CONNECTIVITY_ALGO_IMPL;
 class CN_RATSNEST_NODES;
@@ -148,14 +149,18 @@ private:
     std::unordered_map<const BOARD_CONNECTED_ITEM*, ITEM_MAP_ENTRY> m_itemMap;
 
     CLUSTERS m_connClusters;
-    CLUSTERS m_ratsnestClusters;
     std::vector<bool> m_dirtyNets;
     PROGRESS_REPORTER* m_progressReporter = nullptr;
 
+    ///> Clusters kept up to date across the changes, for the net propagation (zones
+    ///> excluded, nets ignored) and for the ratsnest (items of the same net)
+    CN_CLUSTER_CACHE m_propagateClusters;
+    CN_CLUSTER_CACHE m_ratsnestClusters;
+
     void    searchConnections();
 
     void    update();
-    void    propagateConnections();
+    void    propagateConnections( const CLUSTERS& aClusters );
 
     template <class Container, class BItem>
     void add( Container& c, BItem brditem )
@@ -163,13 +168,20 @@ private:
         auto item = c.Add( brditem );
 
         m_itemMap[ brditem ] = ITEM_MAP_ENTRY( item );
+        itemAdded( item );
     }
 
+    void itemAdded( CN_ITEM* aItem );
+    void invalidateEntry( ITEM_MAP_ENTRY& aEntry );
+
     void markItemNetAsDirty( const BOARD_ITEM* aItem );
 
 public:
 
-    CN_CONNECTIVITY_ALGO() {}
+    CN_CONNECTIVITY_ALGO() :
+        m_propagateClusters( false, false ),
+        m_ratsnestClusters( true, true )
+    {}
     ~CN_CONNECTIVITY_ALGO() { Clear(); }
 
     bool ItemExists( const BOARD_CONNECTED_ITEM* aItem )
@@ -198,7 +210,7 @@ public:
 
     void GetDirtyClusters( CLUSTERS& aClusters )
     {
-        for( auto cl : m_ratsnestClusters )
+        for( auto cl : m_ratsnestClusters.Clusters() )
         {
             int net = cl->OriginNet();
 
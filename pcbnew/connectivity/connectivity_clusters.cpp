@@ -0,0 +1,413 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <connectivity/connectivity_clusters.h>
+
+#include <algorithm>
+#include <deque>
+
+
+CN_CLUSTER_CACHE::CN_CLUSTER_CACHE( bool aSameNet, bool aWithZones ) :
+    m_sameNet( aSameNet ),
+    m_withZones( aWithZones ),
+    m_valid( false )
+{
+}
+
+
+void CN_CLUSTER_CACHE::Invalidate()
+{
+    m_valid = false;
+    m_clusters.clear();
+    m_itemClusters.clear();
+    m_seeds.clear();
+    m_pendingSplits.clear();
+}
+
+
+void CN_CLUSTER_CACHE::ItemAdded( CN_ITEM* aItem )
+{
+    // An invalid cache picks all the items at the next update
+    if( m_valid )
+        m_seeds.insert( aItem );
+}
+
+
+void CN_CLUSTER_CACHE::ItemRemoved( CN_ITEM* aItem )
+{
+    m_seeds.erase( aItem );
+
+    auto it = m_itemClusters.find( aItem );
+
+    if( it == m_itemClusters.end() )
+        return;
+
+    CN_CLUSTER*    cluster = it->second;
+    PENDING_SPLIT& pending = m_pendingSplits[ cluster ];
+
+    m_itemClusters.erase( it );
+    pending.m_removed.insert( aItem );
+
+    // The neighbours removed before are not in the map any more
+    for( auto neighbour : aItem->ConnectedItems() )
+    {
+        auto nit = m_itemClusters.find( neighbour );
+
+        if( nit != m_itemClusters.end() && nit->second == cluster )
+            pending.m_neighbours.push_back( neighbour );
+    }
+}
+
+
+void CN_CLUSTER_CACHE::ItemNetChanged( CN_ITEM* aItem )
+{
+    ItemRemoved( aItem );
+    ItemAdded( aItem );
+}
+
+
+bool CN_CLUSTER_CACHE::accepts( CN_ITEM* aItem ) const
+{
+    if( !aItem->Valid() )
+        return false;
+
+    if( m_sameNet && aItem->Net() <= 0 )
+        return false;
+
+    if( !m_withZones && aItem->Parent()->Type() == PCB_ZONE_AREA_T )
+        return false;
+
+    return true;
+}
+
+
+bool CN_CLUSTER_CACHE::linked( CN_ITEM* aItem, CN_ITEM* aOther ) const
+{
+    if( !accepts( aOther ) )
+        return false;
+
+    return !m_sameNet || aItem->Net() == aOther->Net();
+}
+
+
+void CN_CLUSTER_CACHE::Update( CN_LIST& aItems, CLUSTERS* aChanged )
+{
+    std::unordered_set<CN_CLUSTER*> changed;
+    std::unordered_set<CN_CLUSTER*> dead;
+    CLUSTERS                        created;
+    std::vector<CN_ITEM*>           seeds;
+
+    if( !m_valid )
+    {
+        Invalidate();
+        m_valid = true;
+
+        for( auto item : aItems )
+        {
+            if( accepts( item ) )
+                seeds.push_back( item );
+        }
+    }
+    else
+    {
+        // Take the removed items out of their clusters first, then look for the pieces
+        // the clusters may have been cut into
+        for( auto& entry : m_pendingSplits )
+        {
+            CN_CLUSTER*                            cluster = entry.first;
+            const std::unordered_set<const CN_ITEM*>& removed = entry.second.m_removed;
+
+            cluster->Remove( [&removed]( CN_ITEM* aItem )
+                    {
+                        return removed.count( aItem ) > 0;
+                    } );
+
+            if( cluster->Size() == 0 )
+            {
+                dead.insert( cluster );
+            }
+            else
+            {
+                changed.insert( cluster );
+                split( cluster, entry.second.m_neighbours, created );
+            }
+        }
+
+        m_pendingSplits.clear();
+
+        for( auto item : m_seeds )
+        {
+            if( accepts( item ) && !m_itemClusters.count( item ) )
+                seeds.push_back( item );
+        }
+    }
+
+    m_seeds.clear();
+
+    merge( seeds, created, changed, dead );
+
+    if( changed.empty() && dead.empty() && created.empty() )
+        return;
+
+    if( !dead.empty() )
+    {
+        auto isDead = [&dead]( const CN_CLUSTER_PTR& aCluster )
+        {
+            return dead.count( aCluster.get() ) > 0;
+        };
+
+        m_clusters.erase( std::remove_if( m_clusters.begin(), m_clusters.end(), isDead ),
+                          m_clusters.end() );
+        created.erase( std::remove_if( created.begin(), created.end(), isDead ),
+                       created.end() );
+    }
+
+    if( aChanged )
+    {
+        for( const auto& cluster : m_clusters )
+        {
+            if( changed.count( cluster.get() ) )
+                aChanged->push_back( cluster );
+        }
+
+        aChanged->insert( aChanged->end(), created.begin(), created.end() );
+    }
+
+    m_clusters.insert( m_clusters.end(), created.begin(), created.end() );
+
+    std::sort( m_clusters.begin(), m_clusters.end(), []( CN_CLUSTER_PTR a, CN_CLUSTER_PTR b ) {
+        return a->OriginNet() < b->OriginNet();
+    } );
+}
+
+
+void CN_CLUSTER_CACHE::split( CN_CLUSTER* aCluster, const std::vector<CN_ITEM*>& aNeighbours,
+                              CLUSTERS& aCreated )
+{
+    std::vector<CN_ITEM*>        starts;
+    std::unordered_set<CN_ITEM*> unique;
+
+    for( auto item : aNeighbours )
+    {
+        auto it = m_itemClusters.find( item );
+
+        if( it != m_itemClusters.end() && it->second == aCluster && unique.insert( item ).second )
+            starts.push_back( item );
+    }
+
+    // Every piece of the cluster touches one of the removed items, so a single
+    // neighbour means a single piece
+    if( starts.size() < 2 )
+        return;
+
+    // One breadth first search per neighbour, advanced in turn.  The searches which meet
+    // are joined; a group of searches running out of items before meeting the others has
+    // found a whole piece, which becomes a new cluster.
+    size_t                                  count = starts.size();
+    std::vector<std::deque<CN_ITEM*>>       queues( count );
+    std::vector<std::vector<CN_ITEM*>>      visited( count );
+    std::vector<size_t>                     group( count );
+    std::vector<bool>                       finished( count, false );
+    std::unordered_map<CN_ITEM*, size_t>    owner;
+    size_t                                  liveGroups = count;
+
+    auto root = [&group]( size_t aSearch )
+    {
+        while( group[aSearch] != aSearch )
+        {
+            group[aSearch] = group[ group[aSearch] ];
+            aSearch = group[aSearch];
+        }
+
+        return aSearch;
+    };
+
+    for( size_t ii = 0; ii < count; ++ii )
+    {
+        group[ii] = ii;
+        owner[ starts[ii] ] = ii;
+        queues[ii].push_back( starts[ii] );
+        visited[ii].push_back( starts[ii] );
+    }
+
+    while( liveGroups > 1 )
+    {
+        for( size_t ii = 0; ii < count; ++ii )
+        {
+            if( queues[ii].empty() )
+                continue;
+
+            CN_ITEM* current = queues[ii].front();
+            queues[ii].pop_front();
+
+            for( auto next : current->ConnectedItems() )
+            {
+                auto it = m_itemClusters.find( next );
+
+                if( it == m_itemClusters.end() || it->second != aCluster )
+                    continue;
+
+                if( !linked( current, next ) )
+                    continue;
+
+                auto found = owner.find( next );
+
+                if( found == owner.end() )
+                {
+                    owner[ next ] = ii;
+                    queues[ii].push_back( next );
+                    visited[ii].push_back( next );
+                }
+                else
+                {
+                    size_t a = root( found->second );
+                    size_t b = root( ii );
+
+                    if( a != b )
+                    {
+                        group[a] = b;
+                        liveGroups--;
+                    }
+                }
+            }
+        }
+
+        // Find the groups whose searches are all over
+        std::vector<bool> running( count, false );
+
+        for( size_t ii = 0; ii < count; ++ii )
+        {
+            if( !queues[ii].empty() )
+                running[ root( ii ) ] = true;
+        }
+
+        for( size_t ii = 0; ii < count && liveGroups > 1; ++ii )
+        {
+            if( root( ii ) != ii || running[ii] || finished[ii] )
+                continue;
+
+            CN_CLUSTER_PTR piece( new CN_CLUSTER() );
+            std::unordered_set<CN_ITEM*> pieceItems;
+
+            for( size_t jj = 0; jj < count; ++jj )
+            {
+                if( root( jj ) != ii )
+                    continue;
+
+                for( auto item : visited[jj] )
+                {
+                    piece->Add( item );
+                    pieceItems.insert( item );
+                    m_itemClusters[ item ] = piece.get();
+                }
+            }
+
+            aCluster->Remove( [&pieceItems]( CN_ITEM* aItem )
+                    {
+                        return pieceItems.count( aItem ) > 0;
+                    } );
+
+            aCreated.push_back( piece );
+            finished[ii] = true;
+            liveGroups--;
+        }
+    }
+}
+
+
+void CN_CLUSTER_CACHE::merge( const std::vector<CN_ITEM*>& aSeeds, CLUSTERS& aCreated,
+                              std::unordered_set<CN_CLUSTER*>& aChanged,
+                              std::unordered_set<CN_CLUSTER*>& aDead )
+{
+    std::unordered_set<CN_ITEM*> pending( aSeeds.begin(), aSeeds.end() );
+
+    for( auto seed : aSeeds )
+    {
+        if( !pending.erase( seed ) )
+            continue;
+
+        // Gather the new items connected together, and the clusters they touch
+        std::vector<CN_ITEM*>    component( 1, seed );
+        std::vector<CN_CLUSTER*> touched;
+
+        for( size_t ii = 0; ii < component.size(); ++ii )
+        {
+            CN_ITEM* current = component[ii];
+
+            for( auto next : current->ConnectedItems() )
+            {
+                if( !linked( current, next ) )
+                    continue;
+
+                if( pending.erase( next ) )
+                {
+                    component.push_back( next );
+                    continue;
+                }
+
+                auto it = m_itemClusters.find( next );
+
+                if( it != m_itemClusters.end()
+                        && std::find( touched.begin(), touched.end(), it->second ) == touched.end() )
+                    touched.push_back( it->second );
+            }
+        }
+
+        CN_CLUSTER* target = nullptr;
+
+        if( touched.empty() )
+        {
+            aCreated.emplace_back( new CN_CLUSTER() );
+            target = aCreated.back().get();
+        }
+        else
+        {
+            // Union by size: only the items of the smaller clusters are moved
+            target = *std::max_element( touched.begin(), touched.end(),
+                    []( CN_CLUSTER* a, CN_CLUSTER* b ) { return a->Size() < b->Size(); } );
+
+            for( auto cluster : touched )
+            {
+                if( cluster == target )
+                    continue;
+
+                for( auto item : *cluster )
+                {
+                    target->Add( item );
+                    m_itemClusters[ item ] = target;
+                }
+
+                aChanged.erase( cluster );
+                aDead.insert( cluster );
+            }
+
+            aChanged.insert( target );
+        }
+
+        for( auto item : component )
+        {
+            target->Add( item );
+            m_itemClusters[ item ] = target;
+        }
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef PCBNEW_CONNECTIVITY_CLUSTERS_H_
+#define PCBNEW_CONNECTIVITY_CLUSTERS_H_
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <connectivity/connectivity_items.h>
+
+/**
+ * Class CN_CLUSTER_CACHE
+ * keeps the clusters of connected items up to date across the changes of the item list,
+ * instead of searching them again over the whole board after each change.
+ *
+ * The items added since the last update are merged with the clusters they touch, union-find
+ * style: the smaller clusters are moved into the largest one.  Removing an item only
+ * affects its own cluster, which is checked for a split with simultaneous searches started
+ * from the neighbours of the removed items: they stop as soon as they meet, so a big
+ * cluster is only walked when it really falls apart, and then only its smaller pieces.
+ *
+ * The removed items must be reported while they are still valid and connected, and the
+ * connections of the added items must have been searched before calling Update().
+ */
+class CN_CLUSTER_CACHE
+{
+public:
+    using CLUSTERS = std::vector<CN_CLUSTER_PTR>;
+
+    /**
+     * @param aSameNet: if true, only the items of the same net are clustered together
+     * and the items without net are ignored
+     * @param aWithZones: if false, the zones are left out of the clusters
+     */
+    CN_CLUSTER_CACHE( bool aSameNet, bool aWithZones );
+
+    /**
+     * Function Invalidate
+     * forgets all the clusters: the next Update() builds them again from scratch.
+     */
+    void Invalidate();
+
+    bool IsValid() const { return m_valid; }
+
+    void ItemAdded( CN_ITEM* aItem );
+    void ItemRemoved( CN_ITEM* aItem );
+
+    /**
+     * Function ItemNetChanged
+     * moves an item whose net code was changed out of its cluster.
+     */
+    void ItemNetChanged( CN_ITEM* aItem );
+
+    /**
+     * Function Update
+     * applies the changes reported since the last call to the clusters, or builds them from
+     * aItems when the cache is not valid.
+     * @param aChanged, if not null, receives the clusters created or modified by the update
+     */
+    void Update( CN_LIST& aItems, CLUSTERS* aChanged = nullptr );
+
+    const CLUSTERS& Clusters() const { return m_clusters; }
+
+private:
+    struct PENDING_SPLIT
+    {
+        ///> items removed from the cluster, which may already be deleted
+        std::unordered_set<const CN_ITEM*>  m_removed;
+
+        ///> items of the cluster connected to the removed ones
+        std::vector<CN_ITEM*>               m_neighbours;
+    };
+
+    bool accepts( CN_ITEM* aItem ) const;
+    bool linked( CN_ITEM* aItem, CN_ITEM* aOther ) const;
+
+    void split( CN_CLUSTER* aCluster, const std::vector<CN_ITEM*>& aNeighbours,
+                CLUSTERS& aCreated );
+
+    void merge( const std::vector<CN_ITEM*>& aSeeds, CLUSTERS& aCreated,
+                std::unordered_set<CN_CLUSTER*>& aChanged, std::unordered_set<CN_CLUSTER*>& aDead );
+
+    bool m_sameNet;
+    bool m_withZones;
+    bool m_valid;
+
+    CLUSTERS m_clusters;
+
+    std::unordered_map<const CN_ITEM*, CN_CLUSTER*>  m_itemClusters;
+    std::unordered_set<CN_ITEM*>                     m_seeds;
+    std::unordered_map<CN_CLUSTER*, PENDING_SPLIT>   m_pendingSplits;
+};
+
+#endif /* PCBNEW_CONNECTIVITY_CLUSTERS_H_ */
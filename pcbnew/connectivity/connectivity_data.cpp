@@ -29,11 +29,12 @@
 
 #include <thread>
 #include <algorithm>
-#include <future>
+#include <atomic>
 
 #include <connectivity/connectivity_data.h>
 #include <connectivity/connectivity_algo.h>
 #include <ratsnest_data.h>
+#include <thread_pool.h>
 
 CONNECTIVITY_DATA::CONNECTIVITY_DATA()
 {
@@ -106,31 +107,28 @@ void CONNECTIVITY_DATA::updateRatsnest()
     std::copy_if( m_nets.begin() + 1, m_nets.end(), std::back_inserter( dirty_nets ),
             [] ( RN_NET* aNet ) { return aNet->IsDirty() && aNet->GetNodeCount() > 0; } );
 
-    // We don't want to spin up a new thread for fewer than 8 nets (overhead costs)
-    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+    // We don't want to dispatch a task for fewer than 8 nets (overhead costs)
+    TASK_GROUP tasks;
+    size_t parallelThreadCount = std::min<size_t>( tasks.GetThreadCount(),
             ( dirty_nets.size() + 7 ) / 8 );
 
     std::atomic<size_t> nextNet( 0 );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
 
-    auto update_lambda = [&nextNet, &dirty_nets]() -> size_t
+    auto update_lambda = [&nextNet, &dirty_nets]()
     {
         for( size_t i = nextNet++; i < dirty_nets.size(); i = nextNet++ )
             dirty_nets[i]->Update();
-
-        return 1;
     };
 
-    if( parallelThreadCount == 1 )
+    if( parallelThreadCount <= 1 )
         update_lambda();
     else
     {
         for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, update_lambda );
+            tasks.Run( update_lambda );
 
-        // Finalize the ratsnest threads
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii].wait();
+        // Finalize the ratsnest tasks
+        tasks.Wait();
     }
 
     #ifdef PROFILE
@@ -242,38 +240,108 @@ void CONNECTIVITY_DATA::FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLATED_
 }
 
 
-void CONNECTIVITY_DATA::ComputeDynamicRatsnest( const std::vector<BOARD_ITEM*>& aItems )
+/**
+ * Struct DYNAMIC_RATSNEST_JOB
+ * holds everything the calculation of a dynamic ratsnest needs, so it does not touch the
+ * board while it is running.
+ */
+struct CONNECTIVITY_DATA::DYNAMIC_RATSNEST_JOB
 {
-    m_dynamicRatsnest.clear();
+    ///> Copies of the moved items
+    std::vector<std::unique_ptr<BOARD_ITEM>> m_items;
+
+    ///> Positions of the board nodes which can end a ratsnest line, indexed by net code
+    std::vector<std::vector<VECTOR2I>>       m_targets;
 
+    std::vector<RN_DYNAMIC_LINE>             m_lines;
+
+    std::atomic<bool>                        m_cancelled { false };
+    std::atomic<bool>                        m_done { false };
+};
+
+
+std::shared_ptr<CONNECTIVITY_DATA::DYNAMIC_RATSNEST_JOB> CONNECTIVITY_DATA::prepareDynamicRatsnest(
+        const std::vector<BOARD_ITEM*>& aItems )
+{
     if( std::none_of( aItems.begin(), aItems.end(), []( const BOARD_ITEM* aItem )
             { return( aItem->Type() == PCB_TRACE_T || aItem->Type() == PCB_PAD_T ||
                       aItem->Type() == PCB_ZONE_AREA_T || aItem->Type() == PCB_MODULE_T ||
                       aItem->Type() == PCB_VIA_T ); } ) )
     {
-        return ;
+        return nullptr;
+    }
+
+    auto job = std::make_shared<DYNAMIC_RATSNEST_JOB>();
+    std::vector<BOARD_CONNECTED_ITEM*> citems;
+
+    for( auto item : aItems )
+    {
+        if( item->Type() == PCB_MODULE_T )
+        {
+            for( auto pad : static_cast<MODULE*>( item )->Pads() )
+                citems.push_back( pad );
+        }
+        else if( item->IsConnected() )
+        {
+            citems.push_back( static_cast<BOARD_CONNECTED_ITEM*>( item ) );
+        }
+    }
+
+    // The modules are copied pad by pad, the rest of a module does not matter here.
+    // The copies are detached from their parent: the worker must not read the dragged
+    // module, which the main thread keeps moving.
+    for( auto item : citems )
+    {
+        BOARD_ITEM* copy = static_cast<BOARD_ITEM*>( item->Clone() );
+
+        copy->SetParent( nullptr );
+        job->m_items.emplace_back( copy );
     }
 
-    CONNECTIVITY_DATA connData( aItems );
     BlockRatsnestItems( aItems );
 
+    // Only the nets of the moved items get dynamic ratsnest lines to the board
+    job->m_targets.resize( m_nets.size() );
+
+    for( auto item : citems )
+    {
+        int netCode = item->GetNetCode();
+
+        if( netCode > 0 && netCode < (int) m_nets.size() && m_nets[netCode]
+                && job->m_targets[netCode].empty() )
+        {
+            m_nets[netCode]->GetTargetPositions( job->m_targets[netCode] );
+        }
+    }
+
+    return job;
+}
+
+
+void CONNECTIVITY_DATA::computeDynamicRatsnest( DYNAMIC_RATSNEST_JOB& aJob )
+{
+    std::vector<BOARD_ITEM*> items;
+
+    for( const auto& item : aJob.m_items )
+        items.push_back( item.get() );
+
+    CONNECTIVITY_DATA connData( items );
+
     for( unsigned int nc = 1; nc < connData.m_nets.size(); nc++ )
     {
+        if( aJob.m_cancelled )
+            return;
+
         auto dynNet = connData.m_nets[nc];
 
-        if( dynNet->GetNodeCount() != 0 )
+        if( dynNet->GetNodeCount() != 0 && nc < aJob.m_targets.size() )
         {
-            auto ourNet = m_nets[nc];
-            CN_ANCHOR_PTR nodeA, nodeB;
+            RN_DYNAMIC_LINE l;
 
-            if( ourNet->NearestBicoloredPair( *dynNet, nodeA, nodeB ) )
+            if( dynNet->NearestBicoloredPair( aJob.m_targets[nc], l.a, l.b ) )
             {
-                RN_DYNAMIC_LINE l;
-                l.a = nodeA->Pos();
-                l.b = nodeB->Pos();
                 l.netCode = nc;
-
-                m_dynamicRatsnest.push_back( l );
+                aJob.m_lines.push_back( l );
             }
         }
     }
@@ -297,12 +365,90 @@ void CONNECTIVITY_DATA::ComputeDynamicRatsnest( const std::vector<BOARD_ITEM*>&
             l.a = nodeA->Pos();
             l.b = nodeB->Pos();
             l.netCode = 0;
-            m_dynamicRatsnest.push_back( l );
+            aJob.m_lines.push_back( l );
         }
     }
 }
 
 
+void CONNECTIVITY_DATA::ComputeDynamicRatsnest( const std::vector<BOARD_ITEM*>& aItems )
+{
+    cancelDynamicRatsnest();
+    m_dynamicRatsnest.clear();
+
+    auto job = prepareDynamicRatsnest( aItems );
+
+    if( !job )
+        return;
+
+    computeDynamicRatsnest( *job );
+    m_dynamicRatsnest.swap( job->m_lines );
+}
+
+
+void CONNECTIVITY_DATA::ComputeDynamicRatsnestAsync( const std::vector<BOARD_ITEM*>& aItems )
+{
+    cancelDynamicRatsnest();
+
+    auto job = prepareDynamicRatsnest( aItems );
+
+    if( !job )
+    {
+        m_dynamicRatsnest.clear();
+        return;
+    }
+
+    if( !m_dynamicRatsnestTasks )
+        m_dynamicRatsnestTasks.reset( new TASK_GROUP );
+
+    // The task owns the job too: an abandoned job lives until its task is over
+    m_dynamicRatsnestJob = job;
+    m_dynamicRatsnestTasks->Run( [job]()
+            {
+                try
+                {
+                    if( !job->m_cancelled )
+                        computeDynamicRatsnest( *job );
+                }
+                catch( ... )
+                {
+                    // No ratsnest is better than a job which never ends
+                    job->m_lines.clear();
+                }
+
+                job->m_done = true;
+            } );
+}
+
+
+bool CONNECTIVITY_DATA::IsDynamicRatsnestBusy() const
+{
+    return m_dynamicRatsnestJob && !m_dynamicRatsnestJob->m_done;
+}
+
+
+bool CONNECTIVITY_DATA::PublishDynamicRatsnest()
+{
+    if( !m_dynamicRatsnestJob || !m_dynamicRatsnestJob->m_done )
+        return false;
+
+    m_dynamicRatsnest.swap( m_dynamicRatsnestJob->m_lines );
+    m_dynamicRatsnestJob.reset();
+
+    return true;
+}
+
+
+void CONNECTIVITY_DATA::cancelDynamicRatsnest()
+{
+    if( m_dynamicRatsnestJob )
+    {
+        m_dynamicRatsnestJob->m_cancelled = true;
+        m_dynamicRatsnestJob.reset();
+    }
+}
+
+
 void CONNECTIVITY_DATA::ClearDynamicRatsnest()
 {
     m_connAlgo->ForEachAnchor( [] ( CN_ANCHOR& anchor ) { anchor.SetNoLine( false ); } );
@@ -312,6 +458,7 @@ void CONNECTIVITY_DATA::ClearDynamicRatsnest()
 
 void CONNECTIVITY_DATA::HideDynamicRatsnest()
 {
+    cancelDynamicRatsnest();
     m_dynamicRatsnest.clear();
 }
 
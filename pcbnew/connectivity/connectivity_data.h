@@ -50,6 +50,7 @@ class TRACK;
 class D_PAD;
 class MODULE;
 class PROGRESS_REPORTER;
+class TASK_GROUP;
 
 struct CN_DISJOINT_NET_ENTRY
 {
@@ -201,6 +202,30 @@ public:
      */
     void ComputeDynamicRatsnest( const std::vector<BOARD_ITEM*>& aItems );
 
+    /**
+     * Function ComputeDynamicRatsnestAsync()
+     * Starts the calculation of the dynamic ratsnest for the set of items aItems in the
+     * background, so the items can be dragged without waiting for it.  The items are copied
+     * before returning: they can be moved again immediately.  A previous calculation still
+     * running is abandoned, its result would be stale.
+     * The result is made visible by PublishDynamicRatsnest().
+     */
+    void ComputeDynamicRatsnestAsync( const std::vector<BOARD_ITEM*>& aItems );
+
+    /**
+     * Function IsDynamicRatsnestBusy()
+     * @return true while a background calculation of the dynamic ratsnest is running.
+     */
+    bool IsDynamicRatsnestBusy() const;
+
+    /**
+     * Function PublishDynamicRatsnest()
+     * Replaces the dynamic ratsnest with the result of the last background calculation,
+     * if it is finished.
+     * @return true if the dynamic ratsnest was changed and has to be redrawn.
+     */
+    bool PublishDynamicRatsnest();
+
     const std::vector<RN_DYNAMIC_LINE>& GetDynamicRatsnest() const
     {
         return m_dynamicRatsnest;
@@ -248,6 +273,12 @@ public:
 #endif
 
 private:
+    struct DYNAMIC_RATSNEST_JOB;
+
+    std::shared_ptr<DYNAMIC_RATSNEST_JOB> prepareDynamicRatsnest(
+            const std::vector<BOARD_ITEM*>& aItems );
+    static void computeDynamicRatsnest( DYNAMIC_RATSNEST_JOB& aJob );
+    void cancelDynamicRatsnest();
 
     void    updateRatsnest();
     void    addRatsnestCluster( const std::shared_ptr<CN_CLUSTER>& aCluster );
@@ -255,6 +286,10 @@ private:
     std::shared_ptr<CN_CONNECTIVITY_ALGO> m_connAlgo;
 
     std::vector<RN_DYNAMIC_LINE> m_dynamicRatsnest;
+
+    ///> Background calculation of the dynamic ratsnest, only accessed by the main thread
+    std::shared_ptr<DYNAMIC_RATSNEST_JOB> m_dynamicRatsnestJob;
+    std::unique_ptr<TASK_GROUP>           m_dynamicRatsnestTasks;
     std::vector<RN_NET*> m_nets;
 
     PROGRESS_REPORTER* m_progressReporter;
@@ -349,3 +349,23 @@ void CN_CLUSTER::Add( CN_ITEM* item )
         }
     }
 }
+
+
+void CN_CLUSTER::Remove( const std::function<bool( CN_ITEM* )>& aPred )
+{
+    std::vector<CN_ITEM*> items;
+
+    for( auto item : m_items )
+    {
+        if( !aPred( item ) )
+            items.push_back( item );
+    }
+
+    m_items.clear();
+    m_originPad = nullptr;
+    m_originNet = -1;
+    m_conflicting = false;
+
+    for( auto item : items )
+        Add( item );
+}
@@ -518,6 +518,14 @@ public:
 
     void Add( CN_ITEM* item );
 
+    /**
+     * Function Remove
+     * removes the items for which aPred returns true, and finds the origin pad of the
+     * cluster again among the remaining ones.  aPred is called on all the items before
+     * any of them is accessed, so it may be given items which are already deleted.
+     */
+    void Remove( const std::function<bool( CN_ITEM* )>& aPred );
+
     using ITER = decltype(m_items)::iterator;
 
     ITER begin() { return m_items.begin(); };
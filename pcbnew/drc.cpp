@@ -57,6 +57,17 @@
 #include <board_commit.h>
 #include <geometry/shape_segment.h>
 #include <geometry/shape_arc.h>
+#include <drc_rtree.h>
+#include <zone_filler.h>
+#include <profile.h>
+#include <thread_pool.h>
+
+#include <class_marker_pcb.h>
+
+#include <atomic>
+#include <algorithm>
+#include <climits>
+#include <unordered_map>
 
 void DRC::ShowDRCDialog( wxWindow* aParent )
 {
@@ -77,6 +88,9 @@ void DRC::ShowDRCDialog( wxWindow* aParent )
     toolMgr->DeactivateTool();
     toolMgr->RunAction( PCB_ACTIONS::selectionClear, true );
 
+    // Show the markers of the changes not tested yet
+    TestDirtyItems();
+
     if( !m_drcDialog )
     {
         m_drcDialog = new DIALOG_DRC_CONTROL( this, m_pcbEditorFrame, aParent );
@@ -97,22 +111,186 @@ void DRC::ShowDRCDialog( wxWindow* aParent )
 }
 
 
+// Error codes of the tests run again by TestDirtyItems()
+static bool isDirtyItemsErrorCode( int aErrorCode, bool aPad2PadTest )
+{
+    switch( aErrorCode )
+    {
+    case DRCE_TRACK_NEAR_THROUGH_HOLE:
+    case DRCE_TRACK_NEAR_PAD:
+    case DRCE_TRACK_NEAR_VIA:
+    case DRCE_VIA_NEAR_VIA:
+    case DRCE_VIA_NEAR_TRACK:
+    case DRCE_TRACK_ENDS1:
+    case DRCE_TRACK_ENDS2:
+    case DRCE_TRACK_ENDS3:
+    case DRCE_TRACK_ENDS4:
+    case DRCE_TRACK_SEGMENTS_TOO_CLOSE:
+    case DRCE_TRACKS_CROSSING:
+    case DRCE_ENDS_PROBLEM1:
+    case DRCE_ENDS_PROBLEM2:
+    case DRCE_ENDS_PROBLEM3:
+    case DRCE_ENDS_PROBLEM4:
+    case DRCE_ENDS_PROBLEM5:
+    case DRCE_VIA_HOLE_BIGGER:
+    case DRCE_MICRO_VIA_INCORRECT_LAYER_PAIR:
+    case DRCE_TOO_SMALL_TRACK_WIDTH:
+    case DRCE_TOO_SMALL_VIA:
+    case DRCE_TOO_SMALL_MICROVIA:
+    case DRCE_TOO_SMALL_VIA_DRILL:
+    case DRCE_TOO_SMALL_MICROVIA_DRILL:
+    case DRCE_TRACK_NEAR_ZONE:
+    case DRCE_MICRO_VIA_NOT_ALLOWED:
+    case DRCE_BURIED_VIA_NOT_ALLOWED:
+    case DRCE_TRACK_NEAR_EDGE:
+        return true;
+
+    case DRCE_PAD_NEAR_PAD1:
+    case DRCE_HOLE_NEAR_PAD:
+        return aPad2PadTest;
+
+    default:
+        return false;
+    }
+}
+
+
 void DRC::addMarkerToPcb( MARKER_PCB* aMarker )
 {
+    std::vector<MARKER_PCB*> markers( 1, aMarker );
+
+    addMarkersToPcb( markers );
+}
+
+
+void DRC::addMarkersToPcb( std::vector<MARKER_PCB*>& aMarkers )
+{
+    if( aMarkers.empty() )
+        return;
+
     // In legacy routing mode, do not add markers to the board.
     // only shows the drc error message
     if( m_drcInLegacyRoutingMode )
     {
-        m_pcbEditorFrame->SetMsgPanel( aMarker );
-        delete aMarker;
+        // The first marker is the one left in the message panel
+        for( auto it = aMarkers.rbegin(); it != aMarkers.rend(); ++it )
+        {
+            m_pcbEditorFrame->SetMsgPanel( *it );
+            delete *it;
+        }
+
         m_currentMarker = nullptr;
     }
+    else if( m_markerSink )
+    {
+        m_markerSink->insert( m_markerSink->end(), aMarkers.begin(), aMarkers.end() );
+    }
+    else if( !m_pcbEditorFrame )
+    {
+        // Headless mode: there is no view nor undo list to update
+        for( MARKER_PCB* marker : aMarkers )
+            m_pcb->Add( marker );
+
+        recordMarkers( aMarkers );
+    }
     else
     {
         BOARD_COMMIT commit( m_pcbEditorFrame );
-        commit.Add( aMarker );
+
+        for( MARKER_PCB* marker : aMarkers )
+            commit.Add( marker );
+
         commit.Push( wxEmptyString, false, false );
+
+        recordMarkers( aMarkers );
     }
+
+    aMarkers.clear();
+}
+
+
+void DRC::removeMarkersFromPcb( std::vector<MARKER_PCB*>& aMarkers )
+{
+    if( aMarkers.empty() )
+        return;
+
+    for( MARKER_PCB* marker : aMarkers )
+        forgetMarker( marker );
+
+    if( !m_pcbEditorFrame )
+    {
+        // Headless mode: there is no view nor undo list to update
+        for( MARKER_PCB* marker : aMarkers )
+            m_pcb->Delete( marker );
+    }
+    else
+    {
+        BOARD_COMMIT commit( m_pcbEditorFrame );
+
+        for( MARKER_PCB* marker : aMarkers )
+        {
+            if( m_pcbEditorFrame->GetCurItem() == marker )
+                m_pcbEditorFrame->SetCurItem( NULL );
+
+            commit.Remove( marker );
+        }
+
+        commit.Push( wxEmptyString, false, false );
+
+        // There is no undo entry to own the removed markers
+        for( MARKER_PCB* marker : aMarkers )
+            delete marker;
+    }
+
+    aMarkers.clear();
+}
+
+
+void DRC::recordMarkers( const std::vector<MARKER_PCB*>& aMarkers )
+{
+    for( MARKER_PCB* marker : aMarkers )
+    {
+        const DRC_ITEM& item = marker->GetReporter();
+
+        if( !isDirtyItemsErrorCode( item.GetErrorCode(), true ) )
+            continue;
+
+        const void* mainItem = item.GetMainItemWeakRef();
+        const void* auxItem = item.GetAuxItemWeakRef();
+
+        if( mainItem )
+            m_itemMarkers[ mainItem ].push_back( marker );
+
+        if( auxItem && auxItem != mainItem )
+            m_itemMarkers[ auxItem ].push_back( marker );
+    }
+}
+
+
+void DRC::forgetMarker( MARKER_PCB* aMarker )
+{
+    const DRC_ITEM& item = aMarker->GetReporter();
+
+    for( const void* ref : { item.GetMainItemWeakRef(), item.GetAuxItemWeakRef() } )
+    {
+        auto it = m_itemMarkers.find( ref );
+
+        if( it == m_itemMarkers.end() )
+            continue;
+
+        std::vector<MARKER_PCB*>& markers = it->second;
+
+        markers.erase( std::remove( markers.begin(), markers.end(), aMarker ), markers.end() );
+
+        if( markers.empty() )
+            m_itemMarkers.erase( it );
+    }
+}
+
+
+EDA_UNITS_T DRC::userUnits() const
+{
+    return m_pcbEditorFrame ? m_pcbEditorFrame->GetUserUnits() : m_units;
 }
 
 
@@ -128,10 +306,18 @@ void DRC::DestroyDRCDialog( int aReason )
 }
 
 
-DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
+DRC::DRC( PCB_EDIT_FRAME* aPcbWindow ) :
+    DRC( aPcbWindow->GetBoard(), aPcbWindow->GetUserUnits() )
 {
     m_pcbEditorFrame = aPcbWindow;
-    m_pcb = aPcbWindow->GetBoard();
+}
+
+
+DRC::DRC( BOARD* aBoard, EDA_UNITS_T aUnits )
+{
+    m_pcbEditorFrame = nullptr;
+    m_pcb = aBoard;
+    m_units = aUnits;
     m_drcDialog  = NULL;
 
     // establish initial values for everything:
@@ -143,10 +329,57 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     m_refillZones = false;            // Only fill zones if requested by user.
     m_reportAllTrackErrors = false;
     m_doCreateRptFile = false;
+    m_isWorker = false;
 
     // m_rptFilename set to empty by its constructor
 
     m_currentMarker = NULL;
+    m_markerSink = nullptr;
+    m_outlineDirty = false;
+    m_testsRunning = false;
+    m_dirtyTestPending = false;
+    m_testedBoard = nullptr;
+    m_indexBoard = nullptr;
+    m_indexMargin = 0;
+    m_indexValid = false;
+
+    m_segmAngle  = 0;
+    m_segmLength = 0;
+
+    m_xcliplo = 0;
+    m_ycliplo = 0;
+    m_xcliphi = 0;
+    m_ycliphi = 0;
+}
+
+
+DRC::DRC( const DRC& aParent ) :
+    m_board_outlines( aParent.m_board_outlines )
+{
+    m_pcbEditorFrame = aParent.m_pcbEditorFrame;
+    m_pcb = aParent.m_pcb;
+    m_units = aParent.m_units;
+    m_drcDialog = NULL;
+
+    m_drcInLegacyRoutingMode = false;
+    m_doPad2PadTest     = aParent.m_doPad2PadTest;
+    m_doUnconnectedTest = aParent.m_doUnconnectedTest;
+    m_doZonesTest       = aParent.m_doZonesTest;
+    m_doKeepoutTest     = aParent.m_doKeepoutTest;
+    m_refillZones       = aParent.m_refillZones;
+    m_reportAllTrackErrors = aParent.m_reportAllTrackErrors;
+    m_doCreateRptFile   = false;
+    m_isWorker          = true;
+
+    m_currentMarker = NULL;
+    m_markerSink = nullptr;
+    m_outlineDirty = false;
+    m_testsRunning = false;
+    m_dirtyTestPending = false;
+    m_testedBoard = nullptr;
+    m_indexBoard = nullptr;
+    m_indexMargin = 0;
+    m_indexValid = false;
 
     m_segmAngle  = 0;
     m_segmLength = 0;
@@ -163,6 +396,14 @@ DRC::~DRC()
     // maybe someday look at pointainer.h  <- google for "pointainer.h"
     for( unsigned i = 0; i<m_unconnected.size();  ++i )
         delete m_unconnected[i];
+
+    // The worker copies run on the pool threads and never listen to the board
+    if( m_isWorker )
+        return;
+
+    BOARD* board = m_pcbEditorFrame ? m_pcbEditorFrame->GetBoard() : m_pcb;
+
+    board->RemoveListener( this );
 }
 
 
@@ -212,8 +453,8 @@ int DRC::DrcOnCreatingTrack( TRACK* aRefSegm, TRACK* aList )
 
 int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
 {
-    BOARD* board = m_pcbEditorFrame->GetBoard();
-    BOARD_COMMIT commit( m_pcbEditorFrame );
+    BOARD* board = m_pcbEditorFrame ? m_pcbEditorFrame->GetBoard() : m_pcb;
+    std::vector<MARKER_PCB*> markers;
     int nerrors = 0;
 
     std::vector<SHAPE_POLY_SET> smoothed_polys;
@@ -223,6 +464,9 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
     {
         ZONE_CONTAINER* zoneRef = board->GetArea( ia );
         zoneRef->BuildSmoothedPoly( smoothed_polys[ia] );
+
+        // The corners of all the other zones are tested against it
+        smoothed_polys[ia].EnableContainmentIndex();
     }
 
     // iterate through all areas
@@ -283,7 +527,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                 if( smoothed_polys[ia2].Contains( currentVertex ) )
                 {
                     if( aCreateMarkers )
-                        commit.Add( newMarker( pt, zoneRef, zoneToTest, DRCE_ZONES_INTERSECT ) );
+                        markers.push_back( newMarker( pt, zoneRef, zoneToTest, DRCE_ZONES_INTERSECT ) );
 
                     nerrors++;
                 }
@@ -298,7 +542,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                 if( smoothed_polys[ia].Contains( currentVertex ) )
                 {
                     if( aCreateMarkers )
-                        commit.Add( newMarker( pt, zoneToTest, zoneRef, DRCE_ZONES_INTERSECT ) );
+                        markers.push_back( newMarker( pt, zoneToTest, zoneRef, DRCE_ZONES_INTERSECT ) );
 
                     nerrors++;
                 }
@@ -346,15 +590,14 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
             for( wxPoint pt : conflictPoints )
             {
                 if( aCreateMarkers )
-                    commit.Add( newMarker( pt, zoneRef, zoneToTest, DRCE_ZONES_TOO_CLOSE ) );
+                    markers.push_back( newMarker( pt, zoneRef, zoneToTest, DRCE_ZONES_TOO_CLOSE ) );
 
                 nerrors++;
             }
         }
     }
 
-    if( aCreateMarkers )
-        commit.Push( wxEmptyString, false, false );
+    addMarkersToPcb( markers );
 
     return nerrors;
 }
@@ -391,7 +634,27 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 {
     // be sure m_pcb is the current board, not a old one
     // ( the board can be reloaded )
-    m_pcb = m_pcbEditorFrame->GetBoard();
+    if( m_pcbEditorFrame )
+        m_pcb = m_pcbEditorFrame->GetBoard();
+
+    PROF_COUNTER passTimer;
+
+    m_passDurations.clear();
+
+    auto passDone = [&]( const wxString& aPassName )
+    {
+        m_passDurations.emplace_back( aPassName, passTimer.msecs() );
+        passTimer.Start();
+    };
+
+    // From now on, keep track of the changes for TestDirtyItems().  The changes made
+    // while the tests are running (zone refill, markers) are covered by this run.
+    m_pcb->AddListener( this );
+    m_testedBoard = m_pcb;
+    m_dirtyItems.clear();
+    m_itemMarkers.clear();
+    m_outlineDirty = false;
+    m_testsRunning = true;
 
     if( aMessages )
     {
@@ -400,9 +663,14 @@ void DRC::RunTests( wxTextCtrl* aMessages )
     }
 
     testOutline();
+    passDone( wxT( "outline" ) );
 
     // someone should have cleared the two lists before calling this.
-    if( !testNetClasses() )
+    bool netclassesOk = testNetClasses();
+
+    passDone( wxT( "netclasses" ) );
+
+    if( !netclassesOk )
     {
         // testing the netclasses is a special case because if the netclasses
         // do not pass the BOARD_DESIGN_SETTINGS checks, then every member of a net
@@ -414,6 +682,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         // update the m_drcDialog listboxes
         updatePointers();
 
+        m_testsRunning = false;
         return;
     }
 
@@ -427,6 +696,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         }
 
         testPad2Pad();
+        passDone( wxT( "pad_clearances" ) );
     }
 
     // test clearances between drilled holes
@@ -437,11 +707,27 @@ void DRC::RunTests( wxTextCtrl* aMessages )
     }
 
     testDrilledHoles();
+    passDone( wxT( "drill_clearances" ) );
 
     // caller (a wxTopLevelFrame) is the wxDialog or the Pcb Editor frame that call DRC:
     wxWindow* caller = aMessages ? aMessages->GetParent() : m_pcbEditorFrame;
 
-    if( m_refillZones )
+    if( !m_pcbEditorFrame )
+    {
+        // Headless mode: nobody to ask whether the fills can be updated, so they are
+        // tested as they are unless a refill was requested
+        if( m_refillZones )
+        {
+            std::vector<ZONE_CONTAINER*> toFill;
+
+            for( ZONE_CONTAINER* zone : m_pcb->Zones() )
+                toFill.push_back( zone );
+
+            ZONE_FILLER filler( m_pcb );
+            filler.Fill( toFill );
+        }
+    }
+    else if( m_refillZones )
     {
         if( aMessages )
             aMessages->AppendText( _( "Refilling all zones...\n" ) );
@@ -456,6 +742,8 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         m_pcbEditorFrame->Check_All_Zones( caller );
     }
 
+    passDone( wxT( "zone_fills" ) );
+
     // test track and via clearances to other tracks, pads, and vias
     if( aMessages )
     {
@@ -463,7 +751,8 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    testTracks( aMessages ? aMessages->GetParent() : m_pcbEditorFrame, true );
+    testTracks( caller, m_pcbEditorFrame != nullptr );
+    passDone( wxT( "track_clearances" ) );
 
     // test zone clearances to other zones
     if( aMessages )
@@ -473,6 +762,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
     }
 
     testZones();
+    passDone( wxT( "zone_clearances" ) );
 
     // find and gather unconnected pads.
     if( m_doUnconnectedTest )
@@ -484,6 +774,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         }
 
         testUnconnected();
+        passDone( wxT( "unconnected" ) );
     }
 
     // find and gather vias, tracks, pads inside keepout areas.
@@ -496,6 +787,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         }
 
         testKeepoutAreas();
+        passDone( wxT( "keepout_areas" ) );
     }
 
     // find and gather vias, tracks, pads inside text boxes.
@@ -506,6 +798,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
     }
 
     testCopperTextAndGraphics();
+    passDone( wxT( "texts_and_graphics" ) );
 
     // find overlapping courtyard ares.
     if( m_pcb->GetDesignSettings().m_ProhibitOverlappingCourtyards
@@ -518,10 +811,12 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         }
 
         doFootprintOverlappingDrc();
+        passDone( wxT( "courtyards" ) );
     }
 
     // Check if there are items on disabled layers
     testDisabledLayers();
+    passDone( wxT( "disabled_layers" ) );
 
     if( aMessages )
     {
@@ -538,6 +833,8 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         // to unnecessarily scroll.
         aMessages->AppendText( _( "Finished" ) );
     }
+
+    m_testsRunning = false;
 }
 
 
@@ -553,14 +850,16 @@ void DRC::ListUnconnectedPads()
 void DRC::updatePointers()
 {
     // update my pointers, m_pcbEditorFrame is the only unchangeable one
-    m_pcb = m_pcbEditorFrame->GetBoard();
+    // (in headless mode, the board is given once for all to the constructor)
+    if( m_pcbEditorFrame )
+        m_pcb = m_pcbEditorFrame->GetBoard();
 
     if( m_drcDialog )  // Use diag list boxes only in DRC dialog
     {
         m_drcDialog->m_ClearanceListBox->SetList(
-                m_pcbEditorFrame->GetUserUnits(), new DRC_LIST_MARKERS( m_pcb ) );
+                userUnits(), new DRC_LIST_MARKERS( m_pcb ) );
         m_drcDialog->m_UnconnectedListBox->SetList(
-                m_pcbEditorFrame->GetUserUnits(), new DRC_LIST_UNCONNECTED( &m_unconnected ) );
+                userUnits(), new DRC_LIST_UNCONNECTED( &m_unconnected ) );
 
         m_drcDialog->UpdateDisplayedCounts();
     }
@@ -573,7 +872,7 @@ bool DRC::doNetClass( const NETCLASSPTR& nc, wxString& msg )
 
     const BOARD_DESIGN_SETTINGS& g = m_pcb->GetDesignSettings();
 
-#define FmtVal( x ) GetChars( StringFromValue( m_pcbEditorFrame->GetUserUnits(), x ) )
+#define FmtVal( x ) GetChars( StringFromValue( userUnits(), x ) )
 
 #if 0   // set to 1 when (if...) BOARD_DESIGN_SETTINGS has a m_MinClearance value
     if( nc->GetClearance() < g.m_MinClearance )
@@ -782,7 +1081,7 @@ void DRC::testDrilledHoles()
             if( KiROUND( GetLineLength( checkHole.m_location, refHole.m_location ) )
                     <  checkHole.m_drillRadius + refHole.m_drillRadius + holeToHoleMin )
             {
-                addMarkerToPcb( new MARKER_PCB( m_pcbEditorFrame->GetUserUnits(),
+                addMarkerToPcb( new MARKER_PCB( userUnits(),
                                                 DRCE_DRILLED_HOLES_TOO_CLOSE, refHole.m_location,
                                                 refHole.m_owner, refHole.m_location,
                                                 checkHole.m_owner, checkHole.m_location ) );
@@ -792,17 +1091,171 @@ void DRC::testDrilledHoles()
 }
 
 
+// The candidates of a clearance test are the items closer than the largest clearance.
+// Local pad and footprint clearances can exceed the netclass ones.
+static int biggestClearance( BOARD* aBoard, const std::vector<D_PAD*>& aPads )
+{
+    int clearance = aBoard->GetDesignSettings().GetBiggestClearanceValue();
+
+    for( D_PAD* pad : aPads )
+        clearance = std::max( clearance, pad->GetClearance() );
+
+    return clearance;
+}
+
+
+void DRC::buildIndex()
+{
+    std::vector<D_PAD*> pads = m_pcb->GetPads();
+
+    m_indexMargin = biggestClearance( m_pcb, pads );
+    m_trackIndex.reset( new DRC_RTREE<TRACK*>( m_indexMargin ) );
+    m_padIndex.reset( new DRC_RTREE<D_PAD*>( m_indexMargin ) );
+    m_trackNumbers.clear();
+    m_padNumbers.clear();
+    m_modulePads.clear();
+
+    for( TRACK* segm = m_pcb->m_Track; segm; segm = segm->Next() )
+        m_trackNumbers[ segm ] = m_trackIndex->Insert( segm, segm->GetBoundingBox() );
+
+    // Pads not on the layers of a track are still tested for their hole,
+    // which can be larger than the pad itself
+    for( D_PAD* pad : pads )
+    {
+        m_padNumbers[ pad ] = m_padIndex->Insert( pad, pad->GetBoundingBoxWithHole() );
+        m_modulePads[ pad->GetParent() ].push_back( pad );
+    }
+
+    m_indexBoard = m_pcb;
+    m_indexValid = true;
+
+    // Follow the commits to update the index.  The legacy tools do not commit, and drop
+    // it through PCB_EDIT_FRAME::OnModify() instead.
+    m_pcb->AddListener( this );
+}
+
+
+void DRC::ensureIndex()
+{
+    if( m_pcbEditorFrame )
+        m_pcb = m_pcbEditorFrame->GetBoard();
+
+    if( !m_indexValid || m_indexBoard != m_pcb
+            || m_pcb->GetDesignSettings().GetBiggestClearanceValue() > m_indexMargin )
+    {
+        buildIndex();
+    }
+}
+
+
+void DRC::updateIndex( const std::vector<BOARD_ITEM*>& aChangedItems,
+                       const std::vector<BOARD_ITEM*>& aRemovedItems )
+{
+    auto update = [&]( BOARD_ITEM* aItem )
+    {
+        switch( aItem->Type() )
+        {
+        case PCB_TRACE_T:
+        case PCB_VIA_T:
+        {
+            TRACK* segm = static_cast<TRACK*>( aItem );
+            auto   it = m_trackNumbers.find( segm );
+
+            if( it != m_trackNumbers.end() )
+            {
+                m_trackIndex->Remove( it->second );
+                m_trackNumbers.erase( it );
+            }
+
+            // The removed items are no longer in the board lists
+            if( segm->GetList() )
+                m_trackNumbers[ segm ] = m_trackIndex->Insert( segm, segm->GetBoundingBox() );
+
+            break;
+        }
+
+        case PCB_PAD_T:
+            // The pads are indexed along with the other pads of their footprint
+            if( MODULE* module = static_cast<D_PAD*>( aItem )->GetParent() )
+                updateModuleIndex( module );
+
+            break;
+
+        case PCB_MODULE_T:
+            updateModuleIndex( static_cast<MODULE*>( aItem ) );
+            break;
+
+        default:
+            break;
+        }
+    };
+
+    for( BOARD_ITEM* item : aChangedItems )
+        update( item );
+
+    for( BOARD_ITEM* item : aRemovedItems )
+        update( item );
+}
+
+
+void DRC::updateModuleIndex( MODULE* aModule )
+{
+    auto it = m_modulePads.find( aModule );
+
+    // The pads indexed before may have been deleted since: only use them as keys
+    if( it != m_modulePads.end() )
+    {
+        for( D_PAD* pad : it->second )
+        {
+            auto number = m_padNumbers.find( pad );
+
+            if( number != m_padNumbers.end() )
+            {
+                m_padIndex->Remove( number->second );
+                m_padNumbers.erase( number );
+            }
+        }
+
+        m_modulePads.erase( it );
+    }
+
+    if( !aModule->GetList() )
+        return;
+
+    std::vector<D_PAD*>& pads = m_modulePads[ aModule ];
+
+    for( D_PAD* pad : aModule->Pads() )
+    {
+        m_padNumbers[ pad ] = m_padIndex->Insert( pad, pad->GetBoundingBoxWithHole() );
+        pads.push_back( pad );
+
+        // A local clearance larger than the index margin needs a new index
+        if( pad->GetClearance() > m_indexMargin )
+            m_indexValid = false;
+    }
+}
+
+
 void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
 {
+    std::vector<TRACK*> tracks;
+
+    for( TRACK* segm = m_pcb->m_Track; segm; segm = segm->Next() )
+        tracks.push_back( segm );
+
+    if( tracks.empty() )
+        return;
+
+    // The tracks are numbered in the index in the same order as in the list
+    buildIndex();
+
+    const DRC_RTREE<TRACK*>& trackIndex = *m_trackIndex;
+    const DRC_RTREE<D_PAD*>& padIndex = *m_padIndex;
+
     wxProgressDialog * progressDialog = NULL;
     const int delta = 500;  // This is the number of tests between 2 calls to the
                             // progress bar
-    int count = 0;
-
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
-        count++;
-
-    int deltamax = count/delta;
+    int deltamax = tracks.size() / delta;
 
     if( aShowProgressBar && deltamax > 3 )
     {
@@ -814,40 +1267,385 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
         progressDialog->Update( 0, wxEmptyString );
     }
 
-    int ii = 0;
-    count = 0;
+    // Each track gets its own marker list, so the markers can be added to the board
+    // in track order whatever the thread which found them
+    std::vector<std::vector<MARKER_PCB*>> markers( tracks.size() );
+    std::atomic<size_t> nextItem( 0 );
+    std::atomic<size_t> doneCount( 0 );
+    TASK_GROUP          tasks;
 
-    for( TRACK* segm = m_pcb->m_Track; segm; segm = segm->Next() )
+    size_t parallelThreadCount = std::min<size_t>( tasks.GetThreadCount(), tracks.size() );
+
+    auto drc_lambda = [&] ()
     {
-        if( ii++ > delta )
+        DRC worker( *this );
+        std::vector<int> candidates;
+        std::vector<D_PAD*> candidatePads;
+        std::vector<TRACK*> candidateTracks;
+
+        for( size_t i = nextItem++; i < tracks.size() && !tasks.IsCancelled(); i = nextItem++ )
         {
-            ii = 0;
-            count++;
+            TRACK* segm = tracks[i];
+            EDA_RECT bbox = segm->GetBoundingBox();
+
+            padIndex.Query( bbox, candidates );
+            candidatePads.clear();
+
+            for( int idx : candidates )
+                candidatePads.push_back( padIndex.GetItem( idx ) );
+
+            // Like the sequential test, a segment is only tested against the following
+            // ones: the previous ones have already been tested against it
+            trackIndex.Query( bbox, candidates );
+            candidateTracks.clear();
+
+            for( int idx : candidates )
+            {
+                if( idx > (int) i )
+                    candidateTracks.push_back( trackIndex.GetItem( idx ) );
+            }
+
+            worker.m_markerSink = &markers[i];
+            worker.doTrackDrc( segm, candidatePads.data(),
+                               candidatePads.data() + candidatePads.size(),
+                               candidateTracks.data(),
+                               candidateTracks.data() + candidateTracks.size() );
+
+            doneCount++;
+        }
+    };
+
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        tasks.Run( drc_lambda );
 
-            if( progressDialog )
+    // Here we wake up every 100ms to allow UI updating
+    tasks.Wait( [&]()
             {
-                if( !progressDialog->Update( count, wxEmptyString ) )
-                    break;  // Aborted by user
+                if( progressDialog && !tasks.IsCancelled() )
+                {
+                    int count = std::min<int>( doneCount / delta, deltamax );
+
+                    if( !progressDialog->Update( count, wxEmptyString ) )
+                        tasks.Cancel();     // Aborted by user
+                }
+            } );
+
 #ifdef __WXMAC__
-                // Work around a dialog z-order issue on OS X
-                if( count == deltamax )
-                    aActiveWindow->Raise();
+    // Work around a dialog z-order issue on OS X
+    if( progressDialog )
+        aActiveWindow->Raise();
 #endif
+
+    if( progressDialog )
+        progressDialog->Destroy();
+
+    std::vector<MARKER_PCB*> allMarkers;
+
+    for( std::vector<MARKER_PCB*>& trackMarkers : markers )
+        allMarkers.insert( allMarkers.end(), trackMarkers.begin(), trackMarkers.end() );
+
+    addMarkersToPcb( allMarkers );
+}
+
+
+void DRC::OnBoardItemsChanged( BOARD& aBoard, const std::vector<BOARD_ITEM*>& aChangedItems,
+                               const std::vector<BOARD_ITEM*>& aRemovedItems )
+{
+    if( &aBoard == m_indexBoard && m_indexValid )
+        updateIndex( aChangedItems, aRemovedItems );
+
+    for( BOARD_ITEM* item : aRemovedItems )
+    {
+        if( item->Type() == PCB_MARKER_T )
+            forgetMarker( static_cast<MARKER_PCB*>( item ) );
+    }
+
+    if( m_testsRunning || &aBoard != m_testedBoard )
+        return;
+
+    auto markDirty = [&]( BOARD_ITEM* aItem )
+    {
+        switch( aItem->Type() )
+        {
+        case PCB_MARKER_T:
+            return;     // our own output
+
+        case PCB_MODULE_T:
+        {
+            MODULE* module = static_cast<MODULE*>( aItem );
+
+            for( D_PAD* pad : module->Pads() )
+                m_dirtyItems.insert( pad );
+
+            for( BOARD_ITEM* item : module->GraphicalItems() )
+            {
+                if( item->GetLayer() == Edge_Cuts )
+                    m_outlineDirty = true;
+            }
+
+            break;
+        }
+
+        default:
+            if( aItem->GetLayer() == Edge_Cuts )
+                m_outlineDirty = true;
+
+            break;
+        }
+
+        m_dirtyItems.insert( aItem );
+    };
+
+    for( BOARD_ITEM* item : aChangedItems )
+        markDirty( item );
+
+    for( BOARD_ITEM* item : aRemovedItems )
+        markDirty( item );
+
+    // The markers are changed by commits too, so test only once this commit is done
+    if( !m_pcbEditorFrame )
+    {
+        TestDirtyItems();
+    }
+    else if( !m_dirtyTestPending )
+    {
+        m_dirtyTestPending = true;
+
+        m_pcbEditorFrame->CallAfter( [this]()
+                {
+                    m_dirtyTestPending = false;
+                    TestDirtyItems();
+                } );
+    }
+}
+
+
+void DRC::OnBoardDeleted( BOARD& aBoard )
+{
+    if( &aBoard == m_indexBoard )
+    {
+        m_trackIndex.reset();
+        m_padIndex.reset();
+        m_trackNumbers.clear();
+        m_padNumbers.clear();
+        m_modulePads.clear();
+        m_indexBoard = nullptr;
+        m_indexValid = false;
+    }
+
+    if( &aBoard == m_testedBoard )
+    {
+        m_testedBoard = nullptr;
+        m_itemMarkers.clear();
+        m_dirtyItems.clear();
+        m_outlineDirty = false;
+    }
+}
+
+
+void DRC::TestDirtyItems()
+{
+    if( m_pcbEditorFrame )
+        m_pcb = m_pcbEditorFrame->GetBoard();
+
+    // The changes are tracked only since the last full run on this board
+    if( m_pcb != m_testedBoard || !m_pcb->HasListener( this ) || m_testsRunning )
+        return;
+
+    if( m_dirtyItems.empty() && !m_outlineDirty )
+        return;
+
+    m_testsRunning = true;
+
+    if( m_outlineDirty )
+        m_pcb->GetBoardPolygonOutlines( m_board_outlines, nullptr, nullptr );
+
+    // The commits have kept the index up to date, unless it had to be dropped
+    ensureIndex();
+
+    // Numbers of the tracks and pads to test again in the index
+    std::unordered_set<int> trackDirty;
+    std::unordered_set<int> padDirty;
+    std::vector<int>        candidates;
+
+    if( m_outlineDirty )
+    {
+        for( const auto& entry : m_trackNumbers )
+            trackDirty.insert( entry.second );
+    }
+
+    for( const void* item : m_dirtyItems )
+    {
+        auto it = m_trackNumbers.find( item );
+
+        if( it != m_trackNumbers.end() )
+        {
+            trackDirty.insert( it->second );
+            continue;
+        }
+
+        it = m_padNumbers.find( item );
+
+        if( it == m_padNumbers.end() )
+            continue;
+
+        // The tracks close to a changed pad have to be tested again against it
+        padDirty.insert( it->second );
+        m_trackIndex->Query( m_padIndex->GetItem( it->second )->GetBoundingBoxWithHole(),
+                             candidates );
+        trackDirty.insert( candidates.begin(), candidates.end() );
+    }
+
+    for( ZONE_CONTAINER* zone : m_pcb->Zones() )
+    {
+        if( !m_dirtyItems.count( zone ) )
+            continue;
+
+        m_trackIndex->Query( zone->GetBoundingBox(), candidates );
+        trackDirty.insert( candidates.begin(), candidates.end() );
+    }
+
+    // Find the stale markers: the ones referring to a changed, removed or retested item.
+    // An item may have stopped at its first error, so a clean item losing a marker has to
+    // be tested again too, which can retire more markers.
+    std::vector<const void*>        pending( m_dirtyItems.begin(), m_dirtyItems.end() );
+    std::unordered_set<const void*> visited;
+    std::unordered_set<MARKER_PCB*> boardMarkers;
+    bool                            boardMarkersKnown = false;
+    std::vector<MARKER_PCB*>        staleMarkers;
+
+    for( int number : trackDirty )
+        pending.push_back( m_trackIndex->GetItem( number ) );
+
+    for( int number : padDirty )
+        pending.push_back( m_padIndex->GetItem( number ) );
+
+    while( !pending.empty() )
+    {
+        const void* item = pending.back();
+        pending.pop_back();
+
+        auto it = m_itemMarkers.find( item );
+
+        if( !visited.insert( item ).second || it == m_itemMarkers.end() )
+            continue;
+
+        // The markers deleted by the user are still remembered
+        if( !boardMarkersKnown )
+        {
+            for( int ii = 0; ii < m_pcb->GetMARKERCount(); ii++ )
+                boardMarkers.insert( m_pcb->GetMARKER( ii ) );
+
+            boardMarkersKnown = true;
+        }
+
+        std::vector<MARKER_PCB*> liveMarkers;
+
+        for( MARKER_PCB* marker : it->second )
+        {
+            if( boardMarkers.count( marker ) )
+                liveMarkers.push_back( marker );
+        }
+
+        it->second = liveMarkers;
+
+        for( MARKER_PCB* marker : liveMarkers )
+        {
+            const DRC_ITEM& drcItem = marker->GetReporter();
+            const void*     mainItem = drcItem.GetMainItemWeakRef();
+
+            if( !isDirtyItemsErrorCode( drcItem.GetErrorCode(), m_doPad2PadTest )
+                    || ( mainItem != item && drcItem.GetAuxItemWeakRef() != item ) )
+            {
+                continue;
             }
+
+            forgetMarker( marker );
+            staleMarkers.push_back( marker );
+
+            auto track = m_trackNumbers.find( mainItem );
+            auto pad = m_padNumbers.find( mainItem );
+
+            if( track != m_trackNumbers.end() && trackDirty.insert( track->second ).second )
+                pending.push_back( mainItem );
+            else if( pad != m_padNumbers.end() && padDirty.insert( pad->second ).second )
+                pending.push_back( mainItem );
+        }
+    }
+
+    removeMarkersFromPcb( staleMarkers );
+
+    // Test the dirty items again, in index order.  Pairs of dirty items are tested once.
+    std::vector<int>         tracks( trackDirty.begin(), trackDirty.end() );
+    std::vector<int>         pads( padDirty.begin(), padDirty.end() );
+    std::vector<MARKER_PCB*> markers;
+    std::vector<D_PAD*>      candidatePads;
+    std::vector<TRACK*>      candidateTracks;
+
+    std::sort( tracks.begin(), tracks.end() );
+    std::sort( pads.begin(), pads.end() );
+
+    m_markerSink = &markers;
+
+    for( int i : tracks )
+    {
+        TRACK*   segm = m_trackIndex->GetItem( i );
+        EDA_RECT bbox = segm->GetBoundingBox();
+
+        m_padIndex->Query( bbox, candidates );
+        candidatePads.clear();
+
+        for( int idx : candidates )
+            candidatePads.push_back( m_padIndex->GetItem( idx ) );
+
+        m_trackIndex->Query( bbox, candidates );
+        candidateTracks.clear();
+
+        for( int idx : candidates )
+        {
+            if( idx != i && ( idx > i || !trackDirty.count( idx ) ) )
+                candidateTracks.push_back( m_trackIndex->GetItem( idx ) );
         }
 
-        if( !doTrackDrc( segm, segm->Next(), true ) )
+        doTrackDrc( segm, candidatePads.data(), candidatePads.data() + candidatePads.size(),
+                    candidateTracks.data(), candidateTracks.data() + candidateTracks.size() );
+    }
+
+    if( m_doPad2PadTest )
+    {
+        for( int i : pads )
         {
-            if( m_currentMarker )
+            D_PAD* pad = m_padIndex->GetItem( i );
+
+            m_padIndex->Query( pad->GetBoundingBoxWithHole(), candidates );
+            candidatePads.clear();
+
+            for( int idx : candidates )
+            {
+                if( idx > i || !padDirty.count( idx ) )
+                    candidatePads.push_back( m_padIndex->GetItem( idx ) );
+            }
+
+            if( !doPadToPadsDrc( pad, candidatePads.data(),
+                                 candidatePads.data() + candidatePads.size(), INT_MAX ) )
             {
-                addMarkerToPcb ( m_currentMarker );
+                wxASSERT( m_currentMarker );
+                addMarkerToPcb( m_currentMarker );
                 m_currentMarker = nullptr;
             }
         }
     }
 
-    if( progressDialog )
-        progressDialog->Destroy();
+    m_markerSink = nullptr;
+
+    addMarkersToPcb( markers );
+
+    m_dirtyItems.clear();
+    m_outlineDirty = false;
+    m_testsRunning = false;
+
+    // update the m_drcDialog listboxes
+    updatePointers();
 }
 
 
@@ -868,7 +1666,7 @@ void DRC::testUnconnected()
         auto src = edge.GetSourcePos();
         auto dst = edge.GetTargetPos();
 
-        m_unconnected.emplace_back( new DRC_ITEM( m_pcbEditorFrame->GetUserUnits(),
+        m_unconnected.emplace_back( new DRC_ITEM( userUnits(),
                                                   DRCE_UNCONNECTED_ITEMS,
                                                   edge.GetSourceNode()->Parent(),
                                                   wxPoint( src.x, src.y ),
@@ -1188,7 +1986,7 @@ void DRC::testOutline()
 
 void DRC::testDisabledLayers()
 {
-    BOARD* board = m_pcbEditorFrame->GetBoard();
+    BOARD* board = m_pcb;
     wxCHECK( board, /*void*/ );
     LSET disabledLayers = board->GetEnabledLayers().flip();
 
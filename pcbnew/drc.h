@@ -31,6 +31,9 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_set>
+#include <unordered_map>
+#include <class_board.h>
 #include <geometry/seg.h>
 #include <geometry/shape_poly_set.h>
 
@@ -105,6 +108,7 @@ class DIALOG_DRC_CONTROL;
 class BOARD_ITEM;
 class BOARD;
 class D_PAD;
+class MODULE;
 class ZONE_CONTAINER;
 class TRACK;
 class MARKER_PCB;
@@ -116,6 +120,8 @@ class wxWindow;
 class wxString;
 class wxTextCtrl;
 
+template< class T > class DRC_RTREE;
+
 
 /**
  * Provide an abstract interface of a DRC_ITEM* list manager.  The details
@@ -171,7 +177,7 @@ typedef std::vector<DRC_ITEM*> DRC_LIST;
  * This class is given access to the windows and the BOARD
  * that it needs via its constructor or public access functions.
  */
-class DRC
+class DRC : public BOARD_LISTENER
 {
     friend class DIALOG_DRC_CONTROL;
 
@@ -222,18 +228,101 @@ private:
     int                 m_ycliphi;
 
     PCB_EDIT_FRAME*     m_pcbEditorFrame;   ///< The pcb frame editor which owns the board
+                                            ///< (null when running headless)
     BOARD*              m_pcb;
+    EDA_UNITS_T         m_units;            ///< units of the messages when running headless
     SHAPE_POLY_SET      m_board_outlines;   ///< The board outline including cutouts
     DIALOG_DRC_CONTROL* m_drcDialog;
 
     DRC_LIST            m_unconnected;      ///< list of unconnected pads, as DRC_ITEMs
 
+    /// Items added, modified or removed since the last test, as weak references.
+    /// Only tracked once RunTests() has been run on the current board.
+    std::unordered_set<const void*> m_dirtyItems;
+
+    BOARD*              m_testedBoard;      ///< board of the last RunTests()
+
+    /// Index of the tracks and pads of m_indexBoard, kept between the tests so neither
+    /// TestDirtyItems() nor the legacy router have to scan the whole board.  Built on demand
+    /// by ensureIndex(), then updated by the commits.
+    std::unique_ptr<DRC_RTREE<TRACK*>> m_trackIndex;
+    std::unique_ptr<DRC_RTREE<D_PAD*>> m_padIndex;
+    BOARD*              m_indexBoard;
+    int                 m_indexMargin;      ///< clearance the index items are inflated by
+    bool                m_indexValid;
+
+    /// Number of each track and pad in m_trackIndex and m_padIndex
+    std::unordered_map<const void*, int> m_trackNumbers;
+    std::unordered_map<const void*, int> m_padNumbers;
+
+    /// Pads indexed for each footprint, to drop them when the footprint is changed or removed
+    std::unordered_map<const MODULE*, std::vector<D_PAD*>> m_modulePads;
+
+    /// Markers of the tests run again by TestDirtyItems(), for each item they refer to.
+    /// The markers deleted by other means are only noticed when looked up.
+    std::unordered_map<const void*, std::vector<MARKER_PCB*>> m_itemMarkers;
+
+    bool                m_isWorker;         ///< a worker copy, see DRC( const DRC& )
+
+    bool                m_outlineDirty;     ///< the board outline was edited since the last test
+    bool                m_testsRunning;     ///< ignore the changes made by the tests themselves
+    bool                m_dirtyTestPending; ///< a TestDirtyItems() call is queued on the frame
+
+    /// When not null, new markers are appended to this list instead of being added to the
+    /// board.  Used by the worker copies of the DRC running the track tests in parallel.
+    std::vector<MARKER_PCB*>* m_markerSink;
+
+    /// Name and duration in ms of each pass of the last RunTests(), in run order
+    std::vector<std::pair<wxString, double>> m_passDurations;
+
+    /**
+     * Create a worker copy of \a aParent, used to run segment tests on a separate thread.
+     * The copy shares the board and the settings of its parent, but has its own scratch
+     * state (segment angle, clip box...) and no dialog nor unconnected items list.
+     */
+    DRC( const DRC& aParent );
+
 
     /**
      * Update needed pointers from the one pointer which is known not to change.
      */
     void updatePointers();
 
+    /**
+     * Build the track and pad index of the board from scratch, and start following the
+     * commits so it can be invalidated when they change the board.
+     */
+    void buildIndex();
+
+    /**
+     * Build the track and pad index again if it has been invalidated, if the board has
+     * been changed, or if the clearances grew larger than the margin of the index.
+     */
+    void ensureIndex();
+
+    /**
+     * Update the track and pad index for the items of a commit.  Must be called while the
+     * removed items still exist.
+     */
+    void updateIndex( const std::vector<BOARD_ITEM*>& aChangedItems,
+                      const std::vector<BOARD_ITEM*>& aRemovedItems );
+
+    /**
+     * Index the pads of a footprint again, or drop them if the footprint has been removed.
+     */
+    void updateModuleIndex( MODULE* aModule );
+
+    /**
+     * Remember the markers added to the board by the tests run again by TestDirtyItems(),
+     * for the items they refer to.
+     */
+    void recordMarkers( const std::vector<MARKER_PCB*>& aMarkers );
+
+    /**
+     * Drop a marker from the ones remembered by recordMarkers().
+     */
+    void forgetMarker( MARKER_PCB* aMarker );
+
 
     /**
      * Function newMarker
@@ -275,6 +364,24 @@ private:
      */
     void addMarkerToPcb( MARKER_PCB* aMarker );
 
+    /**
+     * Adds a list of DRC markers to the PCB in a single commit, and clears the list.
+     * In headless mode the markers are added directly to the board.
+     */
+    void addMarkersToPcb( std::vector<MARKER_PCB*>& aMarkers );
+
+    /**
+     * Removes DRC markers from the PCB through the COMMIT mechanism, and deletes them.
+     * The list is cleared.
+     */
+    void removeMarkersFromPcb( std::vector<MARKER_PCB*>& aMarkers );
+
+    /**
+     * @return the units of the messages: the ones of the editor frame, or the ones
+     * given to the constructor when running headless.
+     */
+    EDA_UNITS_T userUnits() const;
+
     //-----<categorical group tests>-----------------------------------------
 
     /**
@@ -291,6 +398,11 @@ private:
     /**
      * Perform the DRC on all tracks.
      *
+     * Tracks, vias and pads are binned in an R-tree so that each segment is only tested
+     * against the items closer than the largest clearance, and the segments are shared
+     * between worker threads.  Markers are added to the board in track list order, so the
+     * result does not depend on the thread scheduling.
+     *
      * This test can take a while, a progress bar can be displayed
      * @param aActiveWindow = the active window ued as parent for the progress bar
      * @param aShowProgressBar = true to show a progress bar
@@ -342,7 +454,8 @@ private:
     bool doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_limit );
 
     /**
-     * Test the current segment.
+     * Test the current segment.  When testing against the whole board, only the items
+     * found close to the segment in the track and pad index are visited.
      *
      * @param aRefSeg The segment to test
      * @param aStart the first item of track list to test against (usually BOARD::m_Track)
@@ -352,6 +465,19 @@ private:
      */
     bool doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool doPads = true );
 
+    /**
+     * Test the current segment against a given set of pads and tracks.
+     *
+     * @param aRefSeg The segment to test
+     * @param aPadStart is the first pad to test against aRefSeg
+     * @param aPadEnd is the end of the pad list and is not included
+     * @param aTrackStart is the first track to test against aRefSeg
+     * @param aTrackEnd is the end of the track list and is not included
+     * @return bool - true if no problems, else false.
+     */
+    bool doTrackDrc( TRACK* aRefSeg, D_PAD** aPadStart, D_PAD** aPadEnd,
+                     TRACK** aTrackStart, TRACK** aTrackEnd );
+
     /**
      * Test the current segment or via.
      *
@@ -437,6 +563,17 @@ private:
 public:
     DRC( PCB_EDIT_FRAME* aPcbWindow );
 
+    /**
+     * Create a headless DRC, running the tests on \a aBoard without any editor frame.
+     * The markers are added directly to the board, the zones are refilled only if
+     * requested by SetSettings() and no dialog nor progress bar is shown.
+     * \a aBoard must outlive the DRC.
+     *
+     * @param aBoard is the board to test.
+     * @param aUnits are the units used in the messages of the markers.
+     */
+    DRC( BOARD* aBoard, EDA_UNITS_T aUnits );
+
     ~DRC();
 
     /**
@@ -501,6 +638,15 @@ public:
      */
     void DestroyDRCDialog( int aReason );
 
+    /**
+     * Drop the track and pad index.  Must be called after the board has been modified
+     * without a commit (i.e. by the legacy tools), as the index only follows the commits.
+     */
+    void InvalidateIndex()
+    {
+        m_indexValid = false;
+    }
+
 
     /**
      * Save all the UI or test settings and may be called before running the tests.
@@ -538,12 +684,54 @@ public:
      */
     void RunTests( wxTextCtrl* aMessages = NULL );
 
+    /**
+     * Run the track and pad clearance tests on the items changed since the last
+     * test only, and on the items close enough to them to be in conflict.
+     *
+     * The markers of these tests which refer to a changed or deleted item are removed
+     * from the board, then the changed items are tested again.  The tests are the ones of
+     * testTracks() and testPad2Pad(); the other tests need a full RunTests().
+     * Does nothing if RunTests() has never been run on the current board.
+     */
+    void TestDirtyItems();
+
+    /**
+     * Collect the items changed by a commit.  If RunTests() has been run on the board, they
+     * are tested by TestDirtyItems() once the commit is done (right away when running
+     * headless, else from the event loop of the editor frame).
+     */
+    void OnBoardItemsChanged( BOARD& aBoard, const std::vector<BOARD_ITEM*>& aChangedItems,
+                              const std::vector<BOARD_ITEM*>& aRemovedItems ) override;
+
+    /**
+     * Forget everything kept about a board being deleted: its index, its markers and its
+     * changes.  A board loaded afterwards needs a new RunTests().
+     */
+    void OnBoardDeleted( BOARD& aBoard ) override;
+
     /**
      * Gather a list of all the unconnected pads and shows them in the
      * dialog, and optionally prints a report of such.
      */
     void ListUnconnectedPads();
 
+    /**
+     * @return the name and the duration in milliseconds of each pass of the last
+     * RunTests(), in run order.
+     */
+    const std::vector<std::pair<wxString, double>>& GetPassDurations() const
+    {
+        return m_passDurations;
+    }
+
+    /**
+     * @return the unconnected items found by the last test.
+     */
+    const DRC_LIST& GetUnconnectedItems() const
+    {
+        return m_unconnected;
+    }
+
     /**
      * @return a pointer to the current marker (last created marker
      */
@@ -37,6 +37,7 @@
 
 #include <pcbnew.h>
 #include <drc.h>
+#include <drc_rtree.h>
 
 #include <class_board.h>
 #include <class_module.h>
@@ -137,7 +138,47 @@ bool convex2pointDRC( wxPoint* aTref, int aTrefCount, wxPoint aPcompare, int aDi
 
 bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
 {
-    TRACK*    track;
+    std::vector<D_PAD*> pads;
+    std::vector<TRACK*> tracks;
+
+    if( aStart == m_pcb->m_Track.GetFirst() )
+    {
+        // The whole board: only visit the items close enough to the segment
+        std::vector<int> candidates;
+        EDA_RECT         bbox = aRefSeg->GetBoundingBox();
+
+        ensureIndex();
+
+        if( testPads )
+        {
+            m_padIndex->Query( bbox, candidates );
+
+            for( int idx : candidates )
+                pads.push_back( m_padIndex->GetItem( idx ) );
+        }
+
+        m_trackIndex->Query( bbox, candidates );
+
+        for( int idx : candidates )
+            tracks.push_back( m_trackIndex->GetItem( idx ) );
+    }
+    else
+    {
+        if( testPads )
+            pads = m_pcb->GetPads();
+
+        for( TRACK* track = aStart; track; track = track->Next() )
+            tracks.push_back( track );
+    }
+
+    return doTrackDrc( aRefSeg, pads.data(), pads.data() + pads.size(),
+                       tracks.data(), tracks.data() + tracks.size() );
+}
+
+
+bool DRC::doTrackDrc( TRACK* aRefSeg, D_PAD** aPadStart, D_PAD** aPadEnd,
+                      TRACK** aTrackStart, TRACK** aTrackEnd )
+{
     wxPoint   delta;           // length on X and Y axis of segments
     LSET layerMask;
     int       net_code_ref;
@@ -147,26 +188,7 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
 
     auto commitMarkers = [&]()
     {
-        // In legacy routing mode, do not add markers to the board.
-        // only shows the drc error message
-        if( m_drcInLegacyRoutingMode )
-        {
-            while( markers.size() > 0 )
-            {
-                m_pcbEditorFrame->SetMsgPanel( markers.back() );
-                delete  markers.back();
-                markers.pop_back();
-            }
-        }
-        else
-        {
-            BOARD_COMMIT commit( m_pcbEditorFrame );
-
-            for( auto marker : markers )
-                commit.Add( marker );
-
-            commit.Push( wxEmptyString, false, false );
-        }
+        addMarkersToPcb( markers );
     };
 
     // Returns false if we should return false from call site, or true to continue
@@ -345,69 +367,62 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     dummypad.SetLayerSet( LSET::AllCuMask() );     // Ensure the hole is on all layers
 
     // Compute the min distance to pads
-    if( testPads )
+    for( D_PAD** it = aPadStart; it != aPadEnd; ++it )
     {
-        unsigned pad_count = m_pcb->GetPadCount();
+        D_PAD* pad = *it;
+        SEG padSeg( pad->GetPosition(), pad->GetPosition() );
 
-        auto pads = m_pcb->GetPads();
 
-        for( unsigned ii = 0; ii < pad_count; ++ii )
+        /* No problem if pads are on another layer,
+         * But if a drill hole exists	(a pad on a single layer can have a hole!)
+         * we must test the hole
+         */
+        if( !( pad->GetLayerSet() & layerMask ).any() )
         {
-            D_PAD* pad = pads[ii];
-            SEG padSeg( pad->GetPosition(), pad->GetPosition() );
-
-
-            /* No problem if pads are on another layer,
-             * But if a drill hole exists	(a pad on a single layer can have a hole!)
-             * we must test the hole
+            /* We must test the pad hole. In order to use the function
+             * checkClearanceSegmToPad(),a pseudo pad is used, with a shape and a
+             * size like the hole
              */
-            if( !( pad->GetLayerSet() & layerMask ).any() )
-            {
-                /* We must test the pad hole. In order to use the function
-                 * checkClearanceSegmToPad(),a pseudo pad is used, with a shape and a
-                 * size like the hole
-                 */
-                if( pad->GetDrillSize().x == 0 )
-                    continue;
-
-                dummypad.SetSize( pad->GetDrillSize() );
-                dummypad.SetPosition( pad->GetPosition() );
-                dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_SHAPE_OBLONG ?
-                                   PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
-                dummypad.SetOrientation( pad->GetOrientation() );
-
-                m_padToTestPos = dummypad.GetPosition() - origin;
-
-                if( !checkClearanceSegmToPad( &dummypad, aRefSeg->GetWidth(),
-                                              netclass->GetClearance() ) )
-                {
-                    markers.push_back( newMarker( aRefSeg, pad, padSeg,
-                                                  DRCE_TRACK_NEAR_THROUGH_HOLE ) );
-
-                    if( !handleNewMarker() )
-                        return false;
-                }
-
+            if( pad->GetDrillSize().x == 0 )
                 continue;
-            }
 
-            // The pad must be in a net (i.e pt_pad->GetNet() != 0 )
-            // but no problem if the pad netcode is the current netcode (same net)
-            if( pad->GetNetCode()                       // the pad must be connected
-               && net_code_ref == pad->GetNetCode() )   // the pad net is the same as current net -> Ok
-                continue;
+            dummypad.SetSize( pad->GetDrillSize() );
+            dummypad.SetPosition( pad->GetPosition() );
+            dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_SHAPE_OBLONG ?
+                               PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
+            dummypad.SetOrientation( pad->GetOrientation() );
 
-            // DRC for the pad
-            shape_pos = pad->ShapePos();
-            m_padToTestPos = shape_pos - origin;
+            m_padToTestPos = dummypad.GetPosition() - origin;
 
-            if( !checkClearanceSegmToPad( pad, aRefSeg->GetWidth(), aRefSeg->GetClearance( pad ) ) )
+            if( !checkClearanceSegmToPad( &dummypad, aRefSeg->GetWidth(),
+                                          netclass->GetClearance() ) )
             {
-                markers.push_back( newMarker( aRefSeg, pad, padSeg, DRCE_TRACK_NEAR_PAD ) );
+                markers.push_back( newMarker( aRefSeg, pad, padSeg,
+                                              DRCE_TRACK_NEAR_THROUGH_HOLE ) );
 
                 if( !handleNewMarker() )
                     return false;
             }
+
+            continue;
+        }
+
+        // The pad must be in a net (i.e pt_pad->GetNet() != 0 )
+        // but no problem if the pad netcode is the current netcode (same net)
+        if( pad->GetNetCode()                       // the pad must be connected
+           && net_code_ref == pad->GetNetCode() )   // the pad net is the same as current net -> Ok
+            continue;
+
+        // DRC for the pad
+        shape_pos = pad->ShapePos();
+        m_padToTestPos = shape_pos - origin;
+
+        if( !checkClearanceSegmToPad( pad, aRefSeg->GetWidth(), aRefSeg->GetClearance( pad ) ) )
+        {
+            markers.push_back( newMarker( aRefSeg, pad, padSeg, DRCE_TRACK_NEAR_PAD ) );
+
+            if( !handleNewMarker() )
+                return false;
         }
     }
 
@@ -421,8 +436,10 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     wxPoint segStartPoint;
     wxPoint segEndPoint;
 
-    for( track = aStart; track; track = track->Next() )
+    for( TRACK** it = aTrackStart; it != aTrackEnd; ++it )
     {
+        TRACK* track = *it;
+
         // No problem if segments have the same net code:
         if( net_code_ref == track->GetNetCode() )
             continue;
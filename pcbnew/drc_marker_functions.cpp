@@ -84,7 +84,7 @@ MARKER_PCB* DRC::newMarker( TRACK* aTrack, ZONE_CONTAINER* aConflictZone, int aE
         markerPos = pt1;
     }
 
-    return new MARKER_PCB( m_pcbEditorFrame->GetUserUnits(), aErrorCode, markerPos,
+    return new MARKER_PCB( userUnits(), aErrorCode, markerPos,
                            aTrack, aTrack->GetPosition(),
                            aConflictZone, aConflictZone->GetPosition() );
 }
@@ -109,7 +109,7 @@ MARKER_PCB* DRC::newMarker( TRACK* aTrack, BOARD_ITEM* aConflitItem, const SEG&
     // Once we're within EPSILON pt1 and pt2 are "equivalent"
     markerPos = pt1;
 
-    return new MARKER_PCB( m_pcbEditorFrame->GetUserUnits(), aErrorCode, markerPos,
+    return new MARKER_PCB( userUnits(), aErrorCode, markerPos,
                            aTrack, aTrack->GetPosition(),
                            aConflitItem, aConflitItem->GetPosition() );
 }
@@ -117,7 +117,7 @@ MARKER_PCB* DRC::newMarker( TRACK* aTrack, BOARD_ITEM* aConflitItem, const SEG&
 
 MARKER_PCB* DRC::newMarker( D_PAD* aPad, BOARD_ITEM* aConflictItem, int aErrorCode )
 {
-    return new MARKER_PCB( m_pcbEditorFrame->GetUserUnits(), aErrorCode, aPad->GetPosition(),
+    return new MARKER_PCB( userUnits(), aErrorCode, aPad->GetPosition(),
                            aPad, aPad->GetPosition(),
                            aConflictItem, aConflictItem->GetPosition() );
 }
@@ -125,7 +125,7 @@ MARKER_PCB* DRC::newMarker( D_PAD* aPad, BOARD_ITEM* aConflictItem, int aErrorCo
 
 MARKER_PCB* DRC::newMarker(const wxPoint &aPos, BOARD_ITEM *aItem, int aErrorCode )
 {
-    return new MARKER_PCB( m_pcbEditorFrame->GetUserUnits(), aErrorCode, aPos,
+    return new MARKER_PCB( userUnits(), aErrorCode, aPos,
                            aItem, aItem->GetPosition(), nullptr, wxPoint() );
 }
 
@@ -133,7 +133,7 @@ MARKER_PCB* DRC::newMarker(const wxPoint &aPos, BOARD_ITEM *aItem, int aErrorCod
 MARKER_PCB* DRC::newMarker( const wxPoint &aPos, BOARD_ITEM* aItem, BOARD_ITEM* bItem,
                             int aErrorCode )
 {
-    return new MARKER_PCB( m_pcbEditorFrame->GetUserUnits(), aErrorCode, aPos,
+    return new MARKER_PCB( userUnits(), aErrorCode, aPos,
                            aItem, aItem->GetPosition(), bItem, bItem->GetPosition() );
 }
 
@@ -0,0 +1,152 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DRC_RTREE_H
+#define DRC_RTREE_H
+
+#include <vector>
+#include <algorithm>
+
+#include <eda_rect.h>
+#include <geometry/rtree.h>
+
+
+/**
+ * Class DRC_RTREE -
+ * Implements an R-tree of board items used by the DRC to find the candidate pairs
+ * of a clearance test.  Each item is stored with its bounding box inflated by a fixed
+ * margin (usually the largest clearance on the board), so a query with the bounding box
+ * of a reference item returns every item which could violate the clearance.
+ *
+ * Items are numbered in insertion order and queries return these numbers sorted, so the
+ * callers can visit the candidates in the same order as the board lists they come from.
+ * The numbers of the removed items are given to the next inserted ones.
+ * Non-owning.
+ */
+template< class T >
+class DRC_RTREE
+{
+public:
+
+    DRC_RTREE( int aMargin = 0 ) :
+        m_margin( aMargin )
+    {
+    }
+
+    /**
+     * Function Insert()
+     * Inserts an item into the tree.
+     * @param aItem is the item to store.
+     * @param aBBox is the bounding box of the item, before inflating by the tree margin.
+     * @return the sequence number of the item.
+     */
+    int Insert( T aItem, const EDA_RECT& aBBox )
+    {
+        const BOX   box = { { aBBox.GetX() - m_margin, aBBox.GetY() - m_margin },
+                            { aBBox.GetRight() + m_margin, aBBox.GetBottom() + m_margin } };
+        int         index;
+
+        if( m_freeIndices.empty() )
+        {
+            index = (int) m_items.size();
+            m_items.push_back( aItem );
+            m_boxes.push_back( box );
+        }
+        else
+        {
+            index = m_freeIndices.back();
+            m_freeIndices.pop_back();
+            m_items[index] = aItem;
+            m_boxes[index] = box;
+        }
+
+        m_tree.Insert( box.mmin, box.mmax, index );
+
+        return index;
+    }
+
+    /**
+     * Function Remove()
+     * Removes an item from the tree.
+     * @param aIndex is the sequence number returned by Insert() for the item.
+     */
+    void Remove( int aIndex )
+    {
+        const BOX& box = m_boxes[aIndex];
+
+        m_tree.Remove( box.mmin, box.mmax, aIndex );
+        m_items[aIndex] = T();
+        m_freeIndices.push_back( aIndex );
+    }
+
+    /**
+     * Function Query()
+     * Collects the sequence numbers of all the items whose inflated bounding box
+     * intersects aBounds, in ascending order.
+     * The tree is not modified, so it is safe to query it from several threads as long
+     * as nobody is inserting at the same time.
+     */
+    void Query( const EDA_RECT& aBounds, std::vector<int>& aResult ) const
+    {
+        const int   mmin[2] = { aBounds.GetX(), aBounds.GetY() };
+        const int   mmax[2] = { aBounds.GetRight(), aBounds.GetBottom() };
+
+        aResult.clear();
+
+        m_tree.Search( mmin, mmax, [&aResult]( const int& aIndex ) -> bool
+                {
+                    aResult.push_back( aIndex );
+                    return true;
+                } );
+
+        std::sort( aResult.begin(), aResult.end() );
+    }
+
+    T GetItem( int aIndex ) const
+    {
+        return m_items[aIndex];
+    }
+
+    int GetCount() const
+    {
+        return (int) m_items.size();
+    }
+
+private:
+
+    ///> Inflated bounding box of an item, as stored in the tree
+    struct BOX
+    {
+        int mmin[2];
+        int mmax[2];
+    };
+
+    int                         m_margin;
+    RTree<int, int, 2, double>  m_tree;
+    std::vector<T>              m_items;
+    std::vector<BOX>            m_boxes;
+    std::vector<int>            m_freeIndices;
+};
+
+
+#endif  // DRC_RTREE_H
@@ -40,9 +40,9 @@
 #include <confirm.h>
 
 #include <gal/graphics_abstraction_layer.h>
+#include <thread_pool.h>
 
 #include <functional>
-#include <thread>
 using namespace std::placeholders;
 
 const LAYER_NUM GAL_LAYER_ORDER[] =
@@ -102,6 +102,9 @@ const LAYER_NUM GAL_LAYER_ORDER[] =
     LAYER_WORKSHEET
 };
 
+///> Pads, vias and footprint texts smaller than this on screen (in pixels) are not drawn one by one
+static const double LOD_THRESHOLD_PIXELS = 2.0;
+
 
 PCB_DRAW_PANEL_GAL::PCB_DRAW_PANEL_GAL( wxWindow* aParentWindow, wxWindowID aWindowId,
                                         const wxPoint& aPosition, const wxSize& aSize,
@@ -146,20 +149,16 @@ void PCB_DRAW_PANEL_GAL::DisplayBoard( BOARD* aBoard )
 
     auto zones = aBoard->Zones();
     std::atomic<size_t> next( 0 );
-    std::atomic<size_t> count_done( 0 );
-    size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+    TASK_GROUP tasks;
+    size_t parallelThreadCount = tasks.GetThreadCount();
 
     for( size_t ii = 0; ii < parallelThreadCount; ++ii )
     {
-        std::thread t = std::thread( [ &count_done, &next, &zones ]( )
+        tasks.Run( [ &next, &zones ]( )
         {
             for( size_t i = next.fetch_add( 1 ); i < zones.size(); i = next.fetch_add( 1 ) )
                 zones[i]->CacheTriangulation();
-
-            count_done++;
         } );
-
-        t.detach();
     }
 
     if( m_worksheet )
@@ -188,8 +187,7 @@ void PCB_DRAW_PANEL_GAL::DisplayBoard( BOARD* aBoard )
     }
 
     // Finalize the triangulation threads
-    while( count_done < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    tasks.Wait();
 
     // Load zones
     for( auto zone : aBoard->Zones() )
@@ -408,13 +406,19 @@ void PCB_DRAW_PANEL_GAL::OnShow()
 
 
 void PCB_DRAW_PANEL_GAL::setDefaultLayerOrder()
+{
+    SetDefaultLayerOrder( m_view );
+}
+
+
+void PCB_DRAW_PANEL_GAL::SetDefaultLayerOrder( KIGFX::VIEW* aView )
 {
     for( LAYER_NUM i = 0; (unsigned) i < sizeof( GAL_LAYER_ORDER ) / sizeof( LAYER_NUM ); ++i )
     {
         LAYER_NUM layer = GAL_LAYER_ORDER[i];
         wxASSERT( layer < KIGFX::VIEW::VIEW_MAX_LAYERS );
 
-        m_view->SetLayerOrder( layer, i );
+        aView->SetLayerOrder( layer, i );
     }
 }
 
@@ -447,10 +451,16 @@ BOX2I PCB_DRAW_PANEL_GAL::GetDefaultViewBBox() const
 void PCB_DRAW_PANEL_GAL::setDefaultLayerDeps()
 {
     // caching makes no sense for Cairo and other software renderers
-    auto target = m_backend == GAL_TYPE_OPENGL ? KIGFX::TARGET_CACHED : KIGFX::TARGET_NONCACHED;
+    SetDefaultLayerDeps( m_view, m_backend == GAL_TYPE_OPENGL );
+}
+
+
+void PCB_DRAW_PANEL_GAL::SetDefaultLayerDeps( KIGFX::VIEW* aView, bool aCached )
+{
+    auto target = aCached ? KIGFX::TARGET_CACHED : KIGFX::TARGET_NONCACHED;
 
     for( int i = 0; i < KIGFX::VIEW::VIEW_MAX_LAYERS; i++ )
-        m_view->SetLayerTarget( i, target );
+        aView->SetLayerTarget( i, target );
 
     for( LAYER_NUM i = 0; (unsigned) i < sizeof( GAL_LAYER_ORDER ) / sizeof( LAYER_NUM ); ++i )
     {
@@ -459,42 +469,51 @@ void PCB_DRAW_PANEL_GAL::setDefaultLayerDeps()
 
         // Set layer display dependencies & targets
         if( IsCopperLayer( layer ) )
-            m_view->SetRequired( GetNetnameLayer( layer ), layer );
+            aView->SetRequired( GetNetnameLayer( layer ), layer );
         else if( IsNetnameLayer( layer ) )
-            m_view->SetLayerDisplayOnly( layer );
+            aView->SetLayerDisplayOnly( layer );
     }
 
-    m_view->SetLayerTarget( LAYER_ANCHOR, KIGFX::TARGET_NONCACHED );
-    m_view->SetLayerDisplayOnly( LAYER_ANCHOR );
+    aView->SetLayerTarget( LAYER_ANCHOR, KIGFX::TARGET_NONCACHED );
+    aView->SetLayerDisplayOnly( LAYER_ANCHOR );
 
     // Some more required layers settings
-    m_view->SetRequired( LAYER_VIAS_HOLES, LAYER_VIA_THROUGH );
-    m_view->SetRequired( LAYER_VIAS_NETNAMES, LAYER_VIA_THROUGH );
-    m_view->SetRequired( LAYER_PADS_PLATEDHOLES, LAYER_PADS_TH );
-    m_view->SetRequired( LAYER_NON_PLATEDHOLES, LAYER_PADS_TH );
-    m_view->SetRequired( LAYER_PADS_NETNAMES, LAYER_PADS_TH );
+    aView->SetRequired( LAYER_VIAS_HOLES, LAYER_VIA_THROUGH );
+    aView->SetRequired( LAYER_VIAS_NETNAMES, LAYER_VIA_THROUGH );
+    aView->SetRequired( LAYER_PADS_PLATEDHOLES, LAYER_PADS_TH );
+    aView->SetRequired( LAYER_NON_PLATEDHOLES, LAYER_PADS_TH );
+    aView->SetRequired( LAYER_PADS_NETNAMES, LAYER_PADS_TH );
 
     // Front modules
-    m_view->SetRequired( LAYER_PAD_FR, F_Cu );
-    m_view->SetRequired( LAYER_MOD_TEXT_FR, LAYER_MOD_FR );
-    m_view->SetRequired( LAYER_PAD_FR_NETNAMES, LAYER_PAD_FR );
+    aView->SetRequired( LAYER_PAD_FR, F_Cu );
+    aView->SetRequired( LAYER_MOD_TEXT_FR, LAYER_MOD_FR );
+    aView->SetRequired( LAYER_PAD_FR_NETNAMES, LAYER_PAD_FR );
 
     // Back modules
-    m_view->SetRequired( LAYER_PAD_BK, B_Cu );
-    m_view->SetRequired( LAYER_MOD_TEXT_BK, LAYER_MOD_BK );
-    m_view->SetRequired( LAYER_PAD_BK_NETNAMES, LAYER_PAD_BK );
-
-    m_view->SetLayerTarget( LAYER_SELECT_OVERLAY , KIGFX::TARGET_OVERLAY );
-    m_view->SetLayerDisplayOnly( LAYER_SELECT_OVERLAY ) ;
-    m_view->SetLayerTarget( LAYER_GP_OVERLAY , KIGFX::TARGET_OVERLAY );
-    m_view->SetLayerDisplayOnly( LAYER_GP_OVERLAY ) ;
-    m_view->SetLayerTarget( LAYER_RATSNEST, KIGFX::TARGET_OVERLAY );
-    m_view->SetLayerDisplayOnly( LAYER_RATSNEST );
-
-    m_view->SetLayerTarget( LAYER_WORKSHEET, KIGFX::TARGET_NONCACHED );
-    m_view->SetLayerDisplayOnly( LAYER_WORKSHEET ) ;
-    m_view->SetLayerDisplayOnly( LAYER_GRID );
-    m_view->SetLayerDisplayOnly( LAYER_DRC );
+    aView->SetRequired( LAYER_PAD_BK, B_Cu );
+    aView->SetRequired( LAYER_MOD_TEXT_BK, LAYER_MOD_BK );
+    aView->SetRequired( LAYER_PAD_BK_NETNAMES, LAYER_PAD_BK );
+
+    // Zoomed out, the tiny pads, vias and footprint texts are drawn as blocks, and their holes
+    // are not drawn at all
+    for( int layer : { LAYER_PAD_FR, LAYER_PAD_BK, LAYER_PADS_TH, LAYER_VIA_THROUGH,
+                       LAYER_VIA_BBLIND, LAYER_VIA_MICROVIA, LAYER_MOD_TEXT_FR, LAYER_MOD_TEXT_BK } )
+        aView->SetLayerLODThreshold( layer, LOD_THRESHOLD_PIXELS );
+
+    for( int layer : { LAYER_VIAS_HOLES, LAYER_PADS_PLATEDHOLES, LAYER_NON_PLATEDHOLES } )
+        aView->SetLayerLODThreshold( layer, LOD_THRESHOLD_PIXELS, false );
+
+    aView->SetLayerTarget( LAYER_SELECT_OVERLAY , KIGFX::TARGET_OVERLAY );
+    aView->SetLayerDisplayOnly( LAYER_SELECT_OVERLAY ) ;
+    aView->SetLayerTarget( LAYER_GP_OVERLAY , KIGFX::TARGET_OVERLAY );
+    aView->SetLayerDisplayOnly( LAYER_GP_OVERLAY ) ;
+    aView->SetLayerTarget( LAYER_RATSNEST, KIGFX::TARGET_OVERLAY );
+    aView->SetLayerDisplayOnly( LAYER_RATSNEST );
+
+    aView->SetLayerTarget( LAYER_WORKSHEET, KIGFX::TARGET_NONCACHED );
+    aView->SetLayerDisplayOnly( LAYER_WORKSHEET ) ;
+    aView->SetLayerDisplayOnly( LAYER_GRID );
+    aView->SetLayerDisplayOnly( LAYER_DRC );
 }
 
 
@@ -107,6 +107,20 @@ public:
     ///> @copydoc EDA_DRAW_PANEL_GAL::GetDefaultViewBBox()
     BOX2I GetDefaultViewBBox() const override;
 
+    /**
+     * Function SetDefaultLayerOrder
+     * applies the board layer order of the draw panel to any view, e.g. one drawing
+     * a board without a window.
+     */
+    static void SetDefaultLayerOrder( KIGFX::VIEW* aView );
+
+    /**
+     * Function SetDefaultLayerDeps
+     * applies the board layer targets & dependencies of the draw panel to any view.
+     * @param aCached tells if the board layers are cached, which makes sense only with OpenGL.
+     */
+    static void SetDefaultLayerDeps( KIGFX::VIEW* aView, bool aCached );
+
 protected:
 
     KIGFX::PCB_VIEW* view() const;
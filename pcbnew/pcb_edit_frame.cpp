@@ -1004,6 +1004,10 @@ void PCB_EDIT_FRAME::OnModify( )
     Update3DView();
 
     m_ZoneFillsDirty = true;
+
+    // The legacy tools modify the board without a commit, which the DRC does not see
+    if( !IsGalCanvasActive() )
+        m_drc->InvalidateIndex();
 }
 
 
@@ -281,6 +281,26 @@ int PCB_PAINTER::getLineThickness( int aActualThickness ) const
 }
 
 
+int PCB_PAINTER::getTextThickness( const TEXTE_PCB* aText, int aLayer ) const
+{
+    if( m_pcbSettings.m_sketchMode[aLayer] )
+        return m_pcbSettings.m_outlineWidth;       // Outline mode
+
+    return getLineThickness( aText->GetThickness() );   // Filled mode
+}
+
+
+int PCB_PAINTER::getTextThickness( const TEXTE_MODULE* aText ) const
+{
+    // Currently, draw text routines do not know the true outline mode.
+    // so draw the text in "line" mode (no thickness)
+    if( m_pcbSettings.m_sketchFpTxtfx )
+        return m_pcbSettings.m_outlineWidth;       // Outline mode
+
+    return getLineThickness( aText->GetThickness() );   // Filled mode
+}
+
+
 int PCB_PAINTER::getDrillShape( const D_PAD* aPad ) const
 {
     return aPad->GetDrillShape();
@@ -364,6 +384,175 @@ bool PCB_PAINTER::Draw( const VIEW_ITEM* aItem, int aLayer )
 }
 
 
+void PCB_PAINTER::PrepareItem( VIEW_ITEM* aItem )
+{
+    EDA_ITEM* item = dynamic_cast<EDA_ITEM*>( aItem );
+
+    if( !item )
+        return;
+
+    switch( item->Type() )
+    {
+    case PCB_TEXT_T:
+    {
+        TEXTE_PCB* text = static_cast<TEXTE_PCB*>( item );
+        int layer = text->GetLayer();
+
+        prepareText( text, text, layer, text->GetTextAngleRadians(),
+                     getTextThickness( text, layer ) );
+        break;
+    }
+
+    case PCB_MODULE_TEXT_T:
+    {
+        TEXTE_MODULE* text = static_cast<TEXTE_MODULE*>( item );
+        int layer = text->IsVisible() ? text->GetLayer() : LAYER_MOD_TEXT_INVISIBLE;
+
+        prepareText( text, text, layer, text->GetDrawRotationRadians(),
+                     getTextThickness( text ) );
+        break;
+    }
+
+    case PCB_LINE_T:
+    case PCB_MODULE_EDGE_T:
+    {
+        DRAWSEGMENT* segment = static_cast<DRAWSEGMENT*>( item );
+
+        if( segment->GetShape() == S_ARC )
+            prepareArc( segment );
+
+        // Only OpenGL draws the polygons from their triangulation
+        if( segment->GetShape() != S_POLYGON || !m_gal->IsOpenGlEngine() )
+            break;
+
+        SHAPE_POLY_SET& shape = segment->GetPolyShape();
+
+        if( shape.OutlineCount() > 0 && !shape.IsTriangulationUpToDate() )
+            shape.CacheTriangulation();
+
+        break;
+    }
+
+    case PCB_ZONE_AREA_T:
+    {
+        if( !m_gal->IsOpenGlEngine() )
+            break;
+
+        ZONE_CONTAINER* zone = static_cast<ZONE_CONTAINER*>( item );
+        const SHAPE_POLY_SET& polySet = zone->GetFilledPolysList();
+
+        // Without up to date triangles, the GAL falls back to the much slower tesselation
+        // of the outlines
+        if( polySet.OutlineCount() > 0 && !polySet.IsTriangulationUpToDate() )
+            zone->CacheTriangulation();
+
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+
+void PCB_PAINTER::ReleasePreparedItems()
+{
+    m_preparedStrokes.clear();
+}
+
+
+void PCB_PAINTER::prepareText( const EDA_ITEM* aItem, const EDA_TEXT* aText, int aLayer,
+                               double aRotation, int aLineWidth )
+{
+    wxString shownText( aText->GetShownText() );
+
+    if( shownText.Length() == 0 )
+        return;
+
+    STROKE_TEXT_ATTRIBUTES attributes;
+
+    attributes.m_glyphSize = VECTOR2D( aText->GetTextSize() );
+    attributes.m_horizontalJustify = aText->GetHorizJustify();
+    attributes.m_verticalJustify = aText->GetVertJustify();
+    attributes.m_bold = aText->IsBold();
+    attributes.m_italic = aText->IsItalic();
+    attributes.m_mirrored = aText->IsMirrored();
+    attributes.m_lineWidth = aLineWidth;
+
+    PREPARED_STROKES prepared;
+
+    prepared.m_layer = aLayer;
+    m_gal->GetStrokeFont().GetStrokes( shownText, VECTOR2D( aText->GetTextPos() ), aRotation,
+                                       attributes, prepared.m_strokes );
+
+    std::lock_guard<std::mutex> lock( m_preparedStrokesLock );
+    m_preparedStrokes[aItem] = std::move( prepared );
+}
+
+
+void PCB_PAINTER::prepareArc( const DRAWSEGMENT* aSegment )
+{
+    bool sketch = ( aSegment->Type() == PCB_LINE_T && m_pcbSettings.m_sketchBoardGfx )
+        || ( aSegment->Type() == PCB_MODULE_EDGE_T && m_pcbSettings.m_sketchFpGfx );
+    double radius = aSegment->GetRadius();
+
+    // Only the filled arcs the GAL splits into segments are worth preparing
+    if( sketch || radius <= 0 )
+        return;
+
+    const double alphaIncrement = m_gal->GetArcAngleStep( radius );
+
+    if( alphaIncrement <= 0.0 )
+        return;
+
+    VECTOR2D center( aSegment->GetStart() );
+    double startAngle = DECIDEG2RAD( aSegment->GetArcAngleStart() );
+    double endAngle = DECIDEG2RAD( aSegment->GetArcAngleStart() + aSegment->GetAngle() );
+
+    // Same points as GAL::DrawArcSegment()
+    SWAP( startAngle, >, endAngle );
+
+    PREPARED_STROKES prepared;
+    std::vector<VECTOR2D>& points = prepared.m_strokes.m_points;
+    double alpha;
+
+    prepared.m_layer = aSegment->GetLayer();
+    prepared.m_strokes.m_lineWidth = getLineThickness( aSegment->GetWidth() );
+    points.emplace_back( center + VECTOR2D( cos( startAngle ), sin( startAngle ) ) * radius );
+
+    for( alpha = startAngle + alphaIncrement; alpha <= endAngle; alpha += alphaIncrement )
+        points.emplace_back( center + VECTOR2D( cos( alpha ), sin( alpha ) ) * radius );
+
+    if( alpha != endAngle )
+        points.emplace_back( center + VECTOR2D( cos( endAngle ), sin( endAngle ) ) * radius );
+
+    prepared.m_strokes.m_polylineEnds.push_back( points.size() );
+
+    std::lock_guard<std::mutex> lock( m_preparedStrokesLock );
+    m_preparedStrokes[aSegment] = std::move( prepared );
+}
+
+
+bool PCB_PAINTER::drawPreparedStrokes( const EDA_ITEM* aItem, int aLayer )
+{
+    PREPARED_STROKES prepared;
+
+    {
+        std::lock_guard<std::mutex> lock( m_preparedStrokesLock );
+        auto it = m_preparedStrokes.find( aItem );
+
+        if( it == m_preparedStrokes.end() || it->second.m_layer != aLayer )
+            return false;
+
+        prepared = std::move( it->second );
+        m_preparedStrokes.erase( it );
+    }
+
+    m_gal->DrawStrokes( prepared.m_strokes );
+    return true;
+}
+
+
 void PCB_PAINTER::draw( const TRACK* aTrack, int aLayer )
 {
     VECTOR2D start( aTrack->GetStart() );
@@ -937,6 +1126,9 @@ void PCB_PAINTER::draw( const DRAWSEGMENT* aSegment, int aLayer )
         break;
 
     case S_ARC:
+        if( drawPreparedStrokes( aSegment, aLayer ) )
+            break;
+
         m_gal->DrawArcSegment( start, aSegment->GetRadius(),
                         DECIDEG2RAD( aSegment->GetArcAngleStart() ),
                         DECIDEG2RAD( aSegment->GetArcAngleStart() + aSegment->GetAngle() ),
@@ -1018,20 +1210,14 @@ void PCB_PAINTER::draw( const TEXTE_PCB* aText, int aLayer )
     const COLOR4D& color = m_pcbSettings.GetColor( aText, aText->GetLayer() );
     VECTOR2D position( aText->GetTextPos().x, aText->GetTextPos().y );
 
-    if( m_pcbSettings.m_sketchMode[aLayer] )
-    {
-        // Outline mode
-        m_gal->SetLineWidth( m_pcbSettings.m_outlineWidth );
-    }
-    else
-    {
-        // Filled mode
-        m_gal->SetLineWidth( getLineThickness( aText->GetThickness() ) );
-    }
-
     m_gal->SetStrokeColor( color );
     m_gal->SetIsFill( false );
     m_gal->SetIsStroke( true );
+
+    if( drawPreparedStrokes( aText, aLayer ) )
+        return;
+
+    m_gal->SetLineWidth( getTextThickness( aText, aLayer ) );
     m_gal->SetTextAttributes( aText );
     m_gal->StrokeText( shownText, position, aText->GetTextAngleRadians() );
 }
@@ -1043,29 +1229,19 @@ void PCB_PAINTER::draw( const TEXTE_MODULE* aText, int aLayer )
     if( shownText.Length() == 0 )
         return;
 
-    bool sketch = m_pcbSettings.m_sketchFpTxtfx;
-
     const COLOR4D& color = m_pcbSettings.GetColor( aText, aLayer );
     VECTOR2D position( aText->GetTextPos().x, aText->GetTextPos().y );
 
-    // Currently, draw text routines do not know the true outline mode.
-    // so draw the text in "line" mode (no thickness)
-    if( sketch )
-    {
-        // Outline mode
-        m_gal->SetLineWidth( m_pcbSettings.m_outlineWidth );
-    }
-    else
-    {
-        // Filled mode
-        m_gal->SetLineWidth( getLineThickness( aText->GetThickness() ) );
-    }
-
     m_gal->SetStrokeColor( color );
     m_gal->SetIsFill( false );
     m_gal->SetIsStroke( true );
-    m_gal->SetTextAttributes( aText );
-    m_gal->StrokeText( shownText, position, aText->GetDrawRotationRadians() );
+
+    if( !drawPreparedStrokes( aText, aLayer ) )
+    {
+        m_gal->SetLineWidth( getTextThickness( aText ) );
+        m_gal->SetTextAttributes( aText );
+        m_gal->StrokeText( shownText, position, aText->GetDrawRotationRadians() );
+    }
 
     // Draw the umbilical line
     if( aText->IsSelected() )
@@ -28,8 +28,11 @@
 #define __CLASS_PCB_PAINTER_H
 
 #include <painter.h>
+#include <gal/stroke_font.h>
 
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 
 class EDA_ITEM;
@@ -228,9 +231,26 @@ public:
     /// @copydoc PAINTER::Draw()
     virtual bool Draw( const VIEW_ITEM* aItem, int aLayer ) override;
 
+    /// @copydoc PAINTER::PrepareItem()
+    virtual void PrepareItem( VIEW_ITEM* aItem ) override;
+
+    /// @copydoc PAINTER::ReleasePreparedItems()
+    virtual void ReleasePreparedItems() override;
+
 protected:
+    ///> Strokes of an item computed by PrepareItem(), for the layer it is drawn on
+    struct PREPARED_STROKES
+    {
+        int              m_layer;
+        STROKE_POLYLINES m_strokes;
+    };
+
     PCB_RENDER_SETTINGS m_pcbSettings;
 
+    ///> Texts and arcs laid out by PrepareItem(), waiting to be drawn
+    std::unordered_map<const EDA_ITEM*, PREPARED_STROKES> m_preparedStrokes;
+    std::mutex m_preparedStrokesLock;
+
     // Drawing functions for various types of PCB-specific items
     void draw( const TRACK* aTrack, int aLayer );
     void draw( const VIA* aVia, int aLayer );
@@ -253,6 +273,38 @@ protected:
      */
     int getLineThickness( int aActualThickness ) const;
 
+    /**
+     * Function getTextThickness()
+     * Get the thickness to draw the strokes of a text with on a given layer.
+     */
+    int getTextThickness( const TEXTE_PCB* aText, int aLayer ) const;
+    int getTextThickness( const TEXTE_MODULE* aText ) const;
+
+    /**
+     * Function prepareText()
+     * Lays out a text for draw() and keeps its strokes until it is drawn.
+     * @param aItem is the text item.
+     * @param aText is its text.
+     * @param aLayer is the layer it is drawn on.
+     * @param aRotation is its drawn rotation, in radians.
+     * @param aLineWidth is the width of its strokes.
+     */
+    void prepareText( const EDA_ITEM* aItem, const EDA_TEXT* aText, int aLayer,
+                      double aRotation, int aLineWidth );
+
+    /**
+     * Function prepareArc()
+     * Splits an arc into the segments the GAL draws it with and keeps them until it is drawn.
+     */
+    void prepareArc( const DRAWSEGMENT* aSegment );
+
+    /**
+     * Function drawPreparedStrokes()
+     * Draws the strokes prepared for an item, if any were for the given layer.
+     * @return true if the item was drawn.
+     */
+    bool drawPreparedStrokes( const EDA_ITEM* aItem, int aLayer );
+
     /**
      * Return drill shape of a pad.
      */
@@ -679,7 +679,7 @@ void PlotLayerOutlines( BOARD* aBoard, PLOTTER* aPlotter,
         outlines.RemoveAllContours();
         aBoard->ConvertBrdLayerToPolygonalContours( layer, outlines );
 
-        outlines.Simplify( SHAPE_POLY_SET::PM_FAST );
+        outlines.SimplifyParallel( SHAPE_POLY_SET::PM_FAST );
 
         // Plot outlines
         std::vector< wxPoint > cornerList;
@@ -899,7 +899,9 @@ void PlotSolderMaskLayer( BOARD *aBoard, PLOTTER* aPlotter,
     zone.SetMinThickness( 0 );      // trace polygons only
     zone.SetLayer ( layer );
 
-    areas.BooleanAdd( initialPolys, SHAPE_POLY_SET::PM_FAST );
+    // Both sets hold one outline per item, merged across the worker threads
+    areas.Append( initialPolys );
+    areas.SimplifyParallel( SHAPE_POLY_SET::PM_FAST );
     areas.Inflate( -inflate, circleToSegmentsCount );
 
     // Combine the current areas to initial areas. This is mandatory because
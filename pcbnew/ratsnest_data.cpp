@@ -150,19 +150,68 @@ static const std::vector<CN_EDGE> kruskalMST( std::list<CN_EDGE>& aEdges,
 }
 
 
+/**
+ * Class TRIANGULATOR_STATE
+ * keeps the euclidean minimum spanning tree of the distinct node positions of a net between
+ * the updates of its ratsnest.
+ *
+ * The ratsnest is the minimum spanning tree of the nodes once the clusters are contracted.
+ * Each of its lines is a line of the position tree too (a longer line is never needed when
+ * a path of shorter ones exists), so the ratsnest only has to be searched among the n - 1
+ * lines of the position tree, which are independent of the clusters.  Adding or removing
+ * a few nodes only changes the tree locally: the nodes added are joined to their nearest
+ * neighbours, one per 60 degree cone (Yao graph, which contains the spanning tree), and
+ * the pieces left by a removed node are joined again the same way.  The full Delaunay
+ * triangulation is only done when many positions change at once.
+ */
 class RN_NET::TRIANGULATOR_STATE
 {
 private:
+    struct POS_HASH
+    {
+        size_t operator()( const VECTOR2I& aPos ) const
+        {
+            return std::hash<int64_t>()( ( (int64_t) aPos.x << 32 ) ^ (uint32_t) aPos.y );
+        }
+    };
+
+    ///> A line of the position tree, between two sites
+    struct SITE_EDGE
+    {
+        int m_a;
+        int m_b;
+        VECTOR2I::extended_type m_weight;   // squared length
+
+        bool operator<( const SITE_EDGE& aOther ) const
+        {
+            return m_weight < aOther.m_weight;
+        }
+    };
+
+    ///> Number of cones of the Yao graph.  Cones narrower than 60 degrees are required
+    ///> for the Yao graph to contain the spanning tree.
+    static constexpr int YAO_CONES = 6;
+
+    ///> Number of sites a removal can walk through before a full update is cheaper
+    static constexpr size_t MIN_LOCAL_SITES = 32;
+
     std::vector<CN_ANCHOR_PTR>  m_allNodes;
 
-    std::list<hed::EDGE_PTR> hedTriangulation( std::vector<hed::NODE_PTR>& aNodes )
+    ///> Distinct positions of the nodes (sites), may contain removed sites
+    std::vector<VECTOR2I>       m_sites;
+    std::vector<bool>           m_siteAlive;
+    std::vector<int>            m_freeSites;
+    std::unordered_map<VECTOR2I, int, POS_HASH> m_siteIndex;
+
+    ///> Lines of the position tree, sorted by length
+    std::vector<SITE_EDGE>      m_mst;
+
+    static VECTOR2I::extended_type squaredDistance( const VECTOR2I& aA, const VECTOR2I& aB )
     {
-        hed::TRIANGULATION triangulator;
-        triangulator.CreateDelaunay( aNodes.begin(), aNodes.end() );
-        std::list<hed::EDGE_PTR> edges;
-        triangulator.GetEdges( edges );
+        VECTOR2I::extended_type dx = (VECTOR2I::extended_type) aA.x - aB.x;
+        VECTOR2I::extended_type dy = (VECTOR2I::extended_type) aA.y - aB.y;
 
-        return edges;
+        return dx * dx + dy * dy;
     }
 
 
@@ -189,114 +238,404 @@ private:
         return true;
     }
 
-public:
 
-    void Clear()
+    int addSite( const VECTOR2I& aPos )
     {
-        m_allNodes.clear();
+        int site;
+
+        if( m_freeSites.empty() )
+        {
+            site = m_sites.size();
+            m_sites.push_back( aPos );
+            m_siteAlive.push_back( true );
+        }
+        else
+        {
+            site = m_freeSites.back();
+            m_freeSites.pop_back();
+            m_sites[site] = aPos;
+            m_siteAlive[site] = true;
+        }
+
+        m_siteIndex[aPos] = site;
+
+        return site;
     }
 
-    void AddNode( CN_ANCHOR_PTR aNode )
+
+    /**
+     * Replaces the tree with the minimum spanning forest of a list of lines sorted by
+     * length (Kruskal algorithm).
+     */
+    void buildTree( const std::vector<SITE_EDGE>& aSortedEdges )
     {
-        m_allNodes.push_back( aNode );
+        std::vector<int> parent( m_sites.size() );
+
+        for( unsigned i = 0; i < parent.size(); i++ )
+            parent[i] = i;
+
+        auto root = [&parent]( int aSite )
+        {
+            while( parent[aSite] != aSite )
+            {
+                parent[aSite] = parent[ parent[aSite] ];
+                aSite = parent[aSite];
+            }
+
+            return aSite;
+        };
+
+        m_mst.clear();
+
+        for( const auto& edge : aSortedEdges )
+        {
+            int a = root( edge.m_a );
+            int b = root( edge.m_b );
+
+            if( a != b )
+            {
+                parent[a] = b;
+                m_mst.push_back( edge );
+            }
+        }
     }
 
-    const std::list<CN_EDGE> Triangulate()
+
+    /**
+     * Adds to aEdges the lines from a site to the nearest accepted site of each cone around
+     * it.
+     */
+    template <typename ACCEPT>
+    void addYaoEdges( int aSite, ACCEPT aAccept, std::vector<SITE_EDGE>& aEdges ) const
     {
-        std::list<CN_EDGE> mstEdges;
-        std::list<hed::EDGE_PTR> triangEdges;
+        const VECTOR2I& pos = m_sites[aSite];
+        SITE_EDGE nearest[YAO_CONES];
+
+        for( int i = 0; i < YAO_CONES; i++ )
+            nearest[i] = { aSite, -1, VECTOR2I::ECOORD_MAX };
+
+        for( unsigned i = 0; i < m_sites.size(); i++ )
+        {
+            if( (int) i == aSite || !m_siteAlive[i] || !aAccept( i ) )
+                continue;
+
+            const VECTOR2I& other = m_sites[i];
+            double angle = atan2( (double) other.y - pos.y, (double) other.x - pos.x );
+            int cone = (int) ( ( angle + M_PI ) * YAO_CONES / ( 2 * M_PI ) ) % YAO_CONES;
+            auto dist = squaredDistance( pos, other );
+
+            if( dist < nearest[cone].m_weight )
+            {
+                nearest[cone].m_b = i;
+                nearest[cone].m_weight = dist;
+            }
+        }
+
+        for( int i = 0; i < YAO_CONES; i++ )
+        {
+            if( nearest[i].m_b >= 0 )
+                aEdges.push_back( nearest[i] );
+        }
+    }
+
+
+    ///> Builds the tree from scratch with a Delaunay triangulation of the positions.
+    void rebuild( const std::vector<VECTOR2I>& aPositions )
+    {
+        m_sites = aPositions;
+        m_siteAlive.assign( m_sites.size(), true );
+        m_freeSites.clear();
+        m_siteIndex.clear();
+        m_mst.clear();
+
         std::vector<hed::NODE_PTR> triNodes;
+        std::vector<SITE_EDGE> edges;
 
-        using ANCHOR_LIST = std::vector<CN_ANCHOR_PTR>;
-        std::vector<ANCHOR_LIST> anchorChains;
+        triNodes.reserve( m_sites.size() );
 
-        triNodes.reserve( m_allNodes.size() );
-        anchorChains.reserve( m_allNodes.size() );
+        for( unsigned i = 0; i < m_sites.size(); i++ )
+        {
+            auto tn = std::make_shared<hed::NODE>( m_sites[i].x, m_sites[i].y );
 
-        std::sort( m_allNodes.begin(), m_allNodes.end(),
-                [] ( const CN_ANCHOR_PTR& aNode1, const CN_ANCHOR_PTR& aNode2 )
+            tn->SetId( i );
+            triNodes.push_back( tn );
+            m_siteIndex[ m_sites[i] ] = i;
+        }
+
+        if( triNodes.size() < 2 )
+            return;
+
+        // The positions are sorted by y, then x, and so are the nodes along a line
+        if( areNodesColinear( triNodes ) )
         {
-            if( aNode1->Pos().y < aNode2->Pos().y )
-                return true;
-            else if( aNode1->Pos().y == aNode2->Pos().y )
+            // special case: all nodes are on the same line - there's no
+            // triangulation for such set.
+            for( unsigned i = 0; i + 1 < m_sites.size(); i++ )
+                edges.push_back( { (int) i, (int) i + 1, squaredDistance( m_sites[i], m_sites[i + 1] ) } );
+        }
+        else
+        {
+            hed::TRIANGULATION triangulator;
+            std::list<hed::EDGE_PTR> triangEdges;
+
+            triangulator.CreateDelaunay( triNodes.begin(), triNodes.end() );
+            triangulator.GetEdges( triangEdges );
+
+            for( const auto& e : triangEdges )
             {
-                return aNode1->Pos().x < aNode2->Pos().x;
+                int a = e->GetSourceNode()->Id();
+                int b = e->GetTargetNode()->Id();
+
+                edges.push_back( { a, b, squaredDistance( m_sites[a], m_sites[b] ) } );
             }
 
-            return false;
+            std::sort( edges.begin(), edges.end() );
         }
-                );
 
-        CN_ANCHOR_PTR prev, last;
-        int id = 0;
+        buildTree( edges );
+    }
+
+
+    void insertSite( const VECTOR2I& aPos )
+    {
+        int site = addSite( aPos );
+        std::vector<SITE_EDGE> yao;
+        std::vector<SITE_EDGE> edges;
+
+        addYaoEdges( site, []( int ) { return true; }, yao );
+        std::sort( yao.begin(), yao.end() );
+
+        edges.reserve( m_mst.size() + yao.size() );
+        std::merge( m_mst.begin(), m_mst.end(), yao.begin(), yao.end(),
+                    std::back_inserter( edges ) );
+
+        buildTree( edges );
+    }
+
+
+    /**
+     * Removes a site and joins the pieces of the tree again.
+     * @return false if the pieces are too large to be joined locally: the tree is left
+     * invalid and has to be rebuilt.
+     */
+    bool removeSite( int aSite, size_t aAliveCount )
+    {
+        m_siteAlive[aSite] = false;
+        m_siteIndex.erase( m_sites[aSite] );
+        m_freeSites.push_back( aSite );
+
+        std::vector<SITE_EDGE> kept;
+        std::vector<int> component( m_sites.size() );
+        std::vector<int> neighbours;
+
+        kept.reserve( m_mst.size() );
+
+        for( unsigned i = 0; i < component.size(); i++ )
+            component[i] = i;
 
-        for( auto n : m_allNodes )
+        auto root = [&component]( int aSite )
         {
-            anchorChains.push_back( ANCHOR_LIST() );
+            while( component[aSite] != aSite )
+            {
+                component[aSite] = component[ component[aSite] ];
+                aSite = component[aSite];
+            }
+
+            return aSite;
+        };
+
+        for( const auto& edge : m_mst )
+        {
+            if( edge.m_a == aSite || edge.m_b == aSite )
+            {
+                neighbours.push_back( edge.m_a == aSite ? edge.m_b : edge.m_a );
+                continue;
+            }
+
+            kept.push_back( edge );
+            component[ root( edge.m_a ) ] = root( edge.m_b );
         }
 
-        for( auto n : m_allNodes )
+        m_mst.swap( kept );
+
+        // A leaf leaves a single piece
+        if( neighbours.size() < 2 )
+            return true;
+
+        // Only the pieces other than the largest one are searched for their nearest sites
+        std::unordered_map<int, size_t> pieceSizes;
+
+        for( int n : neighbours )
+            pieceSizes[ root( n ) ] = 0;
+
+        for( unsigned i = 0; i < m_sites.size(); i++ )
         {
-            if( !prev || prev->Pos() != n->Pos() )
+            if( m_siteAlive[i] )
             {
-                auto tn = std::make_shared<hed::NODE> ( n->Pos().x, n->Pos().y );
+                auto it = pieceSizes.find( root( i ) );
 
-                tn->SetId( id );
-                triNodes.push_back( tn );
+                if( it != pieceSizes.end() )
+                    it->second++;
             }
+        }
+
+        auto largest = std::max_element( pieceSizes.begin(), pieceSizes.end(),
+                []( const std::pair<const int, size_t>& a, const std::pair<const int, size_t>& b )
+                {
+                    return a.second < b.second;
+                } );
+
+        size_t searched = aAliveCount - largest->second;
+
+        if( searched > MIN_LOCAL_SITES && searched > aAliveCount / 16 )
+            return false;
 
-            id++;
-            prev = n;
+        int largestPiece = largest->first;
+        std::vector<SITE_EDGE> yao;
+
+        for( unsigned i = 0; i < m_sites.size(); i++ )
+        {
+            if( !m_siteAlive[i] )
+                continue;
+
+            int piece = root( i );
+
+            if( piece == largestPiece )
+                continue;
+
+            addYaoEdges( i, [&]( int aOther ) { return root( aOther ) != piece; }, yao );
         }
 
-        int prevId = 0;
+        std::sort( yao.begin(), yao.end() );
+
+        std::vector<SITE_EDGE> edges;
+
+        edges.reserve( m_mst.size() + yao.size() );
+        std::merge( m_mst.begin(), m_mst.end(), yao.begin(), yao.end(),
+                    std::back_inserter( edges ) );
+
+        buildTree( edges );
+
+        return true;
+    }
 
-        for( auto n : triNodes )
+
+    /**
+     * Brings the tree up to date with a new list of distinct positions, sorted by y, then x.
+     */
+    void updateSites( const std::vector<VECTOR2I>& aPositions )
+    {
+        std::unordered_set<VECTOR2I, POS_HASH> current( aPositions.begin(), aPositions.end() );
+        std::vector<int> removed;
+        std::vector<VECTOR2I> added;
+
+        for( const auto& entry : m_siteIndex )
         {
-            for( int i = prevId; i < n->Id(); i++ )
-                anchorChains[prevId].push_back( m_allNodes[ i ] );
+            if( !current.count( entry.first ) )
+                removed.push_back( entry.second );
+        }
 
-            prevId = n->Id();
+        for( const auto& pos : aPositions )
+        {
+            if( !m_siteIndex.count( pos ) )
+                added.push_back( pos );
         }
 
-        for( int i = prevId; i < id; i++ )
-            anchorChains[prevId].push_back( m_allNodes[ i ] );
+        // Each local change walks through all the sites
+        size_t changes = removed.size() + added.size();
+
+        if( changes == 0 )
+            return;
 
-        if( triNodes.size() == 1 )
+        if( changes * 16 > aPositions.size() )
         {
-            return mstEdges;
+            rebuild( aPositions );
+            return;
         }
-        else if( areNodesColinear( triNodes ) )
+
+        size_t aliveCount = m_siteIndex.size();
+
+        for( int site : removed )
         {
-            // special case: all nodes are on the same line - there's no
-            // triangulation for such set. In this case, we sort along any coordinate
-            // and chain the nodes together.
-            for(int i = 0; i < (int)triNodes.size() - 1; i++ )
+            if( !removeSite( site, --aliveCount ) )
             {
-                auto src = m_allNodes[ triNodes[i]->Id() ];
-                auto dst = m_allNodes[ triNodes[i + 1]->Id() ];
-                mstEdges.emplace_back( src, dst, getDistance( src, dst ) );
+                rebuild( aPositions );
+                return;
             }
         }
-        else
-        {
-            hed::TRIANGULATION triangulator;
-            triangulator.CreateDelaunay( triNodes.begin(), triNodes.end() );
-            triangulator.GetEdges( triangEdges );
 
-            for( auto e : triangEdges )
+        for( const auto& pos : added )
+            insertSite( pos );
+    }
+
+public:
+
+    void Clear()
+    {
+        m_allNodes.clear();
+    }
+
+    void AddNode( CN_ANCHOR_PTR aNode )
+    {
+        m_allNodes.push_back( aNode );
+    }
+
+    /**
+     * Function Triangulate()
+     * @return the lines the ratsnest of the nodes is made of: the lines of the position tree,
+     * and the lines between the nodes sharing a position.
+     */
+    const std::list<CN_EDGE> Triangulate()
+    {
+        std::list<CN_EDGE> mstEdges;
+
+        std::sort( m_allNodes.begin(), m_allNodes.end(),
+                [] ( const CN_ANCHOR_PTR& aNode1, const CN_ANCHOR_PTR& aNode2 )
+        {
+            if( aNode1->Pos().y < aNode2->Pos().y )
+                return true;
+            else if( aNode1->Pos().y == aNode2->Pos().y )
             {
-                auto    src = m_allNodes[ e->GetSourceNode()->Id() ];
-                auto    dst = m_allNodes[ e->GetTargetNode()->Id() ];
+                return aNode1->Pos().x < aNode2->Pos().x;
+            }
 
-                mstEdges.emplace_back( src, dst, getDistance( src, dst ) );
+            return false;
+        }
+                );
+
+        // The nodes sharing a position, and the first node of each position
+        using ANCHOR_LIST = std::vector<CN_ANCHOR_PTR>;
+        std::vector<ANCHOR_LIST> anchorChains;
+        std::vector<VECTOR2I> positions;
+
+        for( const auto& n : m_allNodes )
+        {
+            if( positions.empty() || positions.back() != n->Pos() )
+            {
+                positions.push_back( n->Pos() );
+                anchorChains.emplace_back();
             }
+
+            anchorChains.back().push_back( n );
         }
 
-        for( unsigned int i = 0; i < anchorChains.size(); i++ )
+        updateSites( positions );
+
+        std::vector<int> siteChains( m_sites.size(), -1 );
+
+        for( unsigned i = 0; i < positions.size(); i++ )
+            siteChains[ m_siteIndex[ positions[i] ] ] = i;
+
+        for( const auto& e : m_mst )
         {
-            auto& chain = anchorChains[i];
+            auto src = anchorChains[ siteChains[e.m_a] ].front();
+            auto dst = anchorChains[ siteChains[e.m_b] ].front();
 
+            mstEdges.emplace_back( src, dst, getDistance( src, dst ) );
+        }
+
+        for( auto& chain : anchorChains )
+        {
             if( chain.size() < 2 )
                 continue;
 
@@ -468,6 +807,43 @@ bool RN_NET::NearestBicoloredPair( const RN_NET& aOtherNet, CN_ANCHOR_PTR& aNode
 }
 
 
+void RN_NET::GetTargetPositions( std::vector<VECTOR2I>& aPositions ) const
+{
+    for( const auto& node : m_nodes )
+    {
+        if( !node->GetNoLine() )
+            aPositions.push_back( node->Pos() );
+    }
+}
+
+
+bool RN_NET::NearestBicoloredPair( const std::vector<VECTOR2I>& aTargets, VECTOR2I& aPos1,
+                                   VECTOR2I& aPos2 ) const
+{
+    bool rv = false;
+
+    VECTOR2I::extended_type distMax = VECTOR2I::ECOORD_MAX;
+
+    for( const auto& target : aTargets )
+    {
+        for( const auto& node : m_nodes )
+        {
+            auto squaredDist = ( target - node->Pos() ).SquaredEuclideanNorm();
+
+            if( squaredDist < distMax )
+            {
+                rv = true;
+                distMax = squaredDist;
+                aPos1   = target;
+                aPos2   = node->Pos();
+            }
+        }
+    }
+
+    return rv;
+}
+
+
 void RN_NET::SetVisible( bool aEnabled )
 {
     for( auto& edge : m_rnEdges )
@@ -144,6 +144,22 @@ public:
 
     bool NearestBicoloredPair( const RN_NET& aOtherNet, CN_ANCHOR_PTR& aNode1, CN_ANCHOR_PTR& aNode2 ) const;
 
+    /**
+     * Function GetTargetPositions()
+     * Adds the positions of the nodes which can be the end of a ratsnest line to a list.
+     */
+    void GetTargetPositions( std::vector<VECTOR2I>& aPositions ) const;
+
+    /**
+     * Function NearestBicoloredPair()
+     * Finds the shortest line between a set of positions and the nodes of the net.
+     * @param aPos1 receives the nearest position of aTargets
+     * @param aPos2 receives the position of the nearest node of the net
+     * @return false if there is no such line.
+     */
+    bool NearestBicoloredPair( const std::vector<VECTOR2I>& aTargets, VECTOR2I& aPos1,
+                               VECTOR2I& aPos2 ) const;
+
 protected:
     ///> Recomputes ratsnest from scratch.
     void compute();
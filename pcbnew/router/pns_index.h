@@ -23,8 +23,12 @@
 #define __PNS_INDEX_H
 
 #include <layers_id_colors_and_visibility.h>
+#include <functional>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <boost/range/adaptor/map.hpp>
 
@@ -50,7 +54,61 @@ public:
     typedef SHAPE_INDEX<ITEM*>          ITEM_SHAPE_INDEX;
     typedef std::unordered_set<ITEM*>   ITEM_SET;
 
+    /**
+     * Struct QUERY_KEY
+     *
+     * Identifies a collision query by the geometry of the searched item rather than by its
+     * address, as the router keeps asking the same questions with temporary items.
+     */
+    struct QUERY_KEY
+    {
+        int         m_kind;
+        int         m_net;
+        int         m_layerStart;
+        int         m_layerEnd;
+        VECTOR2I    m_a;
+        VECTOR2I    m_b;
+        int         m_width;
+        int         m_kindMask;
+        int         m_forceClearance;
+        int         m_minDistance;
+        bool        m_differentNetsOnly;
+
+        bool operator==( const QUERY_KEY& aOther ) const
+        {
+            return m_kind == aOther.m_kind && m_net == aOther.m_net
+                && m_layerStart == aOther.m_layerStart && m_layerEnd == aOther.m_layerEnd
+                && m_a == aOther.m_a && m_b == aOther.m_b && m_width == aOther.m_width
+                && m_kindMask == aOther.m_kindMask
+                && m_forceClearance == aOther.m_forceClearance
+                && m_minDistance == aOther.m_minDistance
+                && m_differentNetsOnly == aOther.m_differentNetsOnly;
+        }
+    };
+
+    struct QUERY_KEY_HASH
+    {
+        size_t operator()( const QUERY_KEY& aKey ) const
+        {
+            size_t h = std::hash<int>()( aKey.m_a.x );
+
+            for( int v : { aKey.m_a.y, aKey.m_b.x, aKey.m_b.y, aKey.m_width, aKey.m_net,
+                           aKey.m_layerStart, aKey.m_layerEnd, aKey.m_kindMask } )
+                h = h * 31 + std::hash<int>()( v );
+
+            return h;
+        }
+    };
+
     INDEX();
+
+    /**
+     * Copy constructor
+     *
+     * Clones the subindices as they are, without inserting the items again.
+     */
+    INDEX( const INDEX& aOther );
+
     ~INDEX();
 
     /**
@@ -120,6 +178,23 @@ public:
      */
     NET_ITEMS_LIST* GetItemsForNet( int aNet );
 
+    /**
+     * Function FindCachedQuery()
+     *
+     * Looks for the result of a collision query made before on this index.  The results
+     * are kept until the index is modified.  Can be called from several threads.
+     * @param aColliding receives the colliding items, in the order of the original query
+     * @return true if the query was found
+     */
+    bool FindCachedQuery( const QUERY_KEY& aKey, std::vector<ITEM*>& aColliding ) const;
+
+    /**
+     * Function CacheQuery()
+     *
+     * Stores the result of a collision query for FindCachedQuery().
+     */
+    void CacheQuery( const QUERY_KEY& aKey, const std::vector<ITEM*>& aColliding );
+
     /**
      * Function Contains()
      *
@@ -152,11 +227,22 @@ private:
     template <class Visitor>
     int querySingle( int index, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor );
 
+    ///> maximum number of cached queries, the cache is emptied when full
+    static const size_t MaxCachedQueries = 16384;
+
     ITEM_SHAPE_INDEX* getSubindex( const ITEM* aItem );
 
+    void invalidateQueries();
+
     ITEM_SHAPE_INDEX* m_subIndices[MaxSubIndices];
     std::map<int, NET_ITEMS_LIST> m_netMap;
     ITEM_SET m_allItems;
+
+    typedef std::unordered_map<QUERY_KEY, std::vector<ITEM*>, QUERY_KEY_HASH> QUERY_CACHE;
+
+    ///> results of the collision queries, not copied with the index
+    QUERY_CACHE m_queryCache;
+    mutable std::mutex m_queryCacheLock;
 };
 
 INDEX::INDEX()
@@ -164,6 +250,18 @@ INDEX::INDEX()
     memset( m_subIndices, 0, sizeof( m_subIndices ) );
 }
 
+INDEX::INDEX( const INDEX& aOther ) :
+    m_netMap( aOther.m_netMap ),
+    m_allItems( aOther.m_allItems )
+{
+    for( int i = 0; i < MaxSubIndices; ++i )
+    {
+        const ITEM_SHAPE_INDEX* idx = aOther.m_subIndices[i];
+
+        m_subIndices[i] = idx ? new ITEM_SHAPE_INDEX( *idx ) : NULL;
+    }
+}
+
 INDEX::ITEM_SHAPE_INDEX* INDEX::getSubindex( const ITEM* aItem )
 {
     int idx_n = -1;
@@ -218,6 +316,8 @@ void INDEX::Add( ITEM* aItem )
     if( !idx )
         return;
 
+    invalidateQueries();
+
     idx->Add( aItem );
     m_allItems.insert( aItem );
     int net = aItem->Net();
@@ -235,6 +335,8 @@ void INDEX::Remove( ITEM* aItem )
     if( !idx )
         return;
 
+    invalidateQueries();
+
     idx->Remove( aItem );
     m_allItems.erase( aItem );
     int net = aItem->Net();
@@ -304,6 +406,8 @@ int INDEX::Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor )
 
 void INDEX::Clear()
 {
+    invalidateQueries();
+
     for( int i = 0; i < MaxSubIndices; ++i )
     {
         ITEM_SHAPE_INDEX* idx = m_subIndices[i];
@@ -328,6 +432,36 @@ INDEX::NET_ITEMS_LIST* INDEX::GetItemsForNet( int aNet )
     return &m_netMap[aNet];
 }
 
+bool INDEX::FindCachedQuery( const QUERY_KEY& aKey, std::vector<ITEM*>& aColliding ) const
+{
+    std::lock_guard<std::mutex> lock( m_queryCacheLock );
+
+    auto it = m_queryCache.find( aKey );
+
+    if( it == m_queryCache.end() )
+        return false;
+
+    aColliding = it->second;
+    return true;
+}
+
+void INDEX::CacheQuery( const QUERY_KEY& aKey, const std::vector<ITEM*>& aColliding )
+{
+    std::lock_guard<std::mutex> lock( m_queryCacheLock );
+
+    if( m_queryCache.size() >= MaxCachedQueries )
+        m_queryCache.clear();
+
+    m_queryCache[aKey] = aColliding;
+}
+
+void INDEX::invalidateQueries()
+{
+    std::lock_guard<std::mutex> lock( m_queryCacheLock );
+
+    m_queryCache.clear();
+}
+
 }
 
 #endif
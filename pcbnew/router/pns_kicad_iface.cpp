@@ -432,6 +432,9 @@ public:
 
     void AddLine( const SHAPE_LINE_CHAIN& aLine, int aType, int aWidth ) override
     {
+        if( !m_view )
+            return;
+
         ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_view );
 
         pitem->Line( aLine, aWidth, aType );
@@ -468,7 +471,7 @@ PNS_KICAD_IFACE::PNS_KICAD_IFACE()
     m_view = nullptr;
     m_previewItems = nullptr;
     m_router = nullptr;
-    m_debugDecorator = nullptr;
+    m_debugDecorator = new PNS_PCBNEW_DEBUG_DECORATOR();
     m_dispOptions = nullptr;
 }
 
@@ -483,6 +486,9 @@ PNS_KICAD_IFACE::~PNS_KICAD_IFACE()
         m_previewItems->FreeItems();
         delete m_previewItems;
     }
+
+    for( auto item : m_addedItems )
+        delete item;
 }
 
 
@@ -1076,6 +1082,9 @@ void PNS_KICAD_IFACE::SyncWorld( PNS::NODE *aWorld )
 
 void PNS_KICAD_IFACE::EraseView()
 {
+    if( !m_view )
+        return;
+
     for( auto item : m_hiddenItems )
         m_view->SetVisible( item, true );
 
@@ -1096,6 +1105,9 @@ void PNS_KICAD_IFACE::DisplayItem( const PNS::ITEM* aItem, int aColor, int aClea
 {
     wxLogTrace( "PNS", "DisplayItem %p", aItem );
 
+    if( !m_view )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( aItem, m_view );
 
     if( aColor >= 0 )
@@ -1124,7 +1136,7 @@ void PNS_KICAD_IFACE::HideItem( PNS::ITEM* aItem )
 {
     BOARD_CONNECTED_ITEM* parent = aItem->Parent();
 
-    if( parent )
+    if( parent && m_view )
     {
         if( m_view->IsVisible( parent ) )
             m_hiddenItems.insert( parent );
@@ -1141,7 +1153,10 @@ void PNS_KICAD_IFACE::RemoveItem( PNS::ITEM* aItem )
 
     if( parent )
     {
-        m_commit->Remove( parent );
+        if( m_commit )
+            m_commit->Remove( parent );
+        else
+            m_removedItems.push_back( parent );
     }
 }
 
@@ -1190,7 +1205,10 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
         aItem->SetParent( newBI );
         newBI->ClearFlags();
 
-        m_commit->Add( newBI );
+        if( m_commit )
+            m_commit->Add( newBI );
+        else
+            m_addedItems.push_back( newBI );
     }
 }
 
@@ -1198,6 +1216,25 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
 void PNS_KICAD_IFACE::Commit()
 {
     EraseView();
+
+    if( !m_commit )
+    {
+        // Without a host tool there is no undo or view to update: the changes go
+        // straight to the board
+        for( auto item : m_removedItems )
+        {
+            m_board->Remove( item );
+            delete item;
+        }
+
+        for( auto item : m_addedItems )
+            m_board->Add( item );
+
+        m_removedItems.clear();
+        m_addedItems.clear();
+        return;
+    }
+
     m_commit->Push( _( "Added a track" ) );
     m_commit.reset( new BOARD_COMMIT( m_tool ) );
 }
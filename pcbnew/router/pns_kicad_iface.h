@@ -23,6 +23,7 @@
 #define __PNS_KICAD_IFACE_H
 
 #include <unordered_set>
+#include <vector>
 
 #include "pns_router.h"
 
@@ -39,6 +40,12 @@ namespace KIGFX
     class VIEW;
 }
 
+/**
+ * Class PNS_KICAD_IFACE
+ * connects the router to a BOARD.  Without a view, nothing is displayed, and without a
+ * host tool, Commit() changes the board directly instead of pushing a BOARD_COMMIT:
+ * this is how the router runs in the headless test programs.
+ */
 class PNS_KICAD_IFACE : public PNS::ROUTER_IFACE {
 public:
     PNS_KICAD_IFACE();
@@ -83,6 +90,10 @@ private:
     PCB_TOOL* m_tool;
     std::unique_ptr<BOARD_COMMIT> m_commit;
     PCB_DISPLAY_OPTIONS* m_dispOptions;
+
+    ///> changes waiting for Commit() when there is no host tool
+    std::vector<BOARD_CONNECTED_ITEM*> m_addedItems;
+    std::vector<BOARD_CONNECTED_ITEM*> m_removedItems;
 };
 
 #endif
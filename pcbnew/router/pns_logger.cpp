@@ -49,6 +49,7 @@ void LOGGER::Clear()
 {
     m_theLog.str( std::string() );
     m_groupOpened = false;
+    m_events.clear();
 }
 
 
@@ -139,6 +140,55 @@ void LOGGER::Log( const VECTOR2I& aStart, const VECTOR2I& aEnd,
 }
 
 
+void LOGGER::Log( EVENT_TYPE aEvent, const VECTOR2I& aPos, const ITEM* aItem, int aParam,
+                  int aRouterMode, int aRoutingMode, int aViaLayerTop, int aViaLayerBottom )
+{
+    EVENT_ENTRY ent;
+
+    ent.m_type = aEvent;
+    ent.m_p = aPos;
+    ent.m_param = aParam;
+    ent.m_routerMode = aRouterMode;
+    ent.m_routingMode = aRoutingMode;
+    ent.m_viaLayerTop = aViaLayerTop;
+    ent.m_viaLayerBottom = aViaLayerBottom;
+    ent.m_itemKind = aItem ? aItem->Kind() : 0;
+    ent.m_itemNet = aItem ? aItem->Net() : -1;
+    ent.m_itemLayer = aItem ? aItem->Layers().Start() : -1;
+
+    m_events.push_back( ent );
+}
+
+
+bool LOGGER::ParseEvent( const std::string& aLine, EVENT_ENTRY& aEvent )
+{
+    std::istringstream in( aLine );
+    std::string tag;
+    int type;
+
+    in >> tag;
+
+    if( tag != "event" )
+        return false;
+
+    in >> type >> aEvent.m_p.x >> aEvent.m_p.y >> aEvent.m_param >> aEvent.m_routerMode
+       >> aEvent.m_routingMode >> aEvent.m_itemKind >> aEvent.m_itemNet >> aEvent.m_itemLayer;
+
+    if( in.fail() || type < EVT_START_ROUTE || type > EVT_SYNC_WORLD )
+        return false;
+
+    aEvent.m_type = (EVENT_TYPE) type;
+
+    if( !( in >> aEvent.m_viaLayerTop >> aEvent.m_viaLayerBottom ) )
+    {
+        aEvent.m_viaLayerTop = -1;
+        aEvent.m_viaLayerBottom = -1;
+    }
+
+    return true;
+}
+
+
 void LOGGER::dumpShape( const SHAPE* aSh )
 {
     switch( aSh->Type() )
@@ -200,8 +250,20 @@ void LOGGER::Save( const std::string& aFilename )
 
     FILE* f = fopen( aFilename.c_str(), "wb" );
     wxLogTrace( "PNS", "Saving to '%s' [%p]", aFilename.c_str(), f );
+
+    if( !f )
+        return;
+
     const std::string s = m_theLog.str();
     fwrite( s.c_str(), 1, s.length(), f );
+
+    for( const EVENT_ENTRY& ent : m_events )
+    {
+        fprintf( f, "event %d %d %d %d %d %d %d %d %d %d %d\n", (int) ent.m_type, ent.m_p.x,
+                 ent.m_p.y, ent.m_param, ent.m_routerMode, ent.m_routingMode, ent.m_itemKind,
+                 ent.m_itemNet, ent.m_itemLayer, ent.m_viaLayerTop, ent.m_viaLayerBottom );
+    }
+
     fclose( f );
 }
 
@@ -39,12 +39,69 @@ class ITEM;
 class LOGGER
 {
 public:
+    ///> Router operations, as recorded for replaying a routing session
+    enum EVENT_TYPE
+    {
+        EVT_START_ROUTE = 0,
+        EVT_START_DRAG,
+        EVT_FIX,
+        EVT_MOVE,
+        EVT_ABORT,
+        EVT_SWITCH_LAYER,
+        EVT_TOGGLE_VIA,
+        EVT_FLIP_POSTURE,
+        EVT_SYNC_WORLD
+    };
+
+    struct EVENT_ENTRY
+    {
+        EVENT_TYPE  m_type;
+        VECTOR2I    m_p;
+
+        ///> start layer, drag mode, force finish flag or new layer, depending on the event
+        int         m_param;
+
+        ///> router mode and routing mode (shove, walkaround...) of the start events
+        int         m_routerMode;
+        int         m_routingMode;
+
+        ///> via layer pair of the start events, -1 if not recorded
+        int         m_viaLayerTop;
+        int         m_viaLayerBottom;
+
+        ///> the item passed to the router, identified by its kind, net and first layer, as
+        ///> the items are different each time the world is built (kind 0 if none)
+        int         m_itemKind;
+        int         m_itemNet;
+        int         m_itemLayer;
+    };
+
     LOGGER();
     ~LOGGER();
 
     void Save( const std::string& aFilename );
     void Clear();
 
+    /**
+     * Function Log()
+     *
+     * Records a router event. The events are saved after the geometry, one per line.
+     */
+    void Log( EVENT_TYPE aEvent, const VECTOR2I& aPos, const ITEM* aItem = nullptr,
+              int aParam = 0, int aRouterMode = 0, int aRoutingMode = 0,
+              int aViaLayerTop = -1, int aViaLayerBottom = -1 );
+
+    const std::vector<EVENT_ENTRY>& GetEvents() const { return m_events; }
+
+    /**
+     * Function ParseEvent()
+     *
+     * Reads back an event line written by Save().  The lines saved without the via layer
+     * pair are read with -1 for it.
+     * @return false if the line is not an event.
+     */
+    static bool ParseEvent( const std::string& aLine, EVENT_ENTRY& aEvent );
+
     void NewGroup( const std::string& aName, int aIter = 0 );
     void EndGroup();
 
@@ -58,6 +115,7 @@ private:
 
     bool m_groupOpened;
     std::stringstream m_theLog;
+    std::vector<EVENT_ENTRY> m_events;
 };
 
 }
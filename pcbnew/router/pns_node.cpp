@@ -20,6 +20,7 @@
  */
 
 #include <vector>
+#include <atomic>
 #include <cassert>
 
 #include <math/vector2d.h>
@@ -45,6 +46,29 @@ namespace PNS {
 static std::unordered_set<NODE*> allocNodes;
 #endif
 
+// The walkaround and the optimizer query the nodes from several threads
+static std::atomic<uint64_t> s_queryCount( 0 );
+static std::atomic<uint64_t> s_cacheHits( 0 );
+static std::atomic<uint64_t> s_cacheMisses( 0 );
+
+
+uint64_t NODE::QueryCount()
+{
+    return s_queryCount.load( std::memory_order_relaxed );
+}
+
+
+uint64_t NODE::QueryCacheHits()
+{
+    return s_cacheHits.load( std::memory_order_relaxed );
+}
+
+
+uint64_t NODE::QueryCacheMisses()
+{
+    return s_cacheMisses.load( std::memory_order_relaxed );
+}
+
 NODE::NODE()
 {
     wxLogTrace( "PNS", "NODE::create %p", this );
@@ -53,7 +77,9 @@ NODE::NODE()
     m_parent = NULL;
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_ruleResolver = NULL;
-    m_index = new INDEX;
+    m_index = std::make_shared<INDEX>();
+    m_joints = std::make_shared<JOINT_MAP>();
+    m_override = std::make_shared<OVERRIDE_SET>();
 
 #ifdef DEBUG
     allocNodes.insert( this );
@@ -81,7 +107,7 @@ NODE::~NODE()
     allocNodes.erase( this );
 #endif
 
-    m_joints.clear();
+    m_joints.reset();
 
     for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
     {
@@ -92,7 +118,7 @@ NODE::~NODE()
     releaseGarbage();
     unlinkParent();
 
-    delete m_index;
+    m_index.reset();
 }
 
 int NODE::GetClearance( const ITEM* aA, const ITEM* aB ) const
@@ -118,21 +144,18 @@ NODE* NODE::Branch()
     child->m_root = isRoot() ? this : m_root;
 
     // immmediate offspring of the root branch needs not copy anything.
-    // For the rest, deep-copy joints, overridden item map and pointers
-    // to stored items.
+    // For the rest, share the joints, overridden item map and index with
+    // this node: they are copied only when either node modifies them, which
+    // the shove branches often never do.
     if( !isRoot() )
     {
-        JOINT_MAP::iterator j;
-
-        for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-            child->m_index->Add( *i );
-
+        child->m_index = m_index;
         child->m_joints = m_joints;
         child->m_override = m_override;
     }
 
     wxLogTrace( "PNS", "%d items, %d joints, %d overrides",
-            child->m_index->Size(), (int) child->m_joints.size(), (int) child->m_override.size() );
+            child->m_index->Size(), (int) child->m_joints->size(), (int) child->m_override->size() );
 
     return child;
 }
@@ -259,6 +282,8 @@ struct NODE::DEFAULT_OBSTACLE_VISITOR : public OBSTACLE_VISITOR
 
 int NODE::QueryColliding( const ITEM* aItem, OBSTACLE_VISITOR& aVisitor )
 {
+    s_queryCount.fetch_add( 1, std::memory_order_relaxed );
+
     aVisitor.SetWorld( this, NULL );
     m_index->Query( aItem, m_maxClearance, aVisitor );
 
@@ -273,9 +298,131 @@ int NODE::QueryColliding( const ITEM* aItem, OBSTACLE_VISITOR& aVisitor )
 }
 
 
+// Only the segments and vias are cached: they are what the shove and the walkaround
+// keep checking, split from the lines.  The key holds everything their collisions depend on.
+static bool makeQueryKey( const ITEM* aItem, int aKindMask, bool aDifferentNetsOnly,
+                          int aForceClearance, int aMinDistance, INDEX::QUERY_KEY& aKey )
+{
+    switch( aItem->Kind() )
+    {
+    case ITEM::SEGMENT_T:
+    {
+        const SEGMENT* seg = static_cast<const SEGMENT*>( aItem );
+
+        aKey.m_a = seg->Seg().A;
+        aKey.m_b = seg->Seg().B;
+        aKey.m_width = seg->Width();
+        break;
+    }
+
+    case ITEM::VIA_T:
+    {
+        const VIA* via = static_cast<const VIA*>( aItem );
+
+        aKey.m_a = via->Pos();
+        aKey.m_b = via->Pos();
+        aKey.m_width = via->Diameter();
+        break;
+    }
+
+    default:
+        return false;
+    }
+
+    aKey.m_kind = aItem->Kind();
+    aKey.m_net = aItem->Net();
+    aKey.m_layerStart = aItem->Layers().Start();
+    aKey.m_layerEnd = aItem->Layers().End();
+    aKey.m_kindMask = aKindMask;
+    aKey.m_forceClearance = aForceClearance;
+    aKey.m_minDistance = aMinDistance;
+    aKey.m_differentNetsOnly = aDifferentNetsOnly;
+
+    return true;
+}
+
+
+bool NODE::cachedColliding( const NODE* aWorld, INDEX& aIndex, const ITEM* aItem, int aKindMask,
+                            bool aDifferentNetsOnly, int aForceClearance,
+                            std::vector<ITEM*>& aColliding ) const
+{
+    INDEX::QUERY_KEY key;
+
+    if( !makeQueryKey( aItem, aKindMask, aDifferentNetsOnly, aForceClearance, m_maxClearance,
+                       key ) )
+        return false;
+
+    if( aIndex.FindCachedQuery( key, aColliding ) )
+    {
+        s_cacheHits.fetch_add( 1, std::memory_order_relaxed );
+        return true;
+    }
+
+    s_cacheMisses.fetch_add( 1, std::memory_order_relaxed );
+
+    // The whole result is cached, without the overrides of the branch, so it is valid
+    // for all the branches sharing the index
+    OBSTACLES                obs;
+    DEFAULT_OBSTACLE_VISITOR visitor( obs, aItem, aKindMask, aDifferentNetsOnly );
+
+    visitor.SetWorld( aWorld, NULL );
+    visitor.m_forceClearance = aForceClearance;
+    aIndex.Query( aItem, m_maxClearance, visitor );
+
+    aColliding.clear();
+
+    for( const OBSTACLE& o : obs )
+        aColliding.push_back( o.m_item );
+
+    aIndex.CacheQuery( key, aColliding );
+
+    return true;
+}
+
+
 int NODE::QueryColliding( const ITEM* aItem,
         NODE::OBSTACLES& aObstacles, int aKindMask, int aLimitCount, bool aDifferentNetsOnly, int aForceClearance )
 {
+    std::vector<ITEM*> colliding;
+
+    s_queryCount.fetch_add( 1, std::memory_order_relaxed );
+
+    if( cachedColliding( this, *m_index, aItem, aKindMask, aDifferentNetsOnly, aForceClearance,
+                         colliding ) )
+    {
+        int matchCount = 0;
+
+        auto report = [&]( bool aCheckOverride ) -> void
+        {
+            for( ITEM* item : colliding )
+            {
+                if( aLimitCount > 0 && matchCount >= aLimitCount )
+                    return;
+
+                if( aCheckOverride && Overrides( item ) )
+                    continue;
+
+                OBSTACLE obs;
+
+                obs.m_item = item;
+                obs.m_head = aItem;
+                aObstacles.push_back( obs );
+                matchCount++;
+            }
+        };
+
+        report( false );
+
+        if( !isRoot() && ( matchCount < aLimitCount || aLimitCount < 0 ) )
+        {
+            cachedColliding( m_root, *m_root->m_index, aItem, aKindMask, aDifferentNetsOnly,
+                             aForceClearance, colliding );
+            report( true );
+        }
+
+        return aObstacles.size();
+    }
+
     DEFAULT_OBSTACLE_VISITOR visitor( aObstacles, aItem, aKindMask, aDifferentNetsOnly );
 
 #ifdef DEBUG
@@ -533,7 +680,7 @@ const ITEM_SET NODE::HitTest( const VECTOR2I& aPoint ) const
 void NODE::addSolid( SOLID* aSolid )
 {
     linkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
-    m_index->Add( aSolid );
+    writableIndex().Add( aSolid );
 }
 
 void NODE::Add( std::unique_ptr< SOLID > aSolid )
@@ -545,7 +692,7 @@ void NODE::Add( std::unique_ptr< SOLID > aSolid )
 void NODE::addVia( VIA* aVia )
 {
     linkJoint( aVia->Pos(), aVia->Layers(), aVia->Net(), aVia );
-    m_index->Add( aVia );
+    writableIndex().Add( aVia );
 }
 
 void NODE::Add( std::unique_ptr< VIA > aVia )
@@ -588,7 +735,7 @@ void NODE::addSegment( SEGMENT* aSeg )
     linkJoint( aSeg->Seg().A, aSeg->Layers(), aSeg->Net(), aSeg );
     linkJoint( aSeg->Seg().B, aSeg->Layers(), aSeg->Net(), aSeg );
 
-    m_index->Add( aSeg );
+    writableIndex().Add( aSeg );
 }
 
 bool NODE::Add( std::unique_ptr< SEGMENT > aSegment, bool aAllowRedundant )
@@ -639,12 +786,12 @@ void NODE::doRemove( ITEM* aItem )
     // case 1: removing an item that is stored in the root node from any branch:
     // mark it as overridden, but do not remove
     if( aItem->BelongsTo( m_root ) && !isRoot() )
-        m_override.insert( aItem );
+        writableOverrides().insert( aItem );
 
     // case 2: the item belongs to this branch or a parent, non-root branch,
     // or the root itself and we are the root: remove from the index
     else if( !aItem->BelongsTo( m_root ) || isRoot() )
-        m_index->Remove( aItem );
+        writableIndex().Remove( aItem );
 
     // the item belongs to this particular branch: un-reference it
     if( aItem->BelongsTo( this ) )
@@ -674,6 +821,7 @@ void NODE::removeViaIndex( VIA* aVia )
 
     JOINT* jt = FindJoint( p, vLayers.Start(), net );
     JOINT::LINKED_ITEMS links( jt->LinkList() );
+    JOINT_MAP& joints = writableJoints();
 
     tag.net = net;
     tag.pos = p;
@@ -682,9 +830,9 @@ void NODE::removeViaIndex( VIA* aVia )
     do
     {
         split = false;
-        std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range = m_joints.equal_range( tag );
+        std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         // find and remove all joints containing the via to be removed
@@ -693,7 +841,7 @@ void NODE::removeViaIndex( VIA* aVia )
         {
             if( aVia->LayersOverlap( &f->second ) )
             {
-                m_joints.erase( f );
+                joints.erase( f );
                 split = true;
                 break;
             }
@@ -972,12 +1120,12 @@ JOINT* NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
+    JOINT_MAP::iterator f = m_joints->find( tag ), end = m_joints->end();
 
     if( f == end && !isRoot() )
     {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
+        end = m_root->m_joints->end();
+        f = m_root->m_joints->find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
     }
 
     if( f == end )
@@ -1009,18 +1157,20 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     tag.pos = aPos;
     tag.net = aNet;
 
+    JOINT_MAP& joints = writableJoints();
+
     // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
+    JOINT_MAP::iterator f = joints.find( tag );
 
     std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
 
     // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
+    if( f == joints.end() && !isRoot() )
     {
-        range = m_root->m_joints.equal_range( tag );
+        range = m_root->m_joints->equal_range( tag );
 
         for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
+            joints.insert( *f );
     }
 
     // now insert and combine overlapping joints
@@ -1031,9 +1181,9 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     do
     {
         merged  = false;
-        range   = m_joints.equal_range( tag );
+        range   = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         for( f = range.first; f != range.second; ++f )
@@ -1041,7 +1191,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
             if( aLayers.Overlaps( f->second.Layers() ) )
             {
                 jt.Merge( f->second );
-                m_joints.erase( f );
+                joints.erase( f );
                 merged = true;
                 break;
             }
@@ -1049,7 +1199,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     }
     while( merged );
 
-    return m_joints.insert( TagJointPair( tag, jt ) )->second;
+    return joints.insert( TagJointPair( tag, jt ) )->second;
 }
 
 
@@ -1103,7 +1253,7 @@ void NODE::Dump( bool aLong )
     JOINT_MAP::iterator j;
 
     if( aLong )
-        for( j = m_joints.begin(); j != m_joints.end(); ++j )
+        for( j = m_joints->begin(); j != m_joints->end(); ++j )
         {
             wxLogTrace( "PNS", "joint : %s, links : %d\n",
                     j->second.GetPos().Format().c_str(), j->second.LinkCount() );
@@ -1155,26 +1305,53 @@ void NODE::Dump( bool aLong )
         lines_count++;
     }
 
-    wxLogTrace( "PNS", "Local joints: %d, lines : %d \n", m_joints.size(), lines_count );
+    wxLogTrace( "PNS", "Local joints: %d, lines : %d \n", m_joints->size(), lines_count );
 #endif
 }
 
 
 void NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
 {
-    aRemoved.reserve( m_override.size() );
+    aRemoved.reserve( m_override->size() );
     aAdded.reserve( m_index->Size() );
 
     if( isRoot() )
         return;
 
-    for( ITEM* item : m_override )
+    for( ITEM* item : *m_override )
         aRemoved.push_back( item );
 
     for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
         aAdded.push_back( *i );
 }
 
+INDEX& NODE::writableIndex()
+{
+    if( m_index.use_count() > 1 )
+        m_index = std::make_shared<INDEX>( *m_index );
+
+    return *m_index;
+}
+
+
+NODE::JOINT_MAP& NODE::writableJoints()
+{
+    if( m_joints.use_count() > 1 )
+        m_joints = std::make_shared<JOINT_MAP>( *m_joints );
+
+    return *m_joints;
+}
+
+
+NODE::OVERRIDE_SET& NODE::writableOverrides()
+{
+    if( m_override.use_count() > 1 )
+        m_override = std::make_shared<OVERRIDE_SET>( *m_override );
+
+    return *m_override;
+}
+
+
 void NODE::releaseChildren()
 {
     // copy the kids as the NODE destructor erases the item from the parent node.
@@ -1208,7 +1385,7 @@ void NODE::Commit( NODE* aNode )
         if( aNode->isRoot() )
             return;
 
-        for( ITEM* item : aNode->m_override )
+        for( ITEM* item : *aNode->m_override )
             Remove( item );
 
         for( auto i : *aNode->m_index )
@@ -24,6 +24,7 @@
 
 #include <vector>
 #include <list>
+#include <memory>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -172,7 +173,7 @@ public:
     ///> Returns the number of joints
     int JointCount() const
     {
-        return m_joints.size();
+        return m_joints->size();
     }
 
     ///> Returns the number of nodes in the inheritance chain (wrs to the root node)
@@ -202,6 +203,23 @@ public:
                          OBSTACLE_VISITOR& aVisitor
                       );
 
+    /**
+     * Function QueryCount()
+     *
+     * @return the number of collision queries made by all the nodes since the start
+     * of the program, for the profiling of the router.
+     */
+    static uint64_t QueryCount();
+
+    /**
+     * Function QueryCacheHits()
+     *
+     * @return the number of index lookups made by QueryColliding() which were answered by
+     * the query caches of the indices, and QueryCacheMisses() the number of the others.
+     */
+    static uint64_t QueryCacheHits();
+    static uint64_t QueryCacheMisses();
+
     /**
      * Function NearestObstacle()
      *
@@ -415,13 +433,14 @@ public:
     ///> from the root branch.
     bool Overrides( ITEM* aItem ) const
     {
-        return m_override.find( aItem ) != m_override.end();
+        return m_override->find( aItem ) != m_override->end();
     }
 
 private:
     struct DEFAULT_OBSTACLE_VISITOR;
     typedef std::unordered_multimap<JOINT::HASH_TAG, JOINT, JOINT::JOINT_TAG_HASH> JOINT_MAP;
     typedef JOINT_MAP::value_type TagJointPair;
+    typedef std::unordered_set<ITEM*> OVERRIDE_SET;
 
     /// nodes are not copyable
     NODE( const NODE& aB );
@@ -449,6 +468,19 @@ private:
     void removeViaIndex( VIA* aVia );
 
     void doRemove( ITEM* aItem );
+
+    ///> finds the items of an index colliding with aItem through the query cache of the
+    ///> index. Returns false if the kind of aItem is not cached.
+    bool cachedColliding( const NODE* aWorld, INDEX& aIndex, const ITEM* aItem, int aKindMask,
+                          bool aDifferentNetsOnly, int aForceClearance,
+                          std::vector<ITEM*>& aColliding ) const;
+
+    ///> accessors to the containers of the branch, which copy them first if they are
+    ///> still shared with the parent or a sibling branch
+    INDEX& writableIndex();
+    JOINT_MAP& writableJoints();
+    OVERRIDE_SET& writableOverrides();
+
     void unlinkParent();
     void releaseChildren();
     void releaseGarbage();
@@ -473,8 +505,9 @@ private:
                      bool        aStopAtLockedJoints );
 
     ///> hash table with the joints, linking the items. Joints are hashed by
-    ///> their position, layer set and net.
-    JOINT_MAP m_joints;
+    ///> their position, layer set and net. Shared with the parent until either
+    ///> of them is modified.
+    std::shared_ptr<JOINT_MAP> m_joints;
 
     ///> node this node was branched from
     NODE* m_parent;
@@ -485,8 +518,9 @@ private:
     ///> list of nodes branched from this one
     std::set<NODE*> m_children;
 
-    ///> hash of root's items that have been changed in this node
-    std::unordered_set<ITEM*> m_override;
+    ///> hash of root's items that have been changed in this node (copy on write, as
+    ///> m_joints)
+    std::shared_ptr<OVERRIDE_SET> m_override;
 
     ///> worst case item-item clearance
     int m_maxClearance;
@@ -494,8 +528,8 @@ private:
     ///> Design rules resolver
     RULE_RESOLVER* m_ruleResolver;
 
-    ///> Geometric/Net index of the items
-    INDEX* m_index;
+    ///> Geometric/Net index of the items (copy on write, as m_joints)
+    std::shared_ptr<INDEX> m_index;
 
     ///> depth of the node (number of parent nodes in the inheritance chain)
     int m_depth;
@@ -21,6 +21,8 @@
 
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_rect.h>
+#include <thread_pool.h>
+#include <atomic>
 #include <cmath>
 
 #include "pns_line.h"
@@ -423,6 +425,45 @@ bool OPTIMIZER::checkColliding( LINE* aLine, const SHAPE_LINE_CHAIN& aOptPath )
 }
 
 
+void OPTIMIZER::checkColliding( LINE* aLine, const std::vector<SHAPE_LINE_CHAIN>& aOptPaths,
+                                std::vector<char>& aColliding )
+{
+    aColliding.assign( aOptPaths.size(), false );
+
+    TASK_GROUP          tasks;
+    std::atomic<size_t> nextPath( 0 );
+    size_t parallelThreadCount = std::min<size_t>( tasks.GetThreadCount(), aOptPaths.size() );
+
+    auto check_lambda = [&]()
+    {
+        for( size_t i = nextPath++; i < aOptPaths.size(); i = nextPath++ )
+            aColliding[i] = checkColliding( aLine, aOptPaths[i] );
+    };
+
+    if( parallelThreadCount <= 1 )
+    {
+        check_lambda();
+        return;
+    }
+
+    // The calling thread takes its share of the paths too
+    for( size_t ii = 1; ii < parallelThreadCount; ++ii )
+        tasks.Run( check_lambda );
+
+    check_lambda();
+    tasks.Wait();
+}
+
+
+///> number of candidate positions evaluated at once by the merge steps: the candidates
+///> after the first good one are checked for nothing, so there is no point in checking
+///> more of them than there are threads
+static int candidateBatchSize()
+{
+    return std::max<int>( THREAD_POOL::Get().GetThreadCount(), 1 );
+}
+
+
 bool OPTIMIZER::mergeObtuse( LINE* aLine )
 {
     SHAPE_LINE_CHAIN& line = aLine->Line();
@@ -454,26 +495,34 @@ bool OPTIMIZER::mergeObtuse( LINE* aLine )
         bool found_anything = false;
         int n = 0;
 
-        while( n < n_segs - step )
+        // The candidates are checked a batch at a time, and the first good one in the
+        // order of the segments is taken, as when checking them one by one
+        std::vector<SHAPE_LINE_CHAIN> opt_paths;
+        std::vector<VECTOR2I> opt_ips;
+        std::vector<int> opt_starts;
+        std::vector<char> colliding;
+
+        while( n < n_segs - step && !found_anything )
         {
-            const SEG s1 = current_path.CSegment( n );
-            const SEG s2 = current_path.CSegment( n + step );
-            SEG s1opt, s2opt;
+            int batch_end = std::min( n + candidateBatchSize(), n_segs - step );
+
+            opt_paths.clear();
+            opt_ips.clear();
+            opt_starts.clear();
 
-            if( DIRECTION_45( s1 ).IsObtuse( DIRECTION_45( s2 ) ) )
+            for( ; n < batch_end; n++ )
             {
+                const SEG s1 = current_path.CSegment( n );
+                const SEG s2 = current_path.CSegment( n + step );
+                SEG s1opt, s2opt;
+
+                if( !DIRECTION_45( s1 ).IsObtuse( DIRECTION_45( s2 ) ) )
+                    continue;
+
                 VECTOR2I ip = *s1.IntersectLines( s2 );
 
-                if( s1.Distance( ip ) <= 1 || s2.Distance( ip ) <= 1 )
-                {
-                    s1opt = SEG( s1.A, ip );
-                    s2opt = SEG( ip, s2.B );
-                }
-                else
-                {
-                    s1opt = SEG( s1.A, ip );
-                    s2opt = SEG( ip, s2.B );
-                }
+                s1opt = SEG( s1.A, ip );
+                s2opt = SEG( ip, s2.B );
 
                 if( DIRECTION_45( s1opt ).IsObtuse( DIRECTION_45( s2opt ) ) )
                 {
@@ -482,20 +531,24 @@ bool OPTIMIZER::mergeObtuse( LINE* aLine )
                     opt_path.Append( s1opt.B );
                     opt_path.Append( s2opt.B );
 
-                    LINE opt_track( *aLine, opt_path );
-
-                    if( !checkColliding( &opt_track ) )
-                    {
-                        current_path.Replace( s1.Index() + 1, s2.Index(), ip );
-                        // removeCachedSegments(aLine, s1.Index(), s2.Index());
-                        n_segs = current_path.SegmentCount();
-                        found_anything = true;
-                        break;
-                    }
+                    opt_paths.push_back( opt_path );
+                    opt_ips.push_back( ip );
+                    opt_starts.push_back( n );
                 }
             }
 
-            n++;
+            checkColliding( aLine, opt_paths, colliding );
+
+            for( size_t i = 0; i < opt_paths.size(); i++ )
+            {
+                if( !colliding[i] )
+                {
+                    current_path.Replace( opt_starts[i] + 1, opt_starts[i] + step, opt_ips[i] );
+                    n_segs = current_path.SegmentCount();
+                    found_anything = true;
+                    break;
+                }
+            }
         }
 
         if( !found_anything )
@@ -595,50 +648,82 @@ bool OPTIMIZER::mergeStep( LINE* aLine, SHAPE_LINE_CHAIN& aCurrentPath, int step
 
     restr.Build( m_world, aLine, aCurrentPath, m_restrictArea, m_restrictAreaActive );
 
+    // Both bypasses of a batch of positions are checked for collisions at once, then
+    // the positions are scanned in order as before
+    std::vector<SHAPE_LINE_CHAIN> bypasses;
+    std::vector<int> bypassIndex;
+    std::vector<char> colliding;
+
     while( n < n_segs - step )
     {
-        const SEG s1    = aCurrentPath.CSegment( n );
-        const SEG s2    = aCurrentPath.CSegment( n + step );
+        int batchStart = n;
+        int batchEnd = std::min( n + candidateBatchSize(), n_segs - step );
 
-        SHAPE_LINE_CHAIN path[2];
-        SHAPE_LINE_CHAIN* picked = NULL;
-        int cost[2];
+        bypasses.clear();
+        bypassIndex.assign( 2 * ( batchEnd - batchStart ), -1 );
 
-        for( int i = 0; i < 2; i++ )
+        for( int k = batchStart; k < batchEnd; k++ )
         {
-            bool postureMatch = true;
-            SHAPE_LINE_CHAIN bypass = DIRECTION_45().BuildInitialTrace( s1.A, s2.B, i );
-            cost[i] = INT_MAX;
+            const SEG s1    = aCurrentPath.CSegment( k );
+            const SEG s2    = aCurrentPath.CSegment( k + step );
+
+            for( int i = 0; i < 2; i++ )
+            {
+                bool postureMatch = true;
+                SHAPE_LINE_CHAIN bypass = DIRECTION_45().BuildInitialTrace( s1.A, s2.B, i );
 
-            bool restrictionsOK = restr.Check ( n, n + step + 1, bypass );
+                bool restrictionsOK = restr.Check ( k, k + step + 1, bypass );
 
-            if( n == 0 && orig_start != DIRECTION_45( bypass.CSegment( 0 ) ) )
-                postureMatch = false;
-            else if( n == n_segs - step && orig_end != DIRECTION_45( bypass.CSegment( -1 ) ) )
-                postureMatch = false;
+                if( k == 0 && orig_start != DIRECTION_45( bypass.CSegment( 0 ) ) )
+                    postureMatch = false;
+                else if( k == n_segs - step && orig_end != DIRECTION_45( bypass.CSegment( -1 ) ) )
+                    postureMatch = false;
 
-            if( restrictionsOK && (postureMatch || !m_keepPostures) && !checkColliding( aLine, bypass ) )
-            {
-                path[i] = aCurrentPath;
-                path[i].Replace( s1.Index(), s2.Index(), bypass );
-                path[i].Simplify();
-                cost[i] = COST_ESTIMATOR::CornerCost( path[i] );
+                if( restrictionsOK && (postureMatch || !m_keepPostures) )
+                {
+                    bypassIndex[ 2 * ( k - batchStart ) + i ] = bypasses.size();
+                    bypasses.push_back( bypass );
+                }
             }
         }
 
-        if( cost[0] < cost_orig && cost[0] < cost[1] )
-            picked = &path[0];
-        else if( cost[1] < cost_orig )
-            picked = &path[1];
+        checkColliding( aLine, bypasses, colliding );
 
-        if( picked )
+        for( ; n < batchEnd; n++ )
         {
-            n_segs = aCurrentPath.SegmentCount();
-            aCurrentPath = *picked;
-            return true;
-        }
+            const SEG s1    = aCurrentPath.CSegment( n );
+            const SEG s2    = aCurrentPath.CSegment( n + step );
 
-        n++;
+            SHAPE_LINE_CHAIN path[2];
+            SHAPE_LINE_CHAIN* picked = NULL;
+            int cost[2];
+
+            for( int i = 0; i < 2; i++ )
+            {
+                int idx = bypassIndex[ 2 * ( n - batchStart ) + i ];
+                cost[i] = INT_MAX;
+
+                if( idx >= 0 && !colliding[idx] )
+                {
+                    path[i] = aCurrentPath;
+                    path[i].Replace( s1.Index(), s2.Index(), bypasses[idx] );
+                    path[i].Simplify();
+                    cost[i] = COST_ESTIMATOR::CornerCost( path[i] );
+                }
+            }
+
+            if( cost[0] < cost_orig && cost[0] < cost[1] )
+                picked = &path[0];
+            else if( cost[1] < cost_orig )
+                picked = &path[1];
+
+            if( picked )
+            {
+                n_segs = aCurrentPath.SegmentCount();
+                aCurrentPath = *picked;
+                return true;
+            }
+        }
     }
 
     return false;
@@ -902,13 +987,24 @@ int OPTIMIZER::smartPadsSingle( LINE* aLine, ITEM* aPad, bool aEnd, int aEndVert
     bool found = false;
     int p_best = -1;
 
+    // The variants are checked all at once, then picked in order
+    std::vector<SHAPE_LINE_CHAIN> paths;
+    std::vector<char> colliding;
+
+    paths.reserve( variants.size() );
+
     for( RtVariant& vp : variants )
+        paths.push_back( vp.second );
+
+    checkColliding( aLine, paths, colliding );
+
+    for( size_t i = 0; i < variants.size(); i++ )
     {
-        LINE tmp( *aLine, vp.second );
+        RtVariant& vp = variants[i];
         int cost = COST_ESTIMATOR::CornerCost( vp.second );
         int len = vp.second.Length();
 
-        if( !checkColliding( &tmp ) )
+        if( !colliding[i] )
         {
             if( cost < min_cost || ( cost == min_cost && len < min_len ) )
             {
@@ -24,6 +24,7 @@
 
 #include <unordered_map>
 #include <memory>
+#include <vector>
 
 #include <geometry/shape_index_list.h>
 #include <geometry/shape_line_chain.h>
@@ -155,6 +156,11 @@ private:
     bool checkColliding( ITEM* aItem, bool aUpdateCache = true );
     bool checkColliding( LINE* aLine, const SHAPE_LINE_CHAIN& aOptPath );
 
+    ///> checks a batch of candidate paths for aLine on the thread pool. The world is only
+    ///> read, so aColliding gets the same flags as checking the paths one after another.
+    void checkColliding( LINE* aLine, const std::vector<SHAPE_LINE_CHAIN>& aOptPaths,
+                         std::vector<char>& aColliding );
+
     void cacheAdd( ITEM* aItem, bool aIsStatic );
     void removeCachedSegments( LINE* aLine, int aStartVertex = 0, int aEndVertex = -1 );
 
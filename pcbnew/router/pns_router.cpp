@@ -22,6 +22,8 @@
 #include <cstdio>
 #include <vector>
 
+#include <wx/filename.h>
+
 #include <view/view.h>
 #include <view/view_item.h>
 #include <view/view_group.h>
@@ -72,6 +74,7 @@ ROUTER::ROUTER()
     m_snapshotIter = 0;
     m_violation = false;
     m_iface = nullptr;
+    m_logEvents = false;
 }
 
 
@@ -90,6 +93,8 @@ ROUTER::~ROUTER()
 
 void ROUTER::SyncWorld()
 {
+    logEvent( LOGGER::EVT_SYNC_WORLD, VECTOR2I() );
+
     ClearWorld();
 
     m_world = std::unique_ptr<NODE>( new NODE );
@@ -126,6 +131,8 @@ const ITEM_SET ROUTER::QueryHoverItems( const VECTOR2I& aP )
 
 bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM* aStartItem, int aDragMode )
 {
+    startEventLog();
+    logEvent( LOGGER::EVT_START_DRAG, aP, aStartItem, aDragMode );
 
     if( aDragMode & DM_FREE_ANGLE )
         m_forceMarkObstaclesMode = true;
@@ -172,6 +179,8 @@ bool ROUTER::isStartingPointRoutable( const VECTOR2I& aWhere, int aLayer )
 
 bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
 {
+    startEventLog();
+    logEvent( LOGGER::EVT_START_ROUTE, aP, aStartItem, aLayer );
 
     if( ! isStartingPointRoutable( aP, aLayer ) )
     {
@@ -227,6 +236,8 @@ void ROUTER::DisplayItems( const ITEM_SET& aItems )
 
 void ROUTER::Move( const VECTOR2I& aP, ITEM* endItem )
 {
+    logEvent( LOGGER::EVT_MOVE, aP, endItem );
+
     m_currentEnd = aP;
 
     switch( m_state )
@@ -368,6 +379,8 @@ bool ROUTER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForceFinish )
 {
     bool rv = false;
 
+    logEvent( LOGGER::EVT_FIX, aP, aEndItem, aForceFinish ? 1 : 0 );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -406,6 +419,8 @@ void ROUTER::StopRouting()
     if( !RoutingInProgress() )
         return;
 
+    logEvent( LOGGER::EVT_ABORT, m_currentEnd );
+
     m_placer.reset();
     m_dragger.reset();
 
@@ -419,6 +434,8 @@ void ROUTER::StopRouting()
 
 void ROUTER::FlipPosture()
 {
+    logEvent( LOGGER::EVT_FLIP_POSTURE, m_currentEnd );
+
     if( m_state == ROUTE_TRACK )
     {
         m_placer->FlipPosture();
@@ -428,6 +445,8 @@ void ROUTER::FlipPosture()
 
 void ROUTER::SwitchLayer( int aLayer )
 {
+    logEvent( LOGGER::EVT_SWITCH_LAYER, m_currentEnd, nullptr, aLayer );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -441,6 +460,8 @@ void ROUTER::SwitchLayer( int aLayer )
 
 void ROUTER::ToggleViaPlacement()
 {
+    logEvent( LOGGER::EVT_TOGGLE_VIA, m_currentEnd );
+
     if( m_state == ROUTE_TRACK )
     {
         bool toggle = !m_placer->IsPlacingVia();
@@ -484,8 +505,31 @@ void ROUTER::DumpLog()
         break;
     }
 
+    // Both logs go to the temporary directory, the event one next to the shove dump
+    const wxString logDir = wxFileName::GetTempDir();
+
     if( logger )
-        logger->Save( "/tmp/shove.log" );
+        logger->Save( wxFileName( logDir, "shove.log" ).GetFullPath().ToStdString() );
+
+    if( m_logEvents )
+        m_logger.Save( wxFileName( logDir, "pns_events.log" ).GetFullPath().ToStdString() );
+}
+
+
+void ROUTER::startEventLog()
+{
+    // Each routing session starts a new log, so it does not grow for the whole editor session
+    if( m_logEvents )
+        m_logger.Clear();
+}
+
+
+void ROUTER::logEvent( LOGGER::EVENT_TYPE aEvent, const VECTOR2I& aP, const ITEM* aItem,
+                       int aParam )
+{
+    if( m_logEvents )
+        m_logger.Log( aEvent, aP, aItem, aParam, m_mode, m_settings.Mode(),
+                      m_sizes.GetLayerTop(), m_sizes.GetLayerBottom() );
 }
 
 
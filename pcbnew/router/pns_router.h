@@ -35,6 +35,7 @@
 #include "pns_item.h"
 #include "pns_itemset.h"
 #include "pns_node.h"
+#include "pns_logger.h"
 
 namespace KIGFX
 {
@@ -160,6 +161,15 @@ public:
 
     void DumpLog();
 
+    /**
+     * Enables the recording of the routing operations in Logger(), so a session can be
+     * saved by DumpLog() and replayed later against the same board.
+     */
+    void SetEventLogging( bool aEnable ) { m_logEvents = aEnable; }
+    bool IsEventLogging() const { return m_logEvents; }
+
+    LOGGER* Logger() { return &m_logger; }
+
     RULE_RESOLVER* GetRuleResolver() const
     {
         return m_iface->GetRuleResolver();
@@ -244,6 +254,10 @@ private:
 
     void highlightCurrent( bool enabled );
 
+    void startEventLog();
+    void logEvent( LOGGER::EVENT_TYPE aEvent, const VECTOR2I& aP, const ITEM* aItem = nullptr,
+                   int aParam = 0 );
+
     void markViolations( NODE* aNode, ITEM_SET& aCurrent, NODE::ITEM_VECTOR& aRemoved );
     bool isStartingPointRoutable( const VECTOR2I& aWhere, int aLayer );
 
@@ -271,6 +285,9 @@ private:
 
     wxString m_toolStatusbarName;
     wxString m_failureReason;
+
+    LOGGER m_logger;
+    bool m_logEvents;
 };
 
 }
@@ -40,6 +40,7 @@ ROUTING_SETTINGS::ROUTING_SETTINGS()
     m_shoveIterationLimit = 250;
     m_shoveTimeLimit = 1000;
     m_walkaroundIterationLimit = 40;
+    m_walkaroundTimeLimit = 1000;
     m_jumpOverObstacles = false;
     m_smoothDraggedSegments = true;
     m_canViolateDRC = false;
@@ -61,6 +62,7 @@ void ROUTING_SETTINGS::Save( TOOL_SETTINGS& aSettings ) const
     aSettings.Set( "ShoveTimeLimit", m_shoveTimeLimit.Get() );
     aSettings.Set( "ShoveIterationLimit", m_shoveIterationLimit );
     aSettings.Set( "WalkaroundIterationLimit", m_walkaroundIterationLimit );
+    aSettings.Set( "WalkaroundTimeLimit", m_walkaroundTimeLimit.Get() );
     aSettings.Set( "JumpOverObstacles", m_jumpOverObstacles );
     aSettings.Set( "SmoothDraggedSegments", m_smoothDraggedSegments );
     aSettings.Set( "CanViolateDRC", m_canViolateDRC );
@@ -81,6 +83,7 @@ void ROUTING_SETTINGS::Load( const TOOL_SETTINGS& aSettings )
     m_shoveTimeLimit.Set( aSettings.Get( "ShoveTimeLimit", 1000 ) );
     m_shoveIterationLimit = aSettings.Get( "ShoveIterationLimit", 250 );
     m_walkaroundIterationLimit = aSettings.Get( "WalkaroundIterationLimit", 50 );
+    m_walkaroundTimeLimit.Set( aSettings.Get( "WalkaroundTimeLimit", 1000 ) );
     m_jumpOverObstacles = aSettings.Get( "JumpOverObstacles", false  );
     m_smoothDraggedSegments = aSettings.Get( "SmoothDraggedSegments", true );
     m_canViolateDRC = aSettings.Get( "CanViolateDRC", false );
@@ -105,6 +108,12 @@ TIME_LIMIT ROUTING_SETTINGS::ShoveTimeLimit() const
 }
 
 
+TIME_LIMIT ROUTING_SETTINGS::WalkaroundTimeLimit() const
+{
+    return TIME_LIMIT ( m_walkaroundTimeLimit );
+}
+
+
 int ROUTING_SETTINGS::ShoveIterationLimit() const
 {
     return m_shoveIterationLimit;
@@ -21,6 +21,7 @@
 
 #define PNS_DEBUG
 
+#include <atomic>
 #include <deque>
 #include <cassert>
 
@@ -45,6 +46,15 @@
 
 namespace PNS {
 
+static std::atomic<uint64_t> s_iterationCount( 0 );
+
+
+uint64_t SHOVE::IterationCount()
+{
+    return s_iterationCount.load( std::memory_order_relaxed );
+}
+
+
 void SHOVE::replaceItems( ITEM* aOld, std::unique_ptr< ITEM > aNew )
 {
     OPT_BOX2I changed_area = ChangedArea( aOld, aNew.get() );
@@ -1055,6 +1065,7 @@ SHOVE::SHOVE_STATUS SHOVE::shoveMainLoop()
         st = shoveIteration( m_iter );
 
         m_iter++;
+        s_iterationCount.fetch_add( 1, std::memory_order_relaxed );
 
         if( st == SH_INCOMPLETE || timeLimit.Expired() || m_iter >= iterLimit )
         {
@@ -85,6 +85,14 @@ public:
 
     void SetInitialLine( LINE& aInitial );
 
+    /**
+     * Function IterationCount()
+     *
+     * @return the number of shove iterations run since the start of the program, for
+     * the profiling of the router.
+     */
+    static uint64_t IterationCount();
+
 private:
     typedef std::vector<SHAPE_LINE_CHAIN> HULL_SET;
     typedef OPT<LINE> OPT_LINE;
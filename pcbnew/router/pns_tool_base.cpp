@@ -56,6 +56,7 @@ using namespace std::placeholders;
 #include "pns_topology.h"
 
 #include <view/view.h>
+#include <advanced_config.h>
 
 using namespace KIGFX;
 
@@ -105,6 +106,7 @@ void TOOL_BASE::Reset( RESET_REASON aReason )
     m_router->SyncWorld();
     m_router->LoadSettings( m_savedSettings );
     m_router->UpdateSizes( m_savedSizes );
+    m_router->SetEventLogging( ADVANCED_CFG::GetCfg().m_recordRouterEvents );
 
     m_gridHelper = new GRID_HELPER( frame() );
 }
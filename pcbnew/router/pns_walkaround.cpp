@@ -19,7 +19,10 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include <core/optional.h>
+#include <thread_pool.h>
 
 #include <geometry/shape_line_chain.h>
 
@@ -52,13 +55,17 @@ NODE::OPT_OBSTACLE WALKAROUND::nearestObstacle( const LINE& aPath )
 
 
 WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
-                                                              bool aWindingDirection )
+                                                              bool aWindingDirection,
+                                                              int aIteration )
 {
     OPT<OBSTACLE>& current_obs =
         aWindingDirection ? m_currentObstacle[0] : m_currentObstacle[1];
 
     bool& prev_recursive = aWindingDirection ? m_recursiveCollision[0] : m_recursiveCollision[1];
 
+    int& blockage_count =
+        aWindingDirection ? m_recursiveBlockageCount[0] : m_recursiveBlockageCount[1];
+
     if( !current_obs )
         return DONE;
 
@@ -68,9 +75,9 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 
     if( ( current_obs->m_hull ).PointInside( last ) || ( current_obs->m_hull ).PointOnEdge( last ) )
     {
-        m_recursiveBlockageCount++;
+        blockage_count++;
 
-        if( m_recursiveBlockageCount < 3 )
+        if( blockage_count < 3 )
             aPath.Line().Append( current_obs->m_hull.NearestPoint( last ) );
         else
         {
@@ -88,12 +95,16 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
         return STUCK;
 
 #ifdef DEBUG
-    m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", m_iteration );
-    m_logger.Log( &path_walk[0], 0, "path-walk" );
-    m_logger.Log( &path_pre[0], 1, "path-pre" );
-    m_logger.Log( &path_post[0], 4, "path-post" );
-    m_logger.Log( &current_obs->m_hull, 2, "hull" );
-    m_logger.Log( current_obs->m_item, 3, "item" );
+    {
+        std::lock_guard<std::mutex> lock( m_loggerLock );
+
+        m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", aIteration );
+        m_logger.Log( &path_walk[0], 0, "path-walk" );
+        m_logger.Log( &path_pre[0], 1, "path-pre" );
+        m_logger.Log( &path_post[0], 4, "path-post" );
+        m_logger.Log( &current_obs->m_hull, 2, "hull" );
+        m_logger.Log( current_obs->m_item, 3, "item" );
+    }
 #endif
 
     int len_pre = path_walk[0].Length();
@@ -144,12 +155,47 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 }
 
 
+WALKAROUND::WALKAROUND_STATUS WALKAROUND::walk( LINE& aPath, bool aWindingDirection,
+                                                int& aIterations, std::atomic<int>& aDoneAt,
+                                                const TIME_LIMIT& aTimeLimit )
+{
+    WALKAROUND_STATUS st = IN_PROGRESS;
+    int iter;
+
+    for( iter = 0; iter < m_iterationLimit; iter++ )
+    {
+        if( !m_forceLongerPath && iter > aDoneAt )
+            break;
+
+        if( aTimeLimit.Expired() )
+            break;
+
+        st = singleStep( aPath, aWindingDirection, iter );
+
+        if( st != IN_PROGRESS )
+            break;
+    }
+
+    if( st == DONE )
+    {
+        int doneAt = aDoneAt;
+
+        while( iter < doneAt && !aDoneAt.compare_exchange_weak( doneAt, iter ) )
+            ;
+    }
+
+    aIterations = iter;
+
+    return st;
+}
+
+
 WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         LINE& aWalkPath, bool aOptimize )
 {
     LINE path_cw( aInitialPath ), path_ccw( aInitialPath );
     WALKAROUND_STATUS s_cw = IN_PROGRESS, s_ccw = IN_PROGRESS;
-    SHAPE_LINE_CHAIN best_path;
+    int iter_cw = 0, iter_ccw = 0;
 
     // special case for via-in-the-middle-of-track placement
     if( aInitialPath.PointCount() <= 1 )
@@ -164,7 +210,7 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
     start( aInitialPath );
 
     m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
-    m_recursiveBlockageCount = 0;
+    m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
 
     aWalkPath = aInitialPath;
 
@@ -177,41 +223,49 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         m_forceSingleDirection = false;
     }
 
-    while( m_iteration < m_iterationLimit )
+    // The two directions only read the world, so they are walked at the same time.  The
+    // result is the one of walking them in lockstep: the first direction done wins, ties
+    // and walks which are never done are decided by the path length.
+    TIME_LIMIT       timeLimit = Settings().WalkaroundTimeLimit();
+    std::atomic<int> doneAt( m_iterationLimit );
+
+    timeLimit.Restart();
+
+    if( s_cw != STUCK && s_ccw != STUCK )
     {
-        if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
+        TASK_GROUP tasks;
 
-        if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
+        tasks.Run( [&]()
+                {
+                    s_cw = walk( path_cw, true, iter_cw, doneAt, timeLimit );
+                } );
 
-        if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
-        {
-            int len_cw  = path_cw.CLine().Length();
-            int len_ccw = path_ccw.CLine().Length();
+        s_ccw = walk( path_ccw, false, iter_ccw, doneAt, timeLimit );
+        tasks.Wait();
+    }
+    else if( s_cw != STUCK )
+    {
+        s_cw = walk( path_cw, true, iter_cw, doneAt, timeLimit );
+    }
+    else
+    {
+        s_ccw = walk( path_ccw, false, iter_ccw, doneAt, timeLimit );
+    }
 
-            if( m_forceLongerPath )
-                aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-            else
-                aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
+    m_iteration = std::max( iter_cw, iter_ccw );
 
-            break;
-        }
-        else if( s_cw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_cw;
-            break;
-        }
-        else if( s_ccw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_ccw;
-            break;
-        }
+    bool cw_first = s_cw == DONE && ( s_ccw != DONE || iter_cw < iter_ccw );
+    bool ccw_first = s_ccw == DONE && ( s_cw != DONE || iter_ccw < iter_cw );
 
-        m_iteration++;
+    if( cw_first && !m_forceLongerPath )
+    {
+        aWalkPath = path_cw;
     }
-
-    if( m_iteration == m_iterationLimit )
+    else if( ccw_first && !m_forceLongerPath )
+    {
+        aWalkPath = path_ccw;
+    }
+    else
     {
         int len_cw  = path_cw.CLine().Length();
         int len_ccw = path_ccw.CLine().Length();
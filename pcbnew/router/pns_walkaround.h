@@ -22,6 +22,8 @@
 #ifndef __PNS_WALKAROUND_H
 #define __PNS_WALKAROUND_H
 
+#include <atomic>
+#include <mutex>
 #include <set>
 
 #include "pns_line.h"
@@ -29,6 +31,7 @@
 #include "pns_router.h"
 #include "pns_logger.h"
 #include "pns_algo_base.h"
+#include "time_limit.h"
 
 namespace PNS {
 
@@ -49,7 +52,7 @@ public:
         m_itemMask = ITEM::ANY_T;
 
         // Initialize other members, to avoid uninitialized variables.
-        m_recursiveBlockageCount = 0;
+        m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
         m_recursiveCollision[0] = m_recursiveCollision[1] = false;
         m_iteration = 0;
         m_forceCw = false;
@@ -129,12 +132,25 @@ public:
 private:
     void start( const LINE& aInitialPath );
 
-    WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection );
+    WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection, int aIteration );
+
+    /**
+     * Function walk()
+     *
+     * Walks around the obstacles in a single direction until done, stuck or out of
+     * iterations or time. Both directions are walked at the same time, each direction
+     * only touches its own state.
+     * @param aIterations receives the iteration at which the walk ended
+     * @param aDoneAt earliest iteration at which one of the directions was done: the walks
+     * ending later cannot be picked, unless the longer path is wanted
+     */
+    WALKAROUND_STATUS walk( LINE& aPath, bool aWindingDirection, int& aIterations,
+                            std::atomic<int>& aDoneAt, const TIME_LIMIT& aTimeLimit );
     NODE::OPT_OBSTACLE nearestObstacle( const LINE& aPath );
 
     NODE* m_world;
 
-    int m_recursiveBlockageCount;
+    int m_recursiveBlockageCount[2];
     int m_iteration;
     int m_iterationLimit;
     int m_itemMask;
@@ -146,6 +162,7 @@ private:
     NODE::OPT_OBSTACLE m_currentObstacle[2];
     bool m_recursiveCollision[2];
     LOGGER m_logger;
+    std::mutex m_loggerLock;
     std::set<ITEM*> m_restrictedSet;
 };
 
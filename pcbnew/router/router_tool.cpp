@@ -44,6 +44,7 @@ using namespace std::placeholders;
 #include <confirm.h>
 #include <bitmaps.h>
 #include <collectors.h>
+#include <advanced_config.h>
 
 #include <tool/context_menu.h>
 #include <tool/tool_manager.h>
@@ -502,8 +503,13 @@ void ROUTER_TOOL::Reset( RESET_REASON aReason )
 
 void ROUTER_TOOL::handleCommonEvents( const TOOL_EVENT& aEvent )
 {
+    bool dumpEnabled = ADVANCED_CFG::GetCfg().m_recordRouterEvents;
+
 #ifdef DEBUG
-    if( aEvent.IsKeyPressed() )
+    dumpEnabled = true;
+#endif
+
+    if( dumpEnabled && aEvent.IsKeyPressed() )
     {
         switch( aEvent.KeyCode() )
         {
@@ -513,7 +519,6 @@ void ROUTER_TOOL::handleCommonEvents( const TOOL_EVENT& aEvent )
             break;
         }
     }
-#endif
 }
 
 
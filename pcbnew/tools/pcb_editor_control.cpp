@@ -56,7 +56,6 @@
 #include <view/view_group.h>
 #include <view/view_controls.h>
 #include <origin_viewitem.h>
-#include <profile.h>
 
 #include <widgets/progress_reporter.h>
 
@@ -244,7 +243,7 @@ PCB_EDITOR_CONTROL::PCB_EDITOR_CONTROL() :
     m_placeOrigin.reset( new KIGFX::ORIGIN_VIEWITEM( KIGFX::COLOR4D( 0.8, 0.0, 0.0, 1.0 ),
                                                 KIGFX::ORIGIN_VIEWITEM::CIRCLE_CROSS ) );
     m_probingSchToPcb = false;
-    m_slowRatsnest = false;
+    m_ratsnestPending = false;
 }
 
 
@@ -1184,28 +1183,18 @@ int PCB_EDITOR_CONTROL::UpdateSelectionRatsnest( const TOOL_EVENT& aEvent )
 
     if( selection.Empty() )
     {
+        m_ratsnestPending = false;
         connectivity->ClearDynamicRatsnest();
     }
-    else if( m_slowRatsnest )
+    else if( connectivity->IsDynamicRatsnestBusy() )
     {
-        // Compute ratsnest only when user stops dragging for a moment
-        connectivity->HideDynamicRatsnest();
-        m_ratsnestTimer.Start( 20 );
+        // Coalesce the motion events: the ratsnest is computed again for the latest
+        // position of the items as soon as the running calculation is over
+        m_ratsnestPending = true;
     }
     else
     {
-        // Check how much time doest it take to calculate ratsnest
-        PROF_COUNTER counter;
         calculateSelectionRatsnest();
-        counter.Stop();
-
-        // If it is too slow, then switch to 'slow ratsnest' mode when
-        // ratsnest is calculated when user stops dragging items for a moment
-        if( counter.msecs() > 25 )
-        {
-            m_slowRatsnest = true;
-            connectivity->HideDynamicRatsnest();
-        }
     }
 
     return 0;
@@ -1215,17 +1204,34 @@ int PCB_EDITOR_CONTROL::UpdateSelectionRatsnest( const TOOL_EVENT& aEvent )
 int PCB_EDITOR_CONTROL::HideSelectionRatsnest( const TOOL_EVENT& aEvent )
 {
     getModel<BOARD>()->GetConnectivity()->ClearDynamicRatsnest();
-    m_slowRatsnest = false;
+    m_ratsnestPending = false;
+    m_ratsnestTimer.Stop();
     return 0;
 }
 
 
 void PCB_EDITOR_CONTROL::ratsnestTimer( wxTimerEvent& aEvent )
 {
-    m_ratsnestTimer.Stop();
-    calculateSelectionRatsnest();
-    static_cast<PCB_DRAW_PANEL_GAL*>( m_frame->GetGalCanvas() )->RedrawRatsnest();
-    m_frame->GetGalCanvas()->Refresh();
+    auto connectivity = board()->GetConnectivity();
+
+    if( connectivity->PublishDynamicRatsnest() )
+    {
+        static_cast<PCB_DRAW_PANEL_GAL*>( m_frame->GetGalCanvas() )->RedrawRatsnest();
+        m_frame->GetGalCanvas()->Refresh();
+    }
+
+    if( connectivity->IsDynamicRatsnestBusy() )
+        return;
+
+    if( m_ratsnestPending )
+    {
+        m_ratsnestPending = false;
+        calculateSelectionRatsnest();
+    }
+    else
+    {
+        m_ratsnestTimer.Stop();
+    }
 }
 
 
@@ -1256,7 +1262,11 @@ void PCB_EDITOR_CONTROL::calculateSelectionRatsnest()
         }
     }
 
-    connectivity->ComputeDynamicRatsnest( items );
+    connectivity->ComputeDynamicRatsnestAsync( items );
+
+    // Polls for the result, see ratsnestTimer()
+    if( !m_ratsnestTimer.IsRunning() )
+        m_ratsnestTimer.Start( 10 );
 }
 
 
@@ -120,7 +120,7 @@ public:
     int ShowLocalRatsnest( const TOOL_EVENT& aEvent );
 
 private:
-    ///> Event handler to recalculate dynamic ratsnest
+    ///> Event handler to display the dynamic ratsnest once computed
     void ratsnestTimer( wxTimerEvent& aEvent );
 
     ///> Recalculates dynamic ratsnest for the current selection
@@ -141,10 +141,10 @@ private:
     ///> Flag to ignore a single crossprobe message from eeschema.
     bool m_probingSchToPcb;
 
-    ///> Flag to indicate whether the current selection ratsnest is slow to calculate.
-    bool m_slowRatsnest;
+    ///> Flag to indicate that the selection was moved while its ratsnest was being computed.
+    bool m_ratsnestPending;
 
-    ///> Timer that start ratsnest calculation when it is slow to compute.
+    ///> Timer polling for the dynamic ratsnest computed in the background.
     wxTimer m_ratsnestTimer;
 
     ///> How to modify a property for selected items.
@@ -25,9 +25,14 @@
 #include <cstdint>
 #include <thread>
 #include <mutex>
+#include <algorithm>
 
 #include <class_zone.h>
 #include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_drawsegment.h>
+#include <board_design_settings.h>
 #include <connectivity/connectivity_data.h>
 #include <board_commit.h>
 
@@ -63,18 +68,182 @@ TOOL_ACTION PCB_ACTIONS::zoneDeleteSegzone( "pcbnew.ZoneFiller.zoneDeleteSegzone
         _( "Delete Zone Filling" ), _( "Delete Zone Filling" ), delete_xpm );
 
 ZONE_FILLER_TOOL::ZONE_FILLER_TOOL() :
-    PCB_TOOL( "pcbnew.ZoneFiller" )
+    PCB_TOOL( "pcbnew.ZoneFiller" ),
+    m_board( nullptr ),
+    m_allZonesDirty( true ),
+    m_filling( false )
 {
 }
 
 
 ZONE_FILLER_TOOL::~ZONE_FILLER_TOOL()
 {
+    if( m_board )
+        m_board->RemoveListener( this );
 }
 
 
 void ZONE_FILLER_TOOL::Reset( RESET_REASON aReason )
 {
+    // A board we do not listen to yet is a new one: we know nothing about its fills
+    if( board() != m_board )
+    {
+        if( m_board )
+            m_board->RemoveListener( this );
+
+        m_board = board();
+        m_board->AddListener( this );
+
+        m_itemAreas.clear();
+        m_dirtyAreas.clear();
+        m_allZonesDirty = true;
+    }
+}
+
+
+void ZONE_FILLER_TOOL::OnBoardDeleted( BOARD& aBoard )
+{
+    if( &aBoard == m_board )
+        m_board = nullptr;
+}
+
+
+ZONE_FILLER_TOOL::ITEM_AREA ZONE_FILLER_TOOL::itemArea( const BOARD_ITEM* aItem )
+{
+    EDA_RECT bbox = aItem->GetBoundingBox();
+    int      clearance = 0;
+
+    if( aItem->Type() == PCB_MODULE_T )
+    {
+        // Pads may have a local clearance or thermal gap larger than their netclass ones
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+
+        for( const D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+            clearance = std::max( { clearance, pad->GetClearance(), pad->GetThermalGap() } );
+
+        bbox.Inflate( clearance );
+
+        // Footprints may have copper graphics on any layer
+        return ITEM_AREA( bbox, LSET::AllLayersMask() );
+    }
+
+    if( aItem->IsConnected() )
+        clearance = static_cast<const BOARD_CONNECTED_ITEM*>( aItem )->GetClearance();
+
+    bbox.Inflate( clearance );
+
+    return ITEM_AREA( bbox, aItem->GetLayerSet() );
+}
+
+
+void ZONE_FILLER_TOOL::OnBoardItemsChanged( BOARD& aBoard,
+                                            const std::vector<BOARD_ITEM*>& aChangedItems,
+                                            const std::vector<BOARD_ITEM*>& aRemovedItems )
+{
+    if( m_filling || m_allZonesDirty )
+        return;
+
+    // The removed items may be already deleted: use their area at the last fill
+    for( BOARD_ITEM* item : aRemovedItems )
+    {
+        auto it = m_itemAreas.find( item );
+
+        if( it != m_itemAreas.end() )
+        {
+            m_dirtyAreas.push_back( it->second );
+            m_itemAreas.erase( it );
+        }
+    }
+
+    // A modified item changes the fills both at its old and at its new place
+    for( BOARD_ITEM* item : aChangedItems )
+    {
+        if( item->Type() == PCB_MARKER_T )
+            continue;
+
+        auto it = m_itemAreas.find( item );
+
+        if( it != m_itemAreas.end() )
+            m_dirtyAreas.push_back( it->second );
+
+        m_dirtyAreas.push_back( itemArea( item ) );
+    }
+}
+
+
+std::vector<ZONE_CONTAINER*> ZONE_FILLER_TOOL::zonesToRefill() const
+{
+    std::vector<ZONE_CONTAINER*> toFill;
+    bool allDirty = m_allZonesDirty || settingsSignature() != m_lastSettings;
+
+    for( ZONE_CONTAINER* zone : board()->Zones() )
+    {
+        if( allDirty || !zone->IsFilled() )
+        {
+            toFill.push_back( zone );
+            continue;
+        }
+
+        // Everything closer to the zone than the clearances and the thermal relief gap
+        // has an effect on its fill.  The dirty areas are inflated by the item clearances.
+        EDA_RECT bbox = zone->GetBoundingBox();
+        bbox.Inflate( zone->GetZoneClearance() + zone->GetThermalReliefGap()
+                      + zone->GetMinThickness() );
+
+        for( const ITEM_AREA& area : m_dirtyAreas )
+        {
+            // Items on Edge_Cuts knock out all the layers
+            if( !area.second.test( zone->GetLayer() ) && !area.second.test( Edge_Cuts ) )
+                continue;
+
+            if( bbox.Intersects( area.first ) )
+            {
+                toFill.push_back( zone );
+                break;
+            }
+        }
+    }
+
+    return toFill;
+}
+
+
+void ZONE_FILLER_TOOL::cacheItemAreas()
+{
+    m_itemAreas.clear();
+
+    for( TRACK* track : board()->Tracks() )
+        m_itemAreas[track] = itemArea( track );
+
+    for( MODULE* module : board()->Modules() )
+        m_itemAreas[module] = itemArea( module );
+
+    for( BOARD_ITEM* item : board()->Drawings() )
+        m_itemAreas[item] = itemArea( item );
+
+    for( ZONE_CONTAINER* zone : board()->Zones() )
+        m_itemAreas[zone] = itemArea( zone );
+
+    m_dirtyAreas.clear();
+    m_allZonesDirty = false;
+    m_lastSettings = settingsSignature();
+}
+
+
+std::vector<int> ZONE_FILLER_TOOL::settingsSignature() const
+{
+    // The netclass and board settings are not changed through commits
+    BOARD_DESIGN_SETTINGS& settings = board()->GetDesignSettings();
+    std::vector<int>       signature;
+
+    signature.push_back( settings.GetDefault()->GetClearance() );
+
+    for( auto nc = settings.m_NetClasses.begin(); nc != settings.m_NetClasses.end(); ++nc )
+        signature.push_back( nc->second->GetClearance() );
+
+    signature.push_back( board()->GetCopperLayerCount() );
+
+    return signature;
 }
 
 // Zone actions
@@ -99,7 +268,11 @@ int ZONE_FILLER_TOOL::ZoneFill( const TOOL_EVENT& aEvent )
 
     ZONE_FILLER filler( board(), &commit );
     filler.SetProgressReporter( progressReporter.get() );
+
+    // Refilling does not change the zone outlines, so it does not dirty the other zones
+    m_filling = true;
     filler.Fill( toFill );
+    m_filling = false;
 
     canvas()->Refresh();
 
@@ -109,15 +282,18 @@ int ZONE_FILLER_TOOL::ZoneFill( const TOOL_EVENT& aEvent )
 
 int ZONE_FILLER_TOOL::ZoneFillAll( const TOOL_EVENT& aEvent )
 {
-    std::vector<ZONE_CONTAINER*> toFill;
+    // Only the zones close to the changes made since the last fill need a refill,
+    // the other ones keep their current fill
+    std::vector<ZONE_CONTAINER*> toFill = zonesToRefill();
 
-    BOARD_COMMIT commit( this );
-
-    for( auto zone : board()->Zones() )
+    if( toFill.empty() )
     {
-        toFill.push_back(zone);
+        frame()->m_ZoneFillsDirty = false;
+        return 0;
     }
 
+    BOARD_COMMIT commit( this );
+
     std::unique_ptr<WX_PROGRESS_REPORTER> progressReporter(
             new WX_PROGRESS_REPORTER( frame(), _( "Fill All Zones" ), 4 )
             );
@@ -125,8 +301,15 @@ int ZONE_FILLER_TOOL::ZoneFillAll( const TOOL_EVENT& aEvent )
     ZONE_FILLER filler( board(), &commit );
     filler.SetProgressReporter( progressReporter.get() );
 
+    m_filling = true;
+
     if( filler.Fill( toFill ) )
+    {
         frame()->m_ZoneFillsDirty = false;
+        cacheItemAreas();
+    }
+
+    m_filling = false;
 
     canvas()->Refresh();
 
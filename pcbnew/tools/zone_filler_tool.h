@@ -26,6 +26,9 @@
 #define ZONE_FILLER_TOOL_H
 
 #include <tools/pcb_tool.h>
+#include <class_board.h>
+
+#include <unordered_map>
 
 
 class PCB_EDIT_FRAME;
@@ -34,8 +37,11 @@ class PCB_EDIT_FRAME;
  * Class ZONE_FILLER_TOOL
  *
  * Handles actions specific to filling copper zones.
+ *
+ * The tool listens to the board commits and keeps the areas changed since the last
+ * "Fill All", so the next one only refills the zones close to a change.
  */
-class ZONE_FILLER_TOOL : public PCB_TOOL
+class ZONE_FILLER_TOOL : public PCB_TOOL, public BOARD_LISTENER
 {
 public:
     ZONE_FILLER_TOOL();
@@ -53,9 +59,51 @@ public:
     // Segzone action
     int SegzoneDeleteFill( const TOOL_EVENT& aEvent );
 
+    ///> Collects the areas changed by a commit
+    void OnBoardItemsChanged( BOARD& aBoard, const std::vector<BOARD_ITEM*>& aChangedItems,
+                              const std::vector<BOARD_ITEM*>& aRemovedItems ) override;
+
+    ///> Forgets the board, which cannot be unregistered from anymore
+    void OnBoardDeleted( BOARD& aBoard ) override;
+
 private:
+    ///> Area covered by an item, and the layers it is on
+    typedef std::pair<EDA_RECT, LSET> ITEM_AREA;
+
     ///> Sets up handlers for various events.
     void setTransitions() override;
+
+    ///> Returns the area where an item can change the zone fills: its bounding box inflated
+    ///> by its own clearance, and its layers.
+    static ITEM_AREA itemArea( const BOARD_ITEM* aItem );
+
+    ///> Returns the zones whose fill may be changed by the edits made since the last fill.
+    std::vector<ZONE_CONTAINER*> zonesToRefill() const;
+
+    ///> Saves the areas of the board items, once all the zones are up to date.
+    void cacheItemAreas();
+
+    ///> Returns the clearance settings the fills depend on, to detect their changes.
+    std::vector<int> settingsSignature() const;
+
+    ///> The board the tool listens to
+    BOARD* m_board;
+
+    ///> Area of each board item at the time of the last fill, to know where a
+    ///> modified or deleted item used to be.
+    std::unordered_map<const BOARD_ITEM*, ITEM_AREA> m_itemAreas;
+
+    ///> Areas changed since the last fill
+    std::vector<ITEM_AREA> m_dirtyAreas;
+
+    ///> True when the changes are unknown (new board), so all zones must be refilled
+    bool m_allZonesDirty;
+
+    ///> True while the tool is filling zones, to ignore its own commits
+    bool m_filling;
+
+    ///> Value of settingsSignature() at the time of the last fill
+    std::vector<int> m_lastSettings;
 };
 
 #endif
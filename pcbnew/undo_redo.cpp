@@ -420,6 +420,9 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
 
     bool build_item_list = true;    // if true the list of existing items must be rebuilt
 
+    std::vector<BOARD_ITEM*> changedItems;      // for the board listeners
+    std::vector<BOARD_ITEM*> removedItems;
+
     // Restore changes in reverse order
     for( int ii = aList->GetCount() - 1; ii >= 0 ; ii-- )
     {
@@ -517,6 +520,7 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
             aList->SetPickedItemStatus( UR_DELETED, ii );
             GetModel()->Remove( item );
             view->Remove( item );
+            removedItems.push_back( item );
             break;
 
         case UR_DELETED:    /* deleted items are put in List, as new items */
@@ -573,6 +577,13 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
         }
         break;
         }
+
+        // The status now describes the reverse operation, so UR_DELETED items are the
+        // ones which just left the board
+        if( aList->GetPickedItemStatus( ii ) != UR_DELETED
+                && aList->GetPickedItemStatus( ii ) != UR_DRILLORIGIN
+                && aList->GetPickedItemStatus( ii ) != UR_GRIDORIGIN )
+            changedItems.push_back( item );
     }
 
     if( not_found )
@@ -586,6 +597,9 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
     }
 
     GetBoard()->SanitizeNetcodes();
+
+    if( IsType( FRAME_PCB ) )
+        GetBoard()->OnItemsChanged( changedItems, removedItems );
 }
 
 
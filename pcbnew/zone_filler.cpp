@@ -27,7 +27,6 @@
 #include <thread>
 #include <mutex>
 #include <algorithm>
-#include <future>
 
 #include <class_board.h>
 #include <class_zone.h>
@@ -48,6 +47,8 @@
 #include <geometry/convex_hull.h>
 #include <geometry/geometry_utils.h>
 #include <confirm.h>
+#include <drc_rtree.h>
+#include <thread_pool.h>
 
 #include "zone_filler.h"
 
@@ -116,14 +117,20 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones, bool aCheck )
     // Remove deprecaded segment zones (only found in very old boards)
     m_board->m_SegZoneDeprecated.DeleteAll();
 
+    buildFeatureIndex();
+
+    TASK_GROUP          tasks;
     std::atomic<size_t> nextItem( 0 );
-    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(), toFill.size() );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
+    size_t parallelThreadCount = std::min<size_t>( tasks.GetThreadCount(), toFill.size() );
 
-    auto fill_lambda = [&] ( PROGRESS_REPORTER* aReporter ) -> size_t
+    auto keepAlive = [&]()
     {
-        size_t num = 0;
+        if( m_progressReporter )
+            m_progressReporter->KeepRefreshing();
+    };
 
+    auto fill_lambda = [&]()
+    {
         for( size_t i = nextItem++; i < toFill.size(); i = nextItem++ )
         {
             ZONE_CONTAINER* zone = toFill[i].m_zone;
@@ -147,33 +154,13 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones, bool aCheck )
 
             if( m_progressReporter )
                 m_progressReporter->AdvanceProgress();
-
-            num++;
         }
-
-        return num;
     };
 
-    if( parallelThreadCount <= 1 )
-        fill_lambda( m_progressReporter );
-    else
-    {
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, fill_lambda, m_progressReporter );
-
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-        {
-            // Here we balance returns with a 100ms timeout to allow UI updating
-            std::future_status status;
-            do
-            {
-                if( m_progressReporter )
-                    m_progressReporter->KeepRefreshing();
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        tasks.Run( fill_lambda );
 
-                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-            } while( status != std::future_status::ready );
-        }
-    }
+    tasks.Wait( keepAlive );
 
     // Now update the connectivity to check for copper islands
     if( m_progressReporter )
@@ -249,42 +236,21 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones, bool aCheck )
 
     nextItem = 0;
 
-    auto tri_lambda = [&] ( PROGRESS_REPORTER* aReporter ) -> size_t
+    auto tri_lambda = [&]()
     {
-        size_t num = 0;
-
         for( size_t i = nextItem++; i < toFill.size(); i = nextItem++ )
         {
             toFill[i].m_zone->CacheTriangulation();
-            num++;
 
             if( m_progressReporter )
                 m_progressReporter->AdvanceProgress();
         }
-
-        return num;
     };
 
-    if( parallelThreadCount <= 1 )
-        tri_lambda( m_progressReporter );
-    else
-    {
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, tri_lambda, m_progressReporter );
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        tasks.Run( tri_lambda );
 
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-        {
-            // Here we balance returns with a 100ms timeout to allow UI updating
-            std::future_status status;
-            do
-            {
-                if( m_progressReporter )
-                    m_progressReporter->KeepRefreshing();
-
-                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-            } while( status != std::future_status::ready );
-        }
-    }
+    tasks.Wait( keepAlive );
 
     if( m_progressReporter )
     {
@@ -313,6 +279,48 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones, bool aCheck )
 }
 
 
+void ZONE_FILLER::buildFeatureIndex()
+{
+    // The pads are indexed with their largest possible knock out, so a zone only has
+    // to inflate its own bounding box by its own clearance and thermal gap
+    int padMargin = m_board->GetDesignSettings().GetBiggestClearanceValue();
+
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+            padMargin = std::max( { padMargin, pad->GetClearance(), pad->GetThermalGap() } );
+    }
+
+    m_padIndex.reset( new DRC_RTREE<D_PAD*>( padMargin ) );
+    m_trackIndex.reset( new DRC_RTREE<TRACK*>() );
+    m_graphicIndex.reset( new DRC_RTREE<BOARD_ITEM*>() );
+
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+        {
+            // The hole is knocked out of the zones on the layers without the pad
+            m_padIndex->Insert( pad, pad->GetBoundingBoxWithHole() );
+        }
+    }
+
+    for( auto track : m_board->Tracks() )
+        m_trackIndex->Insert( track, track->GetBoundingBox() );
+
+    for( auto module : m_board->Modules() )
+    {
+        m_graphicIndex->Insert( &module->Reference(), module->Reference().GetBoundingBox() );
+        m_graphicIndex->Insert( &module->Value(), module->Value().GetBoundingBox() );
+
+        for( auto item : module->GraphicalItems() )
+            m_graphicIndex->Insert( item, item->GetBoundingBox() );
+    }
+
+    for( auto item : m_board->Drawings() )
+        m_graphicIndex->Insert( item, item->GetBoundingBox() );
+}
+
+
 void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
         SHAPE_POLY_SET& aFeatures ) const
 {
@@ -355,6 +363,15 @@ void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
     biggest_clearance = std::max( biggest_clearance, zone_clearance );
     zone_boundingbox.Inflate( biggest_clearance );
 
+    // Only the items found in the feature indexes near the zone are candidates.
+    // The pad index is inflated by the largest pad clearance, the zone side of
+    // the pad tests is covered here.
+    EDA_RECT search_box = zone_boundingbox;
+    search_box.Inflate( std::max( zone_clearance, aZone->GetThermalReliefGap() )
+                        + outline_half_thickness );
+
+    std::vector<int> candidates;
+
     /*
      * First : Add pads. Note: pads having the same net as zone are left in zone.
      * Thermal shapes will be created later if necessary
@@ -370,120 +387,117 @@ void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
     MODULE  dummymodule( m_board );   // Creates a dummy parent
     D_PAD   dummypad( &dummymodule );
 
-    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    m_padIndex->Query( search_box, candidates );
+
+    for( int candidate : candidates )
     {
-        D_PAD* nextpad;
+        // pad pointer can be modified by next code
+        D_PAD* pad = m_padIndex->GetItem( candidate );
 
-        for( D_PAD* pad = module->PadsList(); pad != NULL; pad = nextpad )
+        if( !pad->IsOnLayer( aZone->GetLayer() ) )
         {
-            nextpad = pad->Next();      // pad pointer can be modified by next code, so
-                                        // calculate the next pad here
+            /* Test for pads that are on top or bottom only and have a hole.
+             * There are curious pads but they can be used for some components that are
+             * inside the board (in fact inside the hole. Some photo diodes and Leds are
+             * like this)
+             */
+            if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
+                continue;
 
-            if( !pad->IsOnLayer( aZone->GetLayer() ) )
-            {
-                /* Test for pads that are on top or bottom only and have a hole.
-                 * There are curious pads but they can be used for some components that are
-                 * inside the board (in fact inside the hole. Some photo diodes and Leds are
-                 * like this)
-                 */
-                if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
-                    continue;
+            // Use a dummy pad to calculate a hole shape that have the same dimension as
+            // the pad hole
+            dummypad.SetSize( pad->GetDrillSize() );
+            dummypad.SetOrientation( pad->GetOrientation() );
+            dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_SHAPE_OBLONG ?
+                    PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
+            dummypad.SetPosition( pad->GetPosition() );
 
-                // Use a dummy pad to calculate a hole shape that have the same dimension as
-                // the pad hole
-                dummypad.SetSize( pad->GetDrillSize() );
-                dummypad.SetOrientation( pad->GetOrientation() );
-                dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_SHAPE_OBLONG ?
-                        PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
-                dummypad.SetPosition( pad->GetPosition() );
+            pad = &dummypad;
+        }
 
-                pad = &dummypad;
-            }
+        // Note: netcode <=0 means not connected item
+        if( ( pad->GetNetCode() != aZone->GetNetCode() ) || ( pad->GetNetCode() <= 0 ) )
+        {
+            int item_clearance = pad->GetClearance() + outline_half_thickness;
+            item_boundingbox = pad->GetBoundingBox();
+            item_boundingbox.Inflate( item_clearance );
 
-            // Note: netcode <=0 means not connected item
-            if( ( pad->GetNetCode() != aZone->GetNetCode() ) || ( pad->GetNetCode() <= 0 ) )
+            if( item_boundingbox.Intersects( zone_boundingbox ) )
             {
-                int item_clearance = pad->GetClearance() + outline_half_thickness;
-                item_boundingbox = pad->GetBoundingBox();
-                item_boundingbox.Inflate( item_clearance );
+                int clearance = std::max( zone_clearance, item_clearance );
 
-                if( item_boundingbox.Intersects( zone_boundingbox ) )
+                // PAD_SHAPE_CUSTOM can have a specific keepout, to avoid to break the shape
+                if( pad->GetShape() == PAD_SHAPE_CUSTOM
+                    && pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
                 {
-                    int clearance = std::max( zone_clearance, item_clearance );
-
-                    // PAD_SHAPE_CUSTOM can have a specific keepout, to avoid to break the shape
-                    if( pad->GetShape() == PAD_SHAPE_CUSTOM
-                        && pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
+                    // the pad shape in zone can be its convex hull or
+                    // the shape itself
+                    SHAPE_POLY_SET outline( pad->GetCustomShapeAsPolygon() );
+                    outline.Inflate( KiROUND( clearance * correctionFactor ), segsPerCircle );
+                    pad->CustomShapeAsPolygonToBoardPosition( &outline,
+                            pad->GetPosition(), pad->GetOrientation() );
+
+                    if( pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
                     {
-                        // the pad shape in zone can be its convex hull or
-                        // the shape itself
-                        SHAPE_POLY_SET outline( pad->GetCustomShapeAsPolygon() );
-                        outline.Inflate( KiROUND( clearance * correctionFactor ), segsPerCircle );
-                        pad->CustomShapeAsPolygonToBoardPosition( &outline,
-                                pad->GetPosition(), pad->GetOrientation() );
-
-                        if( pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
-                        {
-                            std::vector<wxPoint> convex_hull;
-                            BuildConvexHull( convex_hull, outline );
-
-                            aFeatures.NewOutline();
-
-                            for( unsigned ii = 0; ii < convex_hull.size(); ++ii )
-                                aFeatures.Append( convex_hull[ii] );
-                        }
-                        else
-                            aFeatures.Append( outline );
+                        std::vector<wxPoint> convex_hull;
+                        BuildConvexHull( convex_hull, outline );
+
+                        aFeatures.NewOutline();
+
+                        for( unsigned ii = 0; ii < convex_hull.size(); ++ii )
+                            aFeatures.Append( convex_hull[ii] );
                     }
                     else
-                        pad->TransformShapeWithClearanceToPolygon( aFeatures,
-                                clearance,
-                                segsPerCircle,
-                                correctionFactor );
+                        aFeatures.Append( outline );
                 }
-
-                continue;
+                else
+                    pad->TransformShapeWithClearanceToPolygon( aFeatures,
+                            clearance,
+                            segsPerCircle,
+                            correctionFactor );
             }
 
-            // Pads are removed from zone if the setup is PAD_ZONE_CONN_NONE
-            // or if they have a custom shape and not PAD_ZONE_CONN_FULL,
-            // because a thermal relief will break
-            // the shape
-            if( aZone->GetPadConnection( pad ) == PAD_ZONE_CONN_NONE
-                || ( pad->GetShape() == PAD_SHAPE_CUSTOM && aZone->GetPadConnection( pad ) != PAD_ZONE_CONN_FULL ) )
-            {
-                int gap = zone_clearance;
-                int thermalGap = aZone->GetThermalReliefGap( pad );
-                gap = std::max( gap, thermalGap );
-                item_boundingbox = pad->GetBoundingBox();
-                item_boundingbox.Inflate( gap );
+            continue;
+        }
 
-                if( item_boundingbox.Intersects( zone_boundingbox ) )
+        // Pads are removed from zone if the setup is PAD_ZONE_CONN_NONE
+        // or if they have a custom shape and not PAD_ZONE_CONN_FULL,
+        // because a thermal relief will break
+        // the shape
+        if( aZone->GetPadConnection( pad ) == PAD_ZONE_CONN_NONE
+            || ( pad->GetShape() == PAD_SHAPE_CUSTOM && aZone->GetPadConnection( pad ) != PAD_ZONE_CONN_FULL ) )
+        {
+            int gap = zone_clearance;
+            int thermalGap = aZone->GetThermalReliefGap( pad );
+            gap = std::max( gap, thermalGap );
+            item_boundingbox = pad->GetBoundingBox();
+            item_boundingbox.Inflate( gap );
+
+            if( item_boundingbox.Intersects( zone_boundingbox ) )
+            {
+                // PAD_SHAPE_CUSTOM has a specific keepout, to avoid to break the shape
+                // the pad shape in zone can be its convex hull or the shape itself
+                if( pad->GetShape() == PAD_SHAPE_CUSTOM
+                    && pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
                 {
-                    // PAD_SHAPE_CUSTOM has a specific keepout, to avoid to break the shape
-                    // the pad shape in zone can be its convex hull or the shape itself
-                    if( pad->GetShape() == PAD_SHAPE_CUSTOM
-                        && pad->GetCustomShapeInZoneOpt() == CUST_PAD_SHAPE_IN_ZONE_CONVEXHULL )
-                    {
-                        // the pad shape in zone can be its convex hull or
-                        // the shape itself
-                        SHAPE_POLY_SET outline( pad->GetCustomShapeAsPolygon() );
-                        outline.Inflate( KiROUND( gap * correctionFactor ), segsPerCircle );
-                        pad->CustomShapeAsPolygonToBoardPosition( &outline,
-                                pad->GetPosition(), pad->GetOrientation() );
+                    // the pad shape in zone can be its convex hull or
+                    // the shape itself
+                    SHAPE_POLY_SET outline( pad->GetCustomShapeAsPolygon() );
+                    outline.Inflate( KiROUND( gap * correctionFactor ), segsPerCircle );
+                    pad->CustomShapeAsPolygonToBoardPosition( &outline,
+                            pad->GetPosition(), pad->GetOrientation() );
 
-                        std::vector<wxPoint> convex_hull;
-                        BuildConvexHull( convex_hull, outline );
+                    std::vector<wxPoint> convex_hull;
+                    BuildConvexHull( convex_hull, outline );
 
-                        aFeatures.NewOutline();
+                    aFeatures.NewOutline();
 
-                        for( unsigned ii = 0; ii < convex_hull.size(); ++ii )
-                            aFeatures.Append( convex_hull[ii] );
-                    }
-                    else
-                        pad->TransformShapeWithClearanceToPolygon( aFeatures,
-                                gap, segsPerCircle, correctionFactor );
+                    for( unsigned ii = 0; ii < convex_hull.size(); ++ii )
+                        aFeatures.Append( convex_hull[ii] );
                 }
+                else
+                    pad->TransformShapeWithClearanceToPolygon( aFeatures,
+                            gap, segsPerCircle, correctionFactor );
             }
         }
     }
@@ -491,8 +505,12 @@ void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
     /* Add holes (i.e. tracks and vias areas as polygons outlines)
      * in cornerBufferPolysToSubstract
      */
-    for( auto track : m_board->Tracks() )
+    m_trackIndex->Query( search_box, candidates );
+
+    for( int candidate : candidates )
     {
+        TRACK* track = m_trackIndex->GetItem( candidate );
+
         if( !track->IsOnLayer( aZone->GetLayer() ) )
             continue;
 
@@ -569,17 +587,10 @@ void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
         }
     };
 
-    for( auto module : m_board->Modules() )
-    {
-        doGraphicItem( &module->Reference() );
-        doGraphicItem( &module->Value() );
+    m_graphicIndex->Query( search_box, candidates );
 
-        for( auto item : module->GraphicalItems() )
-            doGraphicItem( item );
-    }
-
-    for( auto item : m_board->Drawings() )
-        doGraphicItem( item );
+    for( int candidate : candidates )
+        doGraphicItem( m_graphicIndex->GetItem( candidate ) );
 
     /* Add zones outlines having an higher priority and keepout
      */
@@ -736,16 +747,9 @@ void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
     if( s_DumpZonesWhenFilling )
         dumper->Write( &holes, "feature-holes" );
 
-    holes.Simplify( SHAPE_POLY_SET::PM_FAST );
-
-    if( s_DumpZonesWhenFilling )
-        dumper->Write( &holes, "feature-holes-postsimplify" );
-
     // Generate the filled areas (currently, without thermal shapes, which will
     // be created later).
-    // Use SHAPE_POLY_SET::PM_STRICTLY_SIMPLE to generate strictly simple polygons
-    // needed by Gerber files and Fracture()
-    solidAreas.BooleanSubtract( holes, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+    subtractHoles( solidAreas, holes );
 
     if( s_DumpZonesWhenFilling )
         dumper->Write( &solidAreas, "solid-areas-minus-holes" );
@@ -772,7 +776,7 @@ void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
     // remove copper areas corresponding to not connected stubs
     if( !thermalHoles.IsEmpty() )
     {
-        thermalHoles.Simplify( SHAPE_POLY_SET::PM_FAST );
+        thermalHoles.SimplifyParallel( SHAPE_POLY_SET::PM_FAST );
         // Remove unconnected stubs. Use SHAPE_POLY_SET::PM_STRICTLY_SIMPLE to
         // generate strictly simple polygons
         // needed by Gerber files and Fracture()
@@ -797,6 +801,111 @@ void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
         dumper->EndGroup();
 }
 
+void ZONE_FILLER::subtractHoles( SHAPE_POLY_SET& aAreas, SHAPE_POLY_SET& aHoles ) const
+{
+    // Below this count of holes per strip, the cost of the strip cutting and of the
+    // final merge is not worth it
+    const int minHolesPerStrip = 200;
+
+    // The strips are queued in the thread pool, behind the other zones being filled:
+    // they only run in parallel when some workers are idle
+    TASK_GROUP strips;
+    size_t     stripCount = strips.GetThreadCount();
+    int        holeCount = aHoles.OutlineCount();
+
+    stripCount = std::min<size_t>( stripCount, holeCount / minHolesPerStrip );
+
+    if( stripCount <= 1 )
+    {
+        // The holes are merged by the subtraction itself, no need to simplify them first.
+        // Use SHAPE_POLY_SET::PM_STRICTLY_SIMPLE to generate strictly simple polygons
+        // needed by Gerber files and Fracture()
+        aAreas.BooleanSubtract( aHoles, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+        return;
+    }
+
+    // Cut the strips where they get about the same number of holes
+    std::vector<BOX2I> holeBoxes( holeCount );
+    std::vector<int>   centers( holeCount );
+
+    for( int ii = 0; ii < holeCount; ++ii )
+    {
+        holeBoxes[ii] = aHoles.COutline( ii ).BBox();
+        centers[ii] = holeBoxes[ii].Centre().x;
+    }
+
+    std::sort( centers.begin(), centers.end() );
+
+    BOX2I            areasBox = aAreas.BBox();
+    std::vector<int> cuts;
+
+    cuts.push_back( areasBox.GetLeft() - 1 );
+
+    for( size_t ii = 1; ii < stripCount; ++ii )
+    {
+        int x = centers[ ii * holeCount / stripCount ];
+
+        if( x > cuts.back() && x < areasBox.GetRight() )
+            cuts.push_back( x );
+    }
+
+    cuts.push_back( areasBox.GetRight() + 1 );
+
+    std::vector<SHAPE_POLY_SET> results( cuts.size() - 1 );
+
+    auto strip_lambda = [&]( size_t aStrip )
+    {
+        int top = areasBox.GetTop() - 1;
+        int bottom = areasBox.GetBottom() + 1;
+
+        SHAPE_POLY_SET stripBox;
+        stripBox.NewOutline();
+        stripBox.Append( cuts[aStrip], top );
+        stripBox.Append( cuts[aStrip + 1], top );
+        stripBox.Append( cuts[aStrip + 1], bottom );
+        stripBox.Append( cuts[aStrip], bottom );
+
+        SHAPE_POLY_SET stripHoles;
+
+        for( int ii = 0; ii < holeCount; ++ii )
+        {
+            if( holeBoxes[ii].GetRight() < cuts[aStrip]
+                    || holeBoxes[ii].GetLeft() > cuts[aStrip + 1] )
+                continue;
+
+            stripHoles.AddOutline( aHoles.COutline( ii ) );
+
+            for( int jj = 0; jj < aHoles.HoleCount( ii ); ++jj )
+                stripHoles.AddHole( aHoles.CHole( ii, jj ) );
+        }
+
+        // Both operations in a row, without converting the strip back in between.  The
+        // intersection starts from the box to avoid a copy of the whole areas.
+        SHAPE_POLY_SET& stripAreas = results[aStrip];
+        stripAreas = stripBox;
+        stripAreas.BooleanBatch( { { SHAPE_POLY_SET::BO_INTERSECT, &aAreas },
+                                   { SHAPE_POLY_SET::BO_SUBTRACT, &stripHoles } },
+                                 SHAPE_POLY_SET::PM_FAST );
+    };
+
+    for( size_t ii = 0; ii < results.size(); ++ii )
+        strips.Run( std::bind( strip_lambda, ii ) );
+
+    strips.Wait();
+
+    // Merge the strips back.  Both sides of a cut are computed from the same edges, so
+    // they match and the union welds them.  The strictly simple pass is done once the
+    // cuts are gone: Clipper is very slow on the touching edges of the strips.
+    aAreas.RemoveAllContours();
+
+    for( const SHAPE_POLY_SET& strip : results )
+        aAreas.Append( strip );
+
+    aAreas.Simplify( SHAPE_POLY_SET::PM_FAST );
+    aAreas.Simplify( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+}
+
+
 /* Build the filled solid areas data from real outlines (stored in m_Poly)
  * The solid areas can be more than one on copper layers, and do not have holes
  * ( holes are linked by overlapping segments to the main outline)
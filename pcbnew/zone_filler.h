@@ -27,13 +27,18 @@
 #define __ZONE_FILLER_H
 
 #include <vector>
+#include <memory>
 #include <class_zone.h>
 
+template< class T > class DRC_RTREE;
+
 class WX_PROGRESS_REPORTER;
 class BOARD;
 class COMMIT;
 class SHAPE_POLY_SET;
 class SHAPE_LINE_CHAIN;
+class D_PAD;
+class TRACK;
 
 class ZONE_FILLER
 {
@@ -46,6 +51,13 @@ public:
 
 private:
 
+    /**
+     * Function buildFeatureIndex
+     * Builds the spatial indexes of the pads, tracks and graphic items of the board,
+     * shared by all the zones filled by a Fill() call.
+     */
+    void buildFeatureIndex();
+
     void buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
             SHAPE_POLY_SET& aFeatures ) const;
 
@@ -115,9 +127,26 @@ private:
             SHAPE_POLY_SET& aRawPolys,
             SHAPE_POLY_SET& aFinalPolys ) const;
 
+    /**
+     * Function subtractHoles
+     * Removes the feature holes from the solid areas of a zone, with the same result
+     * as a strictly simple BooleanSubtract().
+     * When the zone has many holes, the areas are cut in vertical strips holding about
+     * the same number of holes, which are processed by the thread pool and merged back.
+     * @param aAreas are the solid areas, modified in place
+     * @param aHoles are the feature holes of the zone
+     */
+    void subtractHoles( SHAPE_POLY_SET& aAreas, SHAPE_POLY_SET& aHoles ) const;
+
     BOARD* m_board;
     COMMIT* m_commit;
     WX_PROGRESS_REPORTER* m_progressReporter;
+
+    ///> Items which can knock out a zone fill, in board order.  The pads are indexed
+    ///> with their largest clearance or thermal gap, the other items with their bounding box.
+    std::unique_ptr<DRC_RTREE<D_PAD*>>      m_padIndex;
+    std::unique_ptr<DRC_RTREE<TRACK*>>      m_trackIndex;
+    std::unique_ptr<DRC_RTREE<BOARD_ITEM*>> m_graphicIndex;
 };
 
 #endif
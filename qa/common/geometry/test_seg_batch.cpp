@@ -0,0 +1,173 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <geometry/seg_batch.h>
+#include <geometry/shape_line_chain.h>
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <random>
+
+
+/**
+ * Random segments of all the kinds SEG handles differently: degenerate, horizontal,
+ * vertical, diagonal, almost horizontal, vertical or diagonal, and any other direction.
+ */
+static SEG randomSeg( std::mt19937& aRng, int aRange )
+{
+    std::uniform_int_distribution<int> pos( -aRange, aRange );
+    std::uniform_int_distribution<int> len( -aRange / 4, aRange / 4 );
+    std::uniform_int_distribution<int> offset( -1, 1 );
+    std::uniform_int_distribution<int> kind( 0, 6 );
+
+    VECTOR2I a( pos( aRng ), pos( aRng ) );
+    int      l = len( aRng );
+
+    switch( kind( aRng ) )
+    {
+    case 0:  return SEG( a, a );
+    case 1:  return SEG( a, a + VECTOR2I( l, 0 ) );
+    case 2:  return SEG( a, a + VECTOR2I( 0, l ) );
+    case 3:  return SEG( a, a + VECTOR2I( l, l + offset( aRng ) ) );
+    case 4:  return SEG( a, a + VECTOR2I( l, offset( aRng ) ) );
+    case 5:  return SEG( a, a + VECTOR2I( offset( aRng ), l ) );
+    default: return SEG( a, a + VECTOR2I( len( aRng ), len( aRng ) ) );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( SegBatch )
+
+/**
+ * Check that an empty batch finds nothing
+ */
+BOOST_AUTO_TEST_CASE( Empty )
+{
+    SEG_BATCH         batch;
+    int               index = 0;
+    const SEG::ecoord noDistance = VECTOR2I::ECOORD_MAX;
+
+    BOOST_CHECK_EQUAL( batch.Collide( SEG( 0, 0, 10, 10 ), 100 ), -1 );
+    BOOST_CHECK_EQUAL( batch.SquaredDistance( VECTOR2I( 0, 0 ), &index ), noDistance );
+    BOOST_CHECK_EQUAL( index, -1 );
+}
+
+/**
+ * Check the batch results against the SEG methods called on each segment
+ */
+BOOST_AUTO_TEST_CASE( SameAsSeg )
+{
+    std::mt19937 rng( 1 );
+    const int    clearances[] = { 0, 1, 10, 1000, -10 };
+
+    for( int range : { 100, 100000, 100000000 } )
+    {
+        std::uniform_int_distribution<int> pos( -range, range );
+        SEG_BATCH                          batch;
+        std::vector<SEG>                   segs;
+
+        for( int i = 0; i < 300; i++ )
+        {
+            segs.push_back( randomSeg( rng, range ) );
+            batch.Add( segs.back() );
+        }
+
+        BOOST_REQUIRE_EQUAL( batch.Size(), (int) segs.size() );
+
+        for( int test = 0; test < 300; test++ )
+        {
+            SEG      seg = randomSeg( rng, range );
+            VECTOR2I pt( pos( rng ), pos( rng ) );
+
+            for( int clearance : clearances )
+            {
+                int expected = -1;
+
+                for( int i = 0; i < (int) segs.size() && expected < 0; i++ )
+                {
+                    if( segs[i].Collide( seg, clearance * range / 100 ) )
+                        expected = i;
+                }
+
+                BOOST_CHECK_EQUAL( batch.Collide( seg, clearance * range / 100 ), expected );
+            }
+
+            SEG::ecoord segDist = VECTOR2I::ECOORD_MAX;
+            SEG::ecoord ptDist = VECTOR2I::ECOORD_MAX;
+            int         segIndex = -1;
+            int         ptIndex = -1;
+
+            for( int i = 0; i < (int) segs.size(); i++ )
+            {
+                if( segs[i].SquaredDistance( seg ) < segDist )
+                {
+                    segDist = segs[i].SquaredDistance( seg );
+                    segIndex = i;
+                }
+
+                if( segs[i].SquaredDistance( pt ) < ptDist )
+                {
+                    ptDist = segs[i].SquaredDistance( pt );
+                    ptIndex = i;
+                }
+            }
+
+            int index;
+
+            BOOST_CHECK_EQUAL( batch.SquaredDistance( seg, &index ), segDist );
+            BOOST_CHECK_EQUAL( index, segIndex );
+            BOOST_CHECK_EQUAL( batch.SquaredDistance( pt, &index ), ptDist );
+            BOOST_CHECK_EQUAL( index, ptIndex );
+        }
+    }
+}
+
+/**
+ * Check that a polyline gives the segments of the line chain
+ */
+BOOST_AUTO_TEST_CASE( Polyline )
+{
+    SHAPE_LINE_CHAIN chain;
+    SEG_BATCH        batch;
+
+    chain.Append( 0, 0 );
+    chain.Append( 100, 0 );
+    chain.Append( 100, 50 );
+    chain.Append( 30, 70 );
+
+    for( bool closed : { false, true } )
+    {
+        chain.SetClosed( closed );
+        batch.SetPolyline( chain.CPoints(), closed );
+
+        BOOST_REQUIRE_EQUAL( batch.Size(), chain.SegmentCount() );
+
+        for( int i = 0; i < chain.SegmentCount(); i++ )
+        {
+            BOOST_CHECK( batch.Segment( i ).A == chain.CSegment( i ).A );
+            BOOST_CHECK( batch.Segment( i ).B == chain.CSegment( i ).B );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
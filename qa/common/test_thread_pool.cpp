@@ -0,0 +1,201 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <thread_pool.h>
+
+#include <atomic>
+#include <stdexcept>
+
+struct ThreadPoolFixture
+{
+    ThreadPoolFixture() :
+        m_pool( 4 )
+    {
+    }
+
+    THREAD_POOL m_pool;
+};
+
+
+/**
+ * Declares a struct as the Boost test fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( ThreadPool, ThreadPoolFixture )
+
+
+/**
+ * Check all the tasks of a group are run once before Wait() returns
+ */
+BOOST_AUTO_TEST_CASE( RunAll )
+{
+    std::atomic<int> count( 0 );
+    TASK_GROUP       tasks( m_pool );
+
+    BOOST_CHECK_EQUAL( tasks.GetThreadCount(), 4 );
+
+    for( int ii = 0; ii < 1000; ++ii )
+        tasks.Run( [&count]() { count++; } );
+
+    tasks.Wait();
+
+    BOOST_CHECK_EQUAL( count, 1000 );
+}
+
+
+/**
+ * Check that tasks waiting for nested groups do not starve the pool, even when
+ * there are more waiting tasks than workers
+ */
+BOOST_AUTO_TEST_CASE( NestedGroups )
+{
+    std::atomic<int> count( 0 );
+    TASK_GROUP       outer( m_pool );
+
+    for( int ii = 0; ii < 16; ++ii )
+    {
+        outer.Run( [&]()
+                {
+                    TASK_GROUP inner( m_pool );
+
+                    for( int jj = 0; jj < 16; ++jj )
+                        inner.Run( [&count]() { count++; } );
+
+                    inner.Wait();
+                } );
+    }
+
+    outer.Wait();
+
+    BOOST_CHECK_EQUAL( count, 256 );
+}
+
+
+/**
+ * Check that a waiting thread only runs the tasks of the group it waits for
+ */
+BOOST_AUTO_TEST_CASE( WaitRunsOwnTasksOnly )
+{
+    std::atomic<bool> release( false );
+    std::atomic<int>  started( 0 );
+    std::atomic<bool> foreignRan( false );
+    std::atomic<bool> ownRan( false );
+    TASK_GROUP        busy( m_pool );
+    TASK_GROUP        foreign( m_pool );
+    TASK_GROUP        own( m_pool );
+
+    // Keep all the workers busy, so the queued tasks can only run on the waiting thread
+    for( size_t ii = 0; ii < m_pool.GetThreadCount(); ++ii )
+    {
+        busy.Run( [&]()
+                {
+                    started++;
+
+                    while( !release )
+                        std::this_thread::yield();
+                } );
+    }
+
+    while( started < (int) m_pool.GetThreadCount() )
+        std::this_thread::yield();
+
+    // The newest task is the foreign one
+    own.Run( [&ownRan]() { ownRan = true; } );
+    foreign.Run( [&foreignRan]() { foreignRan = true; } );
+
+    own.Wait();
+
+    BOOST_CHECK( ownRan );
+    BOOST_CHECK( !foreignRan );
+
+    release = true;
+    busy.Wait();
+    foreign.Wait();
+
+    BOOST_CHECK( foreignRan );
+}
+
+
+/**
+ * Check the keep alive callback is called while the tasks are running
+ */
+BOOST_AUTO_TEST_CASE( KeepAlive )
+{
+    std::atomic<bool> release( false );
+    int               calls = 0;
+    TASK_GROUP        tasks( m_pool );
+
+    tasks.Run( [&release]()
+            {
+                while( !release )
+                    std::this_thread::yield();
+            } );
+
+    tasks.Wait( [&]()
+            {
+                if( ++calls == 3 )
+                    release = true;
+            },
+            std::chrono::milliseconds( 1 ) );
+
+    BOOST_CHECK_EQUAL( calls, 3 );
+}
+
+
+/**
+ * Check the tasks of a cancelled group are skipped, and the group can still be waited for
+ */
+BOOST_AUTO_TEST_CASE( Cancel )
+{
+    std::atomic<int> count( 0 );
+    TASK_GROUP       tasks( m_pool );
+
+    tasks.Cancel();
+
+    for( int ii = 0; ii < 100; ++ii )
+        tasks.Run( [&count]() { count++; } );
+
+    tasks.Wait();
+
+    BOOST_CHECK( tasks.IsCancelled() );
+    BOOST_CHECK_EQUAL( count, 0 );
+}
+
+
+/**
+ * Check an exception thrown by a task is given back to the waiting thread
+ */
+BOOST_AUTO_TEST_CASE( Exception )
+{
+    TASK_GROUP tasks( m_pool );
+
+    tasks.Run( []() { throw std::runtime_error( "task failure" ); } );
+
+    BOOST_CHECK_THROW( tasks.Wait(), std::runtime_error );
+
+    // The exception is only reported once
+    tasks.Wait();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,251 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Headless DRC runner: loads a board, runs the design rules check without any
+ * editor frame and writes the violations and the duration of each test pass as JSON.
+ * Intended for continuous integration and for benchmarking the DRC.
+ */
+
+#include <io_mgr.h>
+#include <class_board.h>
+#include <class_marker_pcb.h>
+#include <drc.h>
+#include <drc_item.h>
+#include <base_units.h>
+#include <profile.h>
+#include <qa_report.h>
+
+#include <wx/init.h>
+#include <wx/cmdline.h>
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+
+static void writeJsonItem( std::ostream& aOut, EDA_UNITS_T aUnits, const wxString& aText,
+                           const wxPoint& aPos )
+{
+    aOut << "{ \"description\": ";
+    KI_TEST::WriteJsonString( aOut, aText );
+    aOut << ", \"x\": " << To_User_Unit( aUnits, aPos.x )
+         << ", \"y\": " << To_User_Unit( aUnits, aPos.y ) << " }";
+}
+
+
+static void writeJsonViolation( std::ostream& aOut, EDA_UNITS_T aUnits, const DRC_ITEM& aItem )
+{
+    aOut << "    { \"code\": " << aItem.GetErrorCode() << ", \"message\": ";
+    KI_TEST::WriteJsonString( aOut, aItem.GetErrorText() );
+    aOut << ", \"items\": [ ";
+    writeJsonItem( aOut, aUnits, aItem.GetTextA(), aItem.GetPointA() );
+
+    if( aItem.HasSecondItem() )
+    {
+        aOut << ", ";
+        writeJsonItem( aOut, aUnits, aItem.GetTextB(), aItem.GetPointB() );
+    }
+
+    aOut << " ] }";
+}
+
+
+static void writeJsonReport( std::ostream& aOut, const wxString& aBoardName, EDA_UNITS_T aUnits,
+                             BOARD& aBoard, const DRC& aDrc, double aLoadTime, double aTotalTime )
+{
+    aOut << "{\n  \"board\": ";
+    KI_TEST::WriteJsonString( aOut, aBoardName );
+    aOut << ",\n  \"units\": \"" << ( aUnits == INCHES ? "in" : "mm" ) << "\",\n";
+
+    aOut << "  \"violations\": [";
+
+    for( int ii = 0; ii < aBoard.GetMARKERCount(); ++ii )
+    {
+        aOut << ( ii ? ",\n" : "\n" );
+        writeJsonViolation( aOut, aUnits, aBoard.GetMARKER( ii )->GetReporter() );
+    }
+
+    aOut << "\n  ],\n  \"unconnected\": [";
+
+    const DRC_LIST& unconnected = aDrc.GetUnconnectedItems();
+
+    for( size_t ii = 0; ii < unconnected.size(); ++ii )
+    {
+        aOut << ( ii ? ",\n" : "\n" );
+        writeJsonViolation( aOut, aUnits, *unconnected[ii] );
+    }
+
+    aOut << "\n  ],\n  \"timings_ms\": {\n";
+    aOut << "    \"load\": " << aLoadTime;
+
+    for( const auto& pass : aDrc.GetPassDurations() )
+    {
+        aOut << ",\n    ";
+        KI_TEST::WriteJsonString( aOut, pass.first );
+        aOut << ": " << pass.second;
+    }
+
+    aOut << ",\n    \"total\": " << aTotalTime << "\n  }\n}\n";
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc [] =
+{
+    { wxCMD_LINE_SWITCH, "h", "help",
+        _( "displays help on the command line parameters" ).mb_str(),
+        wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "o", "output",
+        _( "write the JSON report to this file instead of the standard output" ).mb_str(),
+        wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_OPTION, "u", "units",
+        _( "units of the report coordinates: mm (default) or in" ).mb_str(),
+        wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_SWITCH, "r", "refill-zones",
+        _( "refill the zones before running the tests" ).mb_str() },
+    { wxCMD_LINE_SWITCH, "a", "all-track-errors",
+        _( "report all the errors of each track instead of the first one" ).mb_str() },
+    { wxCMD_LINE_SWITCH, "n", "no-unconnected",
+        _( "do not list the unconnected items" ).mb_str() },
+    { wxCMD_LINE_PARAM, nullptr, nullptr,
+        _( "input board file" ).mb_str(),
+        wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum RET_CODES
+{
+    OK = 0,
+    BAD_CMDLINE = 1,
+    LOAD_FAILED = 2,
+    WRITE_FAILED = 3,
+    DRC_VIOLATIONS = 4,
+};
+
+
+int main( int argc, char** argv )
+{
+    if( !wxInitialize() )
+        return RET_CODES::BAD_CMDLINE;
+
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program runs the design rules check on a board "
+        "without the board editor, and writes the violations and the time spent in each "
+        "test as JSON. It returns a non zero code when some violations are found." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        wxUninitialize();
+        return ( cmd_parsed_ok == -1 ) ? RET_CODES::OK : RET_CODES::BAD_CMDLINE;
+    }
+
+    EDA_UNITS_T units = MILLIMETRES;
+    wxString    unitsName;
+
+    if( cl_parser.Found( "units", &unitsName ) )
+    {
+        if( unitsName == "in" )
+        {
+            units = INCHES;
+        }
+        else if( unitsName != "mm" )
+        {
+            std::cerr << "Unknown units: " << unitsName << std::endl;
+            wxUninitialize();
+            return RET_CODES::BAD_CMDLINE;
+        }
+    }
+
+    const wxString filename = cl_parser.GetParam( 0 );
+
+    PROF_COUNTER totalTimer;
+    std::unique_ptr<BOARD> board;
+
+    try
+    {
+        board.reset( IO_MGR::Load( IO_MGR::KICAD_SEXP, filename ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << ioe.What() << std::endl;
+    }
+
+    if( !board )
+    {
+        wxUninitialize();
+        return RET_CODES::LOAD_FAILED;
+    }
+
+    board->BuildConnectivity();
+    board->BuildListOfNets();
+    board->SynchronizeNetsAndNetClasses();
+
+    double loadTime = totalTimer.msecs();
+    int    ret = RET_CODES::OK;
+
+    {
+        // The DRC must be destroyed before the board it is listening to
+        DRC drc( board.get(), units );
+
+        drc.SetSettings( true, !cl_parser.Found( "no-unconnected" ), true, true,
+                         cl_parser.Found( "refill-zones" ), cl_parser.Found( "all-track-errors" ),
+                         wxEmptyString, false );
+        drc.RunTests();
+
+        double   totalTime = totalTimer.msecs();
+        wxString outputName;
+
+        if( cl_parser.Found( "output", &outputName ) )
+        {
+            std::ofstream fout( outputName.ToStdString() );
+
+            if( fout )
+                writeJsonReport( fout, filename, units, *board, drc, loadTime, totalTime );
+
+            if( !fout )
+            {
+                std::cerr << "Unable to write the report to " << outputName << std::endl;
+                ret = RET_CODES::WRITE_FAILED;
+            }
+        }
+        else
+        {
+            writeJsonReport( std::cout, filename, units, *board, drc, loadTime, totalTime );
+        }
+
+        if( ret == RET_CODES::OK
+                && ( board->GetMARKERCount() > 0 || !drc.GetUnconnectedItems().empty() ) )
+            ret = RET_CODES::DRC_VIOLATIONS;
+    }
+
+    board.reset();
+    wxUninitialize();
+
+    return ret;
+}
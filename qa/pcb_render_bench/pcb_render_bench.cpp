@@ -0,0 +1,396 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Board rendering benchmark: loads a board into a view drawn by the board painter on a
+ * Cairo image surface, so no window nor GPU is needed, and times full redraws and pans
+ * at several zoom levels.  The number of items visible on each layer is reported with
+ * the timings as JSON, to tell a slower drawing from a different board.
+ */
+
+#include <io_mgr.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <class_marker_pcb.h>
+#include <profile.h>
+#include <qa_report.h>
+
+#include <pcb_view.h>
+#include <pcb_painter.h>
+#include <pcb_draw_panel_gal.h>
+#include <gal/cairo/cairo_gal.h>
+#include <gal/gal_display_options.h>
+
+#include <wx/init.h>
+#include <wx/cmdline.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+
+
+/**
+ * Cairo GAL drawing to an image surface in memory instead of a window.
+ */
+class OFFSCREEN_CAIRO_GAL : public KIGFX::CAIRO_GAL_BASE
+{
+public:
+    OFFSCREEN_CAIRO_GAL( KIGFX::GAL_DISPLAY_OPTIONS& aOptions, int aWidth, int aHeight ) :
+        CAIRO_GAL_BASE( aOptions )
+    {
+        screenSize = VECTOR2I( aWidth, aHeight );
+        surface = cairo_image_surface_create( GAL_FORMAT, aWidth, aHeight );
+        context = currentContext = cairo_create( surface );
+    }
+
+    bool SavePng( const wxString& aFileName )
+    {
+        cairo_surface_flush( surface );
+
+        return cairo_surface_write_to_png( surface, aFileName.ToUTF8() ) == CAIRO_STATUS_SUCCESS;
+    }
+};
+
+
+///> Zoom levels, relative to the zoom showing the whole board
+static const double ZOOM_LEVELS[] = { 1.0, 4.0, 16.0 };
+
+
+struct ZOOM_STATS
+{
+    double              m_zoom;
+    double              m_scale;
+    std::map<int, int>  m_visibleItems;
+    std::vector<double> m_redrawTimes;
+    std::vector<double> m_panTimes;
+};
+
+
+static wxString layerName( int aLayer )
+{
+    if( IsPcbLayer( aLayer ) )
+        return LSET::Name( ToLAYER_ID( aLayer ) );
+
+    return wxString::Format( "gal_layer_%d", aLayer );
+}
+
+
+static void writeTimings( std::ostream& aOut, std::vector<double>& aTimes )
+{
+    double total = 0.0;
+
+    for( double t : aTimes )
+        total += t;
+
+    std::sort( aTimes.begin(), aTimes.end() );
+
+    aOut << "{ \"count\": " << aTimes.size()
+         << ", \"p50_ms\": " << KI_TEST::Percentile( aTimes, 0.5 )
+         << ", \"p90_ms\": " << KI_TEST::Percentile( aTimes, 0.9 )
+         << ", \"max_ms\": " << ( aTimes.empty() ? 0.0 : aTimes.back() )
+         << ", \"total_ms\": " << total << " }";
+}
+
+
+static void writeJsonReport( std::ostream& aOut, const wxString& aBoardName,
+                             const VECTOR2I& aScreenSize, std::vector<ZOOM_STATS>& aStats,
+                             double aLoadTime, double aViewTime )
+{
+    aOut << "{\n  \"board\": ";
+    KI_TEST::WriteJsonString( aOut, aBoardName );
+    aOut << ",\n";
+    aOut << "  \"screen\": [ " << aScreenSize.x << ", " << aScreenSize.y << " ],\n";
+    aOut << "  \"zoom_levels\": [";
+
+    for( size_t ii = 0; ii < aStats.size(); ++ii )
+    {
+        ZOOM_STATS& stats = aStats[ii];
+
+        aOut << ( ii == 0 ? "\n" : ",\n" );
+        aOut << "    {\n      \"zoom\": " << stats.m_zoom << ",\n";
+        aOut << "      \"scale\": " << stats.m_scale << ",\n";
+        aOut << "      \"visible_items\": {";
+
+        bool first = true;
+
+        for( const auto& entry : stats.m_visibleItems )
+        {
+            aOut << ( first ? " " : ", " );
+            KI_TEST::WriteJsonString( aOut, layerName( entry.first ) );
+            aOut << ": " << entry.second;
+            first = false;
+        }
+
+        aOut << " },\n";
+        aOut << "      \"redraw\": ";
+        writeTimings( aOut, stats.m_redrawTimes );
+        aOut << ",\n      \"pan\": ";
+        writeTimings( aOut, stats.m_panTimes );
+        aOut << "\n    }";
+    }
+
+    aOut << "\n  ],\n";
+    aOut << "  \"timings_ms\": {\n";
+    aOut << "    \"load\": " << aLoadTime << ",\n";
+    aOut << "    \"view\": " << aViewTime << "\n  }\n}\n";
+}
+
+
+/**
+ * Add the board items to the view, the same way the board draw panel does.
+ */
+static void addBoardItems( KIGFX::VIEW& aView, BOARD* aBoard )
+{
+    for( auto drawing : aBoard->Drawings() )
+        aView.Add( drawing );
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+        aView.Add( track );
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+        aView.Add( module );
+
+    for( SEGZONE* zone = aBoard->m_SegZoneDeprecated; zone; zone = zone->Next() )
+        aView.Add( zone );
+
+    for( int marker_idx = 0; marker_idx < aBoard->GetMARKERCount(); ++marker_idx )
+        aView.Add( aBoard->GetMARKER( marker_idx ) );
+
+    for( auto zone : aBoard->Zones() )
+        aView.Add( zone );
+}
+
+
+static double timeRedraw( KIGFX::VIEW& aView, KIGFX::GAL& aGal )
+{
+    PROF_COUNTER timer;
+
+    {
+        KIGFX::GAL_DRAWING_CONTEXT ctx( &aGal );
+        aView.Redraw();
+    }
+
+    return timer.msecs();
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc [] =
+{
+    { wxCMD_LINE_SWITCH, "h", "help",
+        _( "displays help on the command line parameters" ).mb_str(),
+        wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "n", "passes",
+        _( "number of redraws and pans at each zoom level (default 10)" ).mb_str(),
+        wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "W", "width",
+        _( "width of the drawing surface in pixels (default 1280)" ).mb_str(),
+        wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "H", "height",
+        _( "height of the drawing surface in pixels (default 1024)" ).mb_str(),
+        wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_SWITCH, "P", "parallel",
+        _( "rasterize the frames in parallel, as the Cairo canvas does" ).mb_str() },
+    { wxCMD_LINE_OPTION, "p", "png",
+        _( "save the redraw of the whole board to this PNG file" ).mb_str(),
+        wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_OPTION, "o", "output",
+        _( "write the JSON report to this file instead of the standard output" ).mb_str(),
+        wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr,
+        _( "input board file" ).mb_str(),
+        wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum RET_CODES
+{
+    OK = 0,
+    BAD_CMDLINE = 1,
+    LOAD_FAILED = 2,
+    WRITE_FAILED = 3,
+};
+
+
+int main( int argc, char** argv )
+{
+    if( !wxInitialize() )
+        return RET_CODES::BAD_CMDLINE;
+
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program draws a board with the Cairo renderer to an "
+        "image in memory, without any window, and writes the time taken by the redraws "
+        "and the pans at several zoom levels as JSON." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        wxUninitialize();
+        return ( cmd_parsed_ok == -1 ) ? RET_CODES::OK : RET_CODES::BAD_CMDLINE;
+    }
+
+    const wxString filename = cl_parser.GetParam( 0 );
+    long           passes = 10;
+    long           width = 1280;
+    long           height = 1024;
+
+    cl_parser.Found( "passes", &passes );
+    cl_parser.Found( "width", &width );
+    cl_parser.Found( "height", &height );
+
+    if( passes < 1 || width < 1 || height < 1 )
+    {
+        std::cerr << "The number of passes and the surface size must be positive" << std::endl;
+        wxUninitialize();
+        return RET_CODES::BAD_CMDLINE;
+    }
+
+    PROF_COUNTER loadTimer;
+    std::unique_ptr<BOARD> board;
+
+    try
+    {
+        board.reset( IO_MGR::Load( IO_MGR::KICAD_SEXP, filename ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << ioe.What() << std::endl;
+    }
+
+    if( !board )
+    {
+        wxUninitialize();
+        return RET_CODES::LOAD_FAILED;
+    }
+
+    board->BuildConnectivity();
+
+    double loadTime = loadTimer.msecs();
+
+    KIGFX::GAL_DISPLAY_OPTIONS options;
+    OFFSCREEN_CAIRO_GAL        gal( options, width, height );
+    KIGFX::PCB_PAINTER         painter( &gal );
+    KIGFX::PCB_VIEW            view( false );
+    PROF_COUNTER               viewTimer;
+
+    gal.SetParallelRendering( cl_parser.Found( "parallel" ) );
+    gal.SetWorldUnitLength( 1e-9 /* 1 nm */ / 0.0254 /* 1 inch in meters */ );
+
+    view.SetGAL( &gal );
+    view.SetPainter( &painter );
+    PCB_DRAW_PANEL_GAL::SetDefaultLayerOrder( &view );
+    PCB_DRAW_PANEL_GAL::SetDefaultLayerDeps( &view, false );
+
+    addBoardItems( view, board.get() );
+    view.UpdateItems();
+
+    double viewTime = viewTimer.msecs();
+
+    EDA_RECT bbox = board->GetBoundingBox();
+    BOX2D    boardBox( VECTOR2D( bbox.GetOrigin() ), VECTOR2D( bbox.GetSize() ) );
+
+    view.SetViewport( boardBox );
+
+    const double            fitScale = view.GetScale();
+    const VECTOR2D          centre = boardBox.Centre();
+    std::vector<ZOOM_STATS> stats;
+    int                     ret = RET_CODES::OK;
+
+    for( double zoom : ZOOM_LEVELS )
+    {
+        ZOOM_STATS zoomStats;
+
+        view.SetScale( fitScale * zoom, centre );
+        view.SetCenter( centre );
+
+        zoomStats.m_zoom = zoom;
+        zoomStats.m_scale = view.GetScale();
+
+        BOX2D viewport = view.GetViewport();
+        std::vector<KIGFX::VIEW::LAYER_ITEM_PAIR> visible;
+
+        view.Query( BOX2I( VECTOR2I( viewport.GetPosition() ), VECTOR2I( viewport.GetSize() ) ),
+                    visible );
+
+        for( const auto& entry : visible )
+            zoomStats.m_visibleItems[ entry.second ]++;
+
+        for( long ii = 0; ii < passes; ++ii )
+            zoomStats.m_redrawTimes.push_back( timeRedraw( view, gal ) );
+
+        wxString pngName;
+
+        if( zoom == ZOOM_LEVELS[0] && cl_parser.Found( "png", &pngName ) && !gal.SavePng( pngName ) )
+        {
+            std::cerr << "Unable to write the image to " << pngName << std::endl;
+            ret = RET_CODES::WRITE_FAILED;
+        }
+
+        // Pan across the board, from the left edge to the right one
+        for( long ii = 0; ii < passes; ++ii )
+        {
+            double x = boardBox.GetX() + boardBox.GetWidth() * ( ii + 0.5 ) / passes;
+
+            view.SetCenter( VECTOR2D( x, centre.y ) );
+            zoomStats.m_panTimes.push_back( timeRedraw( view, gal ) );
+        }
+
+        stats.push_back( zoomStats );
+    }
+
+    wxString outputName;
+
+    if( cl_parser.Found( "output", &outputName ) )
+    {
+        std::ofstream fout( outputName.ToStdString() );
+
+        if( fout )
+            writeJsonReport( fout, filename, gal.GetScreenPixelSize(), stats, loadTime, viewTime );
+
+        if( !fout )
+        {
+            std::cerr << "Unable to write the report to " << outputName << std::endl;
+            ret = RET_CODES::WRITE_FAILED;
+        }
+    }
+    else
+    {
+        writeJsonReport( std::cout, filename, gal.GetScreenPixelSize(), stats, loadTime,
+                         viewTime );
+    }
+
+    view.Clear();
+    board.reset();
+    wxUninitialize();
+
+    return ret;
+}
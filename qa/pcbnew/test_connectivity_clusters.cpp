@@ -0,0 +1,249 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <netinfo.h>
+#include <connectivity/connectivity_algo.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+
+/**
+ * The items of a cluster, sorted, with its origin net.
+ */
+using CLUSTER_ITEMS = std::pair<int, std::vector<const BOARD_CONNECTED_ITEM*>>;
+
+
+/**
+ * Returns the clusters in an order which does not depend on the way they were found.
+ */
+static std::vector<CLUSTER_ITEMS> canonicalClusters(
+        const CN_CONNECTIVITY_ALGO::CLUSTERS& aClusters )
+{
+    std::vector<CLUSTER_ITEMS> result;
+
+    for( const CN_CLUSTER_PTR& cluster : aClusters )
+    {
+        CLUSTER_ITEMS items;
+
+        items.first = cluster->OriginNet();
+
+        for( CN_ITEM* item : *cluster )
+            items.second.push_back( item->Parent() );
+
+        std::sort( items.second.begin(), items.second.end() );
+        result.push_back( std::move( items ) );
+    }
+
+    std::sort( result.begin(), result.end() );
+
+    return result;
+}
+
+
+/**
+ * A board with a few nets, and random tracks and vias on a coarse grid, so that many of them
+ * touch each other.  The items are not added to the board, only to the connectivity; the
+ * removed ones are kept until the end of the test, as the clusters cache may still refer to
+ * them.
+ */
+struct CLUSTERS_FIXTURE
+{
+    static const int NET_COUNT = 4;
+    static const int GRID_SIZE = 8;
+    static const int GRID_STEP = 1000000;
+
+    CLUSTERS_FIXTURE() :
+        m_rng( 1 )
+    {
+        for( int net = 1; net <= NET_COUNT; net++ )
+            m_board.Add( new NETINFO_ITEM( &m_board, wxString::Format( "Net%d", net ), net ) );
+    }
+
+    wxPoint randomPoint()
+    {
+        std::uniform_int_distribution<int> coord( 0, GRID_SIZE - 1 );
+
+        return wxPoint( coord( m_rng ) * GRID_STEP, coord( m_rng ) * GRID_STEP );
+    }
+
+    int randomNet()
+    {
+        // Net 0 items stay out of the ratsnest clusters
+        return std::uniform_int_distribution<int>( 0, NET_COUNT )( m_rng );
+    }
+
+    BOARD_CONNECTED_ITEM* addItem()
+    {
+        BOARD_CONNECTED_ITEM* item;
+
+        if( std::uniform_int_distribution<int>( 0, 4 )( m_rng ) == 0 )
+        {
+            VIA* via = new VIA( &m_board );
+
+            via->SetPosition( randomPoint() );
+            via->SetViaType( VIA_THROUGH );
+            via->SetLayerPair( F_Cu, B_Cu );
+            via->SetWidth( GRID_STEP / 2 );
+            via->SetDrill( GRID_STEP / 4 );
+            item = via;
+        }
+        else
+        {
+            TRACK* track = new TRACK( &m_board );
+
+            track->SetStart( randomPoint() );
+            track->SetEnd( randomPoint() );
+            track->SetWidth( GRID_STEP / 5 );
+            track->SetLayer( std::uniform_int_distribution<int>( 0, 1 )( m_rng ) ? F_Cu : B_Cu );
+            item = track;
+        }
+
+        item->SetNetCode( randomNet() );
+        m_items.emplace_back( item );
+        m_live.push_back( item );
+        m_algo.Add( item );
+
+        return item;
+    }
+
+    void removeItem()
+    {
+        size_t idx = std::uniform_int_distribution<size_t>( 0, m_live.size() - 1 )( m_rng );
+
+        m_algo.Remove( m_live[idx] );
+        m_live.erase( m_live.begin() + idx );
+    }
+
+    void changeNet()
+    {
+        size_t idx = std::uniform_int_distribution<size_t>( 0, m_live.size() - 1 )( m_rng );
+
+        // As CONNECTIVITY_DATA::Update() does it
+        m_algo.Remove( m_live[idx] );
+        m_live[idx]->SetNetCode( randomNet() );
+        m_algo.Add( m_live[idx] );
+    }
+
+    /**
+     * Checks the cached clusters against a search from scratch.
+     */
+    void checkClusters()
+    {
+        auto cached = canonicalClusters( m_algo.GetClusters() );
+        auto searched = canonicalClusters(
+                m_algo.SearchClusters( CN_CONNECTIVITY_ALGO::CSM_RATSNEST ) );
+
+        BOOST_REQUIRE_EQUAL( cached.size(), searched.size() );
+        BOOST_CHECK( cached == searched );
+    }
+
+    BOARD                                              m_board;
+    std::vector<std::unique_ptr<BOARD_CONNECTED_ITEM>> m_items;
+    std::vector<BOARD_CONNECTED_ITEM*>                 m_live;
+
+    ///> Declared after the items, so that it is destroyed before them
+    CN_CONNECTIVITY_ALGO                               m_algo;
+    std::mt19937                                       m_rng;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ConnectivityClusters, CLUSTERS_FIXTURE )
+
+/**
+ * Checks the clusters built from scratch.
+ */
+BOOST_AUTO_TEST_CASE( Build )
+{
+    for( int ii = 0; ii < 200; ii++ )
+        addItem();
+
+    checkClusters();
+}
+
+/**
+ * Checks the clusters updated after each change of a random sequence of additions,
+ * removals and net changes, the cache being used from the start.
+ */
+BOOST_AUTO_TEST_CASE( RandomChanges )
+{
+    for( int ii = 0; ii < 100; ii++ )
+        addItem();
+
+    checkClusters();
+
+    for( int step = 0; step < 1000; step++ )
+    {
+        BOOST_TEST_CONTEXT( "Step " << step )
+        {
+            int action = std::uniform_int_distribution<int>( 0, 2 )( m_rng );
+
+            if( action == 0 || m_live.size() < 10 )
+                addItem();
+            else if( action == 1 )
+                removeItem();
+            else
+                changeNet();
+
+            checkClusters();
+        }
+    }
+}
+
+/**
+ * Checks the clusters updated after several changes at once.
+ */
+BOOST_AUTO_TEST_CASE( BatchedChanges )
+{
+    for( int ii = 0; ii < 100; ii++ )
+        addItem();
+
+    checkClusters();
+
+    for( int batch = 0; batch < 100; batch++ )
+    {
+        BOOST_TEST_CONTEXT( "Batch " << batch )
+        {
+            for( int ii = 0; ii < 10; ii++ )
+            {
+                int action = std::uniform_int_distribution<int>( 0, 2 )( m_rng );
+
+                if( action == 0 || m_live.size() < 10 )
+                    addItem();
+                else if( action == 1 )
+                    removeItem();
+                else
+                    changeNet();
+            }
+
+            checkClusters();
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,245 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <class_track.h>
+#include <ratsnest_data.h>
+
+#include <memory>
+#include <random>
+
+
+/**
+ * A ratsnest node alone in its cluster, so that the ratsnest of the nodes is the minimum
+ * spanning tree of their positions.
+ */
+struct MST_NODE
+{
+    std::unique_ptr<CN_ITEM> m_item;
+    CN_CLUSTER_PTR           m_cluster;
+};
+
+
+/**
+ * Nodes at random positions, whose ratsnest is computed by an RN_NET kept across the
+ * changes, which updates its spanning tree incrementally, and by a new RN_NET each time,
+ * which builds it from scratch.
+ */
+struct MST_FIXTURE
+{
+    MST_FIXTURE() :
+        m_via( nullptr ),
+        m_rng( 1 )
+    {
+    }
+
+    /**
+     * Returns a random position, on a coarse grid when aOnGrid is true, so that some nodes
+     * share their position, are aligned or are at the same distance from each other.
+     */
+    VECTOR2I randomPos( bool aOnGrid )
+    {
+        if( aOnGrid )
+        {
+            std::uniform_int_distribution<int> coord( 0, 39 );
+
+            return VECTOR2I( coord( m_rng ) * 100000, coord( m_rng ) * 100000 );
+        }
+
+        std::uniform_int_distribution<int> coord( 0, 4000000 );
+
+        return VECTOR2I( coord( m_rng ), coord( m_rng ) );
+    }
+
+    MST_NODE makeNode( const VECTOR2I& aPos )
+    {
+        MST_NODE node;
+
+        // All the items share the same parent, the ratsnest only needs their anchors
+        node.m_item.reset( new CN_ITEM( &m_via, false, 1 ) );
+        node.m_item->AddAnchor( aPos );
+        node.m_cluster = std::make_shared<CN_CLUSTER>();
+        node.m_cluster->Add( node.m_item.get() );
+
+        return node;
+    }
+
+    size_t randomIndex()
+    {
+        return std::uniform_int_distribution<size_t>( 0, m_nodes.size() - 1 )( m_rng );
+    }
+
+    void addNode( bool aOnGrid )
+    {
+        m_nodes.push_back( makeNode( randomPos( aOnGrid ) ) );
+    }
+
+    void removeNode()
+    {
+        m_nodes.erase( m_nodes.begin() + randomIndex() );
+    }
+
+    void moveNode( bool aOnGrid )
+    {
+        m_nodes[ randomIndex() ] = makeNode( randomPos( aOnGrid ) );
+    }
+
+    /**
+     * Applies aCount random moves, additions and removals.
+     */
+    void randomChanges( int aCount, bool aOnGrid )
+    {
+        for( int ii = 0; ii < aCount; ii++ )
+        {
+            int action = std::uniform_int_distribution<int>( 0, 3 )( m_rng );
+
+            if( action == 0 || m_nodes.size() < 10 )
+                addNode( aOnGrid );
+            else if( action == 1 )
+                removeNode();
+            else
+                moveNode( aOnGrid );
+        }
+    }
+
+    void computeRatsnest( RN_NET& aNet )
+    {
+        aNet.Clear();
+
+        for( const MST_NODE& node : m_nodes )
+            aNet.AddCluster( node.m_cluster );
+
+        aNet.Update();
+    }
+
+    static uint64_t totalWeight( const RN_NET& aNet )
+    {
+        uint64_t weight = 0;
+
+        for( const CN_EDGE& edge : aNet.GetUnconnected() )
+            weight += edge.GetWeight();
+
+        return weight;
+    }
+
+    /**
+     * Checks the ratsnest updated incrementally against the one built from scratch.
+     */
+    void checkRatsnest()
+    {
+        RN_NET rebuilt;
+
+        computeRatsnest( m_incremental );
+        computeRatsnest( rebuilt );
+
+        BOOST_CHECK_EQUAL( m_incremental.GetUnconnected().size(), m_nodes.size() - 1 );
+        BOOST_CHECK_EQUAL( m_incremental.GetUnconnected().size(),
+                           rebuilt.GetUnconnected().size() );
+        BOOST_CHECK_EQUAL( totalWeight( m_incremental ), totalWeight( rebuilt ) );
+    }
+
+    VIA                   m_via;
+    std::vector<MST_NODE> m_nodes;
+
+    ///> Declared after the nodes, so that it releases their anchors first
+    RN_NET                m_incremental;
+    std::mt19937          m_rng;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( RatsnestMst, MST_FIXTURE )
+
+/**
+ * Checks the tree updated after each small change, small enough to be done locally.
+ */
+BOOST_AUTO_TEST_CASE( LocalChanges )
+{
+    for( bool onGrid : { false, true } )
+    {
+        BOOST_TEST_CONTEXT( "On grid: " << onGrid )
+        {
+            m_nodes.clear();
+
+            for( int ii = 0; ii < 300; ii++ )
+                addNode( onGrid );
+
+            checkRatsnest();
+
+            for( int step = 0; step < 300; step++ )
+            {
+                BOOST_TEST_CONTEXT( "Step " << step )
+                {
+                    randomChanges( 1 + step % 3, onGrid );
+                    checkRatsnest();
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Checks the tree updated after changes large enough to fall back to a full rebuild,
+ * mixed with small ones.
+ */
+BOOST_AUTO_TEST_CASE( LargeChanges )
+{
+    for( int ii = 0; ii < 300; ii++ )
+        addNode( true );
+
+    checkRatsnest();
+
+    for( int step = 0; step < 50; step++ )
+    {
+        BOOST_TEST_CONTEXT( "Step " << step )
+        {
+            randomChanges( step % 5 == 0 ? 40 : 2, true );
+            checkRatsnest();
+        }
+    }
+}
+
+/**
+ * Checks a net shrinking to a few nodes, then growing again.
+ */
+BOOST_AUTO_TEST_CASE( ShrinkAndGrow )
+{
+    for( int ii = 0; ii < 100; ii++ )
+        addNode( false );
+
+    checkRatsnest();
+
+    while( m_nodes.size() > 3 )
+    {
+        removeNode();
+        checkRatsnest();
+    }
+
+    for( int ii = 0; ii < 100; ii++ )
+    {
+        addNode( false );
+        checkRatsnest();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
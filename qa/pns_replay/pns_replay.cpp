@@ -0,0 +1,370 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Interactive router benchmark: loads a board and a routing session recorded by the
+ * router (RecordRouterEvents advanced option, saved with the dump key), replays the
+ * session on the router without any editor frame and writes the latency of each kind
+ * of operation, the shove iterations and the collision queries as JSON.
+ */
+
+#include <io_mgr.h>
+#include <class_board.h>
+#include <profile.h>
+#include <qa_report.h>
+
+#include <router/pns_router.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_logger.h>
+#include <router/pns_node.h>
+#include <router/pns_shove.h>
+#include <router/pns_sizes_settings.h>
+
+#include <wx/init.h>
+#include <wx/cmdline.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+
+
+static const char* eventName( PNS::LOGGER::EVENT_TYPE aType )
+{
+    switch( aType )
+    {
+    case PNS::LOGGER::EVT_START_ROUTE:  return "start_route";
+    case PNS::LOGGER::EVT_START_DRAG:   return "start_drag";
+    case PNS::LOGGER::EVT_FIX:          return "fix";
+    case PNS::LOGGER::EVT_MOVE:         return "move";
+    case PNS::LOGGER::EVT_ABORT:        return "abort";
+    case PNS::LOGGER::EVT_SWITCH_LAYER: return "switch_layer";
+    case PNS::LOGGER::EVT_TOGGLE_VIA:   return "toggle_via";
+    case PNS::LOGGER::EVT_FLIP_POSTURE: return "flip_posture";
+    case PNS::LOGGER::EVT_SYNC_WORLD:   return "sync_world";
+    }
+
+    return "unknown";
+}
+
+
+/**
+ * Find the item of the router world matching the one recorded with an event: the
+ * recorded items are gone, only their kind, net and layer are known.
+ */
+static PNS::ITEM* findItem( PNS::ROUTER& aRouter, const PNS::LOGGER::EVENT_ENTRY& aEvent )
+{
+    if( aEvent.m_itemKind == 0 )
+        return nullptr;
+
+    const PNS::ITEM_SET candidates = aRouter.QueryHoverItems( aEvent.m_p );
+
+    for( const auto& ent : candidates.CItems() )
+    {
+        PNS::ITEM* item = ent.item;
+
+        if( item->Kind() == aEvent.m_itemKind && item->Net() == aEvent.m_itemNet
+                && item->Layers().Start() == aEvent.m_itemLayer )
+            return item;
+    }
+
+    return nullptr;
+}
+
+
+struct EVENT_STATS
+{
+    std::vector<double> m_latencies;
+    double              m_total = 0.0;
+};
+
+
+static void writeJsonReport( std::ostream& aOut, const wxString& aBoardName,
+                             std::map<int, EVENT_STATS>& aStats, int aMissingItems,
+                             uint64_t aShoveIterations, uint64_t aQueries,
+                             uint64_t aCacheHits, uint64_t aCacheMisses,
+                             double aLoadTime, double aReplayTime )
+{
+    aOut << "{\n  \"board\": ";
+    KI_TEST::WriteJsonString( aOut, aBoardName );
+    aOut << ",\n";
+    aOut << "  \"events\": {";
+
+    bool first = true;
+
+    for( auto& entry : aStats )
+    {
+        std::vector<double>& lat = entry.second.m_latencies;
+
+        std::sort( lat.begin(), lat.end() );
+
+        aOut << ( first ? "\n" : ",\n" );
+        aOut << "    \"" << eventName( (PNS::LOGGER::EVENT_TYPE) entry.first ) << "\": { "
+             << "\"count\": " << lat.size()
+             << ", \"p50_ms\": " << KI_TEST::Percentile( lat, 0.5 )
+             << ", \"p90_ms\": " << KI_TEST::Percentile( lat, 0.9 )
+             << ", \"p99_ms\": " << KI_TEST::Percentile( lat, 0.99 )
+             << ", \"max_ms\": " << ( lat.empty() ? 0.0 : lat.back() )
+             << ", \"total_ms\": " << entry.second.m_total << " }";
+        first = false;
+    }
+
+    aOut << "\n  },\n";
+    aOut << "  \"missing_items\": " << aMissingItems << ",\n";
+    aOut << "  \"shove_iterations\": " << aShoveIterations << ",\n";
+    aOut << "  \"collision_queries\": " << aQueries << ",\n";
+    aOut << "  \"query_cache_hits\": " << aCacheHits << ",\n";
+    aOut << "  \"query_cache_misses\": " << aCacheMisses << ",\n";
+    aOut << "  \"timings_ms\": {\n";
+    aOut << "    \"load\": " << aLoadTime << ",\n";
+    aOut << "    \"replay\": " << aReplayTime << "\n  }\n}\n";
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc [] =
+{
+    { wxCMD_LINE_SWITCH, "h", "help",
+        _( "displays help on the command line parameters" ).mb_str(),
+        wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "o", "output",
+        _( "write the JSON report to this file instead of the standard output" ).mb_str(),
+        wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr,
+        _( "input board file" ).mb_str(),
+        wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr,
+        _( "router log file" ).mb_str(),
+        wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum RET_CODES
+{
+    OK = 0,
+    BAD_CMDLINE = 1,
+    LOAD_FAILED = 2,
+    WRITE_FAILED = 3,
+};
+
+
+int main( int argc, char** argv )
+{
+    if( !wxInitialize() )
+        return RET_CODES::BAD_CMDLINE;
+
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program replays a routing session recorded by the "
+        "interactive router on a board, without the board editor, and writes the latency "
+        "of the router operations as JSON." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        wxUninitialize();
+        return ( cmd_parsed_ok == -1 ) ? RET_CODES::OK : RET_CODES::BAD_CMDLINE;
+    }
+
+    const wxString filename = cl_parser.GetParam( 0 );
+    const wxString logname = cl_parser.GetParam( 1 );
+
+    std::vector<PNS::LOGGER::EVENT_ENTRY> events;
+    std::ifstream logFile( logname.ToStdString() );
+
+    if( !logFile )
+    {
+        std::cerr << "Unable to read " << logname << std::endl;
+        wxUninitialize();
+        return RET_CODES::LOAD_FAILED;
+    }
+
+    for( std::string line; std::getline( logFile, line ); )
+    {
+        PNS::LOGGER::EVENT_ENTRY event;
+
+        // The log also contains the geometry dumped by the router, which is skipped
+        if( PNS::LOGGER::ParseEvent( line, event ) )
+            events.push_back( event );
+    }
+
+    PROF_COUNTER totalTimer;
+    std::unique_ptr<BOARD> board;
+
+    try
+    {
+        board.reset( IO_MGR::Load( IO_MGR::KICAD_SEXP, filename ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << ioe.What() << std::endl;
+    }
+
+    if( !board )
+    {
+        wxUninitialize();
+        return RET_CODES::LOAD_FAILED;
+    }
+
+    board->BuildConnectivity();
+    board->BuildListOfNets();
+    board->SynchronizeNetsAndNetClasses();
+
+    double loadTime = totalTimer.msecs();
+
+    std::map<int, EVENT_STATS> stats;
+    int                        missingItems = 0;
+    const uint64_t             shoveIterStart = PNS::SHOVE::IterationCount();
+    const uint64_t             queryStart = PNS::NODE::QueryCount();
+    const uint64_t             hitStart = PNS::NODE::QueryCacheHits();
+    const uint64_t             missStart = PNS::NODE::QueryCacheMisses();
+    PROF_COUNTER               replayTimer;
+
+    {
+        // No view and no host tool: the router commits directly to the board
+        PNS_KICAD_IFACE iface;
+        PNS::ROUTER     router;
+
+        iface.SetBoard( board.get() );
+        router.SetInterface( &iface );
+        router.ClearWorld();
+        router.SyncWorld();
+
+        for( const auto& event : events )
+        {
+            PNS::ITEM* item = findItem( router, event );
+
+            if( event.m_itemKind != 0 && !item )
+                missingItems++;
+
+            if( event.m_type == PNS::LOGGER::EVT_START_ROUTE
+                    || event.m_type == PNS::LOGGER::EVT_START_DRAG )
+            {
+                PNS::SIZES_SETTINGS sizes( router.Sizes() );
+
+                router.SetMode( (PNS::ROUTER_MODE) event.m_routerMode );
+                router.Settings().SetMode( (PNS::PNS_MODE) event.m_routingMode );
+
+                sizes.Init( board.get(), item );
+                sizes.ClearLayerPairs();
+
+                // The vias are placed between the recorded layers, or the outer ones for the
+                // logs saved without them
+                if( event.m_viaLayerTop >= 0 && event.m_viaLayerBottom >= 0 )
+                    sizes.AddLayerPair( event.m_viaLayerTop, event.m_viaLayerBottom );
+                else
+                    sizes.AddLayerPair( F_Cu, B_Cu );
+                router.UpdateSizes( sizes );
+            }
+
+            PROF_COUNTER timer;
+
+            switch( event.m_type )
+            {
+            case PNS::LOGGER::EVT_START_ROUTE:
+                router.StartRouting( event.m_p, item, event.m_param );
+                break;
+
+            case PNS::LOGGER::EVT_START_DRAG:
+                router.StartDragging( event.m_p, item, event.m_param );
+                break;
+
+            case PNS::LOGGER::EVT_FIX:
+                router.FixRoute( event.m_p, item, event.m_param != 0 );
+                break;
+
+            case PNS::LOGGER::EVT_MOVE:
+                router.Move( event.m_p, item );
+                break;
+
+            case PNS::LOGGER::EVT_ABORT:
+                router.StopRouting();
+                break;
+
+            case PNS::LOGGER::EVT_SWITCH_LAYER:
+                router.SwitchLayer( event.m_param );
+                break;
+
+            case PNS::LOGGER::EVT_TOGGLE_VIA:
+                router.ToggleViaPlacement();
+                break;
+
+            case PNS::LOGGER::EVT_FLIP_POSTURE:
+                router.FlipPosture();
+                break;
+
+            case PNS::LOGGER::EVT_SYNC_WORLD:
+                router.SyncWorld();
+                break;
+            }
+
+            double elapsed = timer.msecs();
+            EVENT_STATS& eventStats = stats[ event.m_type ];
+
+            eventStats.m_latencies.push_back( elapsed );
+            eventStats.m_total += elapsed;
+        }
+
+        router.StopRouting();
+    }
+
+    double   replayTime = replayTimer.msecs();
+    uint64_t shoveIterations = PNS::SHOVE::IterationCount() - shoveIterStart;
+    uint64_t queries = PNS::NODE::QueryCount() - queryStart;
+    uint64_t cacheHits = PNS::NODE::QueryCacheHits() - hitStart;
+    uint64_t cacheMisses = PNS::NODE::QueryCacheMisses() - missStart;
+    int      ret = RET_CODES::OK;
+    wxString outputName;
+
+    if( cl_parser.Found( "output", &outputName ) )
+    {
+        std::ofstream fout( outputName.ToStdString() );
+
+        if( fout )
+        {
+            writeJsonReport( fout, filename, stats, missingItems, shoveIterations, queries,
+                             cacheHits, cacheMisses, loadTime, replayTime );
+        }
+
+        if( !fout )
+        {
+            std::cerr << "Unable to write the report to " << outputName << std::endl;
+            ret = RET_CODES::WRITE_FAILED;
+        }
+    }
+    else
+    {
+        writeJsonReport( std::cout, filename, stats, missingItems, shoveIterations, queries,
+                         cacheHits, cacheMisses, loadTime, replayTime );
+    }
+
+    board.reset();
+    wxUninitialize();
+
+    return ret;
+}
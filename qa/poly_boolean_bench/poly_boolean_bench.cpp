@@ -0,0 +1,372 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Polygon boolean benchmark: subtracts pad and track clearance shapes from a zone outline,
+ * the way the zone filler does, with one operation per shape, with the shapes merged
+ * first, and with a single batch.  The union of the shapes alone is also done in a single
+ * pass and across the worker threads.  The time of each pass is written as JSON, along
+ * with the area of the results, which must be the same for all the subtraction methods
+ * on one side, and for the union methods on the other side.
+ *
+ * The shapes are generated from a fixed seed, so two builds get the same inputs.
+ */
+
+#include <common.h>
+#include <geometry/shape_poly_set.h>
+#include <profile.h>
+#include <qa_report.h>
+
+#include <wx/init.h>
+#include <wx/cmdline.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+///> Size of the zone, in nm
+static const int ZONE_SIZE = 100000000;
+
+///> Segments of the round shapes
+static const int CIRCLE_SEGMENTS = 32;
+
+
+static SHAPE_POLY_SET makeRect( int aLeft, int aTop, int aRight, int aBottom )
+{
+    SHAPE_POLY_SET rect;
+
+    rect.NewOutline();
+    rect.Append( aLeft, aTop );
+    rect.Append( aRight, aTop );
+    rect.Append( aRight, aBottom );
+    rect.Append( aLeft, aBottom );
+
+    return rect;
+}
+
+
+/**
+ * Build the clearance shape of a track segment: a rectangle with round ends.
+ */
+static SHAPE_POLY_SET makeSegment( const VECTOR2I& aStart, const VECTOR2I& aEnd, int aRadius )
+{
+    SHAPE_POLY_SET segment;
+    VECTOR2I       dir = aEnd - aStart;
+    double         angle = atan2( (double) dir.y, (double) dir.x );
+
+    segment.NewOutline();
+
+    for( int ii = 0; ii <= CIRCLE_SEGMENTS / 2; ++ii )
+    {
+        double a = angle - M_PI / 2 + ii * 2 * M_PI / CIRCLE_SEGMENTS;
+        segment.Append( aEnd.x + KiROUND( aRadius * cos( a ) ),
+                        aEnd.y + KiROUND( aRadius * sin( a ) ) );
+    }
+
+    for( int ii = 0; ii <= CIRCLE_SEGMENTS / 2; ++ii )
+    {
+        double a = angle + M_PI / 2 + ii * 2 * M_PI / CIRCLE_SEGMENTS;
+        segment.Append( aStart.x + KiROUND( aRadius * cos( a ) ),
+                        aStart.y + KiROUND( aRadius * sin( a ) ) );
+    }
+
+    return segment;
+}
+
+
+/**
+ * Build a zone with a chamfered outline, and the clearance shapes of pads and tracks
+ * spread over it, some of them overlapping.
+ */
+static void buildInputs( int aShapeCount, SHAPE_POLY_SET& aZone,
+                         std::vector<SHAPE_POLY_SET>& aShapes )
+{
+    const int chamfer = ZONE_SIZE / 10;
+
+    aZone.NewOutline();
+    aZone.Append( chamfer, 0 );
+    aZone.Append( ZONE_SIZE - chamfer, 0 );
+    aZone.Append( ZONE_SIZE, chamfer );
+    aZone.Append( ZONE_SIZE, ZONE_SIZE - chamfer );
+    aZone.Append( ZONE_SIZE - chamfer, ZONE_SIZE );
+    aZone.Append( chamfer, ZONE_SIZE );
+    aZone.Append( 0, ZONE_SIZE - chamfer );
+    aZone.Append( 0, chamfer );
+
+    std::mt19937                       rng( 1 );
+    std::uniform_int_distribution<int> pos( -ZONE_SIZE / 20, ZONE_SIZE + ZONE_SIZE / 20 );
+    std::uniform_int_distribution<int> size( ZONE_SIZE / 400, ZONE_SIZE / 100 );
+    std::uniform_int_distribution<int> length( -ZONE_SIZE / 20, ZONE_SIZE / 20 );
+
+    for( int ii = 0; ii < aShapeCount; ++ii )
+    {
+        VECTOR2I center( pos( rng ), pos( rng ) );
+        int      s = size( rng );
+
+        if( ii % 2 )
+        {
+            // A rectangular pad
+            aShapes.push_back( makeRect( center.x - s, center.y - s / 2,
+                                         center.x + s, center.y + s / 2 ) );
+        }
+        else
+        {
+            // A track, eventually crossing the zone outline
+            VECTOR2I end = center + VECTOR2I( length( rng ), length( rng ) );
+
+            if( end == center )
+                end.x += s;
+
+            aShapes.push_back( makeSegment( center, end, s / 4 ) );
+        }
+    }
+}
+
+
+static double polySetArea( const SHAPE_POLY_SET& aSet )
+{
+    double area = 0.0;
+
+    for( int ii = 0; ii < aSet.OutlineCount(); ++ii )
+    {
+        area += aSet.COutline( ii ).Area();
+
+        for( int jj = 0; jj < aSet.HoleCount( ii ); ++jj )
+            area -= aSet.CHole( ii, jj ).Area();
+    }
+
+    return area;
+}
+
+
+///> Subtraction methods compared by the benchmark
+enum METHOD
+{
+    M_SEQUENTIAL,       ///< One BooleanSubtract() per shape
+    M_MERGED,           ///< The shapes merged, then a single BooleanSubtract()
+    M_BATCH,            ///< A single BooleanBatch()
+    M_UNION,            ///< Union of the shapes only, with Simplify()
+    M_UNION_PARALLEL,   ///< Union of the shapes only, with SimplifyParallel()
+    M_COUNT
+};
+
+
+static const char* const METHOD_NAMES[M_COUNT] = { "sequential", "merged", "batch", "union",
+                                                    "union_parallel" };
+
+
+static void runMethod( METHOD aMethod, SHAPE_POLY_SET& aZone,
+                       const std::vector<SHAPE_POLY_SET>& aShapes )
+{
+    switch( aMethod )
+    {
+    case M_SEQUENTIAL:
+        for( const SHAPE_POLY_SET& shape : aShapes )
+            aZone.BooleanSubtract( shape, SHAPE_POLY_SET::PM_FAST );
+
+        aZone.Simplify( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+        break;
+
+    case M_MERGED:
+    {
+        // This is what the zone filler does with the holes
+        SHAPE_POLY_SET holes;
+
+        for( const SHAPE_POLY_SET& shape : aShapes )
+            holes.Append( shape );
+
+        holes.Simplify( SHAPE_POLY_SET::PM_FAST );
+        aZone.BooleanSubtract( holes, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+        break;
+    }
+
+    case M_BATCH:
+    {
+        std::vector<SHAPE_POLY_SET::BOOLEAN_STEP> steps;
+
+        steps.reserve( aShapes.size() );
+
+        for( const SHAPE_POLY_SET& shape : aShapes )
+            steps.emplace_back( SHAPE_POLY_SET::BO_SUBTRACT, &shape );
+
+        aZone.BooleanBatch( steps, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+        break;
+    }
+
+    case M_UNION:
+    case M_UNION_PARALLEL:
+        aZone.RemoveAllContours();
+
+        for( const SHAPE_POLY_SET& shape : aShapes )
+            aZone.Append( shape );
+
+        if( aMethod == M_UNION )
+            aZone.Simplify( SHAPE_POLY_SET::PM_FAST );
+        else
+            aZone.SimplifyParallel( SHAPE_POLY_SET::PM_FAST );
+
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+static void writeJsonReport( std::ostream& aOut, size_t aShapeCount,
+                             std::vector<double> aPassTimes[M_COUNT],
+                             const SHAPE_POLY_SET aResults[M_COUNT] )
+{
+    aOut << "{\n  \"shapes\": " << aShapeCount << ",\n";
+    aOut << "  \"methods\": {";
+
+    for( int ii = 0; ii < M_COUNT; ++ii )
+    {
+        std::vector<double>& times = aPassTimes[ii];
+
+        std::sort( times.begin(), times.end() );
+
+        aOut << ( ii ? ",\n" : "\n" );
+        aOut << "    \"" << METHOD_NAMES[ii] << "\": {\n";
+        aOut << "      \"outlines\": " << aResults[ii].OutlineCount() << ",\n";
+        aOut << "      \"area\": " << polySetArea( aResults[ii] ) << ",\n";
+        aOut << "      \"pass_p50_ms\": " << KI_TEST::Percentile( times, 0.5 ) << ",\n";
+        aOut << "      \"pass_p90_ms\": " << KI_TEST::Percentile( times, 0.9 ) << ",\n";
+        aOut << "      \"pass_max_ms\": " << ( times.empty() ? 0.0 : times.back() ) << "\n";
+        aOut << "    }";
+    }
+
+    aOut << "\n  }\n}\n";
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc [] =
+{
+    { wxCMD_LINE_SWITCH, "h", "help",
+        _( "displays help on the command line parameters" ).mb_str(),
+        wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "n", "passes",
+        _( "number of times each method is run (default 5)" ).mb_str(),
+        wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "c", "count",
+        _( "number of pad and track shapes subtracted from the zone (default 500)" ).mb_str(),
+        wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "o", "output",
+        _( "write the JSON report to this file instead of the standard output" ).mb_str(),
+        wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum RET_CODES
+{
+    OK = 0,
+    BAD_CMDLINE = 1,
+    WRITE_FAILED = 3,
+};
+
+
+int main( int argc, char** argv )
+{
+    if( !wxInitialize() )
+        return RET_CODES::BAD_CMDLINE;
+
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program subtracts clearance shapes from a zone with "
+        "several methods, and writes the time taken by each pass as JSON." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        wxUninitialize();
+        return ( cmd_parsed_ok == -1 ) ? RET_CODES::OK : RET_CODES::BAD_CMDLINE;
+    }
+
+    long passes = 5;
+    long count = 500;
+
+    cl_parser.Found( "passes", &passes );
+    cl_parser.Found( "count", &count );
+
+    if( passes < 1 || count < 1 )
+    {
+        std::cerr << "The number of passes and of shapes must be positive" << std::endl;
+        wxUninitialize();
+        return RET_CODES::BAD_CMDLINE;
+    }
+
+    SHAPE_POLY_SET              zone;
+    std::vector<SHAPE_POLY_SET> shapes;
+
+    buildInputs( count, zone, shapes );
+
+    std::vector<double> passTimes[M_COUNT];
+    SHAPE_POLY_SET      results[M_COUNT];
+
+    // The methods are interleaved, so that they are all affected the same way by the
+    // state of the machine
+    for( long ii = 0; ii < passes; ++ii )
+    {
+        for( int method = 0; method < M_COUNT; ++method )
+        {
+            results[method] = zone;
+
+            PROF_COUNTER timer;
+            runMethod( (METHOD) method, results[method], shapes );
+            passTimes[method].push_back( timer.msecs() );
+        }
+    }
+
+    int      ret = RET_CODES::OK;
+    wxString outputName;
+
+    if( cl_parser.Found( "output", &outputName ) )
+    {
+        std::ofstream fout( outputName.ToStdString() );
+
+        if( fout )
+            writeJsonReport( fout, shapes.size(), passTimes, results );
+
+        if( !fout )
+        {
+            std::cerr << "Unable to write the report to " << outputName << std::endl;
+            ret = RET_CODES::WRITE_FAILED;
+        }
+    }
+    else
+    {
+        writeJsonReport( std::cout, shapes.size(), passTimes, results );
+    }
+
+    wxUninitialize();
+
+    return ret;
+}
@@ -0,0 +1,63 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "qa_report.h"
+
+#include <algorithm>
+#include <string>
+
+
+void KI_TEST::WriteJsonString( std::ostream& aOut, const wxString& aText )
+{
+    aOut << '"';
+
+    for( char c : std::string( aText.ToUTF8() ) )
+    {
+        switch( c )
+        {
+        case '"':  aOut << "\\\""; break;
+        case '\\': aOut << "\\\\"; break;
+        case '\n': aOut << "\\n";  break;
+        case '\r': aOut << "\\r";  break;
+        case '\t': aOut << "\\t";  break;
+        default:
+            if( (unsigned char) c < 0x20 )
+                aOut << wxString::Format( "\\u%04x", (int) c ).ToStdString();
+            else
+                aOut << c;
+        }
+    }
+
+    aOut << '"';
+}
+
+
+double KI_TEST::Percentile( const std::vector<double>& aSorted, double aRank )
+{
+    if( aSorted.empty() )
+        return 0.0;
+
+    size_t index = (size_t)( aRank * ( aSorted.size() - 1 ) + 0.5 );
+
+    return aSorted[ std::min( index, aSorted.size() - 1 ) ];
+}
@@ -0,0 +1,51 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef QA_REPORT_H
+#define QA_REPORT_H
+
+#include <wx/string.h>
+
+#include <ostream>
+#include <vector>
+
+/**
+ * Helpers shared by the QA tools writing their results as JSON reports.
+ */
+namespace KI_TEST
+{
+
+/**
+ * Write a string as a quoted and escaped JSON string.
+ */
+void WriteJsonString( std::ostream& aOut, const wxString& aText );
+
+/**
+ * Return the value of a given rank (0.0 for the smallest, 1.0 for the largest) in a sorted
+ * list of values, or 0.0 if the list is empty.
+ */
+double Percentile( const std::vector<double>& aSorted, double aRank );
+
+} // namespace KI_TEST
+
+#endif // QA_REPORT_H
@@ -0,0 +1,311 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Segment batch benchmark: tests segments and points against a set of track segments,
+ * with the SEG methods called on each segment and with a SEG_BATCH.  The time of each
+ * pass is written as JSON, along with a checksum of the results, which must be the same
+ * for the scalar and the batch version of each test.
+ *
+ * The segments are generated from a fixed seed, so two builds get the same inputs.
+ */
+
+#include <common.h>
+#include <geometry/seg_batch.h>
+#include <profile.h>
+#include <qa_report.h>
+
+#include <wx/init.h>
+#include <wx/cmdline.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+///> Size of the board, in nm
+static const int BOARD_SIZE = 100000000;
+
+///> Clearance used by the collision tests, in nm
+static const int CLEARANCE = 200000;
+
+
+/**
+ * Build track segments spread over the board, most of them horizontal, vertical or
+ * diagonal like the router makes them.
+ */
+static std::vector<SEG> buildSegments( std::mt19937& aRng, int aCount )
+{
+    std::uniform_int_distribution<int> pos( 0, BOARD_SIZE );
+    std::uniform_int_distribution<int> length( -BOARD_SIZE / 50, BOARD_SIZE / 50 );
+    std::uniform_int_distribution<int> direction( 0, 3 );
+    std::vector<SEG>                   segs;
+
+    for( int ii = 0; ii < aCount; ++ii )
+    {
+        VECTOR2I start( pos( aRng ), pos( aRng ) );
+        int      l = length( aRng );
+
+        switch( direction( aRng ) )
+        {
+        case 0:  segs.emplace_back( start, start + VECTOR2I( l, 0 ) ); break;
+        case 1:  segs.emplace_back( start, start + VECTOR2I( 0, l ) ); break;
+        case 2:  segs.emplace_back( start, start + VECTOR2I( l, l ) ); break;
+        default: segs.emplace_back( start, start + VECTOR2I( l, length( aRng ) ) ); break;
+        }
+    }
+
+    return segs;
+}
+
+
+///> Tests compared by the benchmark, each one in its scalar and batch version
+enum METHOD
+{
+    M_COLLIDE_SCALAR,           ///< SEG::Collide() on each segment
+    M_COLLIDE_BATCH,            ///< SEG_BATCH::Collide()
+    M_DISTANCE_SCALAR,          ///< SEG::SquaredDistance( SEG ) on each segment
+    M_DISTANCE_BATCH,           ///< SEG_BATCH::SquaredDistance( SEG )
+    M_POINT_DISTANCE_SCALAR,    ///< SEG::SquaredDistance( VECTOR2I ) on each segment
+    M_POINT_DISTANCE_BATCH,     ///< SEG_BATCH::SquaredDistance( VECTOR2I )
+    M_COUNT
+};
+
+
+static const char* const METHOD_NAMES[M_COUNT] = { "collide_scalar", "collide_batch",
+                                                    "distance_scalar", "distance_batch",
+                                                    "point_distance_scalar",
+                                                    "point_distance_batch" };
+
+
+/**
+ * Run a test for all the queries.
+ * @return a checksum of the results: the sum of the colliding segment indices, or of
+ * the smallest distances.
+ */
+static int64_t runMethod( METHOD aMethod, const std::vector<SEG>& aSegs, const SEG_BATCH& aBatch,
+                          const std::vector<SEG>& aQueries )
+{
+    int64_t checksum = 0;
+
+    for( const SEG& query : aQueries )
+    {
+        switch( aMethod )
+        {
+        case M_COLLIDE_SCALAR:
+        {
+            int found = -1;
+
+            for( int ii = 0; ii < (int) aSegs.size() && found < 0; ++ii )
+            {
+                if( aSegs[ii].Collide( query, CLEARANCE ) )
+                    found = ii;
+            }
+
+            checksum += found;
+            break;
+        }
+
+        case M_COLLIDE_BATCH:
+            checksum += aBatch.Collide( query, CLEARANCE );
+            break;
+
+        case M_DISTANCE_SCALAR:
+        case M_POINT_DISTANCE_SCALAR:
+        {
+            SEG::ecoord best = VECTOR2I::ECOORD_MAX;
+
+            for( const SEG& seg : aSegs )
+            {
+                if( aMethod == M_DISTANCE_SCALAR )
+                    best = std::min( best, seg.SquaredDistance( query ) );
+                else
+                    best = std::min( best, seg.SquaredDistance( query.A ) );
+            }
+
+            checksum += best;
+            break;
+        }
+
+        case M_DISTANCE_BATCH:
+            checksum += aBatch.SquaredDistance( query );
+            break;
+
+        case M_POINT_DISTANCE_BATCH:
+            checksum += aBatch.SquaredDistance( query.A );
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return checksum;
+}
+
+
+static void writeJsonReport( std::ostream& aOut, size_t aSegmentCount, size_t aQueryCount,
+                             std::vector<double> aPassTimes[M_COUNT],
+                             const int64_t aChecksums[M_COUNT] )
+{
+    aOut << "{\n  \"segments\": " << aSegmentCount << ",\n";
+    aOut << "  \"queries\": " << aQueryCount << ",\n";
+    aOut << "  \"methods\": {";
+
+    for( int ii = 0; ii < M_COUNT; ++ii )
+    {
+        std::vector<double>& times = aPassTimes[ii];
+
+        std::sort( times.begin(), times.end() );
+
+        aOut << ( ii ? ",\n" : "\n" );
+        aOut << "    \"" << METHOD_NAMES[ii] << "\": {\n";
+        aOut << "      \"checksum\": " << aChecksums[ii] << ",\n";
+        aOut << "      \"pass_p50_ms\": " << KI_TEST::Percentile( times, 0.5 ) << ",\n";
+        aOut << "      \"pass_p90_ms\": " << KI_TEST::Percentile( times, 0.9 ) << ",\n";
+        aOut << "      \"pass_max_ms\": " << ( times.empty() ? 0.0 : times.back() ) << "\n";
+        aOut << "    }";
+    }
+
+    aOut << "\n  }\n}\n";
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc [] =
+{
+    { wxCMD_LINE_SWITCH, "h", "help",
+        _( "displays help on the command line parameters" ).mb_str(),
+        wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "n", "passes",
+        _( "number of times each test is run (default 5)" ).mb_str(),
+        wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "c", "count",
+        _( "number of segments in the batch (default 2000)" ).mb_str(),
+        wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "q", "queries",
+        _( "number of segments and points tested against the batch (default 2000)" ).mb_str(),
+        wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "o", "output",
+        _( "write the JSON report to this file instead of the standard output" ).mb_str(),
+        wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum RET_CODES
+{
+    OK = 0,
+    BAD_CMDLINE = 1,
+    WRITE_FAILED = 3,
+};
+
+
+int main( int argc, char** argv )
+{
+    if( !wxInitialize() )
+        return RET_CODES::BAD_CMDLINE;
+
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program tests segments and points against a set of "
+        "segments, one by one and as a batch, and writes the time taken by each pass as "
+        "JSON." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        wxUninitialize();
+        return ( cmd_parsed_ok == -1 ) ? RET_CODES::OK : RET_CODES::BAD_CMDLINE;
+    }
+
+    long passes = 5;
+    long count = 2000;
+    long queries = 2000;
+
+    cl_parser.Found( "passes", &passes );
+    cl_parser.Found( "count", &count );
+    cl_parser.Found( "queries", &queries );
+
+    if( passes < 1 || count < 1 || queries < 1 )
+    {
+        std::cerr << "The number of passes, of segments and of queries must be positive"
+                  << std::endl;
+        wxUninitialize();
+        return RET_CODES::BAD_CMDLINE;
+    }
+
+    std::mt19937     rng( 1 );
+    std::vector<SEG> segs = buildSegments( rng, count );
+    std::vector<SEG> queryList = buildSegments( rng, queries );
+    SEG_BATCH        batch;
+
+    batch.Reserve( segs.size() );
+
+    for( const SEG& seg : segs )
+        batch.Add( seg );
+
+    std::vector<double> passTimes[M_COUNT];
+    int64_t             checksums[M_COUNT] = {};
+
+    // The methods are interleaved, so that they are all affected the same way by the
+    // state of the machine
+    for( long ii = 0; ii < passes; ++ii )
+    {
+        for( int method = 0; method < M_COUNT; ++method )
+        {
+            PROF_COUNTER timer;
+            checksums[method] = runMethod( (METHOD) method, segs, batch, queryList );
+            passTimes[method].push_back( timer.msecs() );
+        }
+    }
+
+    int      ret = RET_CODES::OK;
+    wxString outputName;
+
+    if( cl_parser.Found( "output", &outputName ) )
+    {
+        std::ofstream fout( outputName.ToStdString() );
+
+        if( fout )
+            writeJsonReport( fout, segs.size(), queryList.size(), passTimes, checksums );
+
+        if( !fout )
+        {
+            std::cerr << "Unable to write the report to " << outputName << std::endl;
+            ret = RET_CODES::WRITE_FAILED;
+        }
+    }
+    else
+    {
+        writeJsonReport( std::cout, segs.size(), queryList.size(), passTimes, checksums );
+    }
+
+    wxUninitialize();
+
+    return ret;
+}
@@ -0,0 +1,135 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_line_chain.h>
+
+#include <qa/data/fixtures_geometry.h>
+
+
+static SHAPE_POLY_SET makeRect( int aLeft, int aTop, int aRight, int aBottom )
+{
+    SHAPE_POLY_SET rect;
+
+    rect.NewOutline();
+    rect.Append( aLeft, aTop );
+    rect.Append( aRight, aTop );
+    rect.Append( aRight, aBottom );
+    rect.Append( aLeft, aBottom );
+
+    return rect;
+}
+
+
+/**
+ * Checks that two polysets cover the same area, whatever the way their outlines are split.
+ */
+static bool sameArea( const SHAPE_POLY_SET& aFirst, const SHAPE_POLY_SET& aSecond )
+{
+    SHAPE_POLY_SET onlyFirst = aFirst;
+    SHAPE_POLY_SET onlySecond = aSecond;
+
+    onlyFirst.BooleanSubtract( aSecond, SHAPE_POLY_SET::PM_FAST );
+    onlySecond.BooleanSubtract( aFirst, SHAPE_POLY_SET::PM_FAST );
+
+    return onlyFirst.IsEmpty() && onlySecond.IsEmpty();
+}
+
+
+/**
+ * Declares the BooleanBatch test suite, with the common polysets as fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( BooleanBatch, CommonTestData )
+
+/**
+ * Checks that an empty batch leaves the polyset unchanged.
+ */
+BOOST_AUTO_TEST_CASE( EmptyBatch )
+{
+    SHAPE_POLY_SET result = holeyPolySet;
+
+    result.BooleanBatch( {}, SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK_EQUAL( result.OutlineCount(), holeyPolySet.OutlineCount() );
+    BOOST_CHECK( sameArea( result, holeyPolySet ) );
+}
+
+/**
+ * Checks that a batch mixing all the operations gives the same result as the same
+ * operations done one by one.
+ */
+BOOST_AUTO_TEST_CASE( SameAsSequence )
+{
+    SHAPE_POLY_SET added = makeRect( 80, 80, 150, 150 );
+    SHAPE_POLY_SET cut1 = makeRect( -10, 40, 60, 45 );
+    SHAPE_POLY_SET cut2 = makeRect( 50, -10, 55, 200 );
+    SHAPE_POLY_SET window = makeRect( 5, 5, 140, 120 );
+    SHAPE_POLY_SET cut3 = makeRect( 90, 90, 100, 100 );
+
+    SHAPE_POLY_SET expected = holeyPolySet;
+
+    expected.BooleanAdd( added, SHAPE_POLY_SET::PM_FAST );
+    expected.BooleanSubtract( cut1, SHAPE_POLY_SET::PM_FAST );
+    expected.BooleanSubtract( cut2, SHAPE_POLY_SET::PM_FAST );
+    expected.BooleanIntersection( window, SHAPE_POLY_SET::PM_FAST );
+    expected.BooleanSubtract( cut3, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+
+    SHAPE_POLY_SET result = holeyPolySet;
+
+    result.BooleanBatch( { { SHAPE_POLY_SET::BO_ADD, &added },
+                           { SHAPE_POLY_SET::BO_SUBTRACT, &cut1 },
+                           { SHAPE_POLY_SET::BO_SUBTRACT, &cut2 },
+                           { SHAPE_POLY_SET::BO_INTERSECT, &window },
+                           { SHAPE_POLY_SET::BO_SUBTRACT, &cut3 } },
+                         SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+
+    BOOST_CHECK_EQUAL( result.OutlineCount(), expected.OutlineCount() );
+    BOOST_CHECK( sameArea( result, expected ) );
+}
+
+/**
+ * Checks that consecutive intersections are not merged into an intersection with the
+ * union of their operands.
+ */
+BOOST_AUTO_TEST_CASE( ConsecutiveIntersections )
+{
+    SHAPE_POLY_SET left = makeRect( 0, 0, 60, 100 );
+    SHAPE_POLY_SET right = makeRect( 40, 0, 100, 100 );
+
+    SHAPE_POLY_SET result = holeyPolySet;
+
+    result.BooleanBatch( { { SHAPE_POLY_SET::BO_INTERSECT, &left },
+                           { SHAPE_POLY_SET::BO_INTERSECT, &right } },
+                         SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET expected = holeyPolySet;
+
+    expected.BooleanIntersection( left, SHAPE_POLY_SET::PM_FAST );
+    expected.BooleanIntersection( right, SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK( sameArea( result, expected ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
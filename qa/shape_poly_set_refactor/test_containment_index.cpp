@@ -0,0 +1,174 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_line_chain.h>
+
+#include <qa/data/fixtures_geometry.h>
+
+#include <cmath>
+#include <random>
+
+
+/**
+ * Checks that Contains() gives the same answer with and without the containment index,
+ * for random points around the polyset and for all its vertices.
+ */
+static void checkContainment( const SHAPE_POLY_SET& aPolySet, std::mt19937& aRng,
+                              int aPointCount )
+{
+    SHAPE_POLY_SET indexed = aPolySet;
+
+    indexed.EnableContainmentIndex();
+
+    BOX2I bbox = aPolySet.BBox( 10 );
+    std::uniform_int_distribution<int> xDist( bbox.GetLeft(), bbox.GetRight() );
+    std::uniform_int_distribution<int> yDist( bbox.GetTop(), bbox.GetBottom() );
+    std::vector<VECTOR2I> points;
+
+    for( int ii = 0; ii < aPointCount; ii++ )
+        points.emplace_back( xDist( aRng ), yDist( aRng ) );
+
+    for( int polyIdx = 0; polyIdx < aPolySet.OutlineCount(); polyIdx++ )
+    {
+        for( const SHAPE_LINE_CHAIN& path : aPolySet.CPolygon( polyIdx ) )
+        {
+            for( int ii = 0; ii < path.PointCount(); ii++ )
+                points.push_back( path.CPoint( ii ) );
+        }
+    }
+
+    for( const VECTOR2I& point : points )
+    {
+        for( int ignoreHoles = 0; ignoreHoles < 2; ignoreHoles++ )
+        {
+            BOOST_CHECK_EQUAL( indexed.Contains( point, -1, ignoreHoles ),
+                               aPolySet.Contains( point, -1, ignoreHoles ) );
+
+            for( int polyIdx = 0; polyIdx < aPolySet.OutlineCount(); polyIdx++ )
+            {
+                BOOST_CHECK_EQUAL( indexed.Contains( point, polyIdx, ignoreHoles ),
+                                   aPolySet.Contains( point, polyIdx, ignoreHoles ) );
+            }
+        }
+    }
+}
+
+
+/**
+ * Declares the ContainmentIndex test suite, with the common polysets as fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( ContainmentIndex, CommonTestData )
+
+/**
+ * Checks the index on the small polysets of the fixture.
+ */
+BOOST_AUTO_TEST_CASE( CommonPolySets )
+{
+    std::mt19937 rng( 1 );
+
+    checkContainment( holeyPolySet, rng, 2000 );
+    checkContainment( solidPolySet, rng, 2000 );
+    checkContainment( uniqueVertexPolySet, rng, 2000 );
+}
+
+/**
+ * Checks the index on a polygon with many edges and holes, so that the edges are
+ * spread over many bands.
+ */
+BOOST_AUTO_TEST_CASE( LargePolygon )
+{
+    SHAPE_POLY_SET polySet;
+    std::mt19937   rng( 2 );
+
+    // A star shaped outline with 2000 vertices
+    polySet.NewOutline();
+
+    for( int ii = 0; ii < 2000; ii++ )
+    {
+        double angle = 2.0 * M_PI * ii / 2000;
+        double radius = ( ii % 2 ) ? 100000.0 : 80000.0;
+
+        polySet.Append( (int) std::round( radius * cos( angle ) ),
+                        (int) std::round( radius * sin( angle ) ) );
+    }
+
+    // Square holes on a grid, some of them sharing the rows of the outline vertices
+    for( int x = -40000; x <= 40000; x += 20000 )
+    {
+        for( int y = -40000; y <= 40000; y += 20000 )
+        {
+            int hole = polySet.NewHole();
+
+            polySet.Append( x - 5000, y - 5000, -1, hole );
+            polySet.Append( x + 5000, y - 5000, -1, hole );
+            polySet.Append( x + 5000, y + 5000, -1, hole );
+            polySet.Append( x - 5000, y + 5000, -1, hole );
+        }
+    }
+
+    checkContainment( polySet, rng, 20000 );
+}
+
+/**
+ * Checks that the index follows the changes made to the polyset.
+ */
+BOOST_AUTO_TEST_CASE( Invalidation )
+{
+    SHAPE_POLY_SET polySet = holeyPolySet;
+
+    polySet.EnableContainmentIndex();
+
+    VECTOR2I outside( 1000, 1000 );
+    BOOST_CHECK( !polySet.Contains( outside ) );
+
+    polySet.Move( VECTOR2I( 950, 950 ) );
+    BOOST_CHECK( polySet.Contains( outside ) == holeyPolySet.Contains( VECTOR2I( 50, 50 ) ) );
+
+    polySet.RemoveAllContours();
+    BOOST_CHECK( !polySet.Contains( outside ) );
+
+    polySet.NewOutline();
+    polySet.Append( 900, 900 );
+    polySet.Append( 1100, 900 );
+    polySet.Append( 1100, 1100 );
+    polySet.Append( 900, 1100 );
+    BOOST_CHECK( polySet.Contains( outside ) );
+
+    // A copy shares the index, but changing it must not change the original
+    SHAPE_POLY_SET copy = polySet;
+    BOOST_CHECK( copy.IsContainmentIndexEnabled() );
+
+    copy.Move( VECTOR2I( 1000, 0 ) );
+    BOOST_CHECK( !copy.Contains( outside ) );
+    BOOST_CHECK( polySet.Contains( outside ) );
+
+    // An assignment keeps the setting of the assigned set
+    SHAPE_POLY_SET assigned;
+    assigned = polySet;
+    BOOST_CHECK( !assigned.IsContainmentIndexEnabled() );
+    BOOST_CHECK( assigned.Contains( outside ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,171 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_line_chain.h>
+#include <thread_pool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+
+// SimplifyParallel() puts at least this count of polygons in each strip
+static const size_t minPolysPerStrip = 250;
+
+
+/**
+ * Builds aCount random overlapping rectangles along a wide band, every third one with a
+ * square hole, which the neighbour rectangles may fill in again.
+ */
+static SHAPE_POLY_SET makeOverlappingRects( size_t aCount, unsigned aSeed )
+{
+    SHAPE_POLY_SET polySet;
+    std::mt19937   rng( aSeed );
+    int            bandWidth = (int) aCount * 40;
+
+    std::uniform_int_distribution<int> posX( 0, bandWidth );
+    std::uniform_int_distribution<int> posY( 0, 5000 );
+    std::uniform_int_distribution<int> size( 200, 800 );
+
+    for( size_t ii = 0; ii < aCount; ii++ )
+    {
+        int left = posX( rng );
+        int top = posY( rng );
+        int width = size( rng );
+        int height = size( rng );
+
+        polySet.NewOutline();
+        polySet.Append( left, top );
+        polySet.Append( left + width, top );
+        polySet.Append( left + width, top + height );
+        polySet.Append( left, top + height );
+
+        if( ii % 3 == 0 )
+        {
+            int cx = left + width / 2;
+            int cy = top + height / 2;
+            int half = std::min( width, height ) / 4;
+            int hole = polySet.NewHole();
+
+            polySet.Append( cx - half, cy - half, -1, hole );
+            polySet.Append( cx + half, cy - half, -1, hole );
+            polySet.Append( cx + half, cy + half, -1, hole );
+            polySet.Append( cx - half, cy + half, -1, hole );
+        }
+    }
+
+    return polySet;
+}
+
+
+/**
+ * Returns the area covered by a simplified polyset, the holes being removed.
+ */
+static double totalArea( const SHAPE_POLY_SET& aPolySet )
+{
+    double area = 0.0;
+
+    for( int ii = 0; ii < aPolySet.OutlineCount(); ii++ )
+    {
+        area += std::fabs( aPolySet.COutline( ii ).Area() );
+
+        for( int jj = 0; jj < aPolySet.HoleCount( ii ); jj++ )
+            area -= std::fabs( aPolySet.CHole( ii, jj ).Area() );
+    }
+
+    return area;
+}
+
+
+/**
+ * Checks that the parallel simplification of a polyset covers the same area, with the
+ * same outlines, as its single threaded simplification.
+ */
+static void checkSameAsSimplify( const SHAPE_POLY_SET& aPolySet, size_t aMaxStrips )
+{
+    SHAPE_POLY_SET expected = aPolySet;
+    SHAPE_POLY_SET result = aPolySet;
+
+    expected.Simplify( SHAPE_POLY_SET::PM_FAST );
+    result.SimplifyParallel( SHAPE_POLY_SET::PM_FAST, aMaxStrips );
+
+    BOOST_CHECK_EQUAL( result.OutlineCount(), expected.OutlineCount() );
+    BOOST_CHECK_CLOSE( totalArea( result ), totalArea( expected ), 1e-9 );
+
+    // Symmetric difference
+    SHAPE_POLY_SET onlyResult = result;
+    SHAPE_POLY_SET onlyExpected = expected;
+
+    onlyResult.BooleanSubtract( expected, SHAPE_POLY_SET::PM_FAST );
+    onlyExpected.BooleanSubtract( result, SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK( onlyResult.IsEmpty() );
+    BOOST_CHECK( onlyExpected.IsEmpty() );
+}
+
+
+/**
+ * Declares the SimplifyParallel test suite.
+ */
+BOOST_AUTO_TEST_SUITE( SimplifyParallel )
+
+/**
+ * Checks a set large enough to give a strip to each worker thread.
+ */
+BOOST_AUTO_TEST_CASE( OneStripByThread )
+{
+    size_t threads = THREAD_POOL::Get().GetThreadCount();
+    SHAPE_POLY_SET polySet = makeOverlappingRects( minPolysPerStrip * threads + 37, 1 );
+
+    checkSameAsSimplify( polySet, 0 );
+}
+
+/**
+ * Checks odd strip counts, which leave one strip without partner in some merge rounds.
+ */
+BOOST_AUTO_TEST_CASE( OddStripCount )
+{
+    size_t threads = THREAD_POOL::Get().GetThreadCount();
+    SHAPE_POLY_SET polySet = makeOverlappingRects(
+            minPolysPerStrip * std::max<size_t>( threads, 7 ) + 37, 2 );
+
+    for( size_t strips : { 3, 5, 7 } )
+    {
+        BOOST_TEST_CONTEXT( "Strips: " << strips )
+        {
+            checkSameAsSimplify( polySet, strips );
+        }
+    }
+}
+
+/**
+ * Checks that a set too small to be split is simplified as well.
+ */
+BOOST_AUTO_TEST_CASE( SmallSet )
+{
+    checkSameAsSimplify( makeOverlappingRects( minPolysPerStrip - 1, 3 ), 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
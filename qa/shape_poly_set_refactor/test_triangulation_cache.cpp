@@ -0,0 +1,204 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_line_chain.h>
+
+#include <qa/data/fixtures_geometry.h>
+
+#include <cmath>
+
+
+/**
+ * Adds a square outline to a polyset, starting from its corner number aFirstCorner.
+ */
+static void addSquare( SHAPE_POLY_SET& aPolySet, int aX, int aY, int aSize, int aFirstCorner = 0 )
+{
+    const VECTOR2I corners[4] = { VECTOR2I( aX, aY ), VECTOR2I( aX + aSize, aY ),
+                                  VECTOR2I( aX + aSize, aY + aSize ), VECTOR2I( aX, aY + aSize ) };
+
+    aPolySet.NewOutline();
+
+    for( int ii = 0; ii < 4; ii++ )
+        aPolySet.Append( corners[( aFirstCorner + ii ) % 4] );
+}
+
+
+/**
+ * Area of a polyset: the one of its outlines, less the one of their holes.
+ */
+static double polySetArea( const SHAPE_POLY_SET& aPolySet )
+{
+    double area = 0.0;
+
+    for( int ii = 0; ii < aPolySet.OutlineCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::POLYGON& polygon = aPolySet.CPolygon( ii );
+
+        for( size_t jj = 0; jj < polygon.size(); jj++ )
+            area += ( jj ? -1.0 : 1.0 ) * std::abs( polygon[jj].Area() );
+    }
+
+    return area;
+}
+
+
+/**
+ * Sum of the areas of the triangles of a triangulated polyset.
+ */
+static double triangulatedArea( const SHAPE_POLY_SET& aPolySet )
+{
+    double area = 0.0;
+
+    for( unsigned int ii = 0; ii < aPolySet.TriangulatedPolyCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* tri = aPolySet.TriangulatedPolygon( ii );
+
+        for( size_t jj = 0; jj < tri->GetTriangleCount(); jj++ )
+        {
+            VECTOR2I a, b, c;
+
+            tri->GetTriangle( jj, a, b, c );
+            area += std::abs( (double) ( b - a ).Cross( c - a ) ) / 2.0;
+        }
+    }
+
+    return area;
+}
+
+
+/**
+ * Declares the TriangulationCache test suite, with the common polysets as fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( TriangulationCache, CommonTestData )
+
+/**
+ * Checks that the triangles cover the area of the polysets, also when the same thread
+ * triangulates several of them and reuses its vertices.
+ */
+BOOST_AUTO_TEST_CASE( CoversArea )
+{
+    SHAPE_POLY_SET squares;
+
+    addSquare( squares, 0, 0, 100 );
+    addSquare( squares, 500, 0, 300, 1 );
+
+    for( const SHAPE_POLY_SET* source : { &holeyPolySet, &squares, &holeyPolySet } )
+    {
+        SHAPE_POLY_SET polySet = *source;
+
+        polySet.CacheTriangulation();
+
+        BOOST_CHECK( polySet.IsTriangulationUpToDate() );
+        BOOST_CHECK_CLOSE( triangulatedArea( polySet ), polySetArea( *source ), 1e-6 );
+    }
+}
+
+/**
+ * Checks that the outlines which are the same after an assignment keep their triangles,
+ * even when they start from another point, and that the other ones are triangulated again.
+ */
+BOOST_AUTO_TEST_CASE( ReusesUnchangedOutlines )
+{
+    SHAPE_POLY_SET polySet;
+
+    addSquare( polySet, 0, 0, 100 );
+    addSquare( polySet, 200, 0, 100 );
+    polySet.CacheTriangulation();
+
+    BOOST_REQUIRE_EQUAL( polySet.TriangulatedPolyCount(), 2 );
+
+    const SHAPE_POLY_SET::TRIANGULATED_POLYGON* unchanged = polySet.TriangulatedPolygon( 0 );
+
+    SHAPE_POLY_SET refilled;
+
+    addSquare( refilled, 0, 0, 100, 2 );
+    addSquare( refilled, 200, 0, 150 );
+    polySet = refilled;
+
+    BOOST_CHECK_EQUAL( polySet.TriangulatedPolyCount(), 0 );
+
+    polySet.CacheTriangulation();
+
+    BOOST_REQUIRE_EQUAL( polySet.TriangulatedPolyCount(), 2 );
+    BOOST_CHECK( polySet.IsTriangulationUpToDate() );
+    BOOST_CHECK( polySet.TriangulatedPolygon( 0 ) == unchanged );
+    BOOST_CHECK_CLOSE( triangulatedArea( polySet ), polySetArea( refilled ), 1e-6 );
+}
+
+/**
+ * Checks that an outline changed in place is triangulated again.
+ */
+BOOST_AUTO_TEST_CASE( ChangedInPlace )
+{
+    SHAPE_POLY_SET polySet;
+
+    addSquare( polySet, 0, 0, 100 );
+    polySet.CacheTriangulation();
+
+    polySet.Outline( 0 ).Point( 2 ) = VECTOR2I( 300, 300 );
+
+    BOOST_CHECK( !polySet.IsTriangulationUpToDate() );
+
+    polySet.CacheTriangulation();
+
+    BOOST_CHECK( polySet.IsTriangulationUpToDate() );
+    BOOST_CHECK_CLOSE( triangulatedArea( polySet ), polySetArea( polySet ), 1e-6 );
+}
+
+/**
+ * Checks that the polygons triangulated after one larger than the vertex pool kept by
+ * the thread are still right.
+ */
+BOOST_AUTO_TEST_CASE( AfterLargePolygon )
+{
+    SHAPE_POLY_SET circle;
+    const int      pointCount = 40000;
+
+    circle.NewOutline();
+
+    for( int ii = 0; ii < pointCount; ii++ )
+    {
+        double angle = 2.0 * M_PI * ii / pointCount;
+
+        circle.Append( (int) std::round( 10000000.0 * cos( angle ) ),
+                       (int) std::round( 10000000.0 * sin( angle ) ) );
+    }
+
+    SHAPE_POLY_SET square;
+
+    addSquare( square, 0, 0, 100 );
+
+    for( SHAPE_POLY_SET* polySet : { &circle, &square, &circle } )
+    {
+        SHAPE_POLY_SET copy = *polySet;
+
+        copy.CacheTriangulation();
+
+        BOOST_CHECK( copy.IsTriangulationUpToDate() );
+        BOOST_CHECK_CLOSE( triangulatedArea( copy ), polySetArea( *polySet ), 1e-6 );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
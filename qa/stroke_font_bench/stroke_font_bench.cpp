@@ -0,0 +1,280 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Stroke font benchmark: loads a board and draws all its texts with the stroke font
+ * several times, the same way the board painter does, on a GAL which only counts the
+ * polylines it receives.  The time of each pass is written as JSON, to be compared
+ * between two builds; the polyline and point counts must not change between them.
+ */
+
+#include <io_mgr.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pcb_text.h>
+#include <class_text_mod.h>
+#include <profile.h>
+#include <qa_report.h>
+
+#include <gal/graphics_abstraction_layer.h>
+#include <gal/gal_display_options.h>
+
+#include <wx/init.h>
+#include <wx/cmdline.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+
+/**
+ * GAL drawing nothing, only counting the strokes of the texts.
+ */
+class COUNTING_GAL : public KIGFX::GAL
+{
+public:
+    COUNTING_GAL( KIGFX::GAL_DISPLAY_OPTIONS& aOptions ) :
+        GAL( aOptions ),
+        m_polylines( 0 ),
+        m_points( 0 )
+    {
+    }
+
+    void DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint ) override
+    {
+        m_polylines++;
+        m_points += 2;
+    }
+
+    void DrawPolyline( const std::deque<VECTOR2D>& aPointList ) override
+    {
+        m_polylines++;
+        m_points += aPointList.size();
+    }
+
+    void DrawPolyline( const VECTOR2D aPointList[], int aListSize ) override
+    {
+        m_polylines++;
+        m_points += aListSize;
+    }
+
+    uint64_t m_polylines;
+    uint64_t m_points;
+};
+
+
+static void drawTexts( KIGFX::GAL& aGal, const std::vector<TEXTE_PCB*>& aBoardTexts,
+                       const std::vector<TEXTE_MODULE*>& aModuleTexts )
+{
+    for( auto text : aBoardTexts )
+    {
+        aGal.SetLineWidth( text->GetThickness() );
+        aGal.SetTextAttributes( text );
+        aGal.StrokeText( text->GetShownText(), VECTOR2D( text->GetTextPos() ),
+                         text->GetTextAngleRadians() );
+    }
+
+    for( auto text : aModuleTexts )
+    {
+        aGal.SetLineWidth( text->GetThickness() );
+        aGal.SetTextAttributes( text );
+        aGal.StrokeText( text->GetShownText(), VECTOR2D( text->GetTextPos() ),
+                         text->GetDrawRotationRadians() );
+    }
+}
+
+
+static void writeJsonReport( std::ostream& aOut, const wxString& aBoardName, size_t aTextCount,
+                             uint64_t aPolylines, uint64_t aPoints,
+                             std::vector<double>& aPassTimes, double aLoadTime )
+{
+    double total = 0.0;
+
+    for( double t : aPassTimes )
+        total += t;
+
+    std::sort( aPassTimes.begin(), aPassTimes.end() );
+
+    aOut << "{\n  \"board\": ";
+    KI_TEST::WriteJsonString( aOut, aBoardName );
+    aOut << ",\n";
+    aOut << "  \"texts\": " << aTextCount << ",\n";
+    aOut << "  \"passes\": " << aPassTimes.size() << ",\n";
+    aOut << "  \"polylines_per_pass\": " << aPolylines << ",\n";
+    aOut << "  \"points_per_pass\": " << aPoints << ",\n";
+    aOut << "  \"timings_ms\": {\n";
+    aOut << "    \"load\": " << aLoadTime << ",\n";
+    aOut << "    \"pass_p50\": " << KI_TEST::Percentile( aPassTimes, 0.5 ) << ",\n";
+    aOut << "    \"pass_p90\": " << KI_TEST::Percentile( aPassTimes, 0.9 ) << ",\n";
+    aOut << "    \"pass_max\": " << ( aPassTimes.empty() ? 0.0 : aPassTimes.back() ) << ",\n";
+    aOut << "    \"total\": " << total << "\n  }\n}\n";
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc [] =
+{
+    { wxCMD_LINE_SWITCH, "h", "help",
+        _( "displays help on the command line parameters" ).mb_str(),
+        wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "n", "passes",
+        _( "number of times all the texts are drawn (default 20)" ).mb_str(),
+        wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "o", "output",
+        _( "write the JSON report to this file instead of the standard output" ).mb_str(),
+        wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr,
+        _( "input board file" ).mb_str(),
+        wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum RET_CODES
+{
+    OK = 0,
+    BAD_CMDLINE = 1,
+    LOAD_FAILED = 2,
+    WRITE_FAILED = 3,
+};
+
+
+int main( int argc, char** argv )
+{
+    if( !wxInitialize() )
+        return RET_CODES::BAD_CMDLINE;
+
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program draws all the texts of a board with the stroke "
+        "font, without any display, and writes the time taken by each pass as JSON." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        wxUninitialize();
+        return ( cmd_parsed_ok == -1 ) ? RET_CODES::OK : RET_CODES::BAD_CMDLINE;
+    }
+
+    const wxString filename = cl_parser.GetParam( 0 );
+    long           passes = 20;
+
+    cl_parser.Found( "passes", &passes );
+
+    if( passes < 1 )
+    {
+        std::cerr << "The number of passes must be positive" << std::endl;
+        wxUninitialize();
+        return RET_CODES::BAD_CMDLINE;
+    }
+
+    PROF_COUNTER loadTimer;
+    std::unique_ptr<BOARD> board;
+
+    try
+    {
+        board.reset( IO_MGR::Load( IO_MGR::KICAD_SEXP, filename ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << ioe.What() << std::endl;
+    }
+
+    if( !board )
+    {
+        wxUninitialize();
+        return RET_CODES::LOAD_FAILED;
+    }
+
+    double loadTime = loadTimer.msecs();
+
+    std::vector<TEXTE_PCB*>    boardTexts;
+    std::vector<TEXTE_MODULE*> moduleTexts;
+
+    for( auto item : board->Drawings() )
+    {
+        if( item->Type() == PCB_TEXT_T )
+            boardTexts.push_back( static_cast<TEXTE_PCB*>( item ) );
+    }
+
+    for( auto module : board->Modules() )
+    {
+        moduleTexts.push_back( &module->Reference() );
+        moduleTexts.push_back( &module->Value() );
+
+        for( auto item : module->GraphicalItems() )
+        {
+            if( item->Type() == PCB_MODULE_TEXT_T )
+                moduleTexts.push_back( static_cast<TEXTE_MODULE*>( item ) );
+        }
+    }
+
+    KIGFX::GAL_DISPLAY_OPTIONS options;
+    COUNTING_GAL               gal( options );
+    std::vector<double>        passTimes;
+
+    for( long ii = 0; ii < passes; ++ii )
+    {
+        gal.m_polylines = 0;
+        gal.m_points = 0;
+
+        PROF_COUNTER timer;
+        drawTexts( gal, boardTexts, moduleTexts );
+        passTimes.push_back( timer.msecs() );
+    }
+
+    size_t   textCount = boardTexts.size() + moduleTexts.size();
+    int      ret = RET_CODES::OK;
+    wxString outputName;
+
+    if( cl_parser.Found( "output", &outputName ) )
+    {
+        std::ofstream fout( outputName.ToStdString() );
+
+        if( fout )
+        {
+            writeJsonReport( fout, filename, textCount, gal.m_polylines, gal.m_points,
+                             passTimes, loadTime );
+        }
+
+        if( !fout )
+        {
+            std::cerr << "Unable to write the report to " << outputName << std::endl;
+            ret = RET_CODES::WRITE_FAILED;
+        }
+    }
+    else
+    {
+        writeJsonReport( std::cout, filename, textCount, gal.m_polylines, gal.m_points,
+                         passTimes, loadTime );
+    }
+
+    board.reset();
+    wxUninitialize();
+
+    return ret;
+}